@@ -0,0 +1,418 @@
+/*
+ *  Copyright 2001-2007 Adrian Thurston <thurston@complang.org>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "autostyle.h"
+#include "redfsm.h"
+#include <math.h>
+#include <string.h>
+
+using std::endl;
+
+/* Fixed costs of the generated drivers, in bytes of code. These, and the
+ * per item costs below, are rough figures taken from C output. They only
+ * need to rank the styles, not predict the object size. */
+#define DRIVER_TABLE     600
+#define DRIVER_FLAT      500
+#define DRIVER_GOTO      300
+#define CASE_BYTES       8
+#define SINGLE_BYTES     8
+#define RANGE_BYTES      10
+#define STATE_BYTES      24
+#define TRANS_BYTES      8
+
+/* Statistics of a reduced machine, taken as if defaults were already chosen
+ * by span. The per key figures are averaged over the states, weighted by the
+ * profile when there is one. */
+struct MachineStats
+{
+	MachineStats()
+	:
+		states(0), trans(0), singles(0), ranges(0), defaults(0),
+		maxSingles(0), maxRanges(0), flatSlots(0), maxSpan(0),
+		actions(0), actionTables(0), actionItems(0), actionCode(0),
+		tableCode(0), transCode(0), stateActionKinds(0),
+		tableSteps(0), gotoSteps(0), tableRate(0), actionRate(0)
+	{}
+
+	long long states, trans;
+	long long singles, ranges, defaults;
+	long long maxSingles, maxRanges;
+	long long flatSlots, maxSpan;
+
+	/* Distinct actions and action tables referenced, the length of the
+	 * action array and the code of the actions written once per action, once
+	 * per table and once per transition carrying a table. */
+	long long actions, actionTables, actionItems;
+	long long actionCode, tableCode, transCode;
+
+	/* How many of the to-state, from-state and EOF action arrays exist. */
+	int stateActionKinds;
+
+	/* Search steps per key in the table and goto styles, and the tables and
+	 * actions executed per key. */
+	double tableSteps, gotoSteps;
+	double tableRate, actionRate;
+};
+
+/* Bytes taken by an array element that must hold maxVal. */
+static long long elementSize( long long maxVal )
+{
+	HostType *type = keyOps->typeSubsumes( maxVal );
+	return type != 0 ? type->size : 8;
+}
+
+static double log2Steps( long long items )
+{
+	return log( (double)( items + 1 ) ) / log( 2.0 );
+}
+
+/* Rough size of the code written for an inline list: the text it carries
+ * plus a little for each statement ragel writes itself. */
+static long long inlineSize( GenInlineList *inlineList )
+{
+	long long size = 0;
+	if ( inlineList == 0 )
+		return size;
+
+	for ( GenInlineList::Iter item = *inlineList; item.lte(); item++ ) {
+		if ( item->type == GenInlineItem::Text && item->data != 0 )
+			size += wcslen( item->data );
+		else
+			size += 8;
+		size += inlineSize( item->children );
+	}
+	return size;
+}
+
+static long long tableSize( RedAction *action )
+{
+	long long size = CASE_BYTES;
+	for ( GenActionTable::Iter item = action->key; item.lte(); item++ )
+		size += inlineSize( item->value->inlineList );
+	return size;
+}
+
+static void countActions( RedFsmAp *redFsm, MachineStats &stats )
+{
+	/* Only tables that something refers to get written. */
+	BstSet<RedAction*> used;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		if ( st->toStateAction != 0 )
+			used.insert( st->toStateAction );
+		if ( st->fromStateAction != 0 )
+			used.insert( st->fromStateAction );
+		if ( st->eofAction != 0 )
+			used.insert( st->eofAction );
+	}
+	for ( TransApSet::Iter trans = redFsm->transSet; trans.lte(); trans++ ) {
+		if ( trans->action != 0 ) {
+			used.insert( trans->action );
+			stats.transCode += tableSize( trans->action );
+		}
+	}
+
+	BstSet<GenAction*> usedActions;
+	for ( BstSet<RedAction*>::Iter act = used; act.lte(); act++ ) {
+		stats.actionTables += 1;
+		stats.actionItems += 1 + (*act)->key.length();
+		stats.tableCode += tableSize( *act );
+		for ( GenActionTable::Iter item = (*act)->key; item.lte(); item++ )
+			usedActions.insert( item->value );
+	}
+
+	for ( BstSet<GenAction*>::Iter act = usedActions; act.lte(); act++ )
+		stats.actionCode += CASE_BYTES + inlineSize( (*act)->inlineList );
+	stats.actions = usedActions.length();
+}
+
+static void collectStats( RedFsmAp *redFsm, MachineStats &stats )
+{
+	bool anyTo = false, anyFrom = false, anyEof = false;
+	double totalWeight = 0;
+	bool weighted = false;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		if ( st->profVisits > 0 )
+			weighted = true;
+	}
+
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		stats.states += 1;
+		anyTo = anyTo || st->toStateAction != 0;
+		anyFrom = anyFrom || st->fromStateAction != 0;
+		anyEof = anyEof || st->eofAction != 0;
+
+		/* The default is the transition that chooseDefaultSpan would take
+		 * out of the list. */
+		RedTransAp *defTrans = 0;
+		if ( redFsm->alphabetCovered( st->outRange ) )
+			defTrans = redFsm->chooseDefaultSpan( st );
+		if ( defTrans != 0 )
+			stats.defaults += 1;
+
+		long long singles = 0, ranges = 0;
+		Key lowKey = keyOps->minKey, highKey = keyOps->minKey;
+		double tables = 0, actions = 0;
+		long long keys = 0;
+		for ( RedTransList::Iter rtel = st->outRange; rtel.lte(); rtel++ ) {
+			/* Without a profile every range counts the same. */
+			double hits = weighted ? (double)rtel->profCount : 1.0;
+			keys += weighted ? rtel->profCount : 1;
+			if ( rtel->value->action != 0 ) {
+				tables += hits;
+				actions += hits * rtel->value->action->key.length();
+			}
+
+			if ( rtel->value == defTrans )
+				continue;
+
+			if ( singles + ranges == 0 )
+				lowKey = rtel->lowKey;
+			highKey = rtel->highKey;
+			if ( rtel->lowKey == rtel->highKey )
+				singles += 1;
+			else
+				ranges += 1;
+		}
+
+		stats.singles += singles;
+		stats.ranges += ranges;
+		if ( singles > stats.maxSingles )
+			stats.maxSingles = singles;
+		if ( ranges > stats.maxRanges )
+			stats.maxRanges = ranges;
+		if ( singles + ranges > 0 ) {
+			long long span = keyOps->span( lowKey, highKey );
+			stats.flatSlots += span;
+			if ( span > stats.maxSpan )
+				stats.maxSpan = span;
+		}
+
+		double weight = weighted ? (double)st->profVisits : 1.0;
+		if ( weight > 0 ) {
+			totalWeight += weight;
+			stats.tableSteps += weight * ( log2Steps( singles ) + log2Steps( ranges ) );
+			stats.gotoSteps += weight * log2Steps( singles + ranges );
+			if ( keys > 0 ) {
+				stats.tableRate += weight * tables / keys;
+				stats.actionRate += weight * actions / keys;
+			}
+		}
+	}
+
+	if ( totalWeight > 0 ) {
+		stats.tableSteps /= totalWeight;
+		stats.gotoSteps /= totalWeight;
+		stats.tableRate /= totalWeight;
+		stats.actionRate /= totalWeight;
+	}
+
+	stats.trans = redFsm->transSet.length();
+	stats.stateActionKinds = ( anyTo ? 1 : 0 ) + ( anyFrom ? 1 : 0 ) + ( anyEof ? 1 : 0 );
+	countActions( redFsm, stats );
+}
+
+static void estimateStyle( const MachineStats &stats, StyleEstimate &est )
+{
+	long long alphSize = keyOps->alphType->size;
+	long long stateSize = elementSize( stats.states );
+	long long transSize = elementSize( stats.trans );
+
+	/* The 0 styles refer to offsets into an array of action lists that the
+	 * driver loops over. The 1 styles switch on the table id and have the
+	 * code of every table written out in full. */
+	bool listed = est.style == GenTables || est.style == GenFlat || est.style == GenGoto;
+	long long actSize = listed ? elementSize( stats.actionItems ) :
+			elementSize( stats.actionTables );
+	long long actionArray = listed ? stats.actionItems * elementSize( stats.actions ) : 0;
+	long long actionCode = listed ? stats.actionCode : stats.tableCode;
+	double actionCost = 1.5 * stats.tableRate + ( listed ? 1.5 * stats.actionRate : 0 );
+
+	/* Dispatch costs were fitted to the throughput of each style on a C
+	 * tokenizer. Tables pay for a chain of dependent loads, the goto styles
+	 * for the state switch and the branches of the search. */
+	long long transArrays = stats.trans * ( stateSize + actSize );
+	long long stateActions = stats.stateActionKinds * stats.states * actSize;
+	long long indicies = stats.singles + stats.ranges + stats.defaults;
+
+	switch ( est.style ) {
+	case GenTables:
+	case GenFTables: {
+		long long keys = stats.singles + 2 * stats.ranges;
+		est.tableBytes = actionArray + transArrays + stateActions +
+				keys * alphSize + indicies * transSize +
+				stats.states * ( elementSize( keys ) + elementSize( stats.maxSingles ) +
+				elementSize( stats.maxRanges ) + elementSize( indicies ) );
+		est.codeBytes = DRIVER_TABLE + actionCode;
+		est.dispatchCost = 15 + 1.8 * stats.tableSteps + actionCost;
+		break;
+	}
+	case GenFlat:
+	case GenFFlat: {
+		long long slots = stats.flatSlots + stats.defaults;
+		est.tableBytes = actionArray + transArrays + stateActions +
+				2 * stats.states * alphSize + slots * transSize +
+				stats.states * ( elementSize( stats.maxSpan ) + elementSize( slots ) );
+		est.codeBytes = DRIVER_FLAT + actionCode;
+		est.dispatchCost = 15 + actionCost;
+		break;
+	}
+	case GenGoto:
+	case GenFGoto:
+		/* State actions stay in arrays only in the 0 style. */
+		est.tableBytes = actionArray + ( listed ? stateActions : 0 );
+		est.codeBytes = DRIVER_GOTO + actionCode + stats.states * STATE_BYTES +
+				stats.singles * SINGLE_BYTES + stats.ranges * RANGE_BYTES +
+				stats.trans * TRANS_BYTES;
+		est.dispatchCost = 2.5 + stats.gotoSteps + actionCost;
+		break;
+	case GenIpGoto:
+		/* Every state is code and the actions are written at each
+		 * transition that carries them. */
+		est.tableBytes = 0;
+		est.codeBytes = DRIVER_GOTO + stats.transCode + stats.states * STATE_BYTES +
+				stats.singles * SINGLE_BYTES + stats.ranges * RANGE_BYTES;
+		est.dispatchCost = 1 + stats.gotoSteps;
+		break;
+	default:
+		est.tableBytes = est.codeBytes = 0;
+		est.dispatchCost = 0;
+		break;
+	}
+}
+
+/* The styles that the generator of the host language can write. */
+static void candidateStyles( Vector<CodeStyle> &styles )
+{
+	styles.append( GenTables );
+	if ( hostLang->lang == HostLang::Java )
+		return;
+
+	styles.append( GenFTables );
+	styles.append( GenFlat );
+	styles.append( GenFFlat );
+
+	if ( hostLang->lang == HostLang::Ruby ) {
+		if ( rubyImpl == Rubinius )
+			styles.append( GenGoto );
+		return;
+	}
+
+	styles.append( GenGoto );
+	styles.append( GenFGoto );
+
+	/* The C# -G2 generator writes to-state actions ahead of the first case
+	 * label, which does not compile, so -G2 is offered for C and D only. */
+	if ( hostLang->lang != HostLang::OCaml && hostLang->lang != HostLang::CSharp )
+		styles.append( GenIpGoto );
+}
+
+static const wchar_t *styleName( CodeStyle style )
+{
+	switch ( style ) {
+		case GenTables:   return L"-T0";
+		case GenFTables:  return L"-T1";
+		case GenPackTables: return L"-T2";
+		case GenFlat:     return L"-F0";
+		case GenFFlat:    return L"-F1";
+		case GenCombFlat: return L"-F2";
+		case GenPairFlat: return L"-F3";
+		case GenGoto:     return L"-G0";
+		case GenFGoto:    return L"-G1";
+		case GenIpGoto:   return L"-G2";
+		default:          return L"-P";
+	}
+}
+
+static const wchar_t *objectiveName()
+{
+	switch ( styleObjective ) {
+		case ObjectiveSize:  return L"size";
+		case ObjectiveSpeed: return L"speed";
+		default:             return L"balanced";
+	}
+}
+
+static double styleScore( const StyleEstimate &est, long long minBytes, double minCost )
+{
+	double bytes = (double)( est.tableBytes + est.codeBytes );
+	switch ( styleObjective ) {
+	case ObjectiveSize:
+		return bytes;
+	case ObjectiveSpeed:
+		return est.dispatchCost;
+	default:
+		/* Each measure relative to the best of the candidates. */
+		return bytes / ( minBytes > 0 ? minBytes : 1 ) +
+				est.dispatchCost / ( minCost > 0 ? minCost : 1 );
+	}
+}
+
+CodeStyle chooseCodeStyle( RedFsmAp *redFsm, StyleEstimateList &estimates )
+{
+	MachineStats stats;
+	collectStats( redFsm, stats );
+
+	Vector<CodeStyle> styles;
+	candidateStyles( styles );
+
+	for ( int i = 0; i < styles.length(); i++ ) {
+		StyleEstimate est;
+		est.style = styles[i];
+		estimateStyle( stats, est );
+		estimates.append( est );
+	}
+
+	long long minBytes = 0;
+	double minCost = 0;
+	for ( int i = 0; i < estimates.length(); i++ ) {
+		long long bytes = estimates[i].tableBytes + estimates[i].codeBytes;
+		if ( i == 0 || bytes < minBytes )
+			minBytes = bytes;
+		if ( i == 0 || estimates[i].dispatchCost < minCost )
+			minCost = estimates[i].dispatchCost;
+	}
+
+	/* Ties go to the smaller output, then to the earlier style. */
+	int best = 0;
+	for ( int i = 1; i < estimates.length(); i++ ) {
+		double score = styleScore( estimates[i], minBytes, minCost );
+		double bestScore = styleScore( estimates[best], minBytes, minCost );
+		long long bytes = estimates[i].tableBytes + estimates[i].codeBytes;
+		long long bestBytes = estimates[best].tableBytes + estimates[best].codeBytes;
+		if ( score < bestScore || ( score == bestScore && bytes < bestBytes ) )
+			best = i;
+	}
+
+	return estimates[best].style;
+}
+
+void printStyleEstimates( std::wostream &out, CodeStyle chosen,
+		const StyleEstimateList &estimates )
+{
+	out << L"auto style: " << styleName( chosen ) << L" for " <<
+			objectiveName() << endl;
+	for ( int i = 0; i < estimates.length(); i++ ) {
+		const StyleEstimate &est = estimates[i];
+		out << L"  " << styleName( est.style ) << L" tables " << est.tableBytes <<
+				L" code " << est.codeBytes << L" cost " << est.dispatchCost <<
+				( est.style == chosen ? L" *" : L"" ) << endl;
+	}
+}
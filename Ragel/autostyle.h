@@ -0,0 +1,50 @@
+/*
+ *  Copyright 2001-2007 Adrian Thurston <thurston@complang.org>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _AUTOSTYLE_H
+#define _AUTOSTYLE_H
+
+#include <iostream>
+#include "ragel.h"
+#include "vector.h"
+
+struct RedFsmAp;
+
+/* What one code style is expected to cost for a machine. The sizes are in
+ * bytes. The dispatch cost is relative, per key consumed. */
+struct StyleEstimate
+{
+	CodeStyle style;
+	long long tableBytes;
+	long long codeBytes;
+	double dispatchCost;
+};
+
+typedef Vector<StyleEstimate> StyleEstimateList;
+
+/* Automatic code style. Estimates each style the host language supports from
+ * the statistics of a reduced machine that has not yet been laid out, then
+ * picks the best for the objective given with --auto-style. */
+CodeStyle chooseCodeStyle( RedFsmAp *redFsm, StyleEstimateList &estimates );
+void printStyleEstimates( std::wostream &out, CodeStyle chosen,
+		const StyleEstimateList &estimates );
+
+#endif
@@ -25,6 +25,7 @@
 #include "ragel.h"
 #include "redfsm.h"
 #include "gendata.h"
+#include "profile.h"
 #include <sstream>
 #include <string>
 #include <assert.h>
@@ -48,6 +49,10 @@ extern bool noLineDirectives;
 
 void cdLineDirective( wostream &out, const wchar_t *fileName, int line )
 {
+	/* Output written to the standard output has no file name to give. */
+	if ( fileName == 0 )
+		return;
+
 	if ( noLineDirectives )
 		out << L"/* ";
 
@@ -275,7 +280,7 @@ wstring FsmCodeGen::TOKEND()
 
 wstring FsmCodeGen::GET_WIDE_KEY()
 {
-	if ( redFsm->anyConditions() ) 
+	if ( redFsm->anyConditions() || redFsm->anyClasses() ) 
 		return L"_widec";
 	else
 		return GET_KEY();
@@ -305,6 +310,18 @@ wstring FsmCodeGen::GET_KEY()
 	return ret.str();
 }
 
+/* The key offset places past the current one. Only used when there is no
+ * user supplied method of retrieving keys. */
+wstring FsmCodeGen::GET_KEY_AT( int offset )
+{
+	if ( offset == 0 )
+		return GET_KEY();
+
+	wostringstream ret;
+	ret << P() << L"[" << offset << L"]";
+	return ret.str();
+}
+
 /* Write out level number of tabs. Makes the nested binary search nice
  * looking. */
 wstring FsmCodeGen::TABS( int level )
@@ -413,8 +430,8 @@ void FsmCodeGen::SET_TOKEND( wostream &ret, GenInlineItem *item )
 	/* The tokend action sets tokend. */
 	ret << TOKEND() << L" = " << P();
 	if ( item->offset != 0 ) 
-		out << L"+" << item->offset;
-	out << L";";
+		ret << L"+" << item->offset;
+	ret << L";";
 }
 
 void FsmCodeGen::GET_TOKEND( wostream &ret, GenInlineItem *item )
@@ -556,6 +573,30 @@ void FsmCodeGen::ACTION( wostream &ret, GenAction *action, int targState,
 	ret << L"}\n";
 }
 
+void FsmCodeGen::actionText( wostream &ret, GenAction *action, bool inFinish )
+{
+	INLINE_LIST( ret, action->inlineList, 0, inFinish, false );
+}
+
+/* Write the cases of an action switch. Cases that run the same code share a
+ * body and a case may fall into one that runs the tail of its actions. */
+void FsmCodeGen::ACTION_CASES( ActionCaseList &cases, bool inFinish )
+{
+	mergeActionCases( cases, inFinish, true );
+	for ( ActionCaseList::Iter ac = cases; ac.lte(); ac++ ) {
+		for ( Vector<int>::Iter label = ac->labels; label.lte(); label++ )
+			out << L"\tcase " << *label << L":\n";
+
+		for ( Vector<GenAction*>::Iter act = ac->actions; act.lte(); act++ )
+			ACTION( out, *act, 0, inFinish, false );
+
+		if ( ac->fallThrough )
+			out << FALL_THROUGH();
+		else
+			out << L"\tbreak;\n";
+	}
+}
+
 void FsmCodeGen::CONDITION( wostream &ret, GenAction *condition )
 {
 	ret << L"\n";
@@ -625,7 +666,9 @@ wstring FsmCodeGen::ALPH_TYPE()
 wstring FsmCodeGen::WIDE_ALPH_TYPE()
 {
 	wstring ret;
-	if ( redFsm->maxKey <= keyOps->maxKey )
+	if ( redFsm->anyClasses() )
+		ret = ARRAY_TYPE( redFsm->numClasses - 1 );
+	else if ( redFsm->maxKey <= keyOps->maxKey )
 		ret = ALPH_TYPE();
 	else {
 		long long maxKeyVal = redFsm->maxKey.getLongLong();
@@ -663,6 +706,61 @@ void FsmCodeGen::STATE_IDS()
 	}
 }
 
+/* Write the map from keys to alphabet classes. */
+void FsmCodeGen::CLASS_MAP()
+{
+	if ( redFsm->classPages.length() > 0 ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxClassPage), CMP() );
+		out << L"\t";
+		for ( int page = 0; page < redFsm->classPages.length(); page++ ) {
+			out << redFsm->classPages[page];
+			if ( page < redFsm->classPages.length()-1 ) {
+				out << L", ";
+				if ( (page+1) % IALL == 0 )
+					out << L"\n\t";
+			}
+		}
+		out << L"\n";
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->numClasses-1), CM() );
+	out << L"\t";
+	for ( int pos = 0; pos < redFsm->classMap.length(); pos++ ) {
+		out << redFsm->classMap[pos];
+		if ( pos < redFsm->classMap.length()-1 ) {
+			out << L", ";
+			if ( (pos+1) % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	CLOSE_ARRAY() <<
+	L"\n";
+}
+
+/* Look up the class of the current key. */
+void FsmCodeGen::CLASS_TRANSLATE()
+{
+	wostringstream key;
+	if ( redFsm->classLowKey.getVal() == 0 )
+		key << GET_KEY();
+	else
+		key << L"(" << GET_KEY() << L" - (" << KEY( redFsm->classLowKey ) << L"))";
+
+	out << L"	_widec = ";
+	if ( redFsm->classPages.length() > 0 ) {
+		out << CM() << L"[" << CMP() << L"[" << key.str() << L" >> " << 
+				CLASS_PAGE_BITS << L"] + (" << key.str() << L" & " << 
+				( CLASS_PAGE_SIZE - 1 ) << L")];\n";
+	}
+	else {
+		out << CM() << L"[" << key.str() << L"];\n";
+	}
+	out << L"\n";
+}
+
 void FsmCodeGen::writeStart()
 {
 	out << START_STATE_ID();
@@ -744,6 +842,11 @@ wstring CCodeGen::CTRL_FLOW()
 	return L"";
 }
 
+wstring CCodeGen::FALL_THROUGH()
+{
+	return L"";
+}
+
 void CCodeGen::writeExports()
 {
 	if ( exportList.length() > 0 ) {
@@ -755,6 +858,323 @@ void CCodeGen::writeExports()
 	}
 }
 
+/* Writes a buffer that is refilled through a read callback, and a fill
+ * function to call before each exec. The fill keeps what the last exec has not
+ * finished with, from the token start of a scanner or else from p, by moving
+ * it to the front of the buffer and reading after it. Only the pending token
+ * is moved, so the buffer can be small and of fixed size. At the end of the
+ * input the fill returns 0 and sets eof, and the exec that follows finishes
+ * the last token. A token that fills the buffer makes it return -1. */
+void CCodeGen::writeStream()
+{
+	wstring alphType = ALPH_TYPE();
+	wstring tokens;
+	if ( hasLongestMatch )
+		tokens = L", " + alphType + L" **ts, " + alphType + L" **te";
+
+	out <<
+		L"#include <string.h>\n"
+		L"\n"
+		L"struct " << STREAM() << L"\n"
+		L"{\n"
+		L"	" << alphType << L" *buf;\n"
+		L"	long size;\n"
+		L"	long (*read)( void *ctx, " << alphType << L" *data, long len );\n"
+		L"	void *ctx;\n"
+		L"};\n"
+		L"\n"
+		L"static long " << STREAM() << L"_fill( struct " << STREAM() << L" *s, " <<
+				alphType << L" **p, " << alphType << L" **pe, " << alphType <<
+				L" **eof" << tokens << L" )\n"
+		L"{\n"
+		L"	long keep = 0, len;\n"
+		L"	if ( *pe == 0 )\n"
+		L"		*p = s->buf;\n"
+		L"	else {\n";
+
+	if ( hasLongestMatch ) {
+		out <<
+			L"		" << alphType << L" *from = *ts != 0 ? *ts : *p;\n";
+	}
+	else {
+		out <<
+			L"		" << alphType << L" *from = *p;\n";
+	}
+
+	out <<
+		L"		keep = *pe - from;\n"
+		L"		if ( keep == s->size )\n"
+		L"			return -1;\n"
+		L"		if ( from != s->buf ) {\n"
+		L"			long shift = from - s->buf;\n"
+		L"			memmove( s->buf, from, keep * sizeof(" << alphType << L") );\n"
+		L"			*p -= shift;\n";
+
+	if ( hasLongestMatch ) {
+		out <<
+			L"			if ( *ts != 0 ) {\n"
+			L"				*te = *te >= from ? *te - shift : 0;\n"
+			L"				*ts = s->buf;\n"
+			L"			}\n";
+	}
+
+	out <<
+		L"		}\n"
+		L"	}\n"
+		L"	len = s->read( s->ctx, s->buf + keep, s->size - keep );\n"
+		L"	if ( len < 0 )\n"
+		L"		return len;\n"
+		L"	*pe = s->buf + keep + len;\n"
+		L"	*eof = len == 0 ? *pe : 0;\n"
+		L"	return len;\n"
+		L"}\n"
+		L"\n";
+}
+
+/* The dense next state table of the multi and parallel drivers. The entries
+ * are row offsets. */
+void CCodeGen::MULTI_TABLES()
+{
+	if ( multiTablesWritten )
+		return;
+	multiTablesWritten = true;
+
+	int numClasses = redFsm->numMultiClasses;
+	long long stop = (long long)redFsm->multiStop * numClasses;
+
+	OPEN_ARRAY( ARRAY_TYPE(numClasses-1), MCL() );
+	out << L"\t";
+	for ( int pos = 0; pos < redFsm->multiClassMap.length(); pos++ ) {
+		out << redFsm->multiClassMap[pos];
+		if ( pos < redFsm->multiClassMap.length()-1 ) {
+			out << L", ";
+			if ( (pos+1) % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(stop), MN() );
+	out << L"\t";
+	for ( int pos = 0; pos < redFsm->multiNext.length(); pos++ ) {
+		out << (long long)redFsm->multiNext[pos] * numClasses;
+		if ( pos < redFsm->multiNext.length()-1 ) {
+			out << L", ";
+			if ( (pos+1) % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	CLOSE_ARRAY() <<
+	L"\n";
+}
+
+/* Writes a driver that walks many independent streams through the machine
+ * together. Up to MAX_MULTI_STREAMS streams are held in lanes and each round
+ * takes one key in every lane, so the table loads of the lanes overlap rather
+ * than wait on each other. The lanes all step as far as the shortest has left,
+ * with no test for the end inside the rounds. A transition the table cannot
+ * take leaves the lane where it is, so a stopped lane just repeats it. Lanes
+ * that are done hand back cs and p and take the next stream. A stream stops at
+ * the end of its input, or before any transition with actions or into the
+ * error state, for the exec to carry on from. */
+void CCodeGen::writeMulti()
+{
+	wstring alphType = ALPH_TYPE();
+	int numClasses = redFsm->numMultiClasses;
+	long long stop = (long long)redFsm->multiStop * numClasses;
+
+	MULTI_TABLES();
+
+	wstring low;
+	if ( keyOps->minKey.getVal() != 0 )
+		low = L" - (" + KEY( keyOps->minKey ) + L")";
+
+	out <<
+		L"static void " << DATA_PREFIX() << L"multi_exec( int n, int *cs, " <<
+				alphType << L" **p, " << alphType << L" **pe )\n"
+		L"{\n"
+		L"	int ln[" << MAX_MULTI_STREAMS << L"], row[" << MAX_MULTI_STREAMS << L"];\n"
+		L"	" << alphType << L" *q[" << MAX_MULTI_STREAMS << L"], *e[" <<
+				MAX_MULTI_STREAMS << L"];\n"
+		L"	int lanes = 0, i = 0, l;\n"
+		L"	long m;\n"
+		L"	for ( ;; ) {\n"
+		L"		while ( lanes < " << MAX_MULTI_STREAMS << L" && i < n ) {\n"
+		L"			if ( p[i] != pe[i] ) {\n"
+		L"				ln[lanes] = i;\n"
+		L"				row[lanes] = cs[i] * " << numClasses << L";\n"
+		L"				q[lanes] = p[i];\n"
+		L"				e[lanes] = pe[i];\n"
+		L"				lanes += 1;\n"
+		L"			}\n"
+		L"			i += 1;\n"
+		L"		}\n"
+		L"		if ( lanes == 0 )\n"
+		L"			break;\n"
+		L"\n"
+		L"		m = e[0] - q[0];\n"
+		L"		for ( l = 1; l < lanes; l++ ) {\n"
+		L"			if ( e[l] - q[l] < m )\n"
+		L"				m = e[l] - q[l];\n"
+		L"		}\n"
+		L"		while ( m-- > 0 ) {\n"
+		L"			for ( l = 0; l < lanes; l++ ) {\n"
+		L"				int s = " << MN() << L"[row[l] + " << MCL() << L"[*q[l]" << 
+						low << L"]];\n"
+		L"				if ( s != " << stop << L" ) {\n"
+		L"					row[l] = s;\n"
+		L"					q[l] += 1;\n"
+		L"				}\n"
+		L"			}\n"
+		L"		}\n"
+		L"\n"
+		L"		for ( l = 0; l < lanes; ) {\n"
+		L"			if ( q[l] == e[l] || " << MN() << L"[row[l] + " << MCL() <<
+						L"[*q[l]" << low << L"]] == " << stop << L" ) {\n"
+		L"				cs[ln[l]] = row[l] / " << numClasses << L";\n"
+		L"				p[ln[l]] = q[l];\n"
+		L"				lanes -= 1;\n"
+		L"				ln[l] = ln[lanes];\n"
+		L"				row[l] = row[lanes];\n"
+		L"				q[l] = q[lanes];\n"
+		L"				e[l] = e[lanes];\n"
+		L"			}\n"
+		L"			else\n"
+		L"				l += 1;\n"
+		L"		}\n"
+		L"	}\n"
+		L"}\n"
+		L"\n";
+}
+
+/* Writes a driver that scans one large input in chunks on parallel threads.
+ * The first chunk starts from the given state. The others cannot know theirs,
+ * so they start a path from every state and walk the paths together. Paths
+ * that reach the same state merge and paths that stop are dropped, so most
+ * machines are down to one path after a few keys. Each chunk records the
+ * state each path ends in, and chaining the chunks from the given state
+ * yields the true final state. The machine must not have actions, so a stop
+ * in the table means the error state. The chunks are spread over threads
+ * with OpenMP and run one after another when it is not enabled. The paths
+ * of every chunk and the state each ends in take one allocation on the heap,
+ * since the worker threads have small stacks. If it fails the input is
+ * scanned as one chunk by a single path. Lengths are long long since long is
+ * 32 bits on Windows. */
+void CCodeGen::writeParallel()
+{
+	wstring alphType = ALPH_TYPE();
+	int numClasses = redFsm->numMultiClasses;
+	int numStates = redFsm->stateList.length();
+	long long stop = (long long)redFsm->multiStop * numClasses;
+
+	MULTI_TABLES();
+
+	wstring low;
+	if ( keyOps->minKey.getVal() != 0 )
+		low = L" - (" + KEY( keyOps->minKey ) + L")";
+
+	out <<
+		L"#include <stdlib.h>\n"
+		L"\n"
+		L"static int " << DATA_PREFIX() << L"parallel_exec( int cs, " <<
+				alphType << L" *p, " << alphType << L" *pe, int chunks )\n"
+		L"{\n"
+		L"	long long len = pe - p;\n"
+		L"	int *ends = chunks > 1 ? (int*) malloc( sizeof(int) * chunks * " <<
+				5 * numStates << L" ) : 0;\n"
+		L"	int c;\n"
+		L"	if ( ends == 0 ) {\n"
+		L"		int r = cs * " << numClasses << L";\n"
+		L"		for ( ; p < pe && r != " << stop << L"; p++ )\n"
+		L"			r = " << MN() << L"[r + " << MCL() << L"[*p" << low << L"]];\n"
+		L"		return r == " << stop << L" ? " << ERROR_STATE() << L" : r / " <<
+				numClasses << L";\n"
+		L"	}\n"
+		L"#ifdef _OPENMP\n"
+		L"	#pragma omp parallel for schedule(dynamic)\n"
+		L"#endif\n"
+		L"	for ( c = 0; c < chunks; c++ ) {\n"
+		L"		" << alphType << L" *q = p + len * c / chunks;\n"
+		L"		" << alphType << L" *e = p + len * ( c + 1 ) / chunks;\n"
+		L"		int *cur = ends + chunks * " << numStates << L" + c * " << 
+				4 * numStates << L";\n"
+		L"		int *own = cur + " << numStates << L", *merged = own + " << 
+				numStates << L", *slot = merged + " << numStates << L";\n"
+		L"		int n, m, k, s;\n"
+		L"		if ( c == 0 ) {\n"
+		L"			cur[0] = cs * " << numClasses << L";\n"
+		L"			for ( s = 0; s < " << numStates << L"; s++ )\n"
+		L"				own[s] = 0;\n"
+		L"			n = 1;\n"
+		L"		}\n"
+		L"		else {\n"
+		L"			for ( s = 0; s < " << numStates << L"; s++ ) {\n"
+		L"				cur[s] = s * " << numClasses << L";\n"
+		L"				own[s] = s;\n"
+		L"			}\n"
+		L"			n = " << numStates << L";\n"
+		L"		}\n"
+		L"		for ( s = 0; s < " << numStates << L"; s++ )\n"
+		L"			slot[s] = -1;\n"
+		L"\n"
+		L"		while ( q < e && n > 1 ) {\n"
+		L"			" << alphType << L" *stretch = e - q > " << PARALLEL_STRETCH <<
+						L" ? q + " << PARALLEL_STRETCH << L" : e;\n"
+		L"			for ( ; q < stretch; q++ ) {\n"
+		L"				int cl = " << MCL() << L"[*q" << low << L"];\n"
+		L"				for ( k = 0; k < n; k++ ) {\n"
+		L"					if ( cur[k] != " << stop << L" )\n"
+		L"						cur[k] = " << MN() << L"[cur[k] + cl];\n"
+		L"				}\n"
+		L"			}\n"
+		L"\n"
+		L"			m = 0;\n"
+		L"			for ( k = 0; k < n; k++ ) {\n"
+		L"				if ( cur[k] == " << stop << L" )\n"
+		L"					merged[k] = -1;\n"
+		L"				else {\n"
+		L"					s = cur[k] / " << numClasses << L";\n"
+		L"					if ( slot[s] < 0 ) {\n"
+		L"						slot[s] = m;\n"
+		L"						cur[m++] = cur[k];\n"
+		L"					}\n"
+		L"					merged[k] = slot[s];\n"
+		L"				}\n"
+		L"			}\n"
+		L"			for ( s = 0; s < " << numStates << L"; s++ ) {\n"
+		L"				if ( own[s] >= 0 )\n"
+		L"					own[s] = merged[own[s]];\n"
+		L"			}\n"
+		L"			for ( k = 0; k < m; k++ )\n"
+		L"				slot[cur[k] / " << numClasses << L"] = -1;\n"
+		L"			n = m;\n"
+		L"		}\n"
+		L"\n"
+		L"		if ( n == 1 ) {\n"
+		L"			int r = cur[0];\n"
+		L"			for ( ; q < e && r != " << stop << L"; q++ )\n"
+		L"				r = " << MN() << L"[r + " << MCL() << L"[*q" << low << L"]];\n"
+		L"			cur[0] = r;\n"
+		L"		}\n"
+		L"\n"
+		L"		for ( s = 0; s < " << numStates << L"; s++ ) {\n"
+		L"			ends[c * " << numStates << L" + s] = own[s] < 0 || cur[own[s]] == " <<
+						stop << L" ? " << ERROR_STATE() << L" : cur[own[s]] / " <<
+						numClasses << L";\n"
+		L"		}\n"
+		L"	}\n"
+		L"\n"
+		L"	for ( c = 0; c < chunks && cs >= 0; c++ )\n"
+		L"		cs = ends[c * " << numStates << L" + cs];\n"
+		L"	free( ends );\n"
+		L"	return cs;\n"
+		L"}\n"
+		L"\n";
+}
+
 /*
  * D Specific
  */
@@ -823,6 +1243,11 @@ wstring DCodeGen::CTRL_FLOW()
 	return L"if (true) ";
 }
 
+wstring DCodeGen::FALL_THROUGH()
+{
+	return L"\tgoto case;\n";
+}
+
 void DCodeGen::writeExports()
 {
 	if ( exportList.length() > 0 ) {
@@ -906,6 +1331,11 @@ wstring D2CodeGen::CTRL_FLOW()
 	return L"if (true) ";
 }
 
+wstring D2CodeGen::FALL_THROUGH()
+{
+	return L"\tgoto case;\n";
+}
+
 void D2CodeGen::writeExports()
 {
 	if ( exportList.length() > 0 ) {
@@ -946,6 +1376,9 @@ void D2CodeGen::ACTION( wostream &ret, GenAction *action, int targState,
 
 void FsmCodeGen::finishRagelDef()
 {
+	/* States the frontend kept apart may be the same once reduced. */
+	mergeStates();
+
 	if ( codeStyle == GenGoto || codeStyle == GenFGoto || 
 			codeStyle == GenIpGoto || codeStyle == GenSplit )
 	{
@@ -960,15 +1393,39 @@ void FsmCodeGen::finishRagelDef()
 		redFsm->sortByStateId();
 	}
 
+	/* Maybe index by classes of keys instead of the keys. */
+	if ( alphClasses && classesSupported() )
+		redFsm->makeClasses();
+
+	/* Count the traffic of the sample corpus, if there is one. Directly
+	 * executable machines place the busy states together. */
+	profileMachine( redFsm );
+	if ( redFsm->anyProfile() && ( codeStyle == GenGoto || codeStyle == GenFGoto || 
+			codeStyle == GenIpGoto || codeStyle == GenSplit ) )
+		redFsm->profileOrdering();
+
 	/* Choose default transitions and the single transition. */
 	redFsm->chooseDefaultSpan();
+
+	/* The vector code for skipping self loops is for C compilers and one
+	 * byte keys only. */
+	if ( vectorSkip && hostLang->lang == HostLang::C && keyOps->alphType->size == 1 &&
+			( codeStyle == GenGoto || codeStyle == GenFGoto || codeStyle == GenIpGoto ) )
+		redFsm->findSkipLoops();
 		
 	/* Maybe do flat expand, otherwise choose single. */
-	if ( codeStyle == GenFlat || codeStyle == GenFFlat )
+	if ( codeStyle == GenFlat || codeStyle == GenFFlat || codeStyle == GenCombFlat ||
+			codeStyle == GenPairFlat )
 		redFsm->makeFlat();
 	else
 		redFsm->chooseSingle();
 
+	if ( codeStyle == GenGoto || codeStyle == GenFGoto || codeStyle == GenIpGoto )
+		redFsm->findLiteralRuns();
+
+	if ( codeStyle == GenCombFlat )
+		redFsm->makeComb();
+
 	/* If any errors have occured in the input file then don't write anything. */
 	if ( gblErrorCount > 0 )
 		return;
@@ -984,6 +1441,16 @@ void FsmCodeGen::finishRagelDef()
 	 * of fsm directives in action code. */
 	analyzeMachine();
 
+	/* Machines that only validate step two keys at a time. Others fall back
+	 * to the faster flat tables. */
+	if ( codeStyle == GenPairFlat && pairsSupported() )
+		redFsm->makePairs();
+
+	/* Done after the analysis, which counts action references in the
+	 * singles and ranges that the bitmaps take keys out of. */
+	if ( codeStyle == GenGoto || codeStyle == GenFGoto || codeStyle == GenIpGoto )
+		redFsm->chooseKeyTests();
+
 	/* Determine if we should use indicies. */
 	calcIndexSize();
 }
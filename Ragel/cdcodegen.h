@@ -77,6 +77,8 @@ protected:
 	wstring LDIR_PATH( wchar_t *path );
 	virtual void ACTION( wostream &ret, GenAction *action, int targState, 
 			bool inFinish, bool csForced );
+	void actionText( wostream &ret, GenAction *action, bool inFinish );
+	void ACTION_CASES( ActionCaseList &cases, bool inFinish );
 	void CONDITION( wostream &ret, GenAction *condition );
 	wstring ALPH_TYPE();
 	wstring WIDE_ALPH_TYPE();
@@ -91,6 +93,7 @@ protected:
 	virtual wstring NULL_ITEM() = 0;
 	virtual wstring POINTER() = 0;
 	virtual wstring GET_KEY();
+	virtual wstring GET_KEY_AT( int offset );
 	virtual wostream &SWITCH_DEFAULT() = 0;
 
 	wstring P();
@@ -126,10 +129,26 @@ protected:
 	wstring ET() { return L"_" + DATA_PREFIX() + L"eof_trans"; }
 	wstring SP() { return L"_" + DATA_PREFIX() + L"key_spans"; }
 	wstring CSP() { return L"_" + DATA_PREFIX() + L"cond_key_spans"; }
+	wstring CB() { return L"_" + DATA_PREFIX() + L"comb_base"; }
+	wstring CHK() { return L"_" + DATA_PREFIX() + L"comb_check"; }
+	wstring REC() { return L"_" + DATA_PREFIX() + L"records"; }
+	wstring KB() { return L"_" + DATA_PREFIX() + L"key_bitmaps"; }
+	wstring RO() { return L"_" + DATA_PREFIX() + L"record_offsets"; }
+	wstring DT() { return L"_" + DATA_PREFIX() + L"default_trans"; }
+	wstring PD() { return L"_" + DATA_PREFIX() + L"page_dir"; }
+	wstring CM() { return L"_" + DATA_PREFIX() + L"class_map"; }
+	wstring CMP() { return L"_" + DATA_PREFIX() + L"class_pages"; }
+	wstring PCL() { return L"_" + DATA_PREFIX() + L"pair_classes"; }
+	wstring PCH() { return L"_" + DATA_PREFIX() + L"pair_high_classes"; }
+	wstring PS() { return L"_" + DATA_PREFIX() + L"pair_single"; }
+	wstring PN() { return L"_" + DATA_PREFIX() + L"pair_next"; }
 	wstring START() { return DATA_PREFIX() + L"start"; }
 	wstring ERROR() { return DATA_PREFIX() + L"error"; }
 	wstring FIRST_FINAL() { return DATA_PREFIX() + L"first_final"; }
 	wstring CTXDATA() { return DATA_PREFIX() + L"ctxdata"; }
+	wstring STREAM() { return DATA_PREFIX() + L"stream"; }
+	wstring MCL() { return L"_" + DATA_PREFIX() + L"multi_classes"; }
+	wstring MN() { return L"_" + DATA_PREFIX() + L"multi_next"; }
 
 	void INLINE_LIST( wostream &ret, GenInlineList *inlineList, 
 			int targState, bool inFinish, bool csForced );
@@ -156,6 +175,8 @@ protected:
 	virtual void SUB_ACTION( wostream &ret, GenInlineItem *item, 
 			int targState, bool inFinish, bool csForced );
 	void STATE_IDS();
+	void CLASS_MAP();
+	void CLASS_TRANSLATE();
 
 	wstring ERROR_STATE();
 	wstring FIRST_FINAL_STATE();
@@ -167,6 +188,7 @@ protected:
 	virtual wostream &STATIC_VAR( wstring type, wstring name ) = 0;
 
 	virtual wstring CTRL_FLOW() = 0;
+	virtual wstring FALL_THROUGH() = 0;
 
 	wostream &source_warning(const InputLoc &loc);
 	wostream &source_error(const InputLoc &loc);
@@ -188,7 +210,7 @@ public:
 class CCodeGen : virtual public FsmCodeGen
 {
 public:
-	CCodeGen( wostream &out ) : FsmCodeGen(out) {}
+	CCodeGen( wostream &out ) : FsmCodeGen(out), multiTablesWritten(false) {}
 
 	virtual wstring NULL_ITEM();
 	virtual wstring POINTER();
@@ -202,8 +224,17 @@ public:
 	virtual wstring PTR_CONST();
 	virtual wstring PTR_CONST_END();
 	virtual wstring CTRL_FLOW();
+	virtual wstring FALL_THROUGH();
 
 	virtual void writeExports();
+	virtual void writeStream();
+	virtual void writeMulti();
+	virtual void writeParallel();
+
+	void MULTI_TABLES();
+
+	/* The multi and parallel drivers share their tables. */
+	bool multiTablesWritten;
 };
 
 class DCodeGen : virtual public FsmCodeGen
@@ -223,6 +254,7 @@ public:
 	virtual wstring PTR_CONST();
 	virtual wstring PTR_CONST_END();
 	virtual wstring CTRL_FLOW();
+	virtual wstring FALL_THROUGH();
 
 	virtual void writeExports();
 };
@@ -244,6 +276,7 @@ public:
 	virtual wstring PTR_CONST();
 	virtual wstring PTR_CONST_END();
 	virtual wstring CTRL_FLOW();
+	virtual wstring FALL_THROUGH();
 
 	virtual void writeExports();
 	virtual void SUB_ACTION( wostream &ret, GenInlineItem *item, 
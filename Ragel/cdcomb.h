@@ -0,0 +1,86 @@
+/*
+ *  Copyright 2004-2006 Adrian Thurston <thurston@complang.org>
+ *            2004 Erich Ocean <eric.ocean@ampede.com>
+ *            2005 Alan West <alan@alanz.com>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ * 
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA 
+ */
+
+#ifndef _CDCOMB_H
+#define _CDCOMB_H
+
+#include <iostream>
+#include "cdflat.h"
+
+/* Forwards. */
+struct CodeGenData;
+
+/*
+ * CombFlatCodeGen
+ *
+ * Flat tables with the transition lists packed by row displacement. A state's
+ * row starts at its base in the shared index array. A slot belongs to the
+ * state if the check array holds the state's id, otherwise the key takes the
+ * row's default transition. Keys outside the row take the state's default.
+ */
+class CombFlatCodeGen : public FlatCodeGen
+{
+protected:
+	CombFlatCodeGen( wostream &out ) : FsmCodeGen(out), FlatCodeGen(out) {}
+
+	std::wostream &KEYS();
+	std::wostream &INDICIES();
+	std::wostream &COMB_BASE();
+	std::wostream &COMB_CHECK();
+	std::wostream &DEFAULT_TRANS();
+	void LOCATE_TRANS();
+
+	virtual void writeData();
+};
+
+/*
+ * CCombFlatCodeGen
+ */
+struct CCombFlatCodeGen
+	: public CombFlatCodeGen, public CCodeGen
+{
+	CCombFlatCodeGen( wostream &out ) : 
+		FsmCodeGen(out), CombFlatCodeGen(out), CCodeGen(out) {}
+};
+
+/*
+ * DCombFlatCodeGen
+ */
+struct DCombFlatCodeGen
+	: public CombFlatCodeGen, public DCodeGen
+{
+	DCombFlatCodeGen( wostream &out ) : 
+		FsmCodeGen(out), CombFlatCodeGen(out), DCodeGen(out) {}
+};
+
+/*
+ * D2CombFlatCodeGen
+ */
+struct D2CombFlatCodeGen
+	: public CombFlatCodeGen, public D2CodeGen
+{
+	D2CombFlatCodeGen( wostream &out ) : 
+		FsmCodeGen(out), CombFlatCodeGen(out), D2CodeGen(out) {}
+};
+
+#endif
@@ -68,18 +68,12 @@ std::wostream &FFlatCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &FFlatCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numToStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numToStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -90,18 +84,12 @@ std::wostream &FFlatCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &FFlatCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numFromStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numFromStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -110,18 +98,12 @@ std::wostream &FFlatCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &FFlatCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numEofRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, true, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numEofRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -132,18 +114,12 @@ std::wostream &FFlatCodeGen::EOF_ACTION_SWITCH()
 std::wostream &FFlatCodeGen::ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numTransRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numTransRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -151,6 +127,9 @@ std::wostream &FFlatCodeGen::ACTION_SWITCH()
 
 void FFlatCodeGen::writeData()
 {
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( WIDE_ALPH_TYPE(), CK() );
 		COND_KEYS();
@@ -183,15 +162,19 @@ void FFlatCodeGen::writeData()
 	CLOSE_ARRAY() <<
 	L"\n";
 
-	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxFlatIndexOffset), IO() );
-	FLAT_INDEX_OFFSET();
-	CLOSE_ARRAY() <<
-	L"\n";
+	if ( pagedFlat )
+		PAGED_TABLES();
+	else {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxFlatIndexOffset), IO() );
+		FLAT_INDEX_OFFSET();
+		CLOSE_ARRAY() <<
+		L"\n";
 
-	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
-	INDICIES();
-	CLOSE_ARRAY() <<
-	L"\n";
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
+		INDICIES();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
 
 	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxState), TT() );
 	TRANS_TARGS();
@@ -247,6 +230,9 @@ void FFlatCodeGen::writeExec()
 
 	if ( redFsm->anyRegCurStateRef() )
 		out << L", _ps";
+
+	if ( pagedFlat )
+		out << L", _pos";
 	
 	out << L";\n";
 	out << L"	int _trans";
@@ -265,6 +251,8 @@ void FFlatCodeGen::writeExec()
 			L"	" << PTR_CONST() << ARRAY_TYPE(redFsm->maxCond) << PTR_CONST_END() << POINTER() << L"_conds;\n"
 			L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 	}
+	else if ( redFsm->anyClasses() )
+		out << L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 
 	if ( !noEnd ) {
 		testEofUsed = true;
@@ -293,6 +281,8 @@ void FFlatCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
@@ -30,17 +30,26 @@
 std::wostream &FGotoCodeGen::EXEC_ACTIONS()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numTransRefs > 0 ) {
-			/* 	We are at the start of a glob, write the case. */
-			out << L"f" << redAct->actListId << L":\n";
+		if ( redAct->numTransRefs > 0 )
+			appendActionCase( cases, redAct->actListId, redAct->key );
+	}
+
+	/* Lists that run the same code share a glob. A glob that runs the tail
+	 * of its actions goes on into the glob of the tail. */
+	mergeActionCases( cases, false, true );
+	for ( ActionCaseList::Iter ac = cases; ac.lte(); ac++ ) {
+		/* 	We are at the start of a glob, write the labels. */
+		for ( Vector<int>::Iter label = ac->labels; label.lte(); label++ )
+			out << L"f" << *label << L":\n";
 
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
+		/* Write each action in the list of action items. */
+		for ( Vector<GenAction*>::Iter act = ac->actions; act.lte(); act++ )
+			ACTION( out, *act, 0, false, false );
 
+		if ( !ac->fallThrough )
 			out << L"\tgoto _again;\n";
-		}
 	}
 	return out;
 }
@@ -50,18 +59,12 @@ std::wostream &FGotoCodeGen::EXEC_ACTIONS()
 std::wostream &FGotoCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numToStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numToStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -72,18 +75,12 @@ std::wostream &FGotoCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &FGotoCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numFromStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numFromStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -92,18 +89,12 @@ std::wostream &FGotoCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &FGotoCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numEofRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, true, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numEofRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -152,6 +143,9 @@ unsigned int FGotoCodeGen::EOF_ACTION( RedStateAp *state )
 
 void FGotoCodeGen::writeData()
 {
+	if ( redFsm->numSkipLoops > 0 )
+		SKIP_INCLUDES();
+
 	if ( redFsm->anyToStateActions() ) {
 		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxActionLoc), TSA() );
 		TO_STATE_ACTIONS();
@@ -173,6 +167,13 @@ void FGotoCodeGen::writeData()
 		L"\n";
 	}
 
+	if ( redFsm->bitmapLen > 0 ) {
+		OPEN_ARRAY( ARRAY_TYPE(255), KB() );
+		KEY_BITMAPS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
 	STATE_IDS();
 }
 
@@ -25,6 +25,9 @@
 #include "cdflat.h"
 #include "redfsm.h"
 #include "gendata.h"
+#include <sstream>
+
+using std::wostringstream;
 
 std::wostream &FlatCodeGen::TO_STATE_ACTION( RedStateAp *state )
 {
@@ -66,15 +69,13 @@ std::wostream &FlatCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &FlatCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -83,15 +84,13 @@ std::wostream &FlatCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &FlatCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -100,15 +99,13 @@ std::wostream &FlatCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &FlatCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, true, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -118,15 +115,13 @@ std::wostream &FlatCodeGen::EOF_ACTION_SWITCH()
 std::wostream &FlatCodeGen::ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -385,6 +380,92 @@ std::wostream &FlatCodeGen::INDICIES()
 	return out;
 }
 
+std::wostream &FlatCodeGen::PAGE_DIR_OFFSETS()
+{
+	out << L"\t";
+	int totalStateNum = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		out << st->pageDirOffset;
+		if ( !st.last() ) {
+			out << L", ";
+			if ( ++totalStateNum % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+std::wostream &FlatCodeGen::PAGE_DIR()
+{
+	out << L"\t";
+	for ( int i = 0; i < redFsm->pageDir.length(); i++ ) {
+		out << redFsm->pageDir[i] << L", ";
+		if ( (i+1) % IALL == 0 )
+			out << L"\n\t";
+	}
+
+	/* Output one last number so we don't have to figure out when the last
+	 * entry is and avoid writing a comma. */
+	out << 0 << L"\n";
+	return out;
+}
+
+std::wostream &FlatCodeGen::PAGED_INDICIES()
+{
+	out << L"\t";
+	for ( int i = 0; i < redFsm->pageTrans.length(); i++ ) {
+		out << redFsm->pageTrans[i]->id << L", ";
+		if ( (i+1) % IALL == 0 )
+			out << L"\n\t";
+	}
+
+	/* Output one last number so we don't have to figure out when the last
+	 * entry is and avoid writing a comma. */
+	out << 0 << L"\n";
+	return out;
+}
+
+std::wostream &FlatCodeGen::PAGED_DEFAULTS()
+{
+	out << L"\t";
+	int totalStateNum = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		out << ( st->defTrans != 0 ? st->defTrans->id : 0 );
+		if ( !st.last() ) {
+			out << L", ";
+			if ( ++totalStateNum % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+/* The paged layout replaces the index offsets and the indicies. */
+void FlatCodeGen::PAGED_TABLES()
+{
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxPageDirOffset), IO() );
+	PAGE_DIR_OFFSETS();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxPageStart), PD() );
+	PAGE_DIR();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
+	PAGED_INDICIES();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), DT() );
+	PAGED_DEFAULTS();
+	CLOSE_ARRAY() <<
+	L"\n";
+}
+
 std::wostream &FlatCodeGen::TRANS_TARGS()
 {
 	/* Transitions must be written ordered by their id. */
@@ -441,6 +522,25 @@ std::wostream &FlatCodeGen::TRANS_ACTIONS()
 
 void FlatCodeGen::LOCATE_TRANS()
 {
+	if ( pagedFlat ) {
+		wostringstream page;
+		page << PD() << L"[" << IO() << L"[" << vCS() << L"] + (_pos >> " << 
+				FLAT_PAGE_BITS << L")]";
+		out <<
+			L"	_keys = " << ARR_OFF( K(), L"(" + vCS() + L"<<1)" ) << L";\n"
+			L"	_slen = " << SP() << L"[" << vCS() << L"];\n"
+			L"	if ( _slen > 0 && _keys[0] <= " << GET_WIDE_KEY() << L" && " <<
+					GET_WIDE_KEY() << L" <= _keys[1] ) {\n"
+			L"		_pos = " << GET_WIDE_KEY() << L" - _keys[0];\n"
+			L"		_inds = " << ARR_OFF( I(), page.str() ) << L";\n"
+			L"		_trans = _inds[_pos & " << ( FLAT_PAGE_SIZE - 1 ) << L"];\n"
+			L"	}\n"
+			L"	else\n"
+			L"		_trans = " << DT() << L"[" << vCS() << L"];\n"
+			L"\n";
+		return;
+	}
+
 	out <<
 		L"	_keys = " << ARR_OFF( K(), L"(" + vCS() + L"<<1)" ) << L";\n"
 		L"	_inds = " << ARR_OFF( I(), IO() + L"[" + vCS() + L"]" ) << L";\n"
@@ -548,6 +648,9 @@ void FlatCodeGen::writeData()
 		L"\n";
 	}
 
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( WIDE_ALPH_TYPE(), CK() );
 		COND_KEYS();
@@ -580,15 +683,19 @@ void FlatCodeGen::writeData()
 	CLOSE_ARRAY() <<
 	L"\n";
 
-	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxFlatIndexOffset), IO() );
-	FLAT_INDEX_OFFSET();
-	CLOSE_ARRAY() <<
-	L"\n";
+	if ( pagedFlat )
+		PAGED_TABLES();
+	else {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxFlatIndexOffset), IO() );
+		FLAT_INDEX_OFFSET();
+		CLOSE_ARRAY() <<
+		L"\n";
 
-	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
-	INDICIES();
-	CLOSE_ARRAY() <<
-	L"\n";
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
+		INDICIES();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
 
 	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxState), TT() );
 	TRANS_TARGS();
@@ -686,6 +793,9 @@ void FlatCodeGen::writeExec()
 	if ( redFsm->anyRegCurStateRef() )
 		out << L", _ps";
 
+	if ( pagedFlat )
+		out << L", _pos";
+
 	out << 
 		L";\n"
 		L"	int _trans";
@@ -711,6 +821,8 @@ void FlatCodeGen::writeExec()
 			L"	" << PTR_CONST() << ARRAY_TYPE(redFsm->maxCond) << PTR_CONST_END() << POINTER() << L"_conds;\n"
 			L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 	}
+	else if ( redFsm->anyClasses() )
+		out << L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 
 	out << L"\n";
 
@@ -745,6 +857,8 @@ void FlatCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
@@ -57,7 +57,13 @@ protected:
 	std::wostream &EOF_TRANS();
 	std::wostream &TRANS_TARGS();
 	std::wostream &TRANS_ACTIONS();
-	void LOCATE_TRANS();
+	virtual void LOCATE_TRANS();
+
+	std::wostream &PAGE_DIR_OFFSETS();
+	std::wostream &PAGE_DIR();
+	std::wostream &PAGED_INDICIES();
+	std::wostream &PAGED_DEFAULTS();
+	void PAGED_TABLES();
 
 	std::wostream &COND_INDEX_OFFSET();
 	void COND_TRANSLATE();
@@ -97,18 +97,12 @@ std::wostream &FTabCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &FTabCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numToStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numToStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -119,18 +113,12 @@ std::wostream &FTabCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &FTabCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numFromStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numFromStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -139,18 +127,12 @@ std::wostream &FTabCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &FTabCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numEofRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, true, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numEofRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -161,18 +143,12 @@ std::wostream &FTabCodeGen::EOF_ACTION_SWITCH()
 std::wostream &FTabCodeGen::ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numTransRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numTransRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -180,6 +156,9 @@ std::wostream &FTabCodeGen::ACTION_SWITCH()
 
 void FTabCodeGen::writeData()
 {
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondOffset), CO() );
 		COND_OFFSETS();
@@ -307,7 +286,7 @@ void FTabCodeGen::writeExec()
 		L"	" << PTR_CONST() << WIDE_ALPH_TYPE() << PTR_CONST_END() << POINTER() << L"_keys;\n"
 		L"	int _trans;\n";
 
-	if ( redFsm->anyConditions() )
+	if ( redFsm->anyConditions() || redFsm->anyClasses() )
 		out << L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 
 	out << L"\n";
@@ -339,6 +318,8 @@ void FTabCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
@@ -26,6 +26,15 @@
 #include "redfsm.h"
 #include "bstmap.h"
 #include "gendata.h"
+#include <sstream>
+
+using std::wostringstream;
+
+/* Guards for the vector code of skipped self loops. */
+#define SKIP_AVX2 L"defined(__AVX2__)"
+#define SKIP_SSE2 L"defined(__SSE2__) || defined(_M_X64) || " \
+		L"( defined(_M_IX86_FP) && _M_IX86_FP >= 2 )"
+#define SKIP_NEON L"defined(__ARM_NEON) && defined(__aarch64__)"
 
 /* Emit the goto to take for a given transition. */
 std::wostream &GotoCodeGen::TRANS_GOTO( RedTransAp *trans, int level )
@@ -37,15 +46,13 @@ std::wostream &GotoCodeGen::TRANS_GOTO( RedTransAp *trans, int level )
 std::wostream &GotoCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -54,15 +61,13 @@ std::wostream &GotoCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &GotoCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -71,15 +76,13 @@ std::wostream &GotoCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &GotoCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, true, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -88,15 +91,13 @@ std::wostream &GotoCodeGen::EOF_ACTION_SWITCH()
 std::wostream &GotoCodeGen::ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -115,10 +116,28 @@ void GotoCodeGen::emitSingleSwitch( RedStateAp *state )
 	int numSingles = state->outSingle.length();
 	RedTransEl *data = state->outSingle.data;
 
+	/* With a profile the singles go busiest first and a single that takes
+	 * most of the state's traffic is tested ahead of the switch. */
+	RedTransList profSingles;
+	if ( redFsm->anyProfile() && numSingles > 1 ) {
+		profSingles.append( data, numSingles );
+		MergeSort<RedTransEl, CmpRedTransElProf> mergeSort;
+		mergeSort.sort( profSingles.data, numSingles );
+		data = profSingles.data;
+
+		if ( data[0].profCount * 2 > state->profVisits ) {
+			out << L"\tif ( " << GET_WIDE_KEY(state) << L" == " << 
+					WIDE_KEY(state, data[0].lowKey) << L" )\n\t\t";
+			TRANS_GOTO(data[0].value, 0) << L"\n";
+			data += 1;
+			numSingles -= 1;
+		}
+	}
+
 	if ( numSingles == 1 ) {
 		/* If there is a single single key then write it out as an if. */
 		out << L"\tif ( " << GET_WIDE_KEY(state) << L" == " << 
-				WIDE_KEY(state, data[0].lowKey) << L" )\n\t\t"; 
+				WIDE_KEY(state, data[0].lowKey) << L" )\n\t\t";
 
 		/* Virtual function for writing the target of the transition. */
 		TRANS_GOTO(data[0].value, 0) << L"\n";
@@ -141,11 +160,34 @@ void GotoCodeGen::emitSingleSwitch( RedStateAp *state )
 	}
 }
 
+/* Match a run of linked states with one bounds check. If the keys differ
+ * the states of the run take them one at a time. */
+void GotoCodeGen::LITERAL_RUN( RedStateAp *state )
+{
+	out << L"\tif ( " << PE() << L" - " << P() << L" >= " << state->literalLen;
+
+	RedStateAp *link = state;
+	for ( int i = 0; i < state->literalLen; i++ ) {
+		out << L" &&\n\t\t\t" << GET_KEY_AT( i ) << L" == " << 
+				KEY( link->outSingle[0].lowKey );
+		link = link->outSingle[0].value->targ;
+	}
+
+	out << L" )\n"
+		L"\t{\n"
+		L"\t\t" << P() << L" += " << state->literalLen - 1 << L";\n"
+		L"\t\t";
+	GOTO( out, state->literalTarg->id, false );
+	out << L"\n"
+		L"\t}\n";
+}
+
 void GotoCodeGen::emitRangeBSearch( RedStateAp *state, int level, int low, int high )
 {
-	/* Get the mid position, staying on the lower end of the range. */
-	int mid = (low + high) >> 1;
+	/* Get the mid position, staying on the lower end of the range unless a
+	 * profile says otherwise. */
 	RedTransEl *data = state->outRange.data;
+	int mid = redFsm->searchMid( data, low, high );
 
 	/* Determine if we need to look higher or lower. */
 	bool anyLower = mid > low;
@@ -347,6 +389,240 @@ void GotoCodeGen::emitCondBSearch( RedStateAp *state, int level, int low, int hi
 	}
 }
 
+/* Test a vector of bytes in _v against the bytes that leave the self loop.
+ * The vec argument is 0 for SSE2, 1 for AVX2 and 2 for NEON. */
+wstring GotoCodeGen::SKIP_EXIT_MASK( RedStateAp *state, int vec )
+{
+	wstring pre = vec == 0 ? L"_mm" : L"_mm256";
+	wstring si = vec == 0 ? L"si128" : L"si256";
+
+	wstring mask;
+	for ( int r = 0; r < state->skipRanges; r++ ) {
+		/* Bytes wrap, so a range of signed keys is one range of bytes. */
+		int low = (unsigned char)state->skipLow[r].getVal();
+		int diff = (int)keyOps->span( state->skipLow[r], state->skipHigh[r] ) - 1;
+
+		/* The x86 intrinsics take signed chars. */
+		wostringstream lowArg, diffArg;
+		lowArg << ( vec == 2 || low < 128 ? low : low - 256 );
+		diffArg << ( vec == 2 || diff < 128 ? diff : diff - 256 );
+
+		wstring test;
+		if ( vec == 2 ) {
+			if ( diff == 0 )
+				test = L"vceqq_u8( _v, vdupq_n_u8( " + lowArg.str() + L" ) )";
+			else {
+				test = L"vcleq_u8( vsubq_u8( _v, vdupq_n_u8( " + lowArg.str() + 
+						L" ) ), vdupq_n_u8( " + diffArg.str() + L" ) )";
+			}
+		}
+		else {
+			if ( diff == 0 )
+				test = pre + L"_cmpeq_epi8( _v, " + pre + L"_set1_epi8( " + lowArg.str() + L" ) )";
+			else {
+				/* Saturation leaves zero for the bytes inside the range. */
+				test = pre + L"_cmpeq_epi8( " + pre + L"_subs_epu8( " + pre + 
+						L"_sub_epi8( _v, " + pre + L"_set1_epi8( " + lowArg.str() + 
+						L" ) ), " + pre + L"_set1_epi8( " + diffArg.str() + L" ) ), " + 
+						pre + L"_setzero_" + si + L"() )";
+			}
+		}
+
+		if ( r == 0 )
+			mask = test;
+		else if ( vec == 2 )
+			mask = L"vorrq_u8( " + mask + L", " + test + L" )";
+		else
+			mask = pre + L"_or_" + si + L"( " + mask + L", " + test + L" )";
+	}
+	return mask;
+}
+
+/* Skip the keys a state loops on without actions. A single key leaving the
+ * loop is found with memchr, otherwise the keys are tested a vector at a
+ * time. A vector must leave a key in the buffer so the state code after
+ * the skip can take the next key as usual. */
+void GotoCodeGen::SKIP_LOOP( RedStateAp *state )
+{
+	if ( state->skipRanges == 1 && state->skipLow[0] == state->skipHigh[0] ) {
+		int key = (unsigned char)state->skipLow[0].getVal();
+		out << 
+			L"	{\n"
+			L"		const char *_e = (const char *) memchr( " << P() << L", " << 
+						key << L", " << PE() << L" - " << P() << L" );\n"
+			L"		" << P() << L" += _e != 0 ? _e - (const char *) " << P() << 
+						L" : " << PE() << L" - " << P() << L" - 1;\n"
+			L"	}\n";
+		return;
+	}
+
+	out <<
+		L"#if " SKIP_AVX2 L"\n"
+		L"	while ( " << PE() << L" - " << P() << L" > 32 ) {\n"
+		L"		__m256i _v = _mm256_loadu_si256( (const __m256i *) " << P() << L" );\n"
+		L"		if ( _mm256_movemask_epi8( " << SKIP_EXIT_MASK( state, 1 ) << L" ) != 0 )\n"
+		L"			break;\n"
+		L"		" << P() << L" += 32;\n"
+		L"	}\n"
+		L"#elif " SKIP_SSE2 L"\n"
+		L"	while ( " << PE() << L" - " << P() << L" > 16 ) {\n"
+		L"		__m128i _v = _mm_loadu_si128( (const __m128i *) " << P() << L" );\n"
+		L"		if ( _mm_movemask_epi8( " << SKIP_EXIT_MASK( state, 0 ) << L" ) != 0 )\n"
+		L"			break;\n"
+		L"		" << P() << L" += 16;\n"
+		L"	}\n"
+		L"#elif " SKIP_NEON L"\n"
+		L"	while ( " << PE() << L" - " << P() << L" > 16 ) {\n"
+		L"		uint8x16_t _v = vld1q_u8( (const uint8_t *) " << P() << L" );\n"
+		L"		if ( vmaxvq_u8( " << SKIP_EXIT_MASK( state, 2 ) << L" ) != 0 )\n"
+		L"			break;\n"
+		L"		" << P() << L" += 16;\n"
+		L"	}\n"
+		L"#endif\n";
+}
+
+std::wostream &GotoCodeGen::SKIP_INCLUDES()
+{
+	out <<
+		L"#include <string.h>\n"
+		L"#if " SKIP_AVX2 L"\n"
+		L"#include <immintrin.h>\n"
+		L"#elif " SKIP_SSE2 L"\n"
+		L"#include <emmintrin.h>\n"
+		L"#elif " SKIP_NEON L"\n"
+		L"#include <arm_neon.h>\n"
+		L"#endif\n"
+		L"\n";
+	return out;
+}
+
+/* Test the keys of the bitmap transition with one shift of a word, or a
+ * lookup in the table of bitmaps when the span is wider than a word. */
+void GotoCodeGen::BITMAP_TEST( RedStateAp *state )
+{
+	wstring offset = CAST(L"int") + L"(" + GET_KEY() + L" - " + 
+			KEY(state->bitmapLow) + L")";
+
+	out << L"\tif ( " << CAST(UINT()) << L"(" << GET_KEY() << L" - " << 
+			KEY(state->bitmapLow) << L") < " << state->bitmapSpan << L" && ";
+
+	if ( state->bitmapSpan <= BITMAP_WORD_BITS ) {
+		unsigned long word = 0;
+		for ( RedTransList::Iter el = state->bitmapList; el.lte(); el++ ) {
+			Size first = keyOps->span( state->bitmapLow, el->lowKey ) - 1;
+			Size last = keyOps->span( state->bitmapLow, el->highKey ) - 1;
+			for ( Size b = first; b <= last; b++ )
+				word |= 1ul << b;
+		}
+		out << L"( ( 0x" << std::hex << word << std::dec << L"u >> " << 
+				offset << L" ) & 1 ) != 0 )\n\t\t";
+	}
+	else {
+		out << L"( " << KB() << L"[" << state->bitmapOffset << 
+				L" + (" << offset << L" >> 3)] & (1 << (" << offset << 
+				L" & 7)) ) != 0 )\n\t\t";
+	}
+
+	TRANS_GOTO( state->bitmapTrans, 0 ) << L"\n";
+}
+
+/* Switch on every key of the state so the compiler can use a jump table. */
+void GotoCodeGen::JUMP_SWITCH( RedStateAp *state )
+{
+	Key low = state->outSingle.length() > 0 ? 
+			state->outSingle[0].lowKey : state->outRange[0].lowKey;
+	Key high = low;
+	for ( RedTransList::Iter el = state->outSingle; el.lte(); el++ ) {
+		if ( el->lowKey < low )
+			low = el->lowKey;
+		if ( el->highKey > high )
+			high = el->highKey;
+	}
+	for ( RedTransList::Iter el = state->outRange; el.lte(); el++ ) {
+		if ( el->lowKey < low )
+			low = el->lowKey;
+		if ( el->highKey > high )
+			high = el->highKey;
+	}
+
+	/* The transition of each key. Singles go over the ranges that were
+	 * extended across them. */
+	Size span = keyOps->span( low, high );
+	RedTransAp **keyTrans = new RedTransAp*[span];
+	memset( keyTrans, 0, sizeof(RedTransAp*) * span );
+	for ( RedTransList::Iter el = state->outRange; el.lte(); el++ ) {
+		Size first = keyOps->span( low, el->lowKey ) - 1;
+		Size last = keyOps->span( low, el->highKey ) - 1;
+		for ( Size k = first; k <= last; k++ )
+			keyTrans[k] = el->value;
+	}
+	for ( RedTransList::Iter el = state->outSingle; el.lte(); el++ )
+		keyTrans[keyOps->span( low, el->lowKey ) - 1] = el->value;
+
+	out << L"\tswitch( " << GET_KEY() << L" ) {\n";
+	JUMP_SWITCH_CASES( keyTrans, low, span );
+
+	/* Emits a default case for D code. */
+	SWITCH_DEFAULT();
+
+	out << L"\t}\n";
+	delete[] keyTrans;
+}
+
+/* Write the keys of each transition as cases over one goto. */
+void GotoCodeGen::JUMP_SWITCH_CASES( RedTransAp **keyTrans, Key low, Size span )
+{
+	Key first = low;
+	for ( Size i = 0; i < span; i++, first.increment() ) {
+		RedTransAp *trans = keyTrans[i];
+		if ( trans == 0 )
+			continue;
+
+		Key key = first;
+		for ( Size k = i; k < span; k++, key.increment() ) {
+			if ( keyTrans[k] == trans ) {
+				out << L"\t\tcase " << KEY(key) << L":\n";
+				keyTrans[k] = 0;
+			}
+		}
+
+		out << L"\t\t\t";
+		TRANS_GOTO( trans, 0 ) << L"\n";
+	}
+}
+
+std::wostream &GotoCodeGen::KEY_BITMAPS()
+{
+	int totalItems = 0;
+	out << L"\t";
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		if ( st->keyTest != KeyTestBitmap || st->bitmapSpan <= BITMAP_WORD_BITS )
+			continue;
+
+		int bytes = ( st->bitmapSpan + 7 ) / 8;
+		unsigned char *bits = new unsigned char[bytes];
+		memset( bits, 0, bytes );
+		for ( RedTransList::Iter el = st->bitmapList; el.lte(); el++ ) {
+			Size first = keyOps->span( st->bitmapLow, el->lowKey ) - 1;
+			Size last = keyOps->span( st->bitmapLow, el->highKey ) - 1;
+			for ( Size b = first; b <= last; b++ )
+				bits[b >> 3] |= 1 << (b & 7);
+		}
+
+		for ( int i = 0; i < bytes; i++ ) {
+			out << (unsigned int)bits[i];
+			if ( ++totalItems < redFsm->bitmapLen ) {
+				out << L", ";
+				if ( totalItems % IALL == 0 )
+					out << L"\n\t";
+			}
+		}
+		delete[] bits;
+	}
+	out << L"\n";
+	return out;
+}
+
 std::wostream &GotoCodeGen::STATE_GOTOS()
 {
 	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
@@ -356,18 +632,31 @@ std::wostream &GotoCodeGen::STATE_GOTOS()
 			/* Writing code above state gotos. */
 			GOTO_HEADER( st );
 
+			if ( st->skipRanges > 0 && !noEnd && getKeyExpr == 0 )
+				SKIP_LOOP( st );
+
+			if ( st->literalLen > 0 && !noEnd && getKeyExpr == 0 )
+				LITERAL_RUN( st );
+
 			if ( st->stateCondVect.length() > 0 ) {
 				out << L"	_widec = " << GET_KEY() << L";\n";
 				emitCondBSearch( st, 1, 0, st->stateCondVect.length() - 1 );
 			}
 
-			/* Try singles. */
-			if ( st->outSingle.length() > 0 )
-				emitSingleSwitch( st );
+			if ( st->keyTest == KeyTestJump )
+				JUMP_SWITCH( st );
+			else {
+				/* Try singles. */
+				if ( st->outSingle.length() > 0 )
+					emitSingleSwitch( st );
+
+				if ( st->keyTest == KeyTestBitmap )
+					BITMAP_TEST( st );
 
-			/* Default case is to binary search for the ranges, if that fails then */
-			if ( st->outRange.length() > 0 )
-				emitRangeBSearch( st, 1, 0, st->outRange.length() - 1 );
+				/* Default case is to binary search for the ranges, if that fails then */
+				if ( st->outRange.length() > 0 )
+					emitRangeBSearch( st, 1, 0, st->outRange.length() - 1 );
+			}
 
 			/* Write the default transition. */
 			TRANS_GOTO( st->defTrans, 1 ) << L"\n";
@@ -626,6 +915,9 @@ void GotoCodeGen::BREAK( wostream &ret, int targState, bool csForced )
 
 void GotoCodeGen::writeData()
 {
+	if ( redFsm->numSkipLoops > 0 )
+		SKIP_INCLUDES();
+
 	if ( redFsm->anyActions() ) {
 		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxActArrItem), A() );
 		ACTIONS_ARRAY();
@@ -654,6 +946,13 @@ void GotoCodeGen::writeData()
 		L"\n";
 	}
 
+	if ( redFsm->bitmapLen > 0 ) {
+		OPEN_ARRAY( ARRAY_TYPE(255), KB() );
+		KEY_BITMAPS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
 	STATE_IDS();
 }
 
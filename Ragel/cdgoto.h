@@ -77,6 +77,14 @@ public:
 
 	void emitSingleSwitch( RedStateAp *state );
 	void emitRangeBSearch( RedStateAp *state, int level, int low, int high );
+	void LITERAL_RUN( RedStateAp *state );
+	void SKIP_LOOP( RedStateAp *state );
+	wstring SKIP_EXIT_MASK( RedStateAp *state, int vec );
+	std::wostream &SKIP_INCLUDES();
+	void BITMAP_TEST( RedStateAp *state );
+	void JUMP_SWITCH( RedStateAp *state );
+	void JUMP_SWITCH_CASES( RedTransAp **keyTrans, Key low, Size span );
+	std::wostream &KEY_BITMAPS();
 
 	/* Called from STATE_GOTOS just before writing the gotos */
 	virtual void GOTO_HEADER( RedStateAp *state );
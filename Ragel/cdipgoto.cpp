@@ -362,6 +362,16 @@ void IpGotoCodeGen::setLabelsNeeded()
 
 void IpGotoCodeGen::writeData()
 {
+	if ( redFsm->numSkipLoops > 0 )
+		SKIP_INCLUDES();
+
+	if ( redFsm->bitmapLen > 0 ) {
+		OPEN_ARRAY( ARRAY_TYPE(255), KB() );
+		KEY_BITMAPS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
 	STATE_IDS();
 }
 
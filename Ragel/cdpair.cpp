@@ -0,0 +1,201 @@
+/*
+ *  Copyright 2004-2006 Adrian Thurston <thurston@complang.org>
+ *            2004 Erich Ocean <eric.ocean@ampede.com>
+ *            2005 Alan West <alan@alanz.com>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ * 
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA 
+ */
+
+#include "ragel.h"
+#include "cdpair.h"
+#include "redfsm.h"
+#include "gendata.h"
+
+/* The classes of the keys, multiplied by mult. The first key of a pair takes
+ * its class times the number of classes. */
+std::wostream &PairFlatCodeGen::PAIR_CLASSES( int mult )
+{
+	out << L'\t';
+	for ( int pos = 0; pos < redFsm->multiClassMap.length(); pos++ ) {
+		out << redFsm->multiClassMap[pos] * mult;
+		if ( pos < redFsm->multiClassMap.length()-1 ) {
+			out << L", ";
+			if ( (pos+1) % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+std::wostream &PairFlatCodeGen::PAIR_SINGLE()
+{
+	out << L'\t';
+	for ( int pos = 0; pos < redFsm->pairSingle.length(); pos++ ) {
+		out << redFsm->pairSingle[pos];
+		if ( pos < redFsm->pairSingle.length()-1 ) {
+			out << L", ";
+			if ( (pos+1) % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+std::wostream &PairFlatCodeGen::PAIR_NEXT()
+{
+	out << L'\t';
+	for ( int pos = 0; pos < redFsm->pairNext.length(); pos++ ) {
+		out << redFsm->pairNext[pos];
+		if ( pos < redFsm->pairNext.length()-1 ) {
+			out << L", ";
+			if ( (pos+1) % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+void PairFlatCodeGen::writeData()
+{
+	if ( !redFsm->anyPairs() ) {
+		FFlatCodeGen::writeData();
+		return;
+	}
+
+	int numClasses = redFsm->numMultiClasses;
+	long long numPairs = (long long)numClasses * numClasses;
+
+	OPEN_ARRAY( ARRAY_TYPE(numClasses-1), PCL() );
+	PAIR_CLASSES( 1 );
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE((numClasses-1) * numClasses), PCH() );
+	PAIR_CLASSES( numClasses );
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxState), PS() );
+	PAIR_SINGLE();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE((redFsm->stateList.length()-1) * numPairs), PN() );
+	PAIR_NEXT();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	STATE_IDS();
+}
+
+/* The state is kept as the start of its row in the pair table, which is the
+ * state times the number of class pairs. Dividing the row by the number of
+ * classes gives the start of the state's row in the single table. */
+void PairFlatCodeGen::writeExec()
+{
+	if ( !redFsm->anyPairs() ) {
+		FFlatCodeGen::writeExec();
+		return;
+	}
+
+	int numClasses = redFsm->numMultiClasses;
+	long long numPairs = (long long)numClasses * numClasses;
+
+	wstring low;
+	if ( keyOps->minKey.getVal() != 0 )
+		low = L" - (" + KEY( keyOps->minKey ) + L")";
+	wstring first = GET_KEY() + low;
+	wstring second = GET_KEY_AT( 1 ) + low;
+
+	out << L"	{\n";
+
+	if ( !noEnd )
+		out << L"	int _ps, _next;\n";
+
+	if ( redFsm->errState != 0 ) {
+		out << 
+			L"	if ( " << vCS() << L" == " << redFsm->errState->id << L" )\n"
+			L"		goto _out;\n";
+	}
+
+	if ( noEnd ) {
+		/* No end to pair the keys against, so go one key at a time. */
+		out <<
+			L"	for ( ;; ) {\n"
+			L"		" << vCS() << L" = " << PS() << L"[" << vCS() << L" * " << 
+					numClasses << L" + " << PCL() << L"[" << first << L"]];\n";
+
+		if ( redFsm->errState != 0 ) {
+			out <<
+				L"		if ( " << vCS() << L" == " << redFsm->errState->id << L" )\n"
+				L"			goto _out;\n";
+		}
+
+		out <<
+			L"		" << P() << L" += 1;\n"
+			L"	}\n";
+	}
+	else {
+		out <<
+			L"	_ps = " << vCS() << L" * " << numPairs << L";\n"
+			L"	while ( " << PE() << L" - " << P() << L" >= 2 ) {\n"
+			L"		_next = " << PN() << L"[_ps + " << PCH() << L"[" << first << 
+					L"] + " << PCL() << L"[" << second << L"]];\n";
+
+		if ( redFsm->errState != 0 ) {
+			/* Failed in the pair. Step the first key alone to find which. */
+			out <<
+				L"		if ( _next == " << (long long)redFsm->errState->id * numPairs << L" ) {\n"
+				L"			if ( " << PS() << L"[_ps / " << numClasses << L" + " << 
+						PCL() << L"[" << first << L"]] != " << redFsm->errState->id << L" )\n"
+				L"				" << P() << L" += 1;\n"
+				L"			" << vCS() << L" = " << redFsm->errState->id << L";\n"
+				L"			goto _out;\n"
+				L"		}\n";
+		}
+
+		/* An odd key left over takes a single step. */
+		out <<
+			L"		_ps = _next;\n"
+			L"		" << P() << L" += 2;\n"
+			L"	}\n"
+			L"	" << vCS() << L" = _ps / " << numPairs << L";\n"
+			L"	if ( " << P() << L" != " << PE() << L" ) {\n"
+			L"		" << vCS() << L" = " << PS() << L"[_ps / " << numClasses << 
+					L" + " << PCL() << L"[" << first << L"]];\n";
+
+		if ( redFsm->errState != 0 ) {
+			out <<
+				L"		if ( " << vCS() << L" != " << redFsm->errState->id << L" )\n"
+				L"			" << P() << L" += 1;\n";
+		}
+		else {
+			out << L"		" << P() << L" += 1;\n";
+		}
+
+		out << L"	}\n";
+	}
+
+	if ( redFsm->errState != 0 )
+		out << L"	_out: {}\n";
+
+	out << L"	}\n";
+}
@@ -0,0 +1,84 @@
+/*
+ *  Copyright 2004-2006 Adrian Thurston <thurston@complang.org>
+ *            2004 Erich Ocean <eric.ocean@ampede.com>
+ *            2005 Alan West <alan@alanz.com>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ * 
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA 
+ */
+
+#ifndef _CDPAIR_H
+#define _CDPAIR_H
+
+#include <iostream>
+#include "cdfflat.h"
+
+/* Forwards. */
+struct CodeGenData;
+
+/*
+ * PairFlatCodeGen
+ *
+ * For machines that only validate their input, each step of the exec takes
+ * two keys from a table indexed by the state and the classes of both keys.
+ * A pair that fails is stepped again one key at a time, so the exec stops on
+ * the key that failed. Other machines are written as faster flat tables.
+ */
+class PairFlatCodeGen : public FFlatCodeGen
+{
+protected:
+	PairFlatCodeGen( wostream &out ) : FsmCodeGen(out), FFlatCodeGen(out) {}
+
+	std::wostream &PAIR_CLASSES( int mult );
+	std::wostream &PAIR_SINGLE();
+	std::wostream &PAIR_NEXT();
+
+	virtual void writeData();
+	virtual void writeExec();
+};
+
+/*
+ * CPairFlatCodeGen
+ */
+struct CPairFlatCodeGen
+	: public PairFlatCodeGen, public CCodeGen
+{
+	CPairFlatCodeGen( wostream &out ) : 
+		FsmCodeGen(out), PairFlatCodeGen(out), CCodeGen(out) {}
+};
+
+/*
+ * DPairFlatCodeGen
+ */
+struct DPairFlatCodeGen
+	: public PairFlatCodeGen, public DCodeGen
+{
+	DPairFlatCodeGen( wostream &out ) : 
+		FsmCodeGen(out), PairFlatCodeGen(out), DCodeGen(out) {}
+};
+
+/*
+ * D2PairFlatCodeGen
+ */
+struct D2PairFlatCodeGen
+	: public PairFlatCodeGen, public D2CodeGen
+{
+	D2PairFlatCodeGen( wostream &out ) : 
+		FsmCodeGen(out), PairFlatCodeGen(out), D2CodeGen(out) {}
+};
+
+#endif
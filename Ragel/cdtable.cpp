@@ -95,15 +95,13 @@ std::wostream &TabCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &TabCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -112,15 +110,13 @@ std::wostream &TabCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &TabCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -129,15 +125,13 @@ std::wostream &TabCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &TabCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, true, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -147,15 +141,13 @@ std::wostream &TabCodeGen::EOF_ACTION_SWITCH()
 std::wostream &TabCodeGen::ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -759,6 +751,9 @@ void TabCodeGen::writeData()
 		L"\n";
 	}
 
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondOffset), CO() );
 		COND_OFFSETS();
@@ -938,7 +933,7 @@ void TabCodeGen::writeExec()
 		L";\n"
 		L"	" << UINT() << L" _trans;\n";
 
-	if ( redFsm->anyConditions() )
+	if ( redFsm->anyConditions() || redFsm->anyClasses() )
 		out << L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 
 	if ( redFsm->anyToStateActions() || redFsm->anyRegActions() 
@@ -985,6 +980,8 @@ void TabCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
@@ -216,6 +216,17 @@ struct KeyOps
 		}
 		return 0;
 	}
+
+	/* The first type that holds every value from minVal to maxVal. */
+	HostType *typeSpans( long long minVal, long long maxVal )
+	{
+		for ( int i = 0; i < hostLang->numHostTypes; i++ ) {
+			if ( hostLang->hostTypes[i].minVal <= minVal &&
+					maxVal <= hostLang->hostTypes[i].maxVal )
+				return hostLang->hostTypes + i;
+		}
+		return 0;
+	}
 };
 
 extern KeyOps *keyOps;
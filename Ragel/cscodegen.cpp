@@ -25,6 +25,7 @@
 #include "cscodegen.h"
 #include "redfsm.h"
 #include "gendata.h"
+#include "profile.h"
 #include <sstream>
 #include <iomanip>
 #include <string>
@@ -283,7 +284,7 @@ wstring CSharpFsmCodeGen::TOKEND()
 
 wstring CSharpFsmCodeGen::GET_WIDE_KEY()
 {
-	if ( redFsm->anyConditions() ) 
+	if ( redFsm->anyConditions() || redFsm->anyClasses() ) 
 		return L"_widec";
 	else
 		return GET_KEY();
@@ -313,6 +314,36 @@ wstring CSharpFsmCodeGen::GET_KEY()
 	return ret.str();
 }
 
+/* The key offset places past the current one. Only used when there is no
+ * user supplied method of retrieving keys. */
+wstring CSharpFsmCodeGen::GET_KEY_AT( int offset )
+{
+	if ( offset == 0 )
+		return GET_KEY();
+
+	wostringstream ret;
+	ret << P() << L"[" << offset << L"]";
+	return ret.str();
+}
+
+/* A span of the keys from the current one to the end of the data. Only used
+ * when there is no user supplied method of retrieving keys. */
+wstring CSharpFsmCodeGen::KEYS_TO_END()
+{
+	wostringstream ret;
+	ret << L"new System.ReadOnlySpan<" << ALPH_TYPE() << L">( " << P() << 
+			L", (int)(" << PE() << L" - " << P() << L") )";
+	return ret.str();
+}
+
+/* The set of keys searched for to skip the self loop of a state. */
+wstring CSharpFsmCodeGen::SKIP( RedStateAp *state )
+{
+	wostringstream ret;
+	ret << L"_" << DATA_PREFIX() << L"skip_" << state->id;
+	return ret.str();
+}
+
 /* Write out level number of tabs. Makes the nested binary search nice
  * looking. */
 wstring CSharpFsmCodeGen::TABS( int level )
@@ -338,7 +369,7 @@ wstring CSharpFsmCodeGen::KEY( Key key )
 wstring CSharpFsmCodeGen::ALPHA_KEY( Key key )
 {
 	wostringstream ret;
-	if (key.getVal() > 0xFFFF) {
+	if ( redFsm->anyClasses() || key.getVal() > 0xFFFF ) {
 		ret << key.getVal();
 	} else {
 		if ( keyOps->alphType->isChar )
@@ -396,8 +427,8 @@ void CSharpFsmCodeGen::SET_TOKEND( wostream &ret, GenInlineItem *item )
 	/* The tokend action sets tokend. */
 	ret << TOKEND() << L" = " << P();
 	if ( item->offset != 0 ) 
-		out << L"+" << item->offset;
-	out << L";";
+		ret << L"+" << item->offset;
+	ret << L";";
 }
 
 void CSharpFsmCodeGen::GET_TOKEND( wostream &ret, GenInlineItem *item )
@@ -538,6 +569,30 @@ void CSharpFsmCodeGen::ACTION( wostream &ret, GenAction *action, int targState,
 	ret << L"}\n";
 }
 
+void CSharpFsmCodeGen::actionText( wostream &ret, GenAction *action, bool inFinish )
+{
+	INLINE_LIST( ret, action->inlineList, 0, inFinish );
+}
+
+/* Write the cases of an action switch. Cases that run the same code share a
+ * body and a case may go on to one that runs the tail of its actions. */
+void CSharpFsmCodeGen::ACTION_CASES( ActionCaseList &cases, bool inFinish )
+{
+	mergeActionCases( cases, inFinish, true );
+	for ( int c = 0; c < cases.length(); c++ ) {
+		for ( Vector<int>::Iter label = cases[c].labels; label.lte(); label++ )
+			out << L"\tcase " << *label << L":\n";
+
+		for ( Vector<GenAction*>::Iter act = cases[c].actions; act.lte(); act++ )
+			ACTION( out, *act, 0, inFinish );
+
+		if ( cases[c].fallThrough )
+			out << L"\tgoto case " << cases[c+1].labels[0] << L";\n";
+		else
+			out << L"\tbreak;\n";
+	}
+}
+
 void CSharpFsmCodeGen::CONDITION( wostream &ret, GenAction *condition )
 {
 	ret << L"\n";
@@ -607,7 +662,9 @@ wstring CSharpFsmCodeGen::ALPH_TYPE()
 wstring CSharpFsmCodeGen::WIDE_ALPH_TYPE()
 {
 	wstring ret;
-	if ( redFsm->maxKey <= keyOps->maxKey )
+	if ( redFsm->anyClasses() )
+		ret = ARRAY_TYPE( redFsm->numClasses - 1 );
+	else if ( redFsm->maxKey <= keyOps->maxKey )
 		ret = ALPH_TYPE();
 	else {
 		long long maxKeyVal = redFsm->maxKey.getLongLong();
@@ -646,6 +703,61 @@ void CSharpFsmCodeGen::STATE_IDS()
 }
 
 
+/* Write the map from keys to alphabet classes. */
+void CSharpFsmCodeGen::CLASS_MAP()
+{
+	if ( redFsm->classPages.length() > 0 ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxClassPage), CMP() );
+		out << L"\t";
+		for ( int page = 0; page < redFsm->classPages.length(); page++ ) {
+			out << redFsm->classPages[page];
+			if ( page < redFsm->classPages.length()-1 ) {
+				out << L", ";
+				if ( (page+1) % IALL == 0 )
+					out << L"\n\t";
+			}
+		}
+		out << L"\n";
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->numClasses-1), CM() );
+	out << L"\t";
+	for ( int pos = 0; pos < redFsm->classMap.length(); pos++ ) {
+		out << redFsm->classMap[pos];
+		if ( pos < redFsm->classMap.length()-1 ) {
+			out << L", ";
+			if ( (pos+1) % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	CLOSE_ARRAY() <<
+	L"\n";
+}
+
+/* Look up the class of the current key. */
+void CSharpFsmCodeGen::CLASS_TRANSLATE()
+{
+	wostringstream key;
+	if ( redFsm->classLowKey.getVal() == 0 )
+		key << GET_KEY();
+	else
+		key << L"(" << GET_KEY() << L" - (" << KEY( redFsm->classLowKey ) << L"))";
+
+	out << L"	_widec = ";
+	if ( redFsm->classPages.length() > 0 ) {
+		out << CM() << L"[" << CMP() << L"[" << key.str() << L" >> " << 
+				CLASS_PAGE_BITS << L"] + (" << key.str() << L" & " << 
+				( CLASS_PAGE_SIZE - 1 ) << L")];\n";
+	}
+	else {
+		out << CM() << L"[" << key.str() << L"];\n";
+	}
+	out << L"\n";
+}
+
 void CSharpFsmCodeGen::writeStart()
 {
 	out << START_STATE_ID();
@@ -664,6 +776,51 @@ void CSharpFsmCodeGen::writeError()
 /*
  * C# Specific
  */
+/* The data the keys are read from. */
+wstring CSharpCodeGen::DATA()
+{
+	if ( dataPinned )
+		return L"_data";
+
+	wostringstream ret;
+	if ( dataExpr == 0 )
+		ret << L"data";
+	else
+		INLINE_LIST( ret, dataExpr, 0, false );
+	return ret.str();
+}
+
+/* Unsafe code pins the data for the whole of the exec and reads the keys
+ * through a pointer, with no bounds checks. Labels and gotos all stay inside
+ * the exec, so the fixed statement can enclose it. The tables are pointers
+ * under unsafe code, so the exec is an unsafe block even when a getkey
+ * expression reads the keys and there is no data to pin. */
+void CSharpCodeGen::PIN_DATA()
+{
+	if ( unsafeCode ) {
+		out << L"	unsafe {\n";
+		unsafeBlock = true;
+
+		if ( getKeyExpr == 0 ) {
+			out << L"	fixed ( " << ALPH_TYPE() << L"* _data = " << DATA() << L" ) {\n";
+			dataPinned = true;
+		}
+	}
+}
+
+void CSharpCodeGen::UNPIN_DATA()
+{
+	if ( dataPinned ) {
+		out << L"	}\n";
+		dataPinned = false;
+	}
+
+	if ( unsafeBlock ) {
+		out << L"	}\n";
+		unsafeBlock = false;
+	}
+}
+
 wstring CSharpCodeGen::GET_KEY()
 {
 	wostringstream ret;
@@ -675,15 +832,39 @@ wstring CSharpCodeGen::GET_KEY()
 	}
 	else {
 		/* Expression for retrieving the key, use simple dereference. */
-		if ( dataExpr == 0 )
-			ret << L"data";
-		else
-			INLINE_LIST( ret, dataExpr, 0, false );
+		ret << DATA() << L"[" << P() << L"]";
+	}
+	return ret.str();
+}
+
+wstring CSharpCodeGen::GET_KEY_AT( int offset )
+{
+	if ( offset == 0 )
+		return GET_KEY();
+
+	wostringstream ret;
+	ret << DATA() << L"[" << P() << L" + " << offset << L"]";
+	return ret.str();
+}
 
-		ret << L"[" << P() << L"]";
+wstring CSharpCodeGen::KEYS_TO_END()
+{
+	wostringstream ret;
+	if ( dataPinned ) {
+		ret << L"new System.ReadOnlySpan<" << ALPH_TYPE() << L">( " << DATA() << 
+				L" + " << P() << L", " << PE() << L" - " << P() << L" )";
+	}
+	else if ( feedData ) {
+		ret << DATA() << L".Slice( " << P() << L", " << PE() << L" - " << 
+				P() << L" )";
+	}
+	else {
+		ret << L"System.MemoryExtensions.AsSpan( " << DATA() << L", " << P() << 
+				L", " << PE() << L" - " << P() << L" )";
 	}
 	return ret.str();
 }
+
 wstring CSharpCodeGen::NULL_ITEM()
 {
 	return L"-1";
@@ -703,6 +884,25 @@ wstring CSharpCodeGen::PTR_CONST()
 
 std::wostream &CSharpCodeGen::OPEN_ARRAY( wstring type, wstring name )
 {
+	/* Unsafe code pins each table once for the life of the program and
+	 * indexes it through a pointer. */
+	if ( unsafeCode ) {
+		out << L"static readonly unsafe " << type << L"* " << name << L" = (" << 
+				type << L"*)(void*) System.Runtime.InteropServices.GCHandle.Alloc( new " <<
+				type << L" [] {\n";
+		return out;
+	}
+
+	/* A span over an array of byte constants is read straight from the
+	 * assembly image, with no type initializer and no array on the heap.
+	 * Wider tables go through RuntimeHelpers.CreateSpan, which allocates on
+	 * every access until the JIT tiers the method up, so they stay arrays. */
+	if ( spanTables && ( type == L"sbyte" || type == L"byte" ) ) {
+		out << L"static System.ReadOnlySpan<" << type << L"> " << name << 
+				L" => new " << type << L" [] {\n";
+		return out;
+	}
+
 	out << L"static readonly " << type << L"[] " << name << L" =  ";
 	/*
 	if (type == L"char")
@@ -714,6 +914,10 @@ std::wostream &CSharpCodeGen::OPEN_ARRAY( wstring type, wstring name )
 
 std::wostream &CSharpCodeGen::CLOSE_ARRAY()
 {
+	if ( unsafeCode ) {
+		return out << L"}, System.Runtime.InteropServices.GCHandleType.Pinned )."
+				L"AddrOfPinnedObject();\n";
+	}
 	return out << L"};\n";
 }
 
@@ -761,12 +965,152 @@ void CSharpCodeGen::writeExports()
 	}
 }
 
+/* Writes a struct holding the machine state between chunks, FeedInit and a
+ * Feed that runs the exec over each chunk as it arrives. The variables of the
+ * exec are locals of Feed, so the access prefix and the variable statements do
+ * not apply to them. A scanner keeps only the start of a token that runs past
+ * the end of a chunk and appends the next chunk to it, otherwise the chunk is
+ * read where it lies. */
+void CSharpCodeGen::writeFeed()
+{
+	bool anyCalls = redFsm->anyActionCalls() || redFsm->anyActionRets();
+	wstring alphType = ALPH_TYPE();
+	wstring feed = FEED();
+
+	GenInlineList *userAccess = accessExpr, *userP = pExpr, *userPE = peExpr,
+			*userEOF = eofExpr, *userCS = csExpr, *userTop = topExpr,
+			*userAct = actExpr, *userTS = tokstartExpr, *userTE = tokendExpr,
+			*userData = dataExpr;
+	accessExpr = pExpr = peExpr = eofExpr = csExpr = topExpr = actExpr =
+			tokstartExpr = tokendExpr = dataExpr = 0;
+
+	out <<
+		L"public struct " << FEED_STATE() << L"\n"
+		L"{\n"
+		L"	public int cs;\n";
+
+	if ( anyCalls )
+		out << L"	public int top;\n";
+
+	if ( hasLongestMatch ) {
+		out <<
+			L"	public int act, ts, te;\n"
+			L"	public " << alphType << L"[] buf;\n"
+			L"	public int pending;\n";
+	}
+
+	out <<
+		L"}\n"
+		L"\n" <<
+		FEED_STATE() << L" " << feed << L";\n"
+		L"\n"
+		L"public void FeedInit()\n"
+		L"{\n"
+		L"	" << feed << L" = new " << FEED_STATE() << L"();\n"
+		L"	" << feed << L".cs = " << START() << L";\n";
+
+	if ( hasLongestMatch ) {
+		out <<
+			L"	" << feed << L".ts = " << NULL_ITEM() << L";\n"
+			L"	" << feed << L".te = " << NULL_ITEM() << L";\n";
+	}
+
+	out <<
+		L"}\n"
+		L"\n"
+		L"public void Feed( System.Buffers.ReadOnlySequence<" << alphType <<
+				L"> chunk, bool isFinal )\n"
+		L"{\n"
+		L"	foreach ( System.ReadOnlyMemory<" << alphType << L"> segment in chunk )\n"
+		L"		Feed( segment.Span, false );\n"
+		L"	if ( isFinal )\n"
+		L"		Feed( System.ReadOnlySpan<" << alphType << L">.Empty, true );\n"
+		L"}\n"
+		L"\n"
+		L"public void Feed( System.ReadOnlySpan<" << alphType <<
+				L"> chunk, bool isFinal )\n"
+		L"{\n"
+		L"	int cs = " << feed << L".cs;\n";
+
+	if ( anyCalls )
+		out << L"	int top = " << feed << L".top;\n";
+
+	if ( hasLongestMatch ) {
+		out <<
+			L"	int act = " << feed << L".act, ts = " << feed << L".ts, te = " <<
+					feed << L".te;\n";
+	}
+
+	out <<
+		L"	System.ReadOnlySpan<" << alphType << L"> data = chunk;\n"
+		L"	int p = 0;\n";
+
+	if ( hasLongestMatch ) {
+		out <<
+			L"	if ( " << feed << L".pending > 0 ) {\n"
+			L"		int len = " << feed << L".pending + chunk.Length;\n"
+			L"		if ( " << feed << L".buf.Length < len )\n"
+			L"			System.Array.Resize( ref " << feed << L".buf, "
+						L"System.Math.Max( len, 2 * " << feed << L".buf.Length ) );\n"
+			L"		chunk.CopyTo( System.MemoryExtensions.AsSpan( " << feed <<
+						L".buf, " << feed << L".pending ) );\n"
+			L"		data = new System.ReadOnlySpan<" << alphType << L">( " <<
+						feed << L".buf, 0, len );\n"
+			L"		p = " << feed << L".pending;\n"
+			L"	}\n";
+	}
+
+	out <<
+		L"	int pe = data.Length;\n"
+		L"	int eof = isFinal ? pe : -1;\n"
+		L"\n";
+
+	feedData = true;
+	writeExec();
+	feedData = false;
+
+	out << L"\n";
+
+	if ( hasLongestMatch ) {
+		out <<
+			L"	" << feed << L".pending = 0;\n"
+			L"	if ( !isFinal && ts != " << NULL_ITEM() << L" ) {\n"
+			L"		" << feed << L".pending = pe - ts;\n"
+			L"		if ( " << feed << L".buf == null || " << feed <<
+						L".buf.Length < " << feed << L".pending )\n"
+			L"			" << feed << L".buf = new " << alphType << L"[2 * " <<
+						feed << L".pending];\n"
+			L"		data.Slice( ts, " << feed << L".pending ).CopyTo( " <<
+						feed << L".buf );\n"
+			L"		te -= ts;\n"
+			L"		ts = 0;\n"
+			L"	}\n"
+			L"	" << feed << L".act = act;\n"
+			L"	" << feed << L".ts = ts;\n"
+			L"	" << feed << L".te = te;\n";
+	}
+
+	if ( anyCalls )
+		out << L"	" << feed << L".top = top;\n";
+
+	out <<
+		L"	" << feed << L".cs = cs;\n"
+		L"}\n";
+
+	accessExpr = userAccess; pExpr = userP; peExpr = userPE; eofExpr = userEOF;
+	csExpr = userCS; topExpr = userTop; actExpr = userAct; tokstartExpr = userTS;
+	tokendExpr = userTE; dataExpr = userData;
+}
+
 /*
  * End C#-specific code.
  */
 
 void CSharpFsmCodeGen::finishRagelDef()
 {
+	/* States the frontend kept apart may be the same once reduced. */
+	mergeStates();
+
 	if ( codeStyle == GenGoto || codeStyle == GenFGoto || 
 			codeStyle == GenIpGoto || codeStyle == GenSplit )
 	{
@@ -781,15 +1125,40 @@ void CSharpFsmCodeGen::finishRagelDef()
 		redFsm->sortByStateId();
 	}
 
+	/* Maybe index by classes of keys instead of the keys. */
+	if ( alphClasses && classesSupported() )
+		redFsm->makeClasses();
+
+	/* Count the traffic of the sample corpus, if there is one. Directly
+	 * executable machines place the busy states together. */
+	profileMachine( redFsm );
+	if ( redFsm->anyProfile() && ( codeStyle == GenGoto || codeStyle == GenFGoto || 
+			codeStyle == GenIpGoto || codeStyle == GenSplit ) )
+		redFsm->profileOrdering();
+
 	/* Choose default transitions and the single transition. */
 	redFsm->chooseDefaultSpan();
+
+	/* Self loops are skipped by searching spans, which takes char or byte
+	 * keys. */
+	if ( vectorSkip && ( keyOps->alphType->isChar || 
+			( keyOps->alphType->size == 1 && !keyOps->alphType->isSigned ) ) &&
+			( codeStyle == GenGoto || codeStyle == GenFGoto || codeStyle == GenIpGoto ) )
+		redFsm->findSkipLoops();
 		
 	/* Maybe do flat expand, otherwise choose single. */
-	if ( codeStyle == GenFlat || codeStyle == GenFFlat )
+	if ( codeStyle == GenFlat || codeStyle == GenFFlat || codeStyle == GenCombFlat ||
+			codeStyle == GenPairFlat )
 		redFsm->makeFlat();
 	else
 		redFsm->chooseSingle();
 
+	if ( codeStyle == GenGoto || codeStyle == GenFGoto || codeStyle == GenIpGoto )
+		redFsm->findLiteralRuns();
+
+	if ( codeStyle == GenCombFlat )
+		redFsm->makeComb();
+
 	/* If any errors have occured in the input file then don't write anything. */
 	if ( gblErrorCount > 0 )
 		return;
@@ -805,6 +1174,16 @@ void CSharpFsmCodeGen::finishRagelDef()
 	 * of fsm directives in action code. */
 	analyzeMachine();
 
+	/* Machines that only validate step two keys at a time. Others fall back
+	 * to the faster flat tables. */
+	if ( codeStyle == GenPairFlat && pairsSupported() )
+		redFsm->makePairs();
+
+	/* Done after the analysis, which counts action references in the
+	 * singles and ranges that the bitmaps take keys out of. */
+	if ( codeStyle == GenGoto || codeStyle == GenFGoto || codeStyle == GenIpGoto )
+		redFsm->chooseKeyTests();
+
 	/* Determine if we should use indicies. */
 	calcIndexSize();
 }
@@ -76,6 +76,8 @@ protected:
 	wstring ALPHA_KEY( Key key );
 	wstring LDIR_PATH( wchar_t *path );
 	void ACTION( wostream &ret, GenAction *action, int targState, bool inFinish );
+	void actionText( wostream &ret, GenAction *action, bool inFinish );
+	void ACTION_CASES( ActionCaseList &cases, bool inFinish );
 	void CONDITION( wostream &ret, GenAction *condition );
 	wstring ALPH_TYPE();
 	wstring WIDE_ALPH_TYPE();
@@ -88,6 +90,8 @@ protected:
 	virtual wstring NULL_ITEM() = 0;
 	virtual wstring POINTER() = 0;
 	virtual wstring GET_KEY();
+	virtual wstring GET_KEY_AT( int offset );
+	virtual wstring KEYS_TO_END();
 	virtual wostream &SWITCH_DEFAULT() = 0;
 
 	wstring P();
@@ -123,10 +127,26 @@ protected:
 	wstring ET() { return L"_" + DATA_PREFIX() + L"eof_trans"; }
 	wstring SP() { return L"_" + DATA_PREFIX() + L"key_spans"; }
 	wstring CSP() { return L"_" + DATA_PREFIX() + L"cond_key_spans"; }
+	wstring CB() { return L"_" + DATA_PREFIX() + L"comb_base"; }
+	wstring CHK() { return L"_" + DATA_PREFIX() + L"comb_check"; }
+	wstring REC() { return L"_" + DATA_PREFIX() + L"records"; }
+	wstring KB() { return L"_" + DATA_PREFIX() + L"key_bitmaps"; }
+	wstring SKIP( RedStateAp *state );
+	wstring RO() { return L"_" + DATA_PREFIX() + L"record_offsets"; }
+	wstring DT() { return L"_" + DATA_PREFIX() + L"default_trans"; }
+	wstring PD() { return L"_" + DATA_PREFIX() + L"page_dir"; }
+	wstring CM() { return L"_" + DATA_PREFIX() + L"class_map"; }
+	wstring CMP() { return L"_" + DATA_PREFIX() + L"class_pages"; }
+	wstring PCL() { return L"_" + DATA_PREFIX() + L"pair_classes"; }
+	wstring PCH() { return L"_" + DATA_PREFIX() + L"pair_high_classes"; }
+	wstring PS() { return L"_" + DATA_PREFIX() + L"pair_single"; }
+	wstring PN() { return L"_" + DATA_PREFIX() + L"pair_next"; }
 	wstring START() { return DATA_PREFIX() + L"start"; }
 	wstring ERROR() { return DATA_PREFIX() + L"error"; }
 	wstring FIRST_FINAL() { return DATA_PREFIX() + L"first_final"; }
 	wstring CTXDATA() { return DATA_PREFIX() + L"ctxdata"; }
+	wstring FEED_STATE() { return L"_" + DATA_PREFIX() + L"feed_state"; }
+	wstring FEED() { return L"_" + DATA_PREFIX() + L"feed"; }
 
 	void INLINE_LIST( wostream &ret, GenInlineList *inlineList, int targState, bool inFinish );
 	virtual void GOTO( wostream &ret, int gotoDest, bool inFinish ) = 0;
@@ -151,6 +171,8 @@ protected:
 	void SUB_ACTION( wostream &ret, GenInlineItem *item, 
 			int targState, bool inFinish );
 	void STATE_IDS();
+	void CLASS_MAP();
+	void CLASS_TRANSLATE();
 
 	wstring ERROR_STATE();
 	wstring FIRST_FINAL_STATE();
@@ -182,9 +204,15 @@ public:
 class CSharpCodeGen : virtual public CSharpFsmCodeGen
 {
 public:
-	CSharpCodeGen( wostream &out ) : CSharpFsmCodeGen(out) {}
+	CSharpCodeGen( wostream &out ) : CSharpFsmCodeGen(out), unsafeBlock(false), 
+			dataPinned(false), feedData(false) {}
 
+	wstring DATA();
+	void PIN_DATA();
+	void UNPIN_DATA();
 	virtual wstring GET_KEY();
+	virtual wstring GET_KEY_AT( int offset );
+	virtual wstring KEYS_TO_END();
 	virtual wstring NULL_ITEM();
 	virtual wstring POINTER();
 	virtual wostream &SWITCH_DEFAULT();
@@ -198,6 +226,16 @@ public:
 	virtual wstring CTRL_FLOW();
 
 	virtual void writeExports();
+	virtual void writeFeed();
+
+	/* Unsafe code reads the tables through pointers while the exec runs. */
+	bool unsafeBlock;
+
+	/* Unsafe code reads the keys through a pointer while the exec runs. */
+	bool dataPinned;
+
+	/* Inside the feed the data is a span rather than an array. */
+	bool feedData;
 };
 
 #define MAX(a, b) (a > b ? a : b)
@@ -0,0 +1,251 @@
+/*
+ *  Copyright 2004-2006 Adrian Thurston <thurston@complang.org>
+ *            2004 Erich Ocean <eric.ocean@ampede.com>
+ *            2005 Alan West <alan@alanz.com>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ * 
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA 
+ */
+
+#include "ragel.h"
+#include "cscomb.h"
+#include "redfsm.h"
+#include "gendata.h"
+
+std::wostream &CSharpCombFlatCodeGen::KEYS()
+{
+	out << L'\t';
+	int totalTrans = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		/* Emit the bounds of the packed entries. */
+		out << ALPHA_KEY( st->combLowKey ) << L", ";
+		out << ALPHA_KEY( st->combHighKey ) << L", ";
+		if ( ++totalTrans % IALL == 0 )
+			out << L"\n\t";
+	}
+
+	/* Output one last number so we don't have to figure out when the last
+	 * entry is and avoid writing a comma. */
+	if ( keyOps->alphType->isChar && !redFsm->anyClasses() )
+		out << L"(char) " << 0 << L"\n";
+	else
+		out << 0 << L"\n";
+	return out;
+}
+
+std::wostream &CSharpCombFlatCodeGen::INDICIES()
+{
+	out << L'\t';
+	int totalTrans = 0;
+	for ( int slot = 0; slot < redFsm->combTrans.length(); slot++ ) {
+		/* Unowned slots are never read. */
+		RedTransAp *trans = redFsm->combTrans[slot];
+		out << ( trans != 0 ? trans->id : 0 ) << L", ";
+		if ( ++totalTrans % IALL == 0 )
+			out << L"\n\t";
+	}
+
+	/* Output one last number so we don't have to figure out when the last
+	 * entry is and avoid writing a comma. */
+	out << 0 << L"\n";
+	return out;
+}
+
+std::wostream &CSharpCombFlatCodeGen::COMB_BASE()
+{
+	out << L"\t";
+	int totalStateNum = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		out << st->combBase;
+		if ( !st.last() ) {
+			out << L", ";
+			if ( ++totalStateNum % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+std::wostream &CSharpCombFlatCodeGen::COMB_CHECK()
+{
+	/* Free slots get an id that no state has. */
+	int noState = redFsm->maxState + 1;
+
+	out << L'\t';
+	int totalTrans = 0;
+	for ( int slot = 0; slot < redFsm->combCheck.length(); slot++ ) {
+		RedStateAp *owner = redFsm->combCheck[slot];
+		out << ( owner != 0 ? owner->id : noState ) << L", ";
+		if ( ++totalTrans % IALL == 0 )
+			out << L"\n\t";
+	}
+
+	/* Output one last number so we don't have to figure out when the last
+	 * entry is and avoid writing a comma. */
+	out << noState << L"\n";
+	return out;
+}
+
+std::wostream &CSharpCombFlatCodeGen::DEFAULT_TRANS()
+{
+	out << L'\t';
+	int totalTrans = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		/* Emit the default for keys outside the row, then the default for
+		 * keys in the row. */
+		out << ( st->defTrans != 0 ? st->defTrans->id : 0 ) << L", ";
+		out << ( st->combDefTrans != 0 ? st->combDefTrans->id : 0 ) << L", ";
+		if ( ++totalTrans % IALL == 0 )
+			out << L"\n\t";
+	}
+
+	/* Output one last number so we don't have to figure out when the last
+	 * entry is and avoid writing a comma. */
+	out << 0 << L"\n";
+	return out;
+}
+
+void CSharpCombFlatCodeGen::LOCATE_TRANS()
+{
+	out <<
+		L"	_keys = " << vCS() << L"<<1;\n"
+		L"	_inds = " << CB() << L"[" << vCS() << L"];\n"
+		L"\n"
+		L"	if ( " << K() << L"[_keys] <= " << GET_WIDE_KEY() << L" && " << 
+				GET_WIDE_KEY() << L" <= " << K() << L"[_keys+1] ) {\n"
+		L"		_slen = " << CAST(slenType) << L" (" << GET_WIDE_KEY() << 
+				L" - " << K() << L"[_keys]);\n"
+		L"		_trans = " << CHK() << L"[_inds + _slen] == " << vCS() << L" ?\n"
+		L"			" << I() << L"[_inds + _slen] : " << DT() << L"[_keys+1];\n"
+		L"	}\n"
+		L"	else\n"
+		L"		_trans = " << DT() << L"[_keys];\n"
+		L"\n";
+}
+
+void CSharpCombFlatCodeGen::writeData()
+{
+	/* If there are any transtion functions then output the array. If there
+	 * are none, don't bother emitting an empty array that won't be used. */
+	if ( redFsm->anyActions() ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxActArrItem), A() );
+		ACTIONS_ARRAY();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
+	if ( redFsm->anyConditions() ) {
+		OPEN_ARRAY( WIDE_ALPH_TYPE(), CK() );
+		COND_KEYS();
+		CLOSE_ARRAY() <<
+		L"\n";
+
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondSpan), CSP() );
+		COND_KEY_SPANS();
+		CLOSE_ARRAY() <<
+		L"\n";
+
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCond), C() );
+		CONDS();
+		CLOSE_ARRAY() <<
+		L"\n";
+
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondIndexOffset), CO() );
+		COND_INDEX_OFFSET();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	OPEN_ARRAY( WIDE_ALPH_TYPE(), K() );
+	KEYS();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCombBase), CB() );
+	COMB_BASE();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
+	INDICIES();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxState+1), CHK() );
+	COMB_CHECK();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), DT() );
+	DEFAULT_TRANS();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxState), TT() );
+	TRANS_TARGS();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	if ( redFsm->anyActions() ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxActionLoc), TA() );
+		TRANS_ACTIONS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	if ( redFsm->anyToStateActions() ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxActionLoc), TSA() );
+		TO_STATE_ACTIONS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	if ( redFsm->anyFromStateActions() ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxActionLoc), FSA() );
+		FROM_STATE_ACTIONS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	if ( redFsm->anyEofActions() ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxActionLoc), EA() );
+		EOF_ACTIONS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	if ( redFsm->anyEofTrans() ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndexOffset+1), ET() );
+		EOF_TRANS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	STATE_IDS();
+}
+
+void CSharpCombFlatCodeGen::initVarTypes()
+{
+	slenType = ARRAY_TYPE(MAX(redFsm->maxSpan, redFsm->maxCondSpan));
+	transType = ARRAY_TYPE(redFsm->maxIndex+1);
+	indsType = ARRAY_TYPE(redFsm->maxCombBase);
+	condsType = ARRAY_TYPE(redFsm->maxCondIndexOffset);
+}
@@ -68,18 +68,12 @@ std::wostream &CSharpFFlatCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &CSharpFFlatCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numToStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numToStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -90,18 +84,12 @@ std::wostream &CSharpFFlatCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &CSharpFFlatCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numFromStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numFromStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -110,18 +98,12 @@ std::wostream &CSharpFFlatCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &CSharpFFlatCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numEofRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, true );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numEofRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -132,18 +114,12 @@ std::wostream &CSharpFFlatCodeGen::EOF_ACTION_SWITCH()
 std::wostream &CSharpFFlatCodeGen::ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numTransRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numTransRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -151,6 +127,9 @@ std::wostream &CSharpFFlatCodeGen::ACTION_SWITCH()
 
 void CSharpFFlatCodeGen::writeData()
 {
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( WIDE_ALPH_TYPE(), CK() );
 		COND_KEYS();
@@ -183,15 +162,19 @@ void CSharpFFlatCodeGen::writeData()
 	CLOSE_ARRAY() <<
 	L"\n";
 
-	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxFlatIndexOffset), IO() );
-	FLAT_INDEX_OFFSET();
-	CLOSE_ARRAY() <<
-	L"\n";
+	if ( pagedFlat )
+		PAGED_TABLES();
+	else {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxFlatIndexOffset), IO() );
+		FLAT_INDEX_OFFSET();
+		CLOSE_ARRAY() <<
+		L"\n";
 
-	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
-	INDICIES();
-	CLOSE_ARRAY() <<
-	L"\n";
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
+		INDICIES();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
 
 	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxState), TT() );
 	TRANS_TARGS();
@@ -242,6 +225,8 @@ void CSharpFFlatCodeGen::writeExec()
 	outLabelUsed = false;
 	initVarTypes();
 
+	PIN_DATA();
+
 	out << 
 		L"	{\n"
 		L"	" << slenType << L" _slen";
@@ -264,11 +249,16 @@ void CSharpFFlatCodeGen::writeExec()
 		L"	" << PTR_CONST() << WIDE_ALPH_TYPE() << POINTER() << L"_keys;\n"
 		L"	" << PTR_CONST() << ARRAY_TYPE(redFsm->maxIndex) << POINTER() << L"_inds;\n";*/
 
+	if ( pagedFlat )
+		out << L"	int _pos;\n";
+
 	if ( redFsm->anyConditions() ) {
 		out << 
 			L"	" << condsType << L" _conds;\n"
 			L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 	}
+	else if ( redFsm->anyClasses() )
+		out << L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 
 	if ( !noEnd ) {
 		testEofUsed = true;
@@ -297,6 +287,8 @@ void CSharpFFlatCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
@@ -386,4 +378,5 @@ void CSharpFFlatCodeGen::writeExec()
 		out << L"	_out: {}\n";
 
 	out << L"	}\n";
+	UNPIN_DATA();
 }
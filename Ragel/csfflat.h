@@ -37,7 +37,7 @@ class CSharpFFlatCodeGen : public CSharpFlatCodeGen
 {
 public:
 	CSharpFFlatCodeGen( wostream &out ) : CSharpFsmCodeGen(out), CSharpFlatCodeGen(out) {}
-private:
+protected:
 	std::wostream &TO_STATE_ACTION_SWITCH();
 	std::wostream &FROM_STATE_ACTION_SWITCH();
 	std::wostream &EOF_ACTION_SWITCH();
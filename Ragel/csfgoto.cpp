@@ -30,17 +30,26 @@
 std::wostream &CSharpFGotoCodeGen::EXEC_ACTIONS()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numTransRefs > 0 ) {
-			/* 	We are at the start of a glob, write the case. */
-			out << L"f" << redAct->actListId << L":\n";
+		if ( redAct->numTransRefs > 0 )
+			appendActionCase( cases, redAct->actListId, redAct->key );
+	}
+
+	/* Lists that run the same code share a glob. A glob that runs the tail
+	 * of its actions goes on into the glob of the tail. */
+	mergeActionCases( cases, false, true );
+	for ( ActionCaseList::Iter ac = cases; ac.lte(); ac++ ) {
+		/* 	We are at the start of a glob, write the labels. */
+		for ( Vector<int>::Iter label = ac->labels; label.lte(); label++ )
+			out << L"f" << *label << L":\n";
 
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false );
+		/* Write each action in the list of action items. */
+		for ( Vector<GenAction*>::Iter act = ac->actions; act.lte(); act++ )
+			ACTION( out, *act, 0, false );
 
+		if ( !ac->fallThrough )
 			out << L"\tgoto _again;\n";
-		}
 	}
 	return out;
 }
@@ -50,18 +59,12 @@ std::wostream &CSharpFGotoCodeGen::EXEC_ACTIONS()
 std::wostream &CSharpFGotoCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numToStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numToStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -72,18 +75,12 @@ std::wostream &CSharpFGotoCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &CSharpFGotoCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numFromStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numFromStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -92,18 +89,12 @@ std::wostream &CSharpFGotoCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &CSharpFGotoCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numEofRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, true );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numEofRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -173,6 +164,16 @@ void CSharpFGotoCodeGen::writeData()
 		L"\n";
 	}
 
+	if ( redFsm->bitmapLen > 0 ) {
+		OPEN_ARRAY( ARRAY_TYPE(255), KB() );
+		KEY_BITMAPS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	if ( redFsm->numSkipLoops > 0 )
+		SKIP_SETS();
+
 	STATE_IDS();
 }
 
@@ -181,6 +182,8 @@ void CSharpFGotoCodeGen::writeExec()
 	testEofUsed = false;
 	outLabelUsed = false;
 
+	PIN_DATA();
+
 	out << L"	{\n";
 
 	if ( redFsm->anyRegCurStateRef() )
@@ -293,4 +296,5 @@ void CSharpFGotoCodeGen::writeExec()
 		out << L"	_out: {}\n";
 
 	out << L"	}\n";
+	UNPIN_DATA();
 }
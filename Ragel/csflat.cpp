@@ -66,15 +66,13 @@ std::wostream &CSharpFlatCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &CSharpFlatCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -83,15 +81,13 @@ std::wostream &CSharpFlatCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &CSharpFlatCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -100,15 +96,13 @@ std::wostream &CSharpFlatCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &CSharpFlatCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, true );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -118,15 +112,13 @@ std::wostream &CSharpFlatCodeGen::EOF_ACTION_SWITCH()
 std::wostream &CSharpFlatCodeGen::ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -267,7 +259,7 @@ std::wostream &CSharpFlatCodeGen::COND_KEYS()
 
 	/* Output one last number so we don't have to figure out when the last
 	 * entry is and avoid writing a comma. */
-	if ( keyOps->alphType->isChar )
+	if ( keyOps->alphType->isChar && !redFsm->anyClasses() )
 		out << L"(char) " << 0 << L"\n";
 	else
 		out << 0 << L"\n";
@@ -356,7 +348,7 @@ std::wostream &CSharpFlatCodeGen::KEYS()
 
 	/* Output one last number so we don't have to figure out when the last
 	 * entry is and avoid writing a comma. */
-	if ( keyOps->alphType->isChar )
+	if ( keyOps->alphType->isChar && !redFsm->anyClasses() )
 		out << L"(char) " << 0 << L"\n";
 	else
 		out << 0 << L"\n";
@@ -393,6 +385,92 @@ std::wostream &CSharpFlatCodeGen::INDICIES()
 	return out;
 }
 
+std::wostream &CSharpFlatCodeGen::PAGE_DIR_OFFSETS()
+{
+	out << L"\t";
+	int totalStateNum = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		out << st->pageDirOffset;
+		if ( !st.last() ) {
+			out << L", ";
+			if ( ++totalStateNum % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+std::wostream &CSharpFlatCodeGen::PAGE_DIR()
+{
+	out << L"\t";
+	for ( int i = 0; i < redFsm->pageDir.length(); i++ ) {
+		out << redFsm->pageDir[i] << L", ";
+		if ( (i+1) % IALL == 0 )
+			out << L"\n\t";
+	}
+
+	/* Output one last number so we don't have to figure out when the last
+	 * entry is and avoid writing a comma. */
+	out << 0 << L"\n";
+	return out;
+}
+
+std::wostream &CSharpFlatCodeGen::PAGED_INDICIES()
+{
+	out << L"\t";
+	for ( int i = 0; i < redFsm->pageTrans.length(); i++ ) {
+		out << redFsm->pageTrans[i]->id << L", ";
+		if ( (i+1) % IALL == 0 )
+			out << L"\n\t";
+	}
+
+	/* Output one last number so we don't have to figure out when the last
+	 * entry is and avoid writing a comma. */
+	out << 0 << L"\n";
+	return out;
+}
+
+std::wostream &CSharpFlatCodeGen::PAGED_DEFAULTS()
+{
+	out << L"\t";
+	int totalStateNum = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		out << ( st->defTrans != 0 ? st->defTrans->id : 0 );
+		if ( !st.last() ) {
+			out << L", ";
+			if ( ++totalStateNum % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+/* The paged layout replaces the index offsets and the indicies. */
+void CSharpFlatCodeGen::PAGED_TABLES()
+{
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxPageDirOffset), IO() );
+	PAGE_DIR_OFFSETS();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxPageStart), PD() );
+	PAGE_DIR();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
+	PAGED_INDICIES();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), DT() );
+	PAGED_DEFAULTS();
+	CLOSE_ARRAY() <<
+	L"\n";
+}
+
 std::wostream &CSharpFlatCodeGen::TRANS_TARGS()
 {
 	/* Transitions must be written ordered by their id. */
@@ -449,6 +527,23 @@ std::wostream &CSharpFlatCodeGen::TRANS_ACTIONS()
 
 void CSharpFlatCodeGen::LOCATE_TRANS()
 {
+	if ( pagedFlat ) {
+		out <<
+			L"	_keys = " << vCS() << L"<<1;\n"
+			L"	_slen = " << SP() << L"[" << vCS() << L"];\n"
+			L"	if ( _slen > 0 && " << K() << L"[_keys] <= " << GET_WIDE_KEY() << L" && " <<
+					GET_WIDE_KEY() << L" <= " << K() << L"[_keys+1] ) {\n"
+			L"		_pos = " << GET_WIDE_KEY() << L" - " << K() << L"[_keys];\n"
+			L"		_inds = " << PD() << L"[" << IO() << L"[" << vCS() << L"] + (_pos >> " << 
+					FLAT_PAGE_BITS << L")];\n"
+			L"		_trans = " << I() << L"[_inds + (_pos & " << ( FLAT_PAGE_SIZE - 1 ) << L")];\n"
+			L"	}\n"
+			L"	else\n"
+			L"		_trans = " << DT() << L"[" << vCS() << L"];\n"
+			L"\n";
+		return;
+	}
+
 	out <<
 		L"	_keys = " << vCS() << L"<<1;\n"
 		L"	_inds = " << IO() << L"[" << vCS() << L"];\n"
@@ -557,6 +652,9 @@ void CSharpFlatCodeGen::writeData()
 		L"\n";
 	}
 
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( WIDE_ALPH_TYPE(), CK() );
 		COND_KEYS();
@@ -589,15 +687,19 @@ void CSharpFlatCodeGen::writeData()
 	CLOSE_ARRAY() <<
 	L"\n";
 
-	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxFlatIndexOffset), IO() );
-	FLAT_INDEX_OFFSET();
-	CLOSE_ARRAY() <<
-	L"\n";
+	if ( pagedFlat )
+		PAGED_TABLES();
+	else {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxFlatIndexOffset), IO() );
+		FLAT_INDEX_OFFSET();
+		CLOSE_ARRAY() <<
+		L"\n";
 
-	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
-	INDICIES();
-	CLOSE_ARRAY() <<
-	L"\n";
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxIndex), I() );
+		INDICIES();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
 
 	OPEN_ARRAY( ARRAY_TYPE(redFsm->maxState), TT() );
 	TRANS_TARGS();
@@ -705,6 +807,8 @@ void CSharpFlatCodeGen::writeExec()
 	outLabelUsed = false;
 	initVarTypes();
 
+	PIN_DATA();
+
 	out << 
 		L"	{\n"
 		L"	" << slenType << L" _slen";
@@ -735,11 +839,16 @@ void CSharpFlatCodeGen::writeExec()
 		L"	" << PTR_CONST() << WIDE_ALPH_TYPE() << POINTER() << L"_keys;\n"
 		L"	" << PTR_CONST() << ARRAY_TYPE(redFsm->maxIndex) << POINTER() << L"_inds;\n";*/
 
+	if ( pagedFlat )
+		out << L"	int _pos;\n";
+
 	if ( redFsm->anyConditions() ) {
 		out << 
 			L"	" << condsType << L" _conds;\n"
 			L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 	}
+	else if ( redFsm->anyClasses() )
+		out << L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 
 	out << L"\n";
 
@@ -774,6 +883,8 @@ void CSharpFlatCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
@@ -879,12 +990,13 @@ void CSharpFlatCodeGen::writeExec()
 		out << L"	_out: {}\n";
 
 	out << L"	}\n";
+	UNPIN_DATA();
 }
 
 void CSharpFlatCodeGen::initVarTypes()
 {
 	slenType = ARRAY_TYPE(MAX(redFsm->maxSpan, redFsm->maxCondSpan));
 	transType = ARRAY_TYPE(redFsm->maxIndex+1);
-	indsType = ARRAY_TYPE(redFsm->maxFlatIndexOffset);
+	indsType = ARRAY_TYPE(pagedFlat ? redFsm->maxPageStart : redFsm->maxFlatIndexOffset);
 	condsType = ARRAY_TYPE(redFsm->maxCondIndexOffset);
 }
@@ -97,18 +97,12 @@ std::wostream &CSharpFTabCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &CSharpFTabCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numToStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numToStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -119,18 +113,12 @@ std::wostream &CSharpFTabCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &CSharpFTabCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numFromStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numFromStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -139,18 +127,12 @@ std::wostream &CSharpFTabCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &CSharpFTabCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numEofRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, true );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numEofRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -161,18 +143,12 @@ std::wostream &CSharpFTabCodeGen::EOF_ACTION_SWITCH()
 std::wostream &CSharpFTabCodeGen::ACTION_SWITCH()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numTransRefs > 0 ) {
-			/* Write the entry label. */
-			out << L"\tcase " << redAct->actListId+1 << L":\n";
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false );
-
-			out << L"\tbreak;\n";
-		}
+		if ( redAct->numTransRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -180,6 +156,9 @@ std::wostream &CSharpFTabCodeGen::ACTION_SWITCH()
 
 void CSharpFTabCodeGen::writeData()
 {
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondOffset), CO() );
 		COND_OFFSETS();
@@ -296,6 +275,8 @@ void CSharpFTabCodeGen::writeExec()
 	outLabelUsed = false;
 	initVarTypes();
 
+	PIN_DATA();
+
 	out << 
 		L"	{\n"
 		L"	" << klenType << L" _klen";
@@ -308,7 +289,7 @@ void CSharpFTabCodeGen::writeExec()
 		L"	" << keysType << L" _keys;\n"
 		L"	" << transType << L" _trans;\n";
 
-	if ( redFsm->anyConditions() )
+	if ( redFsm->anyConditions() || redFsm->anyClasses() )
 		out << L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 
 	out << L"\n";
@@ -340,6 +321,8 @@ void CSharpFTabCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
@@ -435,4 +418,5 @@ void CSharpFTabCodeGen::writeExec()
 		out << L"	_out: {}\n";
 
 	out << L"	}\n";
+	UNPIN_DATA();
 }
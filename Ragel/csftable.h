@@ -38,7 +38,7 @@ class CSharpFTabCodeGen : public CSharpTabCodeGen
 {
 public:
 	CSharpFTabCodeGen( wostream &out ) : CSharpFsmCodeGen(out), CSharpTabCodeGen(out) {}
-private:
+protected:
 	std::wostream &TO_STATE_ACTION_SWITCH();
 	std::wostream &FROM_STATE_ACTION_SWITCH();
 	std::wostream &EOF_ACTION_SWITCH();
@@ -27,6 +27,16 @@
 #include "bstmap.h"
 #include "gendata.h"
 
+/* Guards for the searches of skipped self loops. SearchValues came with
+ * .NET 8, IndexOfAnyExcept over spans with .NET 7 and IndexOfAny over spans
+ * with .NET Core 2.1. Older targets take the loops a key at a time. */
+#define SKIP_SEARCH_VALUES L"NET8_0_OR_GREATER"
+#define SKIP_ANY_EXCEPT L"NET7_0_OR_GREATER"
+#define SKIP_ANY L"NETCOREAPP2_1_OR_GREATER || NETSTANDARD2_1_OR_GREATER"
+
+/* Most keys written out for the set of a skipped self loop. */
+#define MAX_SKIP_SET_KEYS 256
+
 /* Emit the goto to take for a given transition. */
 std::wostream &CSharpGotoCodeGen::TRANS_GOTO( RedTransAp *trans, int level )
 {
@@ -37,15 +47,13 @@ std::wostream &CSharpGotoCodeGen::TRANS_GOTO( RedTransAp *trans, int level )
 std::wostream &CSharpGotoCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -54,15 +62,13 @@ std::wostream &CSharpGotoCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &CSharpGotoCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -71,15 +77,13 @@ std::wostream &CSharpGotoCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &CSharpGotoCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, true );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -88,15 +92,13 @@ std::wostream &CSharpGotoCodeGen::EOF_ACTION_SWITCH()
 std::wostream &CSharpGotoCodeGen::ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -115,10 +117,28 @@ void CSharpGotoCodeGen::emitSingleSwitch( RedStateAp *state )
 	int numSingles = state->outSingle.length();
 	RedTransEl *data = state->outSingle.data;
 
+	/* With a profile the singles go busiest first and a single that takes
+	 * most of the state's traffic is tested ahead of the switch. */
+	RedTransList profSingles;
+	if ( redFsm->anyProfile() && numSingles > 1 ) {
+		profSingles.append( data, numSingles );
+		MergeSort<RedTransEl, CmpRedTransElProf> mergeSort;
+		mergeSort.sort( profSingles.data, numSingles );
+		data = profSingles.data;
+
+		if ( data[0].profCount * 2 > state->profVisits ) {
+			out << L"\tif ( " << GET_WIDE_KEY(state) << L" == " << 
+					KEY(data[0].lowKey) << L" )\n\t\t";
+			TRANS_GOTO(data[0].value, 0) << L"\n";
+			data += 1;
+			numSingles -= 1;
+		}
+	}
+
 	if ( numSingles == 1 ) {
 		/* If there is a single single key then write it out as an if. */
 		out << L"\tif ( " << GET_WIDE_KEY(state) << L" == " << 
-				KEY(data[0].lowKey) << L" )\n\t\t"; 
+				KEY(data[0].lowKey) << L" )\n\t\t";
 
 		/* Virtual function for writing the target of the transition. */
 		TRANS_GOTO(data[0].value, 0) << L"\n";
@@ -141,11 +161,34 @@ void CSharpGotoCodeGen::emitSingleSwitch( RedStateAp *state )
 	}
 }
 
+/* Match a run of linked states with one bounds check. If the keys differ
+ * the states of the run take them one at a time. */
+void CSharpGotoCodeGen::LITERAL_RUN( RedStateAp *state )
+{
+	out << L"\tif ( " << PE() << L" - " << P() << L" >= " << state->literalLen;
+
+	RedStateAp *link = state;
+	for ( int i = 0; i < state->literalLen; i++ ) {
+		out << L" &&\n\t\t\t" << GET_KEY_AT( i ) << L" == " << 
+				KEY( link->outSingle[0].lowKey );
+		link = link->outSingle[0].value->targ;
+	}
+
+	out << L" )\n"
+		L"\t{\n"
+		L"\t\t" << P() << L" += " << state->literalLen - 1 << L";\n"
+		L"\t\t";
+	GOTO( out, state->literalTarg->id, false );
+	out << L"\n"
+		L"\t}\n";
+}
+
 void CSharpGotoCodeGen::emitRangeBSearch( RedStateAp *state, int level, int low, int high )
 {
-	/* Get the mid position, staying on the lower end of the range. */
-	int mid = (low + high) >> 1;
+	/* Get the mid position, staying on the lower end of the range unless a
+	 * profile says otherwise. */
 	RedTransEl *data = state->outRange.data;
+	int mid = redFsm->searchMid( data, low, high );
 
 	/* Determine if we need to look higher or lower. */
 	bool anyLower = mid > low;
@@ -347,6 +390,238 @@ void CSharpGotoCodeGen::emitCondBSearch( RedStateAp *state, int level, int low,
 	}
 }
 
+static void appendKeys( Vector<Key> &keys, Key low, Key high )
+{
+	for ( Key key = low; ; key.increment() ) {
+		keys.append( key );
+		if ( key == high )
+			break;
+	}
+}
+
+/* A state's self loop is skipped by searching for the keys that leave it,
+ * or for the first key that is not one of the looping keys when those are
+ * fewer. */
+bool CSharpGotoCodeGen::skipExcept( RedStateAp *state )
+{
+	Size exitKeys = 0;
+	for ( int r = 0; r < state->skipRanges; r++ )
+		exitKeys += keyOps->span( state->skipLow[r], state->skipHigh[r] );
+	return exitKeys > state->skipLoopKeys;
+}
+
+bool CSharpGotoCodeGen::useSkip( RedStateAp *state )
+{
+	if ( state->skipRanges == 0 || noEnd || getKeyExpr != 0 )
+		return false;
+
+	Size setKeys = state->skipLoopKeys;
+	if ( !skipExcept( state ) ) {
+		setKeys = 0;
+		for ( int r = 0; r < state->skipRanges; r++ )
+			setKeys += keyOps->span( state->skipLow[r], state->skipHigh[r] );
+	}
+	return setKeys <= MAX_SKIP_SET_KEYS;
+}
+
+void CSharpGotoCodeGen::SKIP_LOOP( RedStateAp *state )
+{
+	bool except = skipExcept( state );
+	out <<
+		L"#if " SKIP_SEARCH_VALUES L" || " << ( except ? SKIP_ANY_EXCEPT : SKIP_ANY ) << L"\n"
+		L"	{\n"
+		L"		int _s = System.MemoryExtensions." << 
+					( except ? L"IndexOfAnyExcept" : L"IndexOfAny" ) << L"( " << 
+					KEYS_TO_END() << L", " << SKIP( state ) << L" );\n"
+		L"		" << P() << L" += _s >= 0 ? _s : " << PE() << L" - " << P() << L" - 1;\n"
+		L"	}\n"
+		L"#endif\n";
+}
+
+/* Write the sets of keys searched for by the skipped self loops, as
+ * SearchValues where there are and as arrays otherwise. */
+std::wostream &CSharpGotoCodeGen::SKIP_SETS()
+{
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		if ( !useSkip( st ) )
+			continue;
+
+		/* The keys leaving the loop, or the looping keys between them. */
+		bool except = skipExcept( st );
+		Vector<Key> keys;
+		Key next = keyOps->minKey;
+		bool atEnd = false;
+		for ( int r = 0; r < st->skipRanges; r++ ) {
+			if ( !except )
+				appendKeys( keys, st->skipLow[r], st->skipHigh[r] );
+			else if ( next < st->skipLow[r] ) {
+				Key high = st->skipLow[r];
+				high.decrement();
+				appendKeys( keys, next, high );
+			}
+
+			if ( st->skipHigh[r] == keyOps->maxKey )
+				atEnd = true;
+			else {
+				next = st->skipHigh[r];
+				next.increment();
+			}
+		}
+		if ( except && !atEnd )
+			appendKeys( keys, next, keyOps->maxKey );
+
+		wstring list;
+		for ( int k = 0; k < keys.length(); k++ ) {
+			if ( k > 0 )
+				list += k % IALL == 0 ? L",\n\t" : L", ";
+			list += ALPHA_KEY( keys[k] );
+		}
+
+		out <<
+			L"#if " SKIP_SEARCH_VALUES L"\n"
+			L"static readonly System.Buffers.SearchValues<" << ALPH_TYPE() << L"> " << 
+					SKIP(st) << L" = System.Buffers.SearchValues.Create( new " << 
+					ALPH_TYPE() << L"[] {\n"
+			L"\t" << list << L"\n"
+			L"} );\n"
+			L"#elif " << ( except ? SKIP_ANY_EXCEPT : SKIP_ANY ) << L"\n"
+			L"static readonly " << ALPH_TYPE() << L"[] " << SKIP(st) << L" = new " << 
+					ALPH_TYPE() << L"[] {\n"
+			L"\t" << list << L"\n"
+			L"};\n"
+			L"#endif\n"
+			L"\n";
+	}
+	return out;
+}
+
+/* Test the keys of the bitmap transition with one shift of a word, or a
+ * lookup in the table of bitmaps when the span is wider than a word. */
+void CSharpGotoCodeGen::BITMAP_TEST( RedStateAp *state )
+{
+	wstring offset = CAST(L"int") + L"(" + GET_KEY() + L" - " + 
+			KEY(state->bitmapLow) + L")";
+
+	out << L"\tif ( " << CAST(UINT()) << L"(" << GET_KEY() << L" - " << 
+			KEY(state->bitmapLow) << L") < " << state->bitmapSpan << L" && ";
+
+	if ( state->bitmapSpan <= BITMAP_WORD_BITS ) {
+		unsigned long word = 0;
+		for ( RedTransList::Iter el = state->bitmapList; el.lte(); el++ ) {
+			Size first = keyOps->span( state->bitmapLow, el->lowKey ) - 1;
+			Size last = keyOps->span( state->bitmapLow, el->highKey ) - 1;
+			for ( Size b = first; b <= last; b++ )
+				word |= 1ul << b;
+		}
+		out << L"( ( 0x" << std::hex << word << std::dec << L"u >> " << 
+				offset << L" ) & 1 ) != 0 )\n\t\t";
+	}
+	else {
+		out << L"( " << KB() << L"[" << state->bitmapOffset << 
+				L" + (" << offset << L" >> 3)] & (1 << (" << offset << 
+				L" & 7)) ) != 0 )\n\t\t";
+	}
+
+	TRANS_GOTO( state->bitmapTrans, 0 ) << L"\n";
+}
+
+/* Switch on every key of the state so the compiler can use a jump table. */
+void CSharpGotoCodeGen::JUMP_SWITCH( RedStateAp *state )
+{
+	Key low = state->outSingle.length() > 0 ? 
+			state->outSingle[0].lowKey : state->outRange[0].lowKey;
+	Key high = low;
+	for ( RedTransList::Iter el = state->outSingle; el.lte(); el++ ) {
+		if ( el->lowKey < low )
+			low = el->lowKey;
+		if ( el->highKey > high )
+			high = el->highKey;
+	}
+	for ( RedTransList::Iter el = state->outRange; el.lte(); el++ ) {
+		if ( el->lowKey < low )
+			low = el->lowKey;
+		if ( el->highKey > high )
+			high = el->highKey;
+	}
+
+	/* The transition of each key. Singles go over the ranges that were
+	 * extended across them. */
+	Size span = keyOps->span( low, high );
+	RedTransAp **keyTrans = new RedTransAp*[span];
+	memset( keyTrans, 0, sizeof(RedTransAp*) * span );
+	for ( RedTransList::Iter el = state->outRange; el.lte(); el++ ) {
+		Size first = keyOps->span( low, el->lowKey ) - 1;
+		Size last = keyOps->span( low, el->highKey ) - 1;
+		for ( Size k = first; k <= last; k++ )
+			keyTrans[k] = el->value;
+	}
+	for ( RedTransList::Iter el = state->outSingle; el.lte(); el++ )
+		keyTrans[keyOps->span( low, el->lowKey ) - 1] = el->value;
+
+	out << L"\tswitch( " << GET_KEY() << L" ) {\n";
+	JUMP_SWITCH_CASES( keyTrans, low, span );
+
+	/* Emits a default case for D code. */
+	SWITCH_DEFAULT();
+
+	out << L"\t}\n";
+	delete[] keyTrans;
+}
+
+/* Write the keys of each transition as cases over one goto. */
+void CSharpGotoCodeGen::JUMP_SWITCH_CASES( RedTransAp **keyTrans, Key low, Size span )
+{
+	Key first = low;
+	for ( Size i = 0; i < span; i++, first.increment() ) {
+		RedTransAp *trans = keyTrans[i];
+		if ( trans == 0 )
+			continue;
+
+		Key key = first;
+		for ( Size k = i; k < span; k++, key.increment() ) {
+			if ( keyTrans[k] == trans ) {
+				out << L"\t\tcase " << ALPHA_KEY(key) << L":\n";
+				keyTrans[k] = 0;
+			}
+		}
+
+		out << L"\t\t\t";
+		TRANS_GOTO( trans, 0 ) << L"\n";
+	}
+}
+
+std::wostream &CSharpGotoCodeGen::KEY_BITMAPS()
+{
+	int totalItems = 0;
+	out << L"\t";
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		if ( st->keyTest != KeyTestBitmap || st->bitmapSpan <= BITMAP_WORD_BITS )
+			continue;
+
+		int bytes = ( st->bitmapSpan + 7 ) / 8;
+		unsigned char *bits = new unsigned char[bytes];
+		memset( bits, 0, bytes );
+		for ( RedTransList::Iter el = st->bitmapList; el.lte(); el++ ) {
+			Size first = keyOps->span( st->bitmapLow, el->lowKey ) - 1;
+			Size last = keyOps->span( st->bitmapLow, el->highKey ) - 1;
+			for ( Size b = first; b <= last; b++ )
+				bits[b >> 3] |= 1 << (b & 7);
+		}
+
+		for ( int i = 0; i < bytes; i++ ) {
+			out << (unsigned int)bits[i];
+			if ( ++totalItems < redFsm->bitmapLen ) {
+				out << L", ";
+				if ( totalItems % IALL == 0 )
+					out << L"\n\t";
+			}
+		}
+		delete[] bits;
+	}
+	out << L"\n";
+	return out;
+}
+
 std::wostream &CSharpGotoCodeGen::STATE_GOTOS()
 {
 	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
@@ -356,18 +631,31 @@ std::wostream &CSharpGotoCodeGen::STATE_GOTOS()
 			/* Writing code above state gotos. */
 			GOTO_HEADER( st );
 
+			if ( useSkip( st ) )
+				SKIP_LOOP( st );
+
+			if ( st->literalLen > 0 && !noEnd && getKeyExpr == 0 )
+				LITERAL_RUN( st );
+
 			if ( st->stateCondVect.length() > 0 ) {
 				out << L"	_widec = " << GET_KEY() << L";\n";
 				emitCondBSearch( st, 1, 0, st->stateCondVect.length() - 1 );
 			}
 
-			/* Try singles. */
-			if ( st->outSingle.length() > 0 )
-				emitSingleSwitch( st );
+			if ( st->keyTest == KeyTestJump )
+				JUMP_SWITCH( st );
+			else {
+				/* Try singles. */
+				if ( st->outSingle.length() > 0 )
+					emitSingleSwitch( st );
 
-			/* Default case is to binary search for the ranges, if that fails then */
-			if ( st->outRange.length() > 0 )
-				emitRangeBSearch( st, 1, 0, st->outRange.length() - 1 );
+				if ( st->keyTest == KeyTestBitmap )
+					BITMAP_TEST( st );
+
+				/* Default case is to binary search for the ranges, if that fails then */
+				if ( st->outRange.length() > 0 )
+					emitRangeBSearch( st, 1, 0, st->outRange.length() - 1 );
+			}
 
 			/* Write the default transition. */
 			TRANS_GOTO( st->defTrans, 1 ) << L"\n";
@@ -654,6 +942,16 @@ void CSharpGotoCodeGen::writeData()
 		L"\n";
 	}
 
+	if ( redFsm->bitmapLen > 0 ) {
+		OPEN_ARRAY( ARRAY_TYPE(255), KB() );
+		KEY_BITMAPS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	if ( redFsm->numSkipLoops > 0 )
+		SKIP_SETS();
+
 	STATE_IDS();
 }
 
@@ -662,6 +960,8 @@ void CSharpGotoCodeGen::writeExec()
 	testEofUsed = false;
 	outLabelUsed = false;
 
+	PIN_DATA();
+
 	out << L"	{\n";
 
 	if ( redFsm->anyRegCurStateRef() )
@@ -798,4 +1098,5 @@ void CSharpGotoCodeGen::writeExec()
 		out << L"	_out: {}\n";
 
 	out << L"	}\n";
+	UNPIN_DATA();
 }
@@ -356,6 +356,16 @@ void CSharpIpGotoCodeGen::setLabelsNeeded()
 
 void CSharpIpGotoCodeGen::writeData()
 {
+	if ( redFsm->bitmapLen > 0 ) {
+		OPEN_ARRAY( ARRAY_TYPE(255), KB() );
+		KEY_BITMAPS();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	if ( redFsm->numSkipLoops > 0 )
+		SKIP_SETS();
+
 	STATE_IDS();
 }
 
@@ -367,6 +377,8 @@ void CSharpIpGotoCodeGen::writeExec()
 	testEofUsed = false;
 	outLabelUsed = false;
 
+	PIN_DATA();
+
 	out << L"	{\n";
 
 	if ( redFsm->anyRegCurStateRef() )
@@ -435,4 +447,5 @@ void CSharpIpGotoCodeGen::writeExec()
 
 	out <<
 		L"	}\n";
+	UNPIN_DATA();
 }
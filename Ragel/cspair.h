@@ -0,0 +1,54 @@
+/*
+ *  Copyright 2004-2006 Adrian Thurston <thurston@complang.org>
+ *            2004 Erich Ocean <eric.ocean@ampede.com>
+ *            2005 Alan West <alan@alanz.com>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ * 
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ * 
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA 
+ */
+
+#ifndef _CSPAIR_H
+#define _CSPAIR_H
+
+#include <iostream>
+#include "csfflat.h"
+
+/* Forwards. */
+struct CodeGenData;
+
+/*
+ * CSharpPairFlatCodeGen
+ *
+ * Steps two keys at a time for machines that only validate their input. See
+ * PairFlatCodeGen.
+ */
+class CSharpPairFlatCodeGen : public CSharpFFlatCodeGen
+{
+public:
+	CSharpPairFlatCodeGen( wostream &out ) : 
+		CSharpFsmCodeGen(out), CSharpFFlatCodeGen(out) {}
+
+protected:
+	std::wostream &PAIR_CLASSES( int mult );
+	std::wostream &PAIR_SINGLE();
+	std::wostream &PAIR_NEXT();
+
+	virtual void writeData();
+	virtual void writeExec();
+};
+
+#endif
@@ -0,0 +1,414 @@
+/*
+ *  Copyright 2001-2006 Adrian Thurston <thurston@complang.org>
+ *            2004 Erich Ocean <eric.ocean@ampede.com>
+ *            2005 Alan West <alan@alanz.com>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ragel.h"
+#include "csptable.h"
+#include "redfsm.h"
+#include "gendata.h"
+
+static long long actionId( RedAction *action )
+{
+	return action != 0 ? action->actListId+1 : 0;
+}
+
+/* Lay out the records of every state. The offsets are indexed by state id. */
+void CSharpPackTabCodeGen::packRecords( Vector<long long> &vals, Vector<long long> &offsets )
+{
+	bool anyActions = redFsm->anyActions();
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		offsets.append( vals.length() );
+
+		vals.append( st->outSingle.length() );
+		vals.append( st->outRange.length() );
+
+		/* A state without a default covers the whole alphabet with its
+		 * singles and ranges. The default is then never taken. */
+		if ( st->defTrans != 0 ) {
+			vals.append( st->defTrans->targ->id );
+			vals.append( actionId( st->defTrans->action ) );
+		}
+		else {
+			vals.append( 0 );
+			vals.append( 0 );
+		}
+
+		if ( fromStatePos >= 0 )
+			vals.append( actionId( st->fromStateAction ) );
+		if ( toStatePos >= 0 )
+			vals.append( actionId( st->toStateAction ) );
+		if ( eofActionPos >= 0 )
+			vals.append( actionId( st->eofAction ) );
+		if ( eofTransPos >= 0 ) {
+			if ( st->eofTrans != 0 ) {
+				vals.append( 1 );
+				vals.append( st->eofTrans->targ->id );
+				vals.append( actionId( st->eofTrans->action ) );
+			}
+			else {
+				vals.append( 0 );
+				vals.append( 0 );
+				vals.append( 0 );
+			}
+		}
+
+		for ( RedTransList::Iter stel = st->outSingle; stel.lte(); stel++ ) {
+			vals.append( stel->lowKey.getLongLong() );
+			vals.append( stel->value->targ->id );
+			if ( anyActions )
+				vals.append( actionId( stel->value->action ) );
+		}
+
+		for ( RedTransList::Iter rtel = st->outRange; rtel.lte(); rtel++ ) {
+			vals.append( rtel->lowKey.getLongLong() );
+			vals.append( rtel->highKey.getLongLong() );
+			vals.append( rtel->value->targ->id );
+			if ( anyActions )
+				vals.append( actionId( rtel->value->action ) );
+		}
+	}
+}
+
+/* The records replace the indicies. Place the header fields the machine uses
+ * and choose the one type that holds keys, targets and actions. */
+void CSharpPackTabCodeGen::calcIndexSize()
+{
+	useIndicies = false;
+
+	headerLen = 4;
+	fromStatePos = toStatePos = eofActionPos = eofTransPos = -1;
+	if ( redFsm->anyFromStateActions() )
+		fromStatePos = headerLen++;
+	if ( redFsm->anyToStateActions() )
+		toStatePos = headerLen++;
+	if ( redFsm->anyEofActions() )
+		eofActionPos = headerLen++;
+	if ( redFsm->anyEofTrans() ) {
+		eofTransPos = headerLen;
+		headerLen += 3;
+	}
+
+	singleStride = redFsm->anyActions() ? 3 : 2;
+	rangeStride = singleStride + 1;
+
+	Vector<long long> vals, offsets;
+	packRecords( vals, offsets );
+
+	long long minVal = 0, maxVal = 0;
+	for ( int i = 0; i < vals.length(); i++ ) {
+		if ( vals[i] < minVal )
+			minVal = vals[i];
+		if ( vals[i] > maxVal )
+			maxVal = vals[i];
+	}
+
+	recordsLen = vals.length();
+	packType = keyOps->typeSpans( minVal, maxVal );
+	assert( packType != 0 );
+}
+
+wstring CSharpPackTabCodeGen::PACK_TYPE()
+{
+	wstring ret = packType->data1;
+	if ( packType->data2 != 0 ) {
+		ret += L" ";
+		ret += packType->data2;
+	}
+	return ret;
+}
+
+std::wostream &CSharpPackTabCodeGen::RECORDS()
+{
+	Vector<long long> vals, offsets;
+	packRecords( vals, offsets );
+
+	out << L"\t";
+	for ( int i = 0; i < vals.length(); i++ ) {
+		out << vals[i];
+		if ( i < vals.length()-1 ) {
+			out << L", ";
+			if ( (i+1) % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+std::wostream &CSharpPackTabCodeGen::RECORD_OFFSETS()
+{
+	Vector<long long> vals, offsets;
+	packRecords( vals, offsets );
+
+	out << L"\t";
+	for ( int i = 0; i < offsets.length(); i++ ) {
+		out << offsets[i];
+		if ( i < offsets.length()-1 ) {
+			out << L", ";
+			if ( (i+1) % IALL == 0 )
+				out << L"\n\t";
+		}
+	}
+	out << L"\n";
+	return out;
+}
+
+void CSharpPackTabCodeGen::writeData()
+{
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
+	if ( redFsm->anyConditions() ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondOffset), CO() );
+		COND_OFFSETS();
+		CLOSE_ARRAY() <<
+		L"\n";
+
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondLen), CL() );
+		COND_LENS();
+		CLOSE_ARRAY() <<
+		L"\n";
+
+		OPEN_ARRAY( WIDE_ALPH_TYPE(), CK() );
+		COND_KEYS();
+		CLOSE_ARRAY() <<
+		L"\n";
+
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondSpaceId), C() );
+		COND_SPACES();
+		CLOSE_ARRAY() <<
+		L"\n";
+	}
+
+	OPEN_ARRAY( PACK_TYPE(), REC() );
+	RECORDS();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	OPEN_ARRAY( ARRAY_TYPE(recordsLen), RO() );
+	RECORD_OFFSETS();
+	CLOSE_ARRAY() <<
+	L"\n";
+
+	STATE_IDS();
+}
+
+void CSharpPackTabCodeGen::LOCATE_TRANS()
+{
+	out <<
+		L"	_rec = " << RO() << L"[" << vCS() << L"];\n"
+		L"	_ent = _rec + " << headerLen << L";\n"
+		L"\n"
+		L"	_klen = " << REC() << L"[_rec];\n"
+		L"	if ( _klen > 0 ) {\n"
+		L"		int _lower = 0;\n"
+		L"		int _upper = _klen - 1;\n"
+		L"		int _mid;\n"
+		L"		while ( _lower <= _upper ) {\n"
+		L"			_mid = (_lower + _upper) >> 1;\n"
+		L"			if ( " << GET_WIDE_KEY() << L" < " << REC() << L"[_ent + _mid*" << singleStride << L"] )\n"
+		L"				_upper = _mid - 1;\n"
+		L"			else if ( " << GET_WIDE_KEY() << L" > " << REC() << L"[_ent + _mid*" << singleStride << L"] )\n"
+		L"				_lower = _mid + 1;\n"
+		L"			else {\n"
+		L"				_ent += _mid*" << singleStride << L";\n"
+		L"				goto _match;\n"
+		L"			}\n"
+		L"		}\n"
+		L"		_ent += _klen*" << singleStride << L";\n"
+		L"	}\n"
+		L"\n"
+		L"	_klen = " << REC() << L"[_rec + 1];\n"
+		L"	if ( _klen > 0 ) {\n"
+		L"		int _lower = 0;\n"
+		L"		int _upper = _klen - 1;\n"
+		L"		int _mid;\n"
+		L"		while ( _lower <= _upper ) {\n"
+		L"			_mid = (_lower + _upper) >> 1;\n"
+		L"			if ( " << GET_WIDE_KEY() << L" < " << REC() << L"[_ent + _mid*" << rangeStride << L"] )\n"
+		L"				_upper = _mid - 1;\n"
+		L"			else if ( " << GET_WIDE_KEY() << L" > " << REC() << L"[_ent + _mid*" << rangeStride << L" + 1] )\n"
+		L"				_lower = _mid + 1;\n"
+		L"			else {\n"
+		L"				_ent += _mid*" << rangeStride << L" + 1;\n"
+		L"				goto _match;\n"
+		L"			}\n"
+		L"		}\n"
+		L"	}\n"
+		L"\n"
+		L"	_ent = _rec + 1;\n"
+		L"\n";
+}
+
+/* The entry found for a key is an index into the records. It has the target
+ * at one past it and the action at two past it. */
+void CSharpPackTabCodeGen::writeExec()
+{
+	testEofUsed = false;
+	outLabelUsed = false;
+	initVarTypes();
+
+	PIN_DATA();
+
+	out <<
+		L"	{\n"
+		L"	int _klen, _rec, _ent";
+
+	if ( redFsm->anyRegCurStateRef() )
+		out << L", _ps";
+
+	out <<
+		L";\n";
+
+	if ( redFsm->anyConditions() )
+		out << L"	" << keysType << L" _keys;\n";
+
+	if ( redFsm->anyConditions() || redFsm->anyClasses() )
+		out << L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
+
+	out << L"\n";
+
+	if ( !noEnd ) {
+		testEofUsed = true;
+		out <<
+			L"	if ( " << P() << L" == " << PE() << L" )\n"
+			L"		goto _test_eof;\n";
+	}
+
+	if ( redFsm->errState != 0 ) {
+		outLabelUsed = true;
+		out <<
+			L"	if ( " << vCS() << L" == " << redFsm->errState->id << L" )\n"
+			L"		goto _out;\n";
+	}
+
+	out << L"_resume:\n";
+
+	if ( redFsm->anyFromStateActions() ) {
+		out <<
+			L"	switch ( " << REC() << L"[" << RO() << L"[" << vCS() << L"] + " <<
+					fromStatePos << L"] ) {\n";
+			FROM_STATE_ACTION_SWITCH();
+			SWITCH_DEFAULT() <<
+			L"	}\n"
+			L"\n";
+	}
+
+	if ( redFsm->anyConditions() )
+		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
+
+	LOCATE_TRANS();
+
+	out << L"_match:\n";
+
+	if ( redFsm->anyEofTrans() )
+		out << L"_eof_trans:\n";
+
+	if ( redFsm->anyRegCurStateRef() )
+		out << L"	_ps = " << vCS() << L";\n";
+
+	out <<
+		L"	" << vCS() << L" = " << REC() << L"[_ent + 1];\n"
+		L"\n";
+
+	if ( redFsm->anyRegActions() ) {
+		out <<
+			L"	if ( " << REC() << L"[_ent + 2] == 0 )\n"
+			L"		goto _again;\n"
+			L"\n"
+			L"	switch ( " << REC() << L"[_ent + 2] ) {\n";
+			ACTION_SWITCH();
+			SWITCH_DEFAULT() <<
+			L"	}\n"
+			L"\n";
+	}
+
+	if ( redFsm->anyRegActions() || redFsm->anyActionGotos() ||
+			redFsm->anyActionCalls() || redFsm->anyActionRets() )
+		out << L"_again:\n";
+
+	if ( redFsm->anyToStateActions() ) {
+		out <<
+			L"	switch ( " << REC() << L"[" << RO() << L"[" << vCS() << L"] + " <<
+					toStatePos << L"] ) {\n";
+			TO_STATE_ACTION_SWITCH();
+			SWITCH_DEFAULT() <<
+			L"	}\n"
+			L"\n";
+	}
+
+	if ( redFsm->errState != 0 ) {
+		outLabelUsed = true;
+		out <<
+			L"	if ( " << vCS() << L" == " << redFsm->errState->id << L" )\n"
+			L"		goto _out;\n";
+	}
+
+	if ( !noEnd ) {
+		out <<
+			L"	if ( ++" << P() << L" != " << PE() << L" )\n"
+			L"		goto _resume;\n";
+	}
+	else {
+		out <<
+			L"	" << P() << L" += 1;\n"
+			L"	goto _resume;\n";
+	}
+
+	if ( testEofUsed )
+		out << L"	_test_eof: {}\n";
+
+	if ( redFsm->anyEofTrans() || redFsm->anyEofActions() ) {
+		out <<
+			L"	if ( " << P() << L" == " << vEOF() << L" )\n"
+			L"	{\n"
+			L"	_rec = " << RO() << L"[" << vCS() << L"];\n";
+
+		if ( redFsm->anyEofTrans() ) {
+			out <<
+				L"	if ( " << REC() << L"[_rec + " << eofTransPos << L"] > 0 ) {\n"
+				L"		_ent = _rec + " << eofTransPos << L";\n"
+				L"		goto _eof_trans;\n"
+				L"	}\n";
+		}
+
+		if ( redFsm->anyEofActions() ) {
+			out <<
+				L"	switch ( " << REC() << L"[_rec + " << eofActionPos << L"] ) {\n";
+				EOF_ACTION_SWITCH();
+				SWITCH_DEFAULT() <<
+				L"	}\n";
+		}
+
+		out <<
+			L"	}\n"
+			L"\n";
+	}
+
+	if ( outLabelUsed )
+		out << L"	_out: {}\n";
+
+	out << L"	}\n";
+	UNPIN_DATA();
+}
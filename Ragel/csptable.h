@@ -0,0 +1,64 @@
+/*
+ *  Copyright 2001-2006 Adrian Thurston <thurston@complang.org>
+ *            2004 Erich Ocean <eric.ocean@ampede.com>
+ *            2005 Alan West <alan@alanz.com>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _CSPTABLE_H
+#define _CSPTABLE_H
+
+#include <iostream>
+#include "csftable.h"
+
+/* Forwards. */
+struct CodeGenData;
+
+/*
+ * CSharpPackTabCodeGen
+ *
+ * Table driven machine with each state kept in one record. See
+ * PackTabCodeGen.
+ */
+class CSharpPackTabCodeGen : public CSharpFTabCodeGen
+{
+public:
+	CSharpPackTabCodeGen( wostream &out ) : 
+		CSharpFsmCodeGen(out), CSharpFTabCodeGen(out) {}
+
+protected:
+	void packRecords( Vector<long long> &vals, Vector<long long> &offsets );
+	std::wostream &RECORDS();
+	std::wostream &RECORD_OFFSETS();
+	wstring PACK_TYPE();
+	void LOCATE_TRANS();
+
+	virtual void writeData();
+	virtual void writeExec();
+	virtual void calcIndexSize();
+
+	/* Positions of the optional header fields, -1 if the machine does not
+	 * use them. The eof transition takes a flag, a target and an action. */
+	int fromStatePos, toStatePos, eofActionPos, eofTransPos;
+	int headerLen, singleStride, rangeStride;
+	long long recordsLen;
+	HostType *packType;
+};
+
+#endif
@@ -95,15 +95,13 @@ std::wostream &CSharpTabCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &CSharpTabCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -112,15 +110,13 @@ std::wostream &CSharpTabCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &CSharpTabCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -129,15 +125,13 @@ std::wostream &CSharpTabCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &CSharpTabCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, true );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -147,15 +141,13 @@ std::wostream &CSharpTabCodeGen::EOF_ACTION_SWITCH()
 std::wostream &CSharpTabCodeGen::ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -372,7 +364,7 @@ std::wostream &CSharpTabCodeGen::COND_KEYS()
 
 	/* Output one last number so we don't have to figure out when the last
 	 * entry is and avoid writing a comma. */
-	if ( keyOps->alphType->isChar )
+	if ( keyOps->alphType->isChar && !redFsm->anyClasses() )
 		out << L"(char) " << 0 << L"\n";
 	else
 		out << 0 << L"\n";
@@ -428,7 +420,7 @@ std::wostream &CSharpTabCodeGen::KEYS()
 
 	/* Output one last number so we don't have to figure out when the last
 	 * entry is and avoid writing a comma. */
-	if ( keyOps->alphType->isChar )
+	if ( keyOps->alphType->isChar && !redFsm->anyClasses() )
 		out << L"(char) " << 0 << L"\n";
 	else
 		out << 0 << L"\n";
@@ -711,6 +703,9 @@ void CSharpTabCodeGen::writeData()
 		L"\n";
 	}
 
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondOffset), CO() );
 		COND_OFFSETS();
@@ -939,6 +934,8 @@ void CSharpTabCodeGen::writeExec()
 	outLabelUsed = false;
 	initVarTypes();
 
+	PIN_DATA();
+
 	out <<
 		L"	{\n"
 		L"	" << klenType << L" _klen";
@@ -950,7 +947,7 @@ void CSharpTabCodeGen::writeExec()
 		L";\n"
 		L"	" << transType << L" _trans;\n";
 
-	if ( redFsm->anyConditions() )
+	if ( redFsm->anyConditions() || redFsm->anyClasses() )
 		out << L"	" << WIDE_ALPH_TYPE() << L" _widec;\n";
 
 	if ( redFsm->anyToStateActions() || redFsm->anyRegActions() 
@@ -997,6 +994,8 @@ void CSharpTabCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
@@ -1106,6 +1105,7 @@ void CSharpTabCodeGen::writeExec()
 		out << L"	_out: {}\n";
 
 	out << L"	}\n";
+	UNPIN_DATA();
 }
 
 void CSharpTabCodeGen::initVarTypes()
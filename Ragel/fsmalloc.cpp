@@ -0,0 +1,210 @@
+/*
+ *  Copyright 2001-2007 Adrian Thurston <thurston@complang.org>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "fsmalloc.h"
+#include "ragel.h"
+#include <stdlib.h>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using std::endl;
+
+/* Small objects are rounded up to a multiple of the alignment and recycled
+ * through a free list per size. Anything larger gets a mapping of its own. */
+#define SCRATCH_ALIGN      16
+#define SCRATCH_MAX_SMALL  512
+#define SCRATCH_NUM_LISTS  (SCRATCH_MAX_SMALL / SCRATCH_ALIGN)
+
+/* Small objects are cut from segments of this size. Must be a multiple of
+ * the mapping granularity, which is 64K on Windows. */
+#define SCRATCH_SEGMENT    (64 * 1024 * 1024)
+#define SCRATCH_GRANULE    (64 * 1024)
+
+struct FreeChunk
+{
+	FreeChunk *next;
+};
+
+#ifdef _WIN32
+static HANDLE scratchFile = INVALID_HANDLE_VALUE;
+#else
+static int scratchFile = -1;
+#endif
+
+/* Current end of the file. Mappings are always taken from the end. */
+static long long scratchEnd = 0;
+static long long bytesMapped = 0;
+
+/* Region of the current segment not yet handed out. */
+static char *segmentPos = 0;
+static char *segmentEnd = 0;
+
+static FreeChunk *freeLists[SCRATCH_NUM_LISTS];
+
+bool openScratchFile( const wchar_t *fileName )
+{
+#ifdef _WIN32
+	scratchFile = CreateFileW( fileName, GENERIC_READ | GENERIC_WRITE, 0, 0,
+			CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, 0 );
+	return scratchFile != INVALID_HANDLE_VALUE;
+#else
+	size_t len = wcstombs( 0, fileName, 0 );
+	if ( len == (size_t)-1 )
+		return false;
+
+	char *name = new char[len+1];
+	wcstombs( name, fileName, len+1 );
+	scratchFile = open( name, O_RDWR | O_CREAT | O_TRUNC, 0600 );
+
+	/* Nothing outside this process needs the file. Unlinking it right away
+	 * gets it removed no matter how we exit. */
+	if ( scratchFile >= 0 )
+		unlink( name );
+	delete[] name;
+	return scratchFile >= 0;
+#endif
+}
+
+bool scratchFileOpen()
+{
+#ifdef _WIN32
+	return scratchFile != INVALID_HANDLE_VALUE;
+#else
+	return scratchFile >= 0;
+#endif
+}
+
+long long scratchBytesMapped()
+{
+	return bytesMapped;
+}
+
+/* Extend the file by len bytes and map the new region. */
+static void *mapScratch( size_t len )
+{
+	void *region = 0;
+	long long offset = scratchEnd;
+
+#ifdef _WIN32
+	long long newEnd = offset + len;
+	HANDLE mapping = CreateFileMappingW( scratchFile, 0, PAGE_READWRITE,
+			(DWORD)(newEnd >> 32), (DWORD)newEnd, 0 );
+	if ( mapping != 0 ) {
+		region = MapViewOfFile( mapping, FILE_MAP_ALL_ACCESS,
+				(DWORD)(offset >> 32), (DWORD)offset, len );
+
+		/* The view keeps the mapping object alive. */
+		CloseHandle( mapping );
+	}
+#else
+	if ( ftruncate( scratchFile, offset + len ) == 0 ) {
+		region = mmap( 0, len, PROT_READ | PROT_WRITE, MAP_SHARED, scratchFile, offset );
+		if ( region == MAP_FAILED )
+			region = 0;
+	}
+#endif
+
+	if ( region == 0 ) {
+		error() << L"could not extend the scratch file to " <<
+				( offset + len ) << L" bytes" << endl;
+		exit(1);
+	}
+
+	scratchEnd += len;
+	bytesMapped += len;
+	return region;
+}
+
+static void unmapScratch( void *region, size_t len )
+{
+#ifdef _WIN32
+	UnmapViewOfFile( region );
+#else
+	munmap( region, len );
+#endif
+	bytesMapped -= len;
+}
+
+static size_t largeLength( size_t size )
+{
+	return ( size + SCRATCH_GRANULE - 1 ) & ~(size_t)( SCRATCH_GRANULE - 1 );
+}
+
+void *scratchAlloc( size_t size )
+{
+	if ( !scratchFileOpen() )
+		return ::operator new( size );
+
+	if ( size > SCRATCH_MAX_SMALL )
+		return mapScratch( largeLength( size ) );
+
+	if ( size == 0 )
+		size = 1;
+	size_t list = ( size - 1 ) / SCRATCH_ALIGN;
+	if ( freeLists[list] != 0 ) {
+		FreeChunk *chunk = freeLists[list];
+		freeLists[list] = chunk->next;
+		return chunk;
+	}
+
+	size_t chunkSize = ( list + 1 ) * SCRATCH_ALIGN;
+	if ( segmentPos == 0 || (size_t)( segmentEnd - segmentPos ) < chunkSize ) {
+		/* Whatever is left in the old segment is abandoned. It is less than
+		 * the size of one small object. */
+		segmentPos = (char*) mapScratch( SCRATCH_SEGMENT );
+		segmentEnd = segmentPos + SCRATCH_SEGMENT;
+	}
+
+	void *result = segmentPos;
+	segmentPos += chunkSize;
+	return result;
+}
+
+void scratchFree( void *ptr, size_t size )
+{
+	if ( ptr == 0 )
+		return;
+
+	if ( !scratchFileOpen() ) {
+		::operator delete( ptr );
+		return;
+	}
+
+	if ( size > SCRATCH_MAX_SMALL ) {
+		unmapScratch( ptr, largeLength( size ) );
+		return;
+	}
+
+	if ( size == 0 )
+		size = 1;
+	size_t list = ( size - 1 ) / SCRATCH_ALIGN;
+	FreeChunk *chunk = (FreeChunk*) ptr;
+	chunk->next = freeLists[list];
+	freeLists[list] = chunk;
+}
@@ -0,0 +1,55 @@
+/*
+ *  Copyright 2001-2007 Adrian Thurston <thurston@complang.org>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _FSMALLOC_H
+#define _FSMALLOC_H
+
+#include <stddef.h>
+
+/* Storage for the elements of state machine graphs. By default elements come
+ * from the heap. Once a scratch file is opened they are carved out of shared
+ * mappings of that file instead, so the operating system can write pages
+ * that are not being touched back to disk rather than keeping the whole graph
+ * resident. Only the elements themselves are placed there. The vectors, action
+ * tables and other containers they own still come from the heap, and on large
+ * scanners they are most of the memory. */
+bool openScratchFile( const wchar_t *fileName );
+bool scratchFileOpen();
+long long scratchBytesMapped();
+
+void *scratchAlloc( size_t size );
+void scratchFree( void *ptr, size_t size );
+
+/* Base for the classes whose instances make up the bulk of a large graph.
+ * Routes their allocation through the scratch storage. */
+struct ScratchAllocated
+{
+	static void *operator new( size_t size )
+		{ return scratchAlloc( size ); }
+	static void operator delete( void *ptr, size_t size )
+		{ scratchFree( ptr, size ); }
+	static void *operator new[]( size_t size )
+		{ return scratchAlloc( size ); }
+	static void operator delete[]( void *ptr, size_t size )
+		{ scratchFree( ptr, size ); }
+};
+
+#endif
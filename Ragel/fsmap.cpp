@@ -126,7 +126,7 @@ void FsmAp::startFsmPrior( int ordering, PriorDesc *prior )
 	 * the same convention as setting start action in the out action table of
 	 * a final start state. */
 	if ( startState->stateBits & STB_ISFINAL )
-		startState->outPriorTable.setPrior( ordering, prior );
+		startState->extMut().outPriorTable.setPrior( ordering, prior );
 }
 
 /* Set the priority of all transitions in a graph. Walks all transition lists
@@ -150,6 +150,8 @@ void FsmAp::allTransPrior( int ordering, PriorDesc *prior )
  * supported. */
 void FsmAp::finishFsmPrior( int ordering, PriorDesc *prior )
 {
+	needInLists();
+
 	/* Walk all final states. */
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ ) {
 		/* Walk all in transitions of the final state. */
@@ -164,7 +166,7 @@ void FsmAp::leaveFsmPrior( int ordering, PriorDesc *prior )
 {
 	/* Set priority in all final states. */
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ )
-		(*state)->outPriorTable.setPrior( ordering, prior );
+		(*state)->extMut().outPriorTable.setPrior( ordering, prior );
 }
 
 
@@ -190,7 +192,7 @@ void FsmAp::startFsmAction( int ordering, Action *action )
 	 * This means that when the null wstring is accepted the start action will
 	 * not be bypassed. */
 	if ( startState->stateBits & STB_ISFINAL )
-		startState->outActionTable.setAction( ordering, action );
+		startState->extMut().outActionTable.setAction( ordering, action );
 }
 
 /* Set functions to execute on all transitions. Walks the out lists of all
@@ -213,6 +215,8 @@ void FsmAp::allTransAction( int ordering, Action *action )
  * final state from within the same fsm. */
 void FsmAp::finishFsmAction( int ordering, Action *action )
 {
+	needInLists();
+
 	/* Walk all final states. */
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ ) {
 		/* Walk the final state's in list. */
@@ -227,12 +231,14 @@ void FsmAp::leaveFsmAction( int ordering, Action *action )
 {
 	/* Insert the action in the outActionTable of all final states. */
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ )
-		(*state)->outActionTable.setAction( ordering, action );
+		(*state)->extMut().outActionTable.setAction( ordering, action );
 }
 
 /* Add functions to the longest match action table for constructing scanners. */
 void FsmAp::longMatchAction( int ordering, LongestMatchPart *lmPart )
 {
+	needInLists();
+
 	/* Walk all final states. */
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ ) {
 		/* Walk the final state's in list. */
@@ -345,21 +351,24 @@ void FsmAp::setErrorTarget( StateAp *state, StateAp *target, int *orderings,
 
 void FsmAp::transferOutActions( StateAp *state )
 {
-	for ( ActionTable::Iter act = state->outActionTable; act.lte(); act++ )
-		state->eofActionTable.setAction( act->key, act->value ); 
-	state->outActionTable.empty();
+	if ( state->extData != 0 ) {
+		StateExt *ext = state->extData;
+		for ( ActionTable::Iter act = ext->outActionTable; act.lte(); act++ )
+			ext->eofActionTable.setAction( act->key, act->value ); 
+		ext->outActionTable.empty();
+	}
 }
 
 void FsmAp::transferErrorActions( StateAp *state, int transferPoint )
 {
-	for ( int i = 0; i < state->errActionTable.length(); ) {
-		ErrActionTableEl *act = state->errActionTable.data + i;
+	for ( int i = 0; i < state->ext().errActionTable.length(); ) {
+		ErrActionTableEl *act = state->ext().errActionTable.data + i;
 		if ( act->transferPoint == transferPoint ) {
 			/* Transfer the error action and remove it. */
 			setErrorAction( state, act->ordering, act->action );
 			if ( ! state->isFinState() )
-				state->eofActionTable.setAction( act->ordering, act->action );
-			state->errActionTable.vremove( i );
+				state->extMut().eofActionTable.setAction( act->ordering, act->action );
+			state->extMut().errActionTable.vremove( i );
 		}
 		else {
 			/* Not transfering and deleting, skip over the item. */
@@ -375,7 +384,7 @@ void FsmAp::startErrorAction( int ordering, Action *action, int transferPoint )
 	isolateStartState();
 
 	/* Add the actions. */
-	startState->errActionTable.setAction( ordering, action, transferPoint );
+	startState->extMut().errActionTable.setAction( ordering, action, transferPoint );
 }
 
 /* Set error actions in all states where there is a transition out. */
@@ -383,7 +392,7 @@ void FsmAp::allErrorAction( int ordering, Action *action, int transferPoint )
 {
 	/* Insert actions in the error action table of all states. */
 	for ( StateList::Iter state = stateList; state.lte(); state++ )
-		state->errActionTable.setAction( ordering, action, transferPoint );
+		state->extMut().errActionTable.setAction( ordering, action, transferPoint );
 }
 
 /* Set error actions in final states. */
@@ -391,14 +400,14 @@ void FsmAp::finalErrorAction( int ordering, Action *action, int transferPoint )
 {
 	/* Add the action to the error table of final states. */
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ )
-		(*state)->errActionTable.setAction( ordering, action, transferPoint );
+		(*state)->extMut().errActionTable.setAction( ordering, action, transferPoint );
 }
 
 void FsmAp::notStartErrorAction( int ordering, Action *action, int transferPoint )
 {
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( state != startState )
-			state->errActionTable.setAction( ordering, action, transferPoint );
+			state->extMut().errActionTable.setAction( ordering, action, transferPoint );
 	}
 }
 
@@ -406,7 +415,7 @@ void FsmAp::notFinalErrorAction( int ordering, Action *action, int transferPoint
 {
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( ! state->isFinState() )
-			state->errActionTable.setAction( ordering, action, transferPoint );
+			state->extMut().errActionTable.setAction( ordering, action, transferPoint );
 	}
 }
 
@@ -417,7 +426,7 @@ void FsmAp::middleErrorAction( int ordering, Action *action, int transferPoint )
 	 * machine, in which case we don't want it set. */
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( state != startState && ! state->isFinState() )
-			state->errActionTable.setAction( ordering, action, transferPoint );
+			state->extMut().errActionTable.setAction( ordering, action, transferPoint );
 	}
 }
 
@@ -428,7 +437,7 @@ void FsmAp::startEOFAction( int ordering, Action *action )
 	isolateStartState();
 
 	/* Add the actions. */
-	startState->eofActionTable.setAction( ordering, action );
+	startState->extMut().eofActionTable.setAction( ordering, action );
 }
 
 /* Set EOF actions in all states where there is a transition out. */
@@ -436,7 +445,7 @@ void FsmAp::allEOFAction( int ordering, Action *action )
 {
 	/* Insert actions in the EOF action table of all states. */
 	for ( StateList::Iter state = stateList; state.lte(); state++ )
-		state->eofActionTable.setAction( ordering, action );
+		state->extMut().eofActionTable.setAction( ordering, action );
 }
 
 /* Set EOF actions in final states. */
@@ -444,14 +453,14 @@ void FsmAp::finalEOFAction( int ordering, Action *action )
 {
 	/* Add the action to the error table of final states. */
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ )
-		(*state)->eofActionTable.setAction( ordering, action );
+		(*state)->extMut().eofActionTable.setAction( ordering, action );
 }
 
 void FsmAp::notStartEOFAction( int ordering, Action *action )
 {
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( state != startState )
-			state->eofActionTable.setAction( ordering, action );
+			state->extMut().eofActionTable.setAction( ordering, action );
 	}
 }
 
@@ -459,7 +468,7 @@ void FsmAp::notFinalEOFAction( int ordering, Action *action )
 {
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( ! state->isFinState() )
-			state->eofActionTable.setAction( ordering, action );
+			state->extMut().eofActionTable.setAction( ordering, action );
 	}
 }
 
@@ -469,7 +478,7 @@ void FsmAp::middleEOFAction( int ordering, Action *action )
 	/* Set the actions in all states that are not the start state and not final. */
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( state != startState && ! state->isFinState() )
-			state->eofActionTable.setAction( ordering, action );
+			state->extMut().eofActionTable.setAction( ordering, action );
 	}
 }
 
@@ -482,7 +491,7 @@ void FsmAp::startToStateAction( int ordering, Action *action )
 {
 	/* Make sure the start state has no other entry points. */
 	isolateStartState();
-	startState->toStateActionTable.setAction( ordering, action );
+	startState->extMut().toStateActionTable.setAction( ordering, action );
 }
 
 /* Set to state actions in all states. */
@@ -490,7 +499,7 @@ void FsmAp::allToStateAction( int ordering, Action *action )
 {
 	/* Insert the action on all states. */
 	for ( StateList::Iter state = stateList; state.lte(); state++ )
-		state->toStateActionTable.setAction( ordering, action );
+		state->extMut().toStateActionTable.setAction( ordering, action );
 }
 
 /* Set to state actions in final states. */
@@ -498,14 +507,14 @@ void FsmAp::finalToStateAction( int ordering, Action *action )
 {
 	/* Add the action to the error table of final states. */
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ )
-		(*state)->toStateActionTable.setAction( ordering, action );
+		(*state)->extMut().toStateActionTable.setAction( ordering, action );
 }
 
 void FsmAp::notStartToStateAction( int ordering, Action *action )
 {
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( state != startState )
-			state->toStateActionTable.setAction( ordering, action );
+			state->extMut().toStateActionTable.setAction( ordering, action );
 	}
 }
 
@@ -513,7 +522,7 @@ void FsmAp::notFinalToStateAction( int ordering, Action *action )
 {
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( ! state->isFinState() )
-			state->toStateActionTable.setAction( ordering, action );
+			state->extMut().toStateActionTable.setAction( ordering, action );
 	}
 }
 
@@ -523,7 +532,7 @@ void FsmAp::middleToStateAction( int ordering, Action *action )
 	/* Set the action in all states that are not the start state and not final. */
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( state != startState && ! state->isFinState() )
-			state->toStateActionTable.setAction( ordering, action );
+			state->extMut().toStateActionTable.setAction( ordering, action );
 	}
 }
 
@@ -535,28 +544,28 @@ void FsmAp::startFromStateAction( int ordering, Action *action )
 {
 	/* Make sure the start state has no other entry points. */
 	isolateStartState();
-	startState->fromStateActionTable.setAction( ordering, action );
+	startState->extMut().fromStateActionTable.setAction( ordering, action );
 }
 
 void FsmAp::allFromStateAction( int ordering, Action *action )
 {
 	/* Insert the action on all states. */
 	for ( StateList::Iter state = stateList; state.lte(); state++ )
-		state->fromStateActionTable.setAction( ordering, action );
+		state->extMut().fromStateActionTable.setAction( ordering, action );
 }
 
 void FsmAp::finalFromStateAction( int ordering, Action *action )
 {
 	/* Add the action to the error table of final states. */
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ )
-		(*state)->fromStateActionTable.setAction( ordering, action );
+		(*state)->extMut().fromStateActionTable.setAction( ordering, action );
 }
 
 void FsmAp::notStartFromStateAction( int ordering, Action *action )
 {
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( state != startState )
-			state->fromStateActionTable.setAction( ordering, action );
+			state->extMut().fromStateActionTable.setAction( ordering, action );
 	}
 }
 
@@ -564,7 +573,7 @@ void FsmAp::notFinalFromStateAction( int ordering, Action *action )
 {
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( ! state->isFinState() )
-			state->fromStateActionTable.setAction( ordering, action );
+			state->extMut().fromStateActionTable.setAction( ordering, action );
 	}
 }
 
@@ -573,7 +582,7 @@ void FsmAp::middleFromStateAction( int ordering, Action *action )
 	/* Set the action in all states that are not the start state and not final. */
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		if ( state != startState && ! state->isFinState() )
-			state->fromStateActionTable.setAction( ordering, action );
+			state->extMut().fromStateActionTable.setAction( ordering, action );
 	}
 }
 
@@ -606,7 +615,8 @@ void FsmAp::clearAllPriorities()
 {
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		/* Clear out priority data. */
-		state->outPriorTable.empty();
+		if ( state->extData != 0 )
+			state->extData->outPriorTable.empty();
 
 		/* Clear transition data from the out transitions. */
 		for ( TransList::Iter trans = state->outList; trans.lte(); trans++ )
@@ -635,28 +645,33 @@ void FsmAp::nullActionKeys( )
 				action->key = 0;
 		}
 
+		/* The remaining tables are all in the extended data. */
+		StateExt *ext = state->extData;
+		if ( ext == 0 )
+			continue;
+
 		/* Null the action keys of the to state action table. */
-		for ( ActionTable::Iter action = state->toStateActionTable;
+		for ( ActionTable::Iter action = ext->toStateActionTable;
 				action.lte(); action++ )
 			action->key = 0;
 
 		/* Null the action keys of the from state action table. */
-		for ( ActionTable::Iter action = state->fromStateActionTable;
+		for ( ActionTable::Iter action = ext->fromStateActionTable;
 				action.lte(); action++ )
 			action->key = 0;
 
 		/* Null the action keys of the out transtions. */
-		for ( ActionTable::Iter action = state->outActionTable;
+		for ( ActionTable::Iter action = ext->outActionTable;
 				action.lte(); action++ )
 			action->key = 0;
 
 		/* Null the action keys of the error action table. */
-		for ( ErrActionTable::Iter action = state->errActionTable;
+		for ( ErrActionTable::Iter action = ext->errActionTable;
 				action.lte(); action++ )
 			action->ordering = 0;
 
 		/* Null the action keys eof action table. */
-		for ( ActionTable::Iter action = state->eofActionTable;
+		for ( ActionTable::Iter action = ext->eofActionTable;
 				action.lte(); action++ )
 			action->key = 0;
 	}
@@ -670,9 +685,9 @@ void FsmAp::verifyStates()
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		/* Non final states should not have leaving data. */
 		if ( ! (state->stateBits & STB_ISFINAL) ) {
-			assert( state->outActionTable.length() == 0 );
-			assert( state->outCondSet.length() == 0 );
-			assert( state->outPriorTable.length() == 0 );
+			assert( state->ext().outActionTable.length() == 0 );
+			assert( state->ext().outCondSet.length() == 0 );
+			assert( state->ext().outPriorTable.length() == 0 );
 		}
 
 		/* Data used in algorithms should be cleared. */
@@ -765,43 +780,43 @@ int FsmAp::compareStateData( const StateAp *state1, const StateAp *state2 )
 {
 	/* Compare the out priority table. */
 	int cmpRes = CmpPriorTable::
-			compare( state1->outPriorTable, state2->outPriorTable );
+			compare( state1->ext().outPriorTable, state2->ext().outPriorTable );
 	if ( cmpRes != 0 )
 		return cmpRes;
 	
 	/* Test to state action tables. */
-	cmpRes = CmpActionTable::compare( state1->toStateActionTable, 
-			state2->toStateActionTable );
+	cmpRes = CmpActionTable::compare( state1->ext().toStateActionTable, 
+			state2->ext().toStateActionTable );
 	if ( cmpRes != 0 )
 		return cmpRes;
 
 	/* Test from state action tables. */
-	cmpRes = CmpActionTable::compare( state1->fromStateActionTable, 
-			state2->fromStateActionTable );
+	cmpRes = CmpActionTable::compare( state1->ext().fromStateActionTable, 
+			state2->ext().fromStateActionTable );
 	if ( cmpRes != 0 )
 		return cmpRes;
 
 	/* Test out action tables. */
-	cmpRes = CmpActionTable::compare( state1->outActionTable, 
-			state2->outActionTable );
+	cmpRes = CmpActionTable::compare( state1->ext().outActionTable, 
+			state2->ext().outActionTable );
 	if ( cmpRes != 0 )
 		return cmpRes;
 
 	/* Test out condition sets. */
-	cmpRes = CmpOutCondSet::compare( state1->outCondSet, 
-			state2->outCondSet );
+	cmpRes = CmpOutCondSet::compare( state1->ext().outCondSet, 
+			state2->ext().outCondSet );
 	if ( cmpRes != 0 )
 		return cmpRes;
 
 	/* Test out error action tables. */
-	cmpRes = CmpErrActionTable::compare( state1->errActionTable, 
-			state2->errActionTable );
+	cmpRes = CmpErrActionTable::compare( state1->ext().errActionTable, 
+			state2->ext().errActionTable );
 	if ( cmpRes != 0 )
 		return cmpRes;
 
 	/* Test eof action tables. */
-	return CmpActionTable::compare( state1->eofActionTable, 
-			state2->eofActionTable );
+	return CmpActionTable::compare( state1->ext().eofActionTable, 
+			state2->ext().eofActionTable );
 }
 
 
@@ -810,16 +825,18 @@ int FsmAp::compareStateData( const StateAp *state1, const StateAp *state2 )
 void FsmAp::clearOutData( StateAp *state )
 {
 	/* Kill the out actions and priorities. */
-	state->outActionTable.empty();
-	state->outCondSet.empty();
-	state->outPriorTable.empty();
+	if ( state->extData != 0 ) {
+		state->extData->outActionTable.empty();
+		state->extData->outCondSet.empty();
+		state->extData->outPriorTable.empty();
+	}
 }
 
 bool FsmAp::hasOutData( StateAp *state )
 {
-	return ( state->outActionTable.length() > 0 ||
-			state->outCondSet.length() > 0 ||
-			state->outPriorTable.length() > 0 );
+	return ( state->ext().outActionTable.length() > 0 ||
+			state->ext().outCondSet.length() > 0 ||
+			state->ext().outPriorTable.length() > 0 );
 }
 
 /* 
@@ -858,6 +875,53 @@ CondSpace *FsmAp::addCondSpace( const CondSet &condSet )
 	return condSpace;
 }
 
+/* For each condition in fromSet, find the bit it occupies in toSet. The
+ * conditions of fromSet must all be in toSet. */
+void condBitMap( LongVect &bits, const CondSet &fromSet, const CondSet &toSet )
+{
+	bits.empty();
+	for ( CondSet::Iter csi = fromSet; csi.lte(); csi++ ) {
+		Action **cim = toSet.find( *csi );
+		bits.append( cim - toSet.data );
+	}
+}
+
+CondSpaceMerge *FsmAp::mergeCondSpaces( CondSpace *fromCondSpace,
+		CondSpace *withCondSpace )
+{
+	CondSpacePair pair( fromCondSpace, withCondSpace );
+	CondSpaceMerge *merge = condData->condSpaceMergeMap.find( pair );
+	if ( merge == 0 ) {
+		CondSet mergedCS = fromCondSpace->condSet;
+		mergedCS.insert( withCondSpace->condSet );
+
+		merge = new CondSpaceMerge( pair );
+		merge->toCondSpace = addCondSpace( mergedCS );
+		condBitMap( merge->fromBits, fromCondSpace->condSet, mergedCS );
+
+		/* Find the items in the with set that are not in the from set. These
+		 * are the items that we must expand over. */
+		CondSet withOnlyCS = withCondSpace->condSet;
+		for ( CondSet::Iter fcsi = fromCondSpace->condSet; fcsi.lte(); fcsi++ )
+			withOnlyCS.remove( *fcsi );
+
+		LongVect withOnlyBits;
+		condBitMap( withOnlyBits, withOnlyCS, mergedCS );
+
+		for ( long woVals = 0; woVals < (1 << withOnlyBits.length()); woVals++ ) {
+			long targVals = 0;
+			for ( LongVect::Iter bit = withOnlyBits; bit.lte(); bit++ ) {
+				if ( woVals & (1 << bit.pos()) )
+					targVals |= 1 << *bit;
+			}
+			merge->newVals.append( targVals );
+		}
+
+		condData->condSpaceMergeMap.insert( merge );
+	}
+	return merge;
+}
+
 void FsmAp::startFsmCondition( Action *condAction, bool sense )
 {
 	/* Make sure the start state has no other entry points. */
@@ -874,5 +938,5 @@ void FsmAp::allTransCondition( Action *condAction, bool sense )
 void FsmAp::leaveFsmCondition( Action *condAction, bool sense )
 {
 	for ( StateSet::Iter state = finStateSet; state.lte(); state++ )
-		(*state)->outCondSet.insert( OutCond( condAction, sense ) );
+		(*state)->extMut().outCondSet.insert( OutCond( condAction, sense ) );
 }
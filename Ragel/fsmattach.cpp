@@ -26,9 +26,8 @@
 #include <iostream>
 using namespace std;
 
-/* Insert a transition into an inlist. The head must be supplied. */
-void FsmAp::attachToInList( StateAp *from, StateAp *to, 
-		TransAp *&head, TransAp *trans )
+/* Put a transition at the front of an inlist. */
+static inline void linkInList( TransAp *&head, TransAp *trans )
 {
 	trans->ilnext = head;
 	trans->ilprev = 0;
@@ -39,6 +38,14 @@ void FsmAp::attachToInList( StateAp *from, StateAp *to,
 
 	/* Now insert ourselves at the front of the list. */
 	head = trans;
+}
+
+/* Insert a transition into an inlist. The head must be supplied. */
+void FsmAp::attachToInList( StateAp *from, StateAp *to, 
+		TransAp *&head, TransAp *trans )
+{
+	if ( inListsValid )
+		linkInList( head, trans );
 
 	/* Keep track of foreign transitions for from and to. */
 	if ( from != to ) {
@@ -58,13 +65,15 @@ void FsmAp::detachFromInList( StateAp *from, StateAp *to,
 		TransAp *&head, TransAp *trans )
 {
 	/* Detach in the inTransList. */
-	if ( trans->ilprev == 0 ) 
-		head = trans->ilnext; 
-	else
-		trans->ilprev->ilnext = trans->ilnext; 
+	if ( inListsValid ) {
+		if ( trans->ilprev == 0 ) 
+			head = trans->ilnext; 
+		else
+			trans->ilprev->ilnext = trans->ilnext; 
 
-	if ( trans->ilnext != 0 )
-		trans->ilnext->ilprev = trans->ilprev; 
+		if ( trans->ilnext != 0 )
+			trans->ilnext->ilprev = trans->ilprev; 
+	}
 	
 	/* Keep track of foreign transitions for from and to. */
 	if ( from != to ) {
@@ -79,6 +88,39 @@ void FsmAp::detachFromInList( StateAp *from, StateAp *to,
 	}
 }
 
+/* Link every transition into the in list of its target, in one pass over the
+ * out lists. */
+void FsmAp::buildInLists()
+{
+	for ( StateList::Iter state = stateList; state.lte(); state++ )
+		state->inList.head = 0;
+	for ( StateList::Iter state = misfitList; state.lte(); state++ )
+		state->inList.head = 0;
+
+	inListsValid = true;
+
+	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
+		for ( TransList::Iter trans = state->outList; trans.lte(); trans++ ) {
+			if ( trans->toState != 0 )
+				linkInList( trans->toState->inList.head, trans );
+		}
+	}
+	for ( StateList::Iter state = misfitList; state.lte(); state++ ) {
+		for ( TransList::Iter trans = state->outList; trans.lte(); trans++ ) {
+			if ( trans->toState != 0 )
+				linkInList( trans->toState->inList.head, trans );
+		}
+	}
+}
+
+/* Stop maintaining the in lists until someone needs them again. Only has an
+ * effect when in lists are built lazily. */
+void FsmAp::dropInLists()
+{
+	if ( lazyInLists )
+		inListsValid = false;
+}
+
 /* Attach states on the default transition, range list or on out/in list key.
  * First makes a new transition. If there is already a transition out from
  * fromState on the default, then will assertion fail. */
@@ -153,8 +195,14 @@ void FsmAp::detachTrans( StateAp *from, StateAp *to, TransAp *trans )
  * state set. A detached state becomes useless and should be deleted. */
 void FsmAp::detachState( StateAp *state )
 {
+	/* A state with no foreign in transitions can only be entered from itself.
+	 * Those transitions go with the out list below, so the in list is not
+	 * needed. */
+	if ( state->foreignInTrans > 0 )
+		needInLists();
+
 	/* Detach the in transitions from the inList list of transitions. */
-	while ( state->inList.head != 0 ) {
+	while ( inListsValid && state->inList.head != 0 ) {
 		/* Get pointers to the trans and the state. */
 		TransAp *trans = state->inList.head;
 		StateAp *fromState = trans->fromState;
@@ -168,8 +216,8 @@ void FsmAp::detachState( StateAp *state )
 	}
 
 	/* Remove the entry points in on the machine. */
-	while ( state->entryIds.length() > 0 )
-		unsetEntry( state->entryIds[0], state );
+	while ( state->ext().entryIds.length() > 0 )
+		unsetEntry( state->ext().entryIds[0], state );
 
 	/* Detach out range transitions. */
 	for ( TransList::Iter trans = state->outList; trans.lte(); ) {
@@ -401,6 +449,8 @@ void FsmAp::inTransMove( StateAp *dest, StateAp *src )
 	/* Do not try to move in trans to and from the same state. */
 	assert( dest != src );
 
+	needInLists();
+
 	/* If src is the start state, dest becomes the start state. */
 	if ( src == startState ) {
 		unsetStartState();
@@ -409,7 +459,7 @@ void FsmAp::inTransMove( StateAp *dest, StateAp *src )
 
 	/* For each entry point into, create an entry point into dest, when the
 	 * state is detached, the entry points to src will be removed. */
-	for ( EntryIdSet::Iter enId = src->entryIds; enId.lte(); enId++ )
+	for ( EntryIdSet::Iter enId = src->ext().entryIds; enId.lte(); enId++ )
 		changeEntry( *enId, dest, src );
 
 	/* Move the transitions in inList. */
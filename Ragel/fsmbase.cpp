@@ -51,7 +51,9 @@ FsmAp::FsmAp()
 	/* Misfit accounting is a switch, turned on only at specific times. It
 	 * controls what happens when states have no way in from the outside
 	 * world.. */
-	misfitAccounting(false)
+	misfitAccounting(false),
+
+	inListsValid(!lazyInLists)
 {
 }
 
@@ -72,7 +74,10 @@ FsmAp::FsmAp( const FsmAp &graph )
 	finStateSet(),
 	
 	/* Misfit accounting is only on during merging. */
-	misfitAccounting(false)
+	misfitAccounting(false),
+
+	/* Will be filled by copy, if they are being kept. */
+	inListsValid(!lazyInLists)
 {
 	/* Create the states and record their map in the original state. */
 	StateList::Iter origState = graph.stateList;
@@ -100,8 +105,8 @@ FsmAp::FsmAp( const FsmAp &graph )
 		}
 
 		/* Fix the eofTarg, if set. */
-		if ( state->eofTarget != 0 )
-			state->eofTarget = state->eofTarget->alg.stateMap;
+		if ( state->ext().eofTarget != 0 )
+			state->extMut().eofTarget = state->ext().eofTarget->alg.stateMap;
 	}
 
 	/* Fix the state pointers in the entry points array. */
@@ -209,7 +214,7 @@ void FsmAp::setEntry( int id, StateAp *state )
 {
 	/* Insert the id into the state. If the state is already labelled with id,
 	 * nothing to do. */
-	if ( state->entryIds.insert( id ) ) {
+	if ( state->extMut().entryIds.insert( id ) ) {
 		/* Insert the entry and assert that it succeeds. */
 		entryPoints.insertMulti( id, state );
 
@@ -239,7 +244,7 @@ void FsmAp::unsetEntry( int id, StateAp *state )
 	entryPoints.remove( enLow );
 
 	/* Remove the state's sense of the link. */
-	state->entryIds.remove( id );
+	state->extMut().entryIds.remove( id );
 	state->foreignInTrans -= 1;
 	if ( misfitAccounting ) {
 		/* If the number of foreign in transitions just went down to 0 then take
@@ -258,7 +263,7 @@ void FsmAp::unsetEntry( int id )
 	entryPoints.findMulti( id, enLow, enHigh );
 	for ( EntryMapEl *mel = enLow; mel <= enHigh; mel++ ) {
 		/* Remove the state's sense of the link. */
-		mel->value->entryIds.remove( id );
+		mel->value->extMut().entryIds.remove( id );
 		mel->value->foreignInTrans -= 1;
 		if ( misfitAccounting ) {
 			/* If the number of foreign in transitions just went down to 0
@@ -285,7 +290,7 @@ void FsmAp::changeEntry( int id, StateAp *to, StateAp *from )
 	enLow->value = to;
 
 	/* Remove from's sense of the link. */
-	from->entryIds.remove( id );
+	from->extMut().entryIds.remove( id );
 	from->foreignInTrans -= 1;
 	if ( misfitAccounting ) {
 		/* If the number of foreign in transitions just went down to 0 then take
@@ -295,7 +300,7 @@ void FsmAp::changeEntry( int id, StateAp *to, StateAp *from )
 	}
 
 	/* Add to's sense of the link. */
-	if ( to->entryIds.insert( id ) != 0 ) {
+	if ( to->extMut().entryIds.insert( id ) != 0 ) {
 		if ( misfitAccounting ) {
 			/* If the number of foreign in transitions is about to go up to 1 then
 			 * take it off the misfit list and put it on the head list. */
@@ -314,8 +319,8 @@ void FsmAp::unsetAllEntryPoints()
 {
 	for ( EntryMap::Iter en = entryPoints; en.lte(); en++ ) {
 		/* Kill all the state's entry points at once. */
-		if ( en->value->entryIds.length() > 0 ) {
-			en->value->foreignInTrans -= en->value->entryIds.length();
+		if ( en->value->ext().entryIds.length() > 0 ) {
+			en->value->foreignInTrans -= en->value->ext().entryIds.length();
 
 			if ( misfitAccounting ) {
 				/* If the number of foreign in transitions just went down to 0
@@ -326,7 +331,7 @@ void FsmAp::unsetAllEntryPoints()
 			}
 
 			/* Clear the set of ids out all at once. */
-			en->value->entryIds.empty();
+			en->value->extMut().entryIds.empty();
 		}
 	}
 
@@ -338,7 +343,7 @@ void FsmAp::unsetAllEntryPoints()
 void FsmAp::epsilonTrans( int id )
 {
 	for ( StateSet::Iter fs = finStateSet; fs.lte(); fs++ )
-		(*fs)->epsilonTrans.append( id );
+		(*fs)->extMut().epsilonTrans.append( id );
 }
 
 /* Mark all states reachable from state. Traverses transitions forward. Used
@@ -401,11 +406,24 @@ void FsmAp::markReachableFromHereReverse( StateAp *state )
 bool FsmAp::isStartStateIsolated()
 {
 	/* If there are any in transitions then the state is not isolated. */
-	if ( startState->inList.head != 0 )
-		return false;
+	if ( inListsValid ) {
+		if ( startState->inList.head != 0 )
+			return false;
+	}
+	else {
+		/* The start state's own count includes its being the start state.
+		 * Anything more is an in transition or an entry point. Beyond that it
+		 * can only be entered from itself. */
+		if ( startState->foreignInTrans > 1 )
+			return false;
+		for ( TransList::Iter trans = startState->outList; trans.lte(); trans++ ) {
+			if ( trans->toState == startState )
+				return false;
+		}
+	}
 
 	/* If there are any entry points then isolated. */
-	if ( startState->entryIds.length() > 0 )
+	if ( startState->ext().entryIds.length() > 0 )
 		return false;
 
 	return true;
@@ -438,6 +456,8 @@ void FsmAp::setFinBits( int finStateBits )
 /* Tests the integrity of the transition lists and the fromStates. */
 void FsmAp::verifyIntegrity()
 {
+	needInLists();
+
 	for ( StateList::Iter state = stateList; state.lte(); state++ ) {
 		/* Walk the out transitions and assert fromState is correct. */
 		for ( TransList::Iter trans = state->outList; trans.lte(); trans++ )
@@ -467,6 +487,8 @@ void FsmAp::verifyReachability()
 
 void FsmAp::verifyNoDeadEndStates()
 {
+	needInLists();
+
 	/* Mark all states that have paths to the final states. */
 	for ( StateSet::Iter pst = finStateSet; pst.lte(); pst++ )
 		markReachableFromHereReverse( *pst );
@@ -187,10 +187,10 @@ void FsmAp::transferOutData( StateAp *destState, StateAp *srcState )
 	for ( TransList::Iter trans = destState->outList; trans.lte(); trans++ ) {
 		if ( trans->toState != 0 ) {
 			/* Get the actions data from the outActionTable. */
-			trans->actionTable.setActions( srcState->outActionTable );
+			trans->actionTable.setActions( srcState->ext().outActionTable );
 
 			/* Get the priorities from the outPriorTable. */
-			trans->priorTable.setPriors( srcState->outPriorTable );
+			trans->priorTable.setPriors( srcState->ext().outPriorTable );
 		}
 	}
 }
@@ -514,7 +514,7 @@ bool FsmAp::inEptVect( EptVect *eptVect, StateAp *state )
 void FsmAp::epsilonFillEptVectFrom( StateAp *root, StateAp *from, bool parentLeaving )
 {
 	/* Walk the epsilon transitions out of the state. */
-	for ( EpsilonTrans::Iter ep = from->epsilonTrans; ep.lte(); ep++ ) {
+	for ( EpsilonTrans::Iter ep = from->ext().epsilonTrans; ep.lte(); ep++ ) {
 		/* Find the entry point, if the it does not resove, ignore it. */
 		EntryMapEl *enLow, *enHigh;
 		if ( entryPoints.findMulti( *ep, enLow, enHigh ) ) {
@@ -522,10 +522,10 @@ void FsmAp::epsilonFillEptVectFrom( StateAp *root, StateAp *from, bool parentLea
 			for ( EntryMapEl *en = enLow; en <= enHigh; en++ ) {
 				/* Do not add the root or states already in eptVect. */
 				StateAp *targ = en->value;
-				if ( targ != from && !inEptVect(root->eptVect, targ) ) {
+				if ( targ != from && !inEptVect(root->ext().eptVect, targ) ) {
 					/* Maybe need to create the eptVect. */
-					if ( root->eptVect == 0 )
-						root->eptVect = new EptVect();
+					if ( root->ext().eptVect == 0 )
+						root->extMut().eptVect = new EptVect();
 
 					/* If moving to a different graph or if any parent is
 					 * leaving then we are leaving. */
@@ -533,7 +533,7 @@ void FsmAp::epsilonFillEptVectFrom( StateAp *root, StateAp *from, bool parentLea
 							root->owningGraph != targ->owningGraph;
 
 					/* All ok, add the target epsilon and recurse. */
-					root->eptVect->append( EptVectEl(targ, leaving) );
+					root->extData->eptVect->append( EptVectEl(targ, leaving) );
 					epsilonFillEptVectFrom( root, targ, leaving );
 				}
 			}
@@ -544,8 +544,10 @@ void FsmAp::epsilonFillEptVectFrom( StateAp *root, StateAp *from, bool parentLea
 void FsmAp::shadowReadWriteStates( MergeData &md )
 {
 	/* Init isolatedShadow algorithm data. */
-	for ( StateList::Iter st = stateList; st.lte(); st++ )
-		st->isolatedShadow = 0;
+	for ( StateList::Iter st = stateList; st.lte(); st++ ) {
+		if ( st->extData != 0 )
+			st->extData->isolatedShadow = 0;
+	}
 
 	/* Any states that may be both read from and written to must 
 	 * be shadowed. */
@@ -553,23 +555,23 @@ void FsmAp::shadowReadWriteStates( MergeData &md )
 		/* Find such states by looping through stateVect lists, which give us
 		 * the states that will be read from. May cause us to visit the states
 		 * that we are interested in more than once. */
-		if ( st->eptVect != 0 ) {
+		if ( st->ext().eptVect != 0 ) {
 			/* For all states that will be read from. */
-			for ( EptVect::Iter ept = *st->eptVect; ept.lte(); ept++ ) {
+			for ( EptVect::Iter ept = *st->ext().eptVect; ept.lte(); ept++ ) {
 				/* Check for read and write to the same state. */
 				StateAp *targ = ept->targ;
-				if ( targ->eptVect != 0 ) {
+				if ( targ->ext().eptVect != 0 ) {
 					/* State is to be written to, if the shadow is not already
 					 * there, create it. */
-					if ( targ->isolatedShadow == 0 ) {
+					if ( targ->ext().isolatedShadow == 0 ) {
 						StateAp *shadow = addState();
 						mergeStates( md, shadow, targ );
-						targ->isolatedShadow = shadow;
+						targ->extMut().isolatedShadow = shadow;
 					}
 
 					/* Write shadow into the state vector so that it is the
 					 * state that the epsilon transition will read from. */
-					ept->targ = targ->isolatedShadow;
+					ept->targ = targ->ext().isolatedShadow;
 				}
 			}
 		}
@@ -589,9 +591,9 @@ void FsmAp::resolveEpsilonTrans( MergeData &md )
 	 * clear the epsilon transitions. */
 	for ( StateList::Iter st = stateList; st.lte(); st++ ) {
 		/* If there is a state vector, then create the pre-merge state. */
-		if ( st->eptVect != 0 ) {
+		if ( st->ext().eptVect != 0 ) {
 			/* Merge all the epsilon targets into the state. */
-			for ( EptVect::Iter ept = *st->eptVect; ept.lte(); ept++ ) {
+			for ( EptVect::Iter ept = *st->ext().eptVect; ept.lte(); ept++ ) {
 				if ( ept->leaving )
 					mergeStatesLeaving( md, st, ept->targ );
 				else
@@ -599,12 +601,13 @@ void FsmAp::resolveEpsilonTrans( MergeData &md )
 			}
 
 			/* Clean up the target list. */
-			delete st->eptVect;
-			st->eptVect = 0;
+			delete st->extData->eptVect;
+			st->extData->eptVect = 0;
 		}
 
 		/* Clear the epsilon transitions vector. */
-		st->epsilonTrans.empty();
+		if ( st->extData != 0 )
+			st->extData->epsilonTrans.empty();
 	}
 }
 
@@ -929,7 +932,7 @@ void FsmAp::findTransExpansions( ExpansionList &expansionList,
 		StateAp *destState, StateAp *srcState )
 {
 	PairIter<TransAp, StateCond> transCond( destState->outList.head,
-			srcState->stateCondList.head );
+			srcState->ext().stateCondList.head );
 	for ( ; !transCond.end(); transCond++ ) {
 		if ( transCond.userState == RangeOverlap ) {
 			Expansion *expansion = new Expansion( transCond.s1Tel.lowKey, 
@@ -956,34 +959,57 @@ void FsmAp::findTransExpansions( ExpansionList &expansionList,
 
 void FsmAp::findCondExpInTrans( ExpansionList &expansionList, StateAp *state, 
 		Key lowKey, Key highKey, CondSpace *fromCondSpace, CondSpace *toCondSpace,
-		long fromVals, LongVect &toValsList )
+		const LongVect &fromBits, const LongVect &newVals )
 {
-	/* Make condition-space low and high keys for searching. */
-	TransAp searchTrans;
-	searchTrans.lowKey = fromCondSpace->baseKey + fromVals * keyOps->alphSize() + 
-			(lowKey - keyOps->minKey);
-	searchTrans.highKey = fromCondSpace->baseKey + fromVals * keyOps->alphSize() + 
-			(highKey - keyOps->minKey);
-	searchTrans.prev = searchTrans.next = 0;
-
-	PairIter<TransAp> pairIter( state->outList.head, &searchTrans );
-	for ( ; !pairIter.end(); pairIter++ ) {
-		if ( pairIter.userState == RangeOverlap ) {
+	/* Only the combinations of condition values that the state has
+	 * transitions on need expanding. Walk the part of the out list that lies
+	 * in the from space once and work out which combination each transition
+	 * belongs to, rather than searching the list for every combination. */
+	long numFromVals = 1 << fromCondSpace->condSet.length();
+	Key spaceLow = fromCondSpace->baseKey;
+	Key spaceHigh = fromCondSpace->baseKey + numFromVals * keyOps->alphSize() - 1;
+
+	for ( TransList::Iter trans = state->outList; trans.lte(); trans++ ) {
+		if ( trans->highKey < spaceLow )
+			continue;
+		if ( trans->lowKey > spaceHigh )
+			break;
+
+		long firstVals = trans->lowKey < spaceLow ? 0 : (long)( 
+				(Size)(unsigned long)(trans->lowKey - spaceLow).getVal() / keyOps->alphSize() );
+		long lastVals = trans->highKey > spaceHigh ? numFromVals - 1 : (long)( 
+				(Size)(unsigned long)(trans->highKey - spaceLow).getVal() / keyOps->alphSize() );
+
+		for ( long fromVals = firstVals; fromVals <= lastVals; fromVals++ ) {
+			/* Condition-space low and high keys of the range. */
+			Key valsBase = spaceLow + fromVals * keyOps->alphSize();
+			Key rangeLow = valsBase + (lowKey - keyOps->minKey);
+			Key rangeHigh = valsBase + (highKey - keyOps->minKey);
+
+			Key overlapLow = trans->lowKey < rangeLow ? rangeLow : trans->lowKey;
+			Key overlapHigh = trans->highKey > rangeHigh ? rangeHigh : trans->highKey;
+			if ( overlapLow > overlapHigh )
+				continue;
+
 			/* Need to make character-space low and high keys from the range
 			 * overlap for the expansion object. */
-			Key expLowKey = pairIter.s1Tel.lowKey - fromCondSpace->baseKey - fromVals *
-					keyOps->alphSize() + keyOps->minKey;
-			Key expHighKey = pairIter.s1Tel.highKey - fromCondSpace->baseKey - fromVals *
-					keyOps->alphSize() + keyOps->minKey;
-
-			Expansion *expansion = new Expansion( expLowKey, expHighKey );
-			expansion->fromTrans = new TransAp(*pairIter.s1Tel.trans);
+			Expansion *expansion = new Expansion( 
+					overlapLow - valsBase + keyOps->minKey,
+					overlapHigh - valsBase + keyOps->minKey );
+			expansion->fromTrans = new TransAp(*trans);
 			expansion->fromTrans->fromState = 0;
-			expansion->fromTrans->toState = pairIter.s1Tel.trans->toState;
+			expansion->fromTrans->toState = trans->toState;
 			expansion->fromCondSpace = fromCondSpace;
 			expansion->fromVals = fromVals;
 			expansion->toCondSpace = toCondSpace;
-			expansion->toValsList = toValsList;
+
+			long basicVals = 0;
+			for ( LongVect::Iter bit = fromBits; bit.lte(); bit++ ) {
+				if ( fromVals & (1 << bit.pos()) )
+					basicVals |= 1 << *bit;
+			}
+			for ( LongVect::Iter nv = newVals; nv.lte(); nv++ )
+				expansion->toValsList.append( basicVals | *nv );
 
 			expansionList.append( expansion );
 			#ifdef LOG_CONDS
@@ -996,97 +1022,126 @@ void FsmAp::findCondExpInTrans( ExpansionList &expansionList, StateAp *state,
 void FsmAp::findCondExpansions( ExpansionList &expansionList, 
 		StateAp *destState, StateAp *srcState )
 {
-	PairIter<StateCond, StateCond> condCond( destState->stateCondList.head,
-			srcState->stateCondList.head );
+	PairIter<StateCond, StateCond> condCond( destState->ext().stateCondList.head,
+			srcState->ext().stateCondList.head );
 	for ( ; !condCond.end(); condCond++ ) {
 		if ( condCond.userState == RangeOverlap ) {
-			/* Loop over all existing condVals . */
-			CondSet &destCS = condCond.s1Tel.trans->condSpace->condSet;
-			long destLen = destCS.length();
-
-			/* Find the items in src cond set that are not in dest
-			 * cond set. These are the items that we must expand. */
-			CondSet srcOnlyCS = condCond.s2Tel.trans->condSpace->condSet;
-			for ( CondSet::Iter dcsi = destCS; dcsi.lte(); dcsi++ )
-				srcOnlyCS.remove( *dcsi );
-			long srcOnlyLen = srcOnlyCS.length();
-
-			if ( srcOnlyCS.length() > 0 ) {
+			CondSpace *fromCondSpace = condCond.s1Tel.trans->condSpace;
+			CondSpaceMerge *merge = mergeCondSpaces( fromCondSpace,
+					condCond.s2Tel.trans->condSpace );
+
+			/* If there are items in the src cond set that are not in the
+			 * dest cond set then the dest transitions must be expanded over
+			 * them. */
+			if ( merge->newVals.length() > 1 ) {
 				#ifdef LOG_CONDS
-				err() << L"there are " << srcOnlyCS.length() << L" item(s) that are "
-							L"only in the srcCS" << endl;
+				err() << L"there are " << merge->newVals.length() << L" combination(s) "
+							L"of items that are only in the srcCS" << endl;
 				#endif
 
-				CondSet mergedCS = destCS;
-				mergedCS.insert( condCond.s2Tel.trans->condSpace->condSet );
-
-				CondSpace *fromCondSpace = addCondSpace( destCS );
-				CondSpace *toCondSpace = addCondSpace( mergedCS );
-
-				/* Loop all values in the dest space. */
-				for ( long destVals = 0; destVals < (1 << destLen); destVals++ ) {
-					long basicVals = 0;
-					for ( CondSet::Iter csi = destCS; csi.lte(); csi++ ) {
-						if ( destVals & (1 << csi.pos()) ) {
-							Action **cim = mergedCS.find( *csi );
-							long bitPos = (cim - mergedCS.data);
-							basicVals |= 1 << bitPos;
-						}
-					}
-
-					/* Loop all new values. */
-					LongVect expandToVals;
-					for ( long soVals = 0; soVals < (1 << srcOnlyLen); soVals++ ) {
-						long targVals = basicVals;
-						for ( CondSet::Iter csi = srcOnlyCS; csi.lte(); csi++ ) {
-							if ( soVals & (1 << csi.pos()) ) {
-								Action **cim = mergedCS.find( *csi );
-								long bitPos = (cim - mergedCS.data);
-								targVals |= 1 << bitPos;
-							}
-						}
-						expandToVals.append( targVals );
-					}
-
-					findCondExpInTrans( expansionList, destState, 
-							condCond.s1Tel.lowKey, condCond.s1Tel.highKey, 
-							fromCondSpace, toCondSpace, destVals, expandToVals );
-				}
+				findCondExpInTrans( expansionList, destState, 
+						condCond.s1Tel.lowKey, condCond.s1Tel.highKey, 
+						fromCondSpace, merge->toCondSpace, merge->fromBits,
+						merge->newVals );
 			}
 		}
 	}
 }
 
+/* Orders transitions by their low key. */
+struct CmpTransLowKey
+{
+	static int compare( TransAp *trans1, TransAp *trans2 )
+	{
+		if ( trans1->lowKey < trans2->lowKey )
+			return -1;
+		else if ( trans1->lowKey > trans2->lowKey )
+			return 1;
+		return 0;
+	}
+};
+
+/* Orders removals by their low key. */
+struct CmpRemovalLowKey
+{
+	static int compare( const Removal &removal1, const Removal &removal2 )
+	{
+		if ( removal1.lowKey < removal2.lowKey )
+			return -1;
+		else if ( removal1.lowKey > removal2.lowKey )
+			return 1;
+		return 0;
+	}
+};
+
 void FsmAp::doExpand( MergeData &md, StateAp *destState, ExpansionList &expList1 )
 {
+	/* Make a copy of the expanded transition for every combination it goes
+	 * to. Each gets the keys of its combination, everything else comes from
+	 * the copy that was made when the expansion was created. */
+	Vector<TransAp*> expanded;
 	for ( ExpansionList::Iter exp = expList1; exp.lte(); exp++ ) {
 		for ( LongVect::Iter to = exp->toValsList; to.lte(); to++ ) {
 			long targVals = *to;
 
-			/* We will use the copy of the transition that was made when the
-			 * expansion was created. It will get used multiple times. Each
-			 * time we must set up the keys, everything else is constant and
-			 * and already prepared. */
-			TransAp *srcTrans = exp->fromTrans;
-
+			TransAp *srcTrans = new TransAp( *exp->fromTrans );
+			srcTrans->toState = exp->fromTrans->toState;
 			srcTrans->lowKey = exp->toCondSpace->baseKey +
 					targVals * keyOps->alphSize() + (exp->lowKey - keyOps->minKey);
 			srcTrans->highKey = exp->toCondSpace->baseKey +
 					targVals * keyOps->alphSize() + (exp->highKey - keyOps->minKey);
+			expanded.append( srcTrans );
+		}
+	}
 
-			TransList srcList;
-			srcList.append( srcTrans );
+	if ( expanded.length() == 0 )
+		return;
+
+	condData->expandedTrans += expanded.length();
+
+	MergeSort<TransAp*, CmpTransLowKey> mergeSort;
+	mergeSort.sort( expanded.data, expanded.length() );
+
+	/* Expansions come from distinct ranges of the state and so land on
+	 * distinct keys. When they do, copy them all in with a single pass over
+	 * the out list instead of one pass each. */
+	bool disjoint = true;
+	for ( int i = 1; i < expanded.length(); i++ ) {
+		if ( expanded[i]->lowKey <= expanded[i-1]->highKey )
+			disjoint = false;
+	}
+
+	TransList srcList;
+	if ( disjoint ) {
+		for ( int i = 0; i < expanded.length(); i++ )
+			srcList.append( expanded[i] );
+		outTransCopy( md, destState, srcList.head );
+	}
+	else {
+		for ( int i = 0; i < expanded.length(); i++ ) {
+			srcList.append( expanded[i] );
 			outTransCopy( md, destState, srcList.head );
-			srcList.abandon();
+			srcList.detach( expanded[i] );
+			delete expanded[i];
 		}
 	}
+
+	/* The copies were only read from. */
+	srcList.empty();
 }
 
 
 void FsmAp::doRemove( MergeData &md, StateAp *destState, ExpansionList &expList1 )
 {
+	if ( expList1.length() == 0 )
+		return;
+
+	/* Gather the ranges the expansions moved out of and remove them all in
+	 * one pass over the out list. */
+	Removal *removals = new Removal[expList1.length()];
+	int numRemovals = 0;
 	for ( ExpansionList::Iter exp = expList1; exp.lte(); exp++ ) {
-		Removal removal;
+		Removal &removal = removals[numRemovals++];
 		if ( exp->fromCondSpace == 0 ) {
 			removal.lowKey = exp->lowKey;
 			removal.highKey = exp->highKey;
@@ -1097,45 +1152,64 @@ void FsmAp::doRemove( MergeData &md, StateAp *destState, ExpansionList &expList1
 			removal.highKey = exp->fromCondSpace->baseKey + 
 				exp->fromVals * keyOps->alphSize() + (exp->highKey - keyOps->minKey);
 		}
-		removal.next = 0;
+	}
 
-		TransList destList;
-		PairIter<TransAp, Removal> pairIter( destState->outList.head, &removal );
-		for ( ; !pairIter.end(); pairIter++ ) {
-			switch ( pairIter.userState ) {
-			case RangeInS1: {
-				TransAp *destTrans = pairIter.s1Tel.trans;
-				destTrans->lowKey = pairIter.s1Tel.lowKey;
-				destTrans->highKey = pairIter.s1Tel.highKey;
-				destList.append( destTrans );
-				break;
-			}
-			case RangeInS2:
-				break;
-			case RangeOverlap: {
-				TransAp *trans = pairIter.s1Tel.trans;
-				detachTrans( trans->fromState, trans->toState, trans );
-				delete trans;
-				break;
-			}
-			case BreakS1: {
-				pairIter.s1Tel.trans = dupTrans( destState, 
-						pairIter.s1Tel.trans );
-				break;
-			}
-			case BreakS2:
-				break;
-			}
+	MergeSort<Removal, CmpRemovalLowKey> mergeSort;
+	mergeSort.sort( removals, numRemovals );
+
+	/* Join any ranges that overlap, then link them up. */
+	int last = 0;
+	for ( int r = 1; r < numRemovals; r++ ) {
+		if ( removals[r].lowKey <= removals[last].highKey ) {
+			if ( removals[r].highKey > removals[last].highKey )
+				removals[last].highKey = removals[r].highKey;
+		}
+		else {
+			removals[++last] = removals[r];
 		}
-		destState->outList.transfer( destList );
 	}
+	numRemovals = last + 1;
+	for ( int r = 0; r < numRemovals; r++ )
+		removals[r].next = r+1 < numRemovals ? &removals[r+1] : 0;
+
+	TransList destList;
+	PairIter<TransAp, Removal> pairIter( destState->outList.head, removals );
+	for ( ; !pairIter.end(); pairIter++ ) {
+		switch ( pairIter.userState ) {
+		case RangeInS1: {
+			TransAp *destTrans = pairIter.s1Tel.trans;
+			destTrans->lowKey = pairIter.s1Tel.lowKey;
+			destTrans->highKey = pairIter.s1Tel.highKey;
+			destList.append( destTrans );
+			break;
+		}
+		case RangeInS2:
+			break;
+		case RangeOverlap: {
+			TransAp *trans = pairIter.s1Tel.trans;
+			detachTrans( trans->fromState, trans->toState, trans );
+			delete trans;
+			break;
+		}
+		case BreakS1: {
+			pairIter.s1Tel.trans = dupTrans( destState, 
+					pairIter.s1Tel.trans );
+			break;
+		}
+		case BreakS2:
+			break;
+		}
+	}
+	destState->outList.transfer( destList );
+
+	delete[] removals;
 }
 
 void FsmAp::mergeStateConds( StateAp *destState, StateAp *srcState )
 {
 	StateCondList destList;
-	PairIter<StateCond> pairIter( destState->stateCondList.head,
-			srcState->stateCondList.head );
+	PairIter<StateCond> pairIter( destState->ext().stateCondList.head,
+			srcState->ext().stateCondList.head );
 	for ( ; !pairIter.end(); pairIter++ ) {
 		switch ( pairIter.userState ) {
 		case RangeInS1: {
@@ -1155,10 +1229,8 @@ void FsmAp::mergeStateConds( StateAp *destState, StateAp *srcState )
 		case RangeOverlap: {
 			StateCond *destCond = pairIter.s1Tel.trans;
 			StateCond *srcCond = pairIter.s2Tel.trans;
-			CondSet mergedCondSet;
-			mergedCondSet.insert( destCond->condSpace->condSet );
-			mergedCondSet.insert( srcCond->condSpace->condSet );
-			destCond->condSpace = addCondSpace( mergedCondSet );
+			destCond->condSpace = mergeCondSpaces( destCond->condSpace,
+					srcCond->condSpace )->toCondSpace;
 
 			destCond->lowKey = pairIter.s1Tel.lowKey;
 			destCond->highKey = pairIter.s1Tel.highKey;
@@ -1173,7 +1245,8 @@ void FsmAp::mergeStateConds( StateAp *destState, StateAp *srcState )
 			break;
 		}
 	}
-	destState->stateCondList.transfer( destList );
+	if ( destList.length() > 0 || destState->extData != 0 )
+		destState->extMut().stateCondList.transfer( destList );
 }
 
 /* A state merge which represents the drawing in of leaving transitions.  If
@@ -1189,7 +1262,7 @@ void FsmAp::mergeStatesLeaving( MergeData &md, StateAp *destState, StateAp *srcS
 		mergeStates( md, ssMutable, srcState );
 		transferOutData( ssMutable, destState );
 
-		for ( OutCondSet::Iter cond = destState->outCondSet; cond.lte(); cond++ )
+		for ( OutCondSet::Iter cond = destState->ext().outCondSet; cond.lte(); cond++ )
 			embedCondition( md, ssMutable, cond->action, cond->sense );
 
 		mergeStates( md, destState, ssMutable );
@@ -1231,40 +1304,48 @@ void FsmAp::mergeStates( MergeData &md, StateAp *destState, StateAp *srcState )
 	if ( srcState->isFinState() )
 		setFinState( destState );
 
-	/* Draw in any properties of srcState into destState. */
+	/* Draw in any properties of srcState into destState. A source without
+	 * extended data has none to give. */
+	if ( srcState->extData == 0 )
+		return;
+
+	StateExt &dest = destState->extMut();
+	const StateExt &src = *srcState->extData;
 	if ( srcState == destState ) {
 		/* Duplicate the list to protect against write to source. The
 		 * priorities sets are not copied in because that would have no
 		 * effect. */
-		destState->epsilonTrans.append( EpsilonTrans( srcState->epsilonTrans ) );
+		dest.epsilonTrans.append( EpsilonTrans( src.epsilonTrans ) );
 
 		/* Get all actions, duplicating to protect against write to source. */
-		destState->toStateActionTable.setActions( 
-				ActionTable( srcState->toStateActionTable ) );
-		destState->fromStateActionTable.setActions( 
-				ActionTable( srcState->fromStateActionTable ) );
-		destState->outActionTable.setActions( ActionTable( srcState->outActionTable ) );
-		destState->outCondSet.insert( OutCondSet( srcState->outCondSet ) );
-		destState->errActionTable.setActions( ErrActionTable( srcState->errActionTable ) );
-		destState->eofActionTable.setActions( ActionTable( srcState->eofActionTable ) );
+		dest.toStateActionTable.setActions( ActionTable( src.toStateActionTable ) );
+		dest.fromStateActionTable.setActions( ActionTable( src.fromStateActionTable ) );
+		dest.outActionTable.setActions( ActionTable( src.outActionTable ) );
+		dest.outCondSet.insert( OutCondSet( src.outCondSet ) );
+		dest.errActionTable.setActions( ErrActionTable( src.errActionTable ) );
+		dest.eofActionTable.setActions( ActionTable( src.eofActionTable ) );
 	}
 	else {
 		/* Get the epsilons, out priorities. */
-		destState->epsilonTrans.append( srcState->epsilonTrans );
-		destState->outPriorTable.setPriors( srcState->outPriorTable );
+		dest.epsilonTrans.append( src.epsilonTrans );
+		dest.outPriorTable.setPriors( src.outPriorTable );
 
 		/* Get all actions. */
-		destState->toStateActionTable.setActions( srcState->toStateActionTable );
-		destState->fromStateActionTable.setActions( srcState->fromStateActionTable );
-		destState->outActionTable.setActions( srcState->outActionTable );
-		destState->outCondSet.insert( srcState->outCondSet );
-		destState->errActionTable.setActions( srcState->errActionTable );
-		destState->eofActionTable.setActions( srcState->eofActionTable );
+		dest.toStateActionTable.setActions( src.toStateActionTable );
+		dest.fromStateActionTable.setActions( src.fromStateActionTable );
+		dest.outActionTable.setActions( src.outActionTable );
+		dest.outCondSet.insert( src.outCondSet );
+		dest.errActionTable.setActions( src.errActionTable );
+		dest.eofActionTable.setActions( src.eofActionTable );
 	}
 }
 
 void FsmAp::fillInStates( MergeData &md )
 {
+	/* Filling in states rewrites most of the graph and never looks at in
+	 * lists. */
+	dropInLists();
+
 	/* Merge any states that are awaiting merging. This will likey cause
 	 * other states to be added to the stfil list. */
 	StateAp *state = md.stfillHead;
@@ -1294,7 +1375,7 @@ void FsmAp::findEmbedExpansions( ExpansionList &expansionList,
 {
 	StateCondList destList;
 	PairIter<TransAp, StateCond> transCond( destState->outList.head,
-			destState->stateCondList.head );
+			destState->ext().stateCondList.head );
 	for ( ; !transCond.end(); transCond++ ) {
 		switch ( transCond.userState ) {
 			case RangeInS1: {
@@ -1330,37 +1411,24 @@ void FsmAp::findEmbedExpansions( ExpansionList &expansionList,
 				stateCond->lowKey = transCond.s2Tel.lowKey;
 				stateCond->highKey = transCond.s2Tel.highKey;
 
-				CondSet &destCS = stateCond->condSpace->condSet;
-				long destLen = destCS.length();
 				CondSpace *fromCondSpace = stateCond->condSpace;
 
-				CondSet mergedCS = destCS;
+				CondSet mergedCS = fromCondSpace->condSet;
 				mergedCS.insert( condAction );
 				CondSpace *toCondSpace = addCondSpace( mergedCS );
 				stateCond->condSpace = toCondSpace;
 				destList.append( stateCond );
 
-				/* Loop all values in the dest space. */
-				for ( long destVals = 0; destVals < (1 << destLen); destVals++ ) {
-					long basicVals = 0;
-					for ( CondSet::Iter csi = destCS; csi.lte(); csi++ ) {
-						if ( destVals & (1 << csi.pos()) ) {
-							Action **cim = mergedCS.find( *csi );
-							long bitPos = (cim - mergedCS.data);
-							basicVals |= 1 << bitPos;
-						}
-					}
+				LongVect fromBits;
+				condBitMap( fromBits, fromCondSpace->condSet, mergedCS );
 
-					long targVals = basicVals;
-					Action **cim = mergedCS.find( condAction );
-					long bitPos = (cim - mergedCS.data);
-					targVals |= (sense?1:0) << bitPos;
-					
-					LongVect expandToVals( targVals );
-					findCondExpInTrans( expansionList, destState, 
-						transCond.s2Tel.lowKey, transCond.s2Tel.highKey, 
-						fromCondSpace, toCondSpace, destVals, expandToVals );
-				}
+				Action **cim = mergedCS.find( condAction );
+				long bitPos = (cim - mergedCS.data);
+				LongVect senseVals( (sense?1:0) << bitPos );
+
+				findCondExpInTrans( expansionList, destState, 
+					transCond.s2Tel.lowKey, transCond.s2Tel.highKey, 
+					fromCondSpace, toCondSpace, fromBits, senseVals );
 				break;
 			}
 
@@ -1373,7 +1441,8 @@ void FsmAp::findEmbedExpansions( ExpansionList &expansionList,
 		}
 	}
 
-	destState->stateCondList.transfer( destList );
+	if ( destList.length() > 0 || destState->extData != 0 )
+		destState->extMut().stateCondList.transfer( destList );
 }
 
 void FsmAp::embedCondition( StateAp *state, Action *condAction, bool sense )
@@ -39,6 +39,7 @@
 #include "avlset.h"
 #include "avlmap.h"
 #include "ragel.h"
+#include "fsmalloc.h"
 
 //#define LOG_CONDS
 
@@ -373,7 +374,9 @@ typedef Vector<int> TransFuncList;
 typedef CmpTable< int, CmpOrd<int> > TransFuncListCompare;
 
 /* Transition class that implements actions and priorities. */
-struct TransAp 
+struct TransAp
+:
+	public ScratchAllocated
 {
 	TransAp() : fromState(0), toState(0) {}
 	TransAp( const TransAp &other ) :
@@ -588,6 +591,61 @@ typedef Vector<CondSpace*> CondSpaceVect;
 
 typedef AvlTree<CondSpace, CondSet, CmpCondSet> CondSpaceMap;
 
+typedef Vector<long> LongVect;
+
+/* Key for looking up the merge of two condition spaces. */
+struct CondSpacePair
+{
+	CondSpacePair( CondSpace *fromCondSpace, CondSpace *withCondSpace )
+		: fromCondSpace(fromCondSpace), withCondSpace(withCondSpace) {}
+
+	CondSpace *fromCondSpace;
+	CondSpace *withCondSpace;
+};
+
+struct CmpCondSpacePair
+{
+	static int compare( const CondSpacePair &pair1, const CondSpacePair &pair2 )
+	{
+		if ( pair1.fromCondSpace < pair2.fromCondSpace )
+			return -1;
+		else if ( pair1.fromCondSpace > pair2.fromCondSpace )
+			return 1;
+		else if ( pair1.withCondSpace < pair2.withCondSpace )
+			return -1;
+		else if ( pair1.withCondSpace > pair2.withCondSpace )
+			return 1;
+		return 0;
+	}
+};
+
+/* The result of widening a condition space with the conditions of another.
+ * Computed once per pair of spaces and kept, so merges that meet the same
+ * pair again don't redo the set union, the space lookup and the remapping of
+ * condition bits. */
+struct CondSpaceMerge
+	: public AvlTreeEl<CondSpaceMerge>
+{
+	CondSpaceMerge( const CondSpacePair &pair )
+		: pair(pair), toCondSpace(0) {}
+
+	const CondSpacePair &getKey() { return pair; }
+
+	CondSpacePair pair;
+	CondSpace *toCondSpace;
+
+	/* Bit in the to space of each condition in the from space. */
+	LongVect fromBits;
+
+	/* The to space bits of every combination of the conditions that are
+	 * only in the with space. */
+	LongVect newVals;
+};
+
+typedef AvlTree<CondSpaceMerge, CondSpacePair, CmpCondSpacePair> CondSpaceMergeMap;
+
+void condBitMap( LongVect &bits, const CondSet &fromSet, const CondSet &toSet );
+
 struct StateCond
 {
 	StateCond( Key lowKey, Key highKey ) :
@@ -601,7 +659,6 @@ struct StateCond
 };
 
 typedef DList<StateCond> StateCondList;
-typedef Vector<long> LongVect;
 
 struct Expansion
 {
@@ -641,12 +698,16 @@ struct Removal
 
 struct CondData
 {
-	CondData() : lastCondKey(0) {}
+	CondData() : lastCondKey(0), expandedTrans(0) {}
 
 	/* Condition info. */
 	Key lastCondKey;
 
 	CondSpaceMap condSpaceMap;
+	CondSpaceMergeMap condSpaceMergeMap;
+
+	/* Number of transitions created by expanding into condition spaces. */
+	long expandedTrans;
 };
 
 extern CondData *condData;
@@ -663,21 +724,15 @@ struct FsmConstructFail
 	Reason reason;
 };
 
-/* State class that implements actions and priorities. */
-struct StateAp 
+/* State data that most states never carry. It lives outside of StateAp so the
+ * part of a state that the graph algorithms walk stays small. A state has
+ * none of it until the first time any of it is written. */
+struct StateExt
+:
+	public ScratchAllocated
 {
-	StateAp();
-	StateAp(const StateAp &other);
-	~StateAp();
-
-	/* Is the state final? */
-	bool isFinState() { return stateBits & STB_ISFINAL; }
-
-	/* Out transition list and the pointer for the default out trans. */
-	TransList outList;
-
-	/* In transition Lists. */
-	TransInList inList;
+	StateExt();
+	StateExt( const StateExt &other );
 
 	/* Set only during scanner construction when actions are added. NFA to DFA
 	 * code can ignore this. */
@@ -692,47 +747,13 @@ struct StateAp
 	/* Condition info. */
 	StateCondList stateCondList;
 
-	/* Number of in transitions from states other than ourselves. */
-	int foreignInTrans;
-
-	/* Temporary data for various algorithms. */
-	union {
-		/* When duplicating the fsm we need to map each 
-		 * state to the new state representing it. */
-		StateAp *stateMap;
-
-		/* When minimizing machines by partitioning, this maps to the group
-		 * the state is in. */
-		MinPartition *partition;
-
-		/* When merging states (state machine operations) this next pointer is
-		 * used for the list of states that need to be filled in. */
-		StateAp *next;
-
-		/* Identification for printing and stable minimization. */
-		int stateNum;
-
-	} alg;
-
-	/* Data used in epsilon operation, maybe fit into alg? */
+	/* Data used in epsilon operation. */
 	StateAp *isolatedShadow;
-	int owningGraph;
-
-	/* A pointer to a dict element that contains the set of states this state
-	 * represents. This cannot go into alg, because alg.next is used during
-	 * the merging process. */
-	StateDictEl *stateDictEl;
 
 	/* When drawing epsilon transitions, holds the list of states to merge
 	 * with. */
 	EptVect *eptVect;
 
-	/* Bits controlling the behaviour of the state during collapsing to dfa. */
-	int stateBits;
-
-	/* State list elements. */
-	StateAp *next, *prev;
-
 	/* 
 	 * Priority and Action data.
 	 */
@@ -767,6 +788,80 @@ struct StateAp
 
 	/* Set of longest match items that may be active in this state. */
 	LmItemSet lmItemSet;
+
+	/* What states without any of this data read. */
+	static const StateExt empty;
+};
+
+/* State class that implements actions and priorities. */
+struct StateAp
+:
+	public ScratchAllocated
+{
+	StateAp();
+	StateAp(const StateAp &other);
+	~StateAp();
+
+	/* Is the state final? */
+	bool isFinState() { return stateBits & STB_ISFINAL; }
+
+	/* Out transition list and the pointer for the default out trans. */
+	TransList outList;
+
+	/* In transition Lists. */
+	TransInList inList;
+
+	/* Number of in transitions from states other than ourselves. */
+	int foreignInTrans;
+
+	/* Bits controlling the behaviour of the state during collapsing to dfa. */
+	int stateBits;
+
+	/* Temporary data for various algorithms. */
+	union {
+		/* When duplicating the fsm we need to map each 
+		 * state to the new state representing it. */
+		StateAp *stateMap;
+
+		/* When minimizing machines by partitioning, this maps to the group
+		 * the state is in. */
+		MinPartition *partition;
+
+		/* When merging states (state machine operations) this next pointer is
+		 * used for the list of states that need to be filled in. */
+		StateAp *next;
+
+		/* Identification for printing and stable minimization. */
+		int stateNum;
+
+	} alg;
+
+	/* A pointer to a dict element that contains the set of states this state
+	 * represents. This cannot go into alg, because alg.next is used during
+	 * the merging process. */
+	StateDictEl *stateDictEl;
+
+	/* State list elements. */
+	StateAp *next, *prev;
+
+	/* Data used in epsilon operation. Written for every state of the
+	 * operands, so it is kept here rather than in the extended data. */
+	int owningGraph;
+
+	/* The rarely used data, null until some of it is written. */
+	StateExt *extData;
+
+	/* Read the rarely used data. Never allocates. */
+	const StateExt &ext() const
+		{ return extData != 0 ? *extData : StateExt::empty; }
+
+	/* Get the rarely used data for writing, allocating it on first use. */
+	StateExt &extMut()
+	{
+		if ( extData == 0 )
+			extData = new StateExt();
+		return *extData;
+	}
 };
 
 template <class ListItem> struct NextTrans
@@ -1122,6 +1217,12 @@ struct FsmAp
 	/* Misfit Accounting. Are misfits put on a separate list. */
 	bool misfitAccounting;
 
+	/* Are the in lists of the states up to date. When in lists are built
+	 * lazily they are dropped for bulk rewrites of the graph and rebuilt the
+	 * next time something walks them. The foreign in transition counts are
+	 * always kept. */
+	bool inListsValid;
+
 	/*
 	 * Transition actions and priorities.
 	 */
@@ -1154,6 +1255,8 @@ struct FsmAp
 
 	/* Set conditions. */
 	CondSpace *addCondSpace( const CondSet &condSet );
+	CondSpaceMerge *mergeCondSpaces( CondSpace *fromCondSpace,
+			CondSpace *withCondSpace );
 
 	void findEmbedExpansions( ExpansionList &expansionList, 
 		StateAp *destState, Action *condAction, bool sense );
@@ -1215,6 +1318,12 @@ struct FsmAp
 	void setMisfitAccounting( bool val ) 
 		{ misfitAccounting = val; }
 
+	/* Make sure the in lists are up to date before walking them. */
+	void needInLists()
+		{ if ( !inListsValid ) buildInLists(); }
+	void buildInLists();
+	void dropInLists();
+
 	/* Set and Unset a state as final. */
 	void setFinState( StateAp *state );
 	void unsetFinState( StateAp *state );
@@ -1286,7 +1395,7 @@ struct FsmAp
 	void doExpand( MergeData &md, StateAp *destState, ExpansionList &expList1 );
 	void findCondExpInTrans( ExpansionList &expansionList, StateAp *state, 
 			Key lowKey, Key highKey, CondSpace *fromCondSpace, CondSpace *toCondSpace,
-			long destVals, LongVect &toValsList );
+			const LongVect &fromBits, const LongVect &newVals );
 	void findTransExpansions( ExpansionList &expansionList, 
 			StateAp *destState, StateAp *srcState );
 	void findCondExpansions( ExpansionList &expansionList, 
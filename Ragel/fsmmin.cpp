@@ -86,6 +86,10 @@ void FsmAp::minimizePartition1()
 	if ( stateList.length() == 0 )
 		return;
 
+	/* States come off the main list while partitioned, so the in lists have
+	 * to be in place before that. */
+	needInLists();
+
 	/* 
 	 * First thing is to partition the states by final state status and
 	 * transition functions. This gives us an initial partitioning to work
@@ -289,6 +293,10 @@ void FsmAp::minimizePartition2()
 	if ( stateList.length() == 0 )
 		return;
 
+	/* States come off the main list while partitioned, so the in lists have
+	 * to be in place before that. */
+	needInLists();
+
 	/* 
 	 * First thing is to partition the states by final state status and
 	 * transition functions. This gives us an initial partitioning to work
@@ -562,6 +570,8 @@ void FsmAp::removeDeadEndStates()
 	 * misfit list. */
 	assert( !misfitAccounting && misfitList.length() == 0 );
 
+	needInLists();
+
 	/* Mark all states that have paths to the final states. */
 	StateAp **st = finStateSet.data;
 	int nst = finStateSet.length();
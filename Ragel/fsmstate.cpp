@@ -68,14 +68,12 @@ bool MarkIndex::isPairMarked(int state1, int state2)
 	return array[pos];
 }
 
-/* Create a new fsm state. State has not out transitions or in transitions, not
- * out out transition data and not number. */
-StateAp::StateAp()
-:
-	/* No out or in transitions. */
-	outList(),
-	inList(),
+/* The data read from states that have no extended data. */
+const StateExt StateExt::empty;
 
+/* Create empty extended state data. */
+StateExt::StateExt()
+:
 	/* No EOF target. */
 	eofTarget(0),
 
@@ -86,16 +84,10 @@ StateAp::StateAp()
 	/* Conditions. */
 	stateCondList(),
 
-	/* No transitions in from other states. */
-	foreignInTrans(0),
-
-	/* Only used during merging. Normally null. */
-	stateDictEl(0),
+	/* Only used during epsilon operations. Normally null. */
+	isolatedShadow(0),
 	eptVect(0),
 
-	/* No state identification bits. */
-	stateBits(0),
-
 	/* No Priority data. */
 	outPriorTable(),
 
@@ -105,19 +97,15 @@ StateAp::StateAp()
 	outActionTable(),
 	outCondSet(),
 	errActionTable(),
-	eofActionTable()
+	eofActionTable(),
+	lmItemSet()
 {
 }
 
-/* Copy everything except actual the transitions. That is left up to the
- * FsmAp copy constructor. */
-StateAp::StateAp(const StateAp &other)
+/* Copy the extended data of a state that is being duplicated. The epsilon
+ * operation data and longest match items are not carried over. */
+StateExt::StateExt( const StateExt &other )
 :
-	/* All lists are cleared. They will be filled in when the
-	 * individual transitions are duplicated and attached. */
-	outList(),
-	inList(),
-
 	/* Set this using the original state's eofTarget. It will get mapped back
 	 * to the new machine in the Fsm copy constructor. */
 	eofTarget(other.eofTarget),
@@ -130,16 +118,10 @@ StateAp::StateAp(const StateAp &other)
 	/* Copy in the elements of the conditions. */
 	stateCondList( other.stateCondList ),
 
-	/* No transitions in from other states. */
-	foreignInTrans(0),
-
-	/* This is only used during merging. Normally null. */
-	stateDictEl(0),
+	/* This is only used during epsilon operations. Normally null. */
+	isolatedShadow(0),
 	eptVect(0),
 
-	/* Fsm state data. */
-	stateBits(other.stateBits),
-
 	/* Copy in priority data. */
 	outPriorTable(other.outPriorTable),
 
@@ -149,7 +131,59 @@ StateAp::StateAp(const StateAp &other)
 	outActionTable(other.outActionTable),
 	outCondSet(other.outCondSet),
 	errActionTable(other.errActionTable),
-	eofActionTable(other.eofActionTable)
+	eofActionTable(other.eofActionTable),
+	lmItemSet()
+{
+}
+
+/* Create a new fsm state. State has not out transitions or in transitions, not
+ * out out transition data and not number. */
+StateAp::StateAp()
+:
+	/* No out or in transitions. */
+	outList(),
+	inList(),
+
+	/* No transitions in from other states. */
+	foreignInTrans(0),
+
+	/* No state identification bits. */
+	stateBits(0),
+
+	/* Only used during merging. Normally null. */
+	stateDictEl(0),
+
+	/* Not in an epsilon operation. */
+	owningGraph(0),
+
+	/* No priority, action, condition or entry data. */
+	extData(0)
+{
+}
+
+/* Copy everything except actual the transitions. That is left up to the
+ * FsmAp copy constructor. */
+StateAp::StateAp(const StateAp &other)
+:
+	/* All lists are cleared. They will be filled in when the
+	 * individual transitions are duplicated and attached. */
+	outList(),
+	inList(),
+
+	/* No transitions in from other states. */
+	foreignInTrans(0),
+
+	/* Fsm state data. */
+	stateBits(other.stateBits),
+
+	/* This is only used during merging. Normally null. */
+	stateDictEl(0),
+
+	/* Not in an epsilon operation. */
+	owningGraph(0),
+
+	/* Copy in the priority, action, condition and entry data. */
+	extData( other.extData != 0 ? new StateExt( *other.extData ) : 0 )
 {
 	/* Duplicate all the transitions. */
 	for ( TransList::Iter trans = other.outList; trans.lte(); trans++ ) {
@@ -162,12 +196,14 @@ StateAp::StateAp(const StateAp &other)
 	}
 }
 
-/* If there is a state dict element, then delete it. Everything else is left
- * up to the FsmGraph destructor. */
+/* If there is a state dict element, then delete it. The extended data goes
+ * with the state. Everything else is left up to the FsmGraph destructor. */
 StateAp::~StateAp()
 {
 	if ( stateDictEl != 0 )
 		delete stateDictEl;
+	if ( extData != 0 )
+		delete extData;
 }
 
 /* Compare two states using pointers to the states. With the approximate
@@ -184,8 +220,8 @@ int ApproxCompare::compare( const StateAp *state1, const StateAp *state2 )
 		return 1;
 	
 	/* Test epsilon transition sets. */
-	compareRes = CmpEpsilonTrans::compare( state1->epsilonTrans, 
-			state2->epsilonTrans );
+	compareRes = CmpEpsilonTrans::compare( state1->ext().epsilonTrans, 
+			state2->ext().epsilonTrans );
 	if ( compareRes != 0 )
 		return compareRes;
 	
@@ -225,9 +261,9 @@ int ApproxCompare::compare( const StateAp *state1, const StateAp *state2 )
 	}
 
 	/* Check EOF targets. */
-	if ( state1->eofTarget < state2->eofTarget )
+	if ( state1->ext().eofTarget < state2->ext().eofTarget )
 		return -1;
-	else if ( state1->eofTarget > state2->eofTarget )
+	else if ( state1->ext().eofTarget > state2->ext().eofTarget )
 		return 1;
 
 	/* Got through the entire state comparison, deem them equal. */
@@ -246,8 +282,8 @@ int InitPartitionCompare::compare( const StateAp *state1 , const StateAp *state2
 		return 1;
 
 	/* Test epsilon transition sets. */
-	compareRes = CmpEpsilonTrans::compare( state1->epsilonTrans, 
-			state2->epsilonTrans );
+	compareRes = CmpEpsilonTrans::compare( state1->ext().epsilonTrans, 
+			state2->ext().epsilonTrans );
 	if ( compareRes != 0 )
 		return compareRes;
 
@@ -257,7 +293,8 @@ int InitPartitionCompare::compare( const StateAp *state1 , const StateAp *state2
 		return compareRes;
 
 	/* Use a pair iterator to test the condition pairs. */
-	PairIter<StateCond> condPair( state1->stateCondList.head, state2->stateCondList.head );
+	PairIter<StateCond> condPair( state1->ext().stateCondList.head, 
+			state2->ext().stateCondList.head );
 	for ( ; !condPair.end(); condPair++ ) {
 		switch ( condPair.userState ) {
 		case RangeInS1:
@@ -349,14 +386,14 @@ int PartitionCompare::compare( const StateAp *state1, const StateAp *state2 )
 	}
 
 	/* Test eof targets. */
-	if ( state1->eofTarget == 0 && state2->eofTarget != 0 )
+	if ( state1->ext().eofTarget == 0 && state2->ext().eofTarget != 0 )
 		return -1;
-	else if ( state1->eofTarget != 0 && state2->eofTarget == 0 )
+	else if ( state1->ext().eofTarget != 0 && state2->ext().eofTarget == 0 )
 		return 1;
-	else if ( state1->eofTarget != 0 ) {
+	else if ( state1->ext().eofTarget != 0 ) {
 		/* Both eof targets are set. */
 		compareRes = CmpOrd< MinPartition* >::compare( 
-			state1->eofTarget->alg.partition, state2->eofTarget->alg.partition );
+			state1->ext().eofTarget->alg.partition, state2->ext().eofTarget->alg.partition );
 		if ( compareRes != 0 )
 			return compareRes;
 	}
@@ -21,7 +21,9 @@
 
 #include "gendata.h"
 #include "ragel.h"
+#include "mergesort.h"
 #include <iostream>
+#include <sstream>
 
 /*
  * Code generators.
@@ -31,6 +33,9 @@
 #include "csftable.h"
 #include "csflat.h"
 #include "csfflat.h"
+#include "cscomb.h"
+#include "cspair.h"
+#include "csptable.h"
 #include "csgoto.h"
 #include "csfgoto.h"
 #include "csipgoto.h"
@@ -40,6 +45,9 @@
 #include "cdftable.h"
 #include "cdflat.h"
 #include "cdfflat.h"
+#include "cdcomb.h"
+#include "cdpair.h"
+#include "cdptable.h"
 #include "cdgoto.h"
 #include "cdfgoto.h"
 #include "cdipgoto.h"
@@ -104,18 +112,29 @@ CodeGenData *cdMakeCodeGen( const wchar_t *sourceFileName, const wchar_t *fsmNam
 	switch ( hostLang->lang ) {
 	case HostLang::C:
 		switch ( codeStyle ) {
+		/* The automatic style is chosen before the generator is made. */
+		case GenAuto:
 		case GenTables:
 			codeGen = new CTabCodeGen(out);
 			break;
 		case GenFTables:
 			codeGen = new CFTabCodeGen(out);
 			break;
+		case GenPackTables:
+			codeGen = new CPackTabCodeGen(out);
+			break;
 		case GenFlat:
 			codeGen = new CFlatCodeGen(out);
 			break;
 		case GenFFlat:
 			codeGen = new CFFlatCodeGen(out);
 			break;
+		case GenCombFlat:
+			codeGen = new CCombFlatCodeGen(out);
+			break;
+		case GenPairFlat:
+			codeGen = new CPairFlatCodeGen(out);
+			break;
 		case GenGoto:
 			codeGen = new CGotoCodeGen(out);
 			break;
@@ -133,18 +152,28 @@ CodeGenData *cdMakeCodeGen( const wchar_t *sourceFileName, const wchar_t *fsmNam
 
 	case HostLang::D:
 		switch ( codeStyle ) {
+		case GenAuto:
 		case GenTables:
 			codeGen = new DTabCodeGen(out);
 			break;
 		case GenFTables:
 			codeGen = new DFTabCodeGen(out);
 			break;
+		case GenPackTables:
+			codeGen = new DPackTabCodeGen(out);
+			break;
 		case GenFlat:
 			codeGen = new DFlatCodeGen(out);
 			break;
 		case GenFFlat:
 			codeGen = new DFFlatCodeGen(out);
 			break;
+		case GenCombFlat:
+			codeGen = new DCombFlatCodeGen(out);
+			break;
+		case GenPairFlat:
+			codeGen = new DPairFlatCodeGen(out);
+			break;
 		case GenGoto:
 			codeGen = new DGotoCodeGen(out);
 			break;
@@ -162,18 +191,28 @@ CodeGenData *cdMakeCodeGen( const wchar_t *sourceFileName, const wchar_t *fsmNam
 
 	case HostLang::D2:
 		switch ( codeStyle ) {
+		case GenAuto:
 		case GenTables:
 			codeGen = new D2TabCodeGen(out);
 			break;
 		case GenFTables:
 			codeGen = new D2FTabCodeGen(out);
 			break;
+		case GenPackTables:
+			codeGen = new D2PackTabCodeGen(out);
+			break;
 		case GenFlat:
 			codeGen = new D2FlatCodeGen(out);
 			break;
 		case GenFFlat:
 			codeGen = new D2FFlatCodeGen(out);
 			break;
+		case GenCombFlat:
+			codeGen = new D2CombFlatCodeGen(out);
+			break;
+		case GenPairFlat:
+			codeGen = new D2PairFlatCodeGen(out);
+			break;
 		case GenGoto:
 			codeGen = new D2GotoCodeGen(out);
 			break;
@@ -292,18 +331,28 @@ CodeGenData *csharpMakeCodeGen( const wchar_t *sourceFileName, const wchar_t *fs
 	CodeGenData *codeGen = 0;
 
 	switch ( codeStyle ) {
+	case GenAuto:
 	case GenTables:
 		codeGen = new CSharpTabCodeGen(out);
 		break;
 	case GenFTables:
 		codeGen = new CSharpFTabCodeGen(out);
 		break;
+	case GenPackTables:
+		codeGen = new CSharpPackTabCodeGen(out);
+		break;
 	case GenFlat:
 		codeGen = new CSharpFlatCodeGen(out);
 		break;
 	case GenFFlat:
 		codeGen = new CSharpFFlatCodeGen(out);
 		break;
+	case GenCombFlat:
+		codeGen = new CSharpCombFlatCodeGen(out);
+		break;
+	case GenPairFlat:
+		codeGen = new CSharpPairFlatCodeGen(out);
+		break;
 	case GenGoto:
 		codeGen = new CSharpGotoCodeGen(out);
 		break;
@@ -447,11 +496,13 @@ CodeGenData::CodeGenData( wostream &out )
 	dataExpr(0),
 	wantComplete(true),
 	hasLongestMatch(false),
+	codeStyle(::codeStyle),
 	noEnd(false),
 	noPrefix(false),
 	noFinal(false),
 	noError(false),
-	noCS(false)
+	noCS(false),
+	pagedFlat(false)
 {}
 
 
@@ -660,6 +711,44 @@ void CodeGenData::resolveTargetStates( GenInlineList *inlineList )
 	}
 }
 
+void CodeGenData::mergeTargetStates( GenInlineList *inlineList )
+{
+	for ( GenInlineList::Iter item = *inlineList; item.lte(); item++ ) {
+		switch ( item->type ) {
+		case GenInlineItem::Goto: case GenInlineItem::Call:
+		case GenInlineItem::Next: case GenInlineItem::Entry:
+			if ( item->targState->mergedInto != 0 )
+				item->targState = item->targState->mergedInto;
+			break;
+		default:
+			break;
+		}
+
+		if ( item->children != 0 )
+			mergeTargetStates( item->children );
+	}
+}
+
+/* Merge the states the reduction made equivalent. The entry points and the
+ * targets of the control statements are moved to the states that remain.
+ * Skipped when minimization is turned off. */
+void CodeGenData::mergeStates()
+{
+	if ( minimizeOpt == MinimizeNone )
+		return;
+
+	redFsm->mergeStates();
+	if ( redFsm->statesMerged == 0 )
+		return;
+
+	/* The entry point ids are frontend numbers, which index allStates. */
+	for ( EntryIdVect::Iter en = entryPointIds; en.lte(); en++ )
+		*en = allStates[*en].id;
+
+	for ( GenActionList::Iter a = actionList; a.lte(); a++ )
+		mergeTargetStates( a->inlineList );
+}
+
 void CodeGenData::closeMachine()
 {
 	for ( GenActionList::Iter a = actionList; a.lte(); a++ )
@@ -895,6 +984,66 @@ void CodeGenData::assignActionIds()
 	}
 }
 
+/* Alphabet classes replace the keys of table and flat machines. Condition
+ * keys are placed beyond the end of the alphabet so machines with conditions
+ * keep their keys. */
+bool CodeGenData::classesSupported()
+{
+	if ( codeStyle != GenTables && codeStyle != GenFTables && codeStyle != GenPackTables &&
+			codeStyle != GenFlat && codeStyle != GenFFlat && codeStyle != GenCombFlat &&
+			codeStyle != GenPairFlat )
+		return false;
+
+	return condSpaceList.length() == 0 && keyOps->alphSize() <= 0x10000;
+}
+
+/* Paged transition lists are written by the flat styles of the C family and
+ * C#. */
+bool CodeGenData::pagesSupported()
+{
+	if ( codeStyle != GenFlat && codeStyle != GenFFlat )
+		return false;
+
+	return hostLang->lang == HostLang::C || hostLang->lang == HostLang::D ||
+			hostLang->lang == HostLang::D2 || hostLang->lang == HostLang::CSharp;
+}
+
+/* Chunked feeding is written for C#. The split style keeps its partitions in
+ * separate functions, which cannot see the locals of the feed. */
+bool CodeGenData::feedSupported()
+{
+	return hostLang->lang == HostLang::CSharp && codeStyle != GenSplit;
+}
+
+/* The stream helpers are written for C. */
+bool CodeGenData::streamSupported()
+{
+	return hostLang->lang == HostLang::C;
+}
+
+/* The lockstep driver is written for C. It steps keys through a dense table,
+ * which takes the keys without conditions and of a small alphabet. */
+bool CodeGenData::multiSupported()
+{
+	return hostLang->lang == HostLang::C && condSpaceList.length() == 0 &&
+			keyOps->alphSize() <= MAX_MULTI_ALPH;
+}
+
+/* The parallel driver uses the same table, and replays no actions. */
+bool CodeGenData::parallelSupported()
+{
+	return multiSupported() && !redFsm->anyActions();
+}
+
+/* The pair style steps two keys at a time for machines that only validate
+ * their input, over alphabets no wider than a byte. The keys are read straight
+ * from the data, so there can be no getkey expression. */
+bool CodeGenData::pairsSupported()
+{
+	return condSpaceList.length() == 0 && keyOps->alphSize() <= MAX_MULTI_ALPH &&
+			!redFsm->anyActions() && !redFsm->anyEofTrans() && getKeyExpr == 0;
+}
+
 void CodeGenData::setValueLimits()
 {
 	redFsm->maxSingleLen = 0;
@@ -1056,11 +1205,205 @@ void CodeGenData::analyzeMachine()
 	setValueLimits();
 }
 
+void CodeGenData::appendActionCase( ActionCaseList &cases, int label, GenAction *action )
+{
+	ActionCase actionCase;
+	actionCase.labels.append( label );
+	actionCase.actions.append( action );
+	cases.append( actionCase );
+}
+
+void CodeGenData::appendActionCase( ActionCaseList &cases, int label, GenActionTable &actions )
+{
+	ActionCase actionCase;
+	actionCase.labels.append( label );
+	for ( GenActionTable::Iter item = actions; item.lte(); item++ )
+		actionCase.actions.append( item->value );
+	cases.append( actionCase );
+}
+
+/* The code of an action as written by actionText. Runs of blanks outside of
+ * literals are taken as one, so actions written alike in different places
+ * compare equal. */
+static wstring actionTextKey( const wstring &text )
+{
+	wstring key;
+	wchar_t quote = 0;
+	bool blank = false;
+	for ( size_t pos = 0; pos < text.length(); pos++ ) {
+		wchar_t c = text[pos];
+		if ( quote == 0 && ( c == L' ' || c == L'\t' || c == L'\r' ) ) {
+			blank = true;
+			continue;
+		}
+
+		if ( blank && c != L'\n' && key.length() > 0 && key[key.length()-1] != L'\n' )
+			key += L' ';
+		blank = false;
+		key += c;
+
+		if ( quote != 0 ) {
+			if ( c == L'\\' && pos + 1 < text.length() )
+				key += text[++pos];
+			else if ( c == quote )
+				quote = 0;
+		}
+		else if ( c == L'"' || c == L'\'' )
+			quote = c;
+	}
+	return key;
+}
+
+/* A case that can end by falling into another, whose actions are the tail
+ * of its own. */
+struct ActionTail
+{
+	int from, to;
+	int length;
+};
+
+struct CmpActionTail
+{
+	static int compare( const ActionTail &t1, const ActionTail &t2 )
+	{
+		if ( t1.length > t2.length )
+			return -1;
+		else if ( t1.length < t2.length )
+			return 1;
+		else
+			return 0;
+	}
+};
+
+/* Merge the cases of an action switch. Cases whose actions expand to the
+ * same code take one body with the labels of all. With fallThrough, a case
+ * whose actions end with all of another case's is written just before that
+ * case and falls into it after its own leading actions. Each case takes at
+ * most one other in this way. */
+void CodeGenData::mergeActionCases( ActionCaseList &cases, bool inFinish, bool fallThrough )
+{
+	/* Number the actions by the code they expand to. */
+	int *textId = new int[actionList.length()];
+	for ( int i = 0; i < actionList.length(); i++ )
+		textId[i] = -1;
+	AvlMap<wstring, int, CmpOrd<wstring> > textMap;
+
+	/* The actions of each case, as a string of text ids. */
+	wstring *seqs = new wstring[cases.length()];
+	for ( int c = 0; c < cases.length(); c++ ) {
+		for ( int a = 0; a < cases[c].actions.length(); a++ ) {
+			GenAction *action = cases[c].actions[a];
+			if ( textId[action->actionId] < 0 ) {
+				std::wostringstream text;
+				actionText( text, action, inFinish );
+				wstring key = actionTextKey( text.str() );
+				AvlMapEl<wstring, int> *inMap = textMap.find( key );
+				if ( inMap == 0 )
+					inMap = textMap.insert( key, textMap.length() );
+				textId[action->actionId] = inMap->value;
+			}
+			seqs[c] += itoa( textId[action->actionId] ) + L",";
+		}
+	}
+
+	/* One case for each distinct code, keeping the labels of all. */
+	ActionCaseList distinct;
+	wstring *distinctSeqs = new wstring[cases.length()];
+	AvlMap<wstring, int, CmpOrd<wstring> > seqMap;
+	for ( int c = 0; c < cases.length(); c++ ) {
+		AvlMapEl<wstring, int> *inMap = seqMap.find( seqs[c] );
+		if ( inMap != 0 )
+			distinct[inMap->value].labels.append( cases[c].labels );
+		else {
+			distinctSeqs[distinct.length()] = seqs[c];
+			seqMap.insert( seqs[c], distinct.length() );
+			distinct.append( cases[c] );
+		}
+	}
+
+	int *next = new int[distinct.length()];
+	int *prev = new int[distinct.length()];
+	for ( int d = 0; d < distinct.length(); d++ )
+		next[d] = prev[d] = -1;
+
+	if ( fallThrough ) {
+		/* Every case another can fall into, longest shared tails first. */
+		Vector<ActionTail> tails;
+		for ( int d = 0; d < distinct.length(); d++ ) {
+			const wstring &seq = distinctSeqs[d];
+			int length = distinct[d].actions.length();
+			for ( size_t pos = seq.find( L',' ); pos + 1 < seq.length();
+					pos = seq.find( L',', pos + 1 ) )
+			{
+				length -= 1;
+				AvlMapEl<wstring, int> *inMap = seqMap.find( seq.substr( pos + 1 ) );
+				if ( inMap != 0 ) {
+					ActionTail tail = { d, inMap->value, length };
+					tails.append( tail );
+				}
+			}
+		}
+
+		MergeSort<ActionTail, CmpActionTail> mergeSort;
+		mergeSort.sort( tails.data, tails.length() );
+		for ( int t = 0; t < tails.length(); t++ ) {
+			if ( next[tails[t].from] < 0 && prev[tails[t].to] < 0 ) {
+				next[tails[t].from] = tails[t].to;
+				prev[tails[t].to] = tails[t].from;
+			}
+		}
+	}
+
+	/* Write out the chains of cases in the order their first cases came. */
+	ActionCaseList merged;
+	for ( int d = 0; d < distinct.length(); d++ ) {
+		if ( prev[d] >= 0 )
+			continue;
+		for ( int c = d; c >= 0; c = next[c] ) {
+			ActionCase &actionCase = distinct[c];
+			if ( next[c] >= 0 ) {
+				int own = actionCase.actions.length() - distinct[next[c]].actions.length();
+				actionCase.actions.remove( own, actionCase.actions.length() - own );
+				actionCase.fallThrough = true;
+			}
+			merged.append( actionCase );
+		}
+	}
+	cases.transfer( merged );
+
+	delete[] textId;
+	delete[] seqs;
+	delete[] distinctSeqs;
+	delete[] next;
+	delete[] prev;
+}
+
 void CodeGenData::write_option_error( InputLoc &loc, wchar_t *arg )
 {
 	source_warning(loc) << L"unrecognized write option \"" << arg << "\"" << endl;
 }
 
+/* The paged layout changes how the exec finds transitions as well as the
+ * tables, and the exec may be written before the data. */
+void CodeGenData::prepareWrite( InputLoc &loc, int nargs, wchar_t **args )
+{
+	if ( wcscmp( args[0], L"data" ) != 0 )
+		return;
+
+	for ( int i = 1; i < nargs; i++ ) {
+		if ( wcscmp( args[i], L"paged" ) == 0 && !pagedFlat ) {
+			if ( pagesSupported() ) {
+				pagedFlat = true;
+				redFsm->makePages();
+			}
+			else {
+				source_warning(loc) << L"write option \"paged\" is only "
+						L"supported by the -F0 and -F1 code styles" << endl;
+			}
+		}
+	}
+}
+
 /* returns true if the following section should generate line directives. */
 bool CodeGenData::writeStatement( InputLoc &loc, int nargs, wchar_t **args )
 {
@@ -1078,9 +1421,13 @@ bool CodeGenData::writeStatement( InputLoc &loc, int nargs, wchar_t **args )
 				noPrefix = true;
 			else if ( wcscmp( args[i], L"nofinal" ) == 0 )
 				noFinal = true;
+			else if ( wcscmp( args[i], L"paged" ) == 0 ) {
+				/* Taken by prepareWrite. */
+			}
 			else
 				write_option_error( loc, args[i] );
 		}
+
 		writeData();
 	}
 	else if ( wcscmp( args[0], L"init" ) == 0 ) {
@@ -1118,6 +1465,76 @@ bool CodeGenData::writeStatement( InputLoc &loc, int nargs, wchar_t **args )
 			write_option_error( loc, args[i] );
 		writeExports();
 	}
+	else if ( wcscmp( args[0], L"feed" ) == 0 ) {
+		out << L'\n';
+		genLineDirective( out );
+		followLineDirective = true;
+
+		for ( int i = 1; i < nargs; i++ )
+			write_option_error( loc, args[i] );
+
+		if ( !feedSupported() ) {
+			source_warning(loc) << L"write feed is only supported by the C# "
+					L"code styles other than -P" << endl;
+		}
+		else if ( getKeyExpr != 0 ) {
+			source_warning(loc) << L"write feed reads the keys from the chunk "
+					L"and cannot be used with getkey" << endl;
+		}
+		else
+			writeFeed();
+	}
+	else if ( wcscmp( args[0], L"stream" ) == 0 ) {
+		out << L'\n';
+		genLineDirective( out );
+		followLineDirective = true;
+
+		for ( int i = 1; i < nargs; i++ )
+			write_option_error( loc, args[i] );
+
+		if ( !streamSupported() ) {
+			source_warning(loc) << L"write stream is only supported by the C "
+					L"code styles" << endl;
+		}
+		else
+			writeStream();
+	}
+	else if ( wcscmp( args[0], L"multi" ) == 0 ) {
+		out << L'\n';
+		genLineDirective( out );
+		followLineDirective = true;
+
+		for ( int i = 1; i < nargs; i++ )
+			write_option_error( loc, args[i] );
+
+		if ( !multiSupported() ) {
+			source_warning(loc) << L"write multi is only supported by the C "
+					L"code styles, for alphabets of at most " << 
+					MAX_MULTI_ALPH << L" keys and no conditions" << endl;
+		}
+		else {
+			redFsm->makeMulti();
+			writeMulti();
+		}
+	}
+	else if ( wcscmp( args[0], L"parallel" ) == 0 ) {
+		out << L'\n';
+		genLineDirective( out );
+		followLineDirective = true;
+
+		for ( int i = 1; i < nargs; i++ )
+			write_option_error( loc, args[i] );
+
+		if ( !parallelSupported() ) {
+			source_warning(loc) << L"write parallel is only supported by the C "
+					L"code styles, for machines without actions or conditions "
+					L"and alphabets of at most " << MAX_MULTI_ALPH << L" keys" << endl;
+		}
+		else {
+			redFsm->makeMulti();
+			writeParallel();
+		}
+	}
 	else if ( wcscmp( args[0], L"start" ) == 0 ) {
 		for ( int i = 1; i < nargs; i++ )
 			write_option_error( loc, args[i] );
@@ -24,6 +24,7 @@
 
 #include <iostream>
 #include "config.h"
+#include "ragel.h"
 #include "redfsm.h"
 #include "common.h"
 
@@ -56,6 +57,20 @@ void lineDirective( wostream &out, const wchar_t *fileName, int line );
 
 wstring itoa( int i );
 
+/* A case of an action switch: the labels that select it and the actions it
+ * runs. After merging, a case that falls through goes on to run the case
+ * written after it. */
+struct ActionCase
+{
+	ActionCase() : fallThrough(false) {}
+
+	Vector<int> labels;
+	Vector<GenAction*> actions;
+	bool fallThrough;
+};
+
+typedef Vector<ActionCase> ActionCaseList;
+
 /*********************************/
 
 struct CodeGenData
@@ -70,6 +85,10 @@ struct CodeGenData
 	virtual void writeInit() {};
 	virtual void writeExec() {};
 	virtual void writeExports() {};
+	virtual void writeFeed() {};
+	virtual void writeStream() {};
+	virtual void writeMulti() {};
+	virtual void writeParallel() {};
 	virtual void writeStart() {};
 	virtual void writeFirstFinal() {};
 	virtual void writeError() {};
@@ -78,6 +97,10 @@ struct CodeGenData
 	 * statements. */
 	virtual bool writeStatement( InputLoc &loc, int nargs, wchar_t **args );
 
+	/* Takes the write options that change how the other statements are
+	 * written. Called for every write statement before any is written. */
+	void prepareWrite( InputLoc &loc, int nargs, wchar_t **args );
+
 	/********************/
 
 	CodeGenData( wostream &out );
@@ -126,12 +149,26 @@ struct CodeGenData
 	bool hasLongestMatch;
 	ExportList exportList;
 
+	/* The style the generator was made for. With --auto-style the global
+	 * goes back to GenAuto before the write statements run, so the checks
+	 * made while writing read this copy instead. */
+	CodeStyle codeStyle;
+
 	/* Write options. */
 	bool noEnd;
 	bool noPrefix;
 	bool noFinal;
 	bool noError;
 	bool noCS;
+	bool pagedFlat;
+
+	bool classesSupported();
+	bool pagesSupported();
+	bool feedSupported();
+	bool streamSupported();
+	bool multiSupported();
+	bool parallelSupported();
+	bool pairsSupported();
 
 	void createMachine();
 	void initActionList( unsigned long length );
@@ -167,6 +204,8 @@ struct CodeGenData
 	bool setAlphType( const wchar_t *data );
 
 	void resolveTargetStates( GenInlineList *inlineList );
+	void mergeTargetStates( GenInlineList *inlineList );
+	void mergeStates();
 	Key findMaxKey();
 
 	/* Gather various info on the machine. */
@@ -175,6 +214,14 @@ struct CodeGenData
 	void findFinalActionRefs();
 	void analyzeMachine();
 
+	/* Action switches. Cases are compared by the code their actions expand
+	 * to, as written by the host language's actionText. It writes the inline
+	 * list alone, without a line directive or the block around it. */
+	virtual void actionText( wostream &ret, GenAction *action, bool inFinish ) {}
+	void appendActionCase( ActionCaseList &cases, int label, GenAction *action );
+	void appendActionCase( ActionCaseList &cases, int label, GenActionTable &actions );
+	void mergeActionCases( ActionCaseList &cases, bool inFinish, bool fallThrough );
+
 	void closeMachine();
 	void setValueLimits();
 	void assignActionIds();
@@ -25,6 +25,7 @@
 #include "ragel.h"
 #include "redfsm.h"
 #include "gendata.h"
+#include "profile.h"
 #include <sstream>
 #include <string>
 #include <assert.h>
@@ -48,6 +49,9 @@ using std::endl;
 
 void goLineDirective( wostream &out, const wchar_t *fileName, int line )
 {
+	if ( fileName == 0 )
+		return;
+
 	out << L"//line " << fileName << L":" << line << endl;
 }
 
@@ -248,7 +252,7 @@ wstring GoCodeGen::TOKEND()
 
 wstring GoCodeGen::GET_WIDE_KEY()
 {
-	if ( redFsm->anyConditions() )
+	if ( redFsm->anyConditions() || redFsm->anyClasses() )
 		return L"_widec";
 	else
 		return GET_KEY();
@@ -379,8 +383,8 @@ void GoCodeGen::SET_TOKEND( wostream &ret, GenInlineItem *item )
 	/* The tokend action sets tokend. */
 	ret << TOKEND() << L" = " << P();
 	if ( item->offset != 0 )
-		out << L"+" << item->offset;
-	out << endl;
+		ret << L"+" << item->offset;
+	ret << endl;
 }
 
 void GoCodeGen::GET_TOKEND( wostream &ret, GenInlineItem *item )
@@ -521,6 +525,30 @@ void GoCodeGen::ACTION( wostream &ret, GenAction *action, int targState,
 	ret << endl;
 }
 
+void GoCodeGen::actionText( wostream &ret, GenAction *action, bool inFinish )
+{
+	INLINE_LIST( ret, action->inlineList, 0, inFinish, false );
+}
+
+/* Write the cases of an action switch. Cases that run the same code share a
+ * body and a case may fall into one that runs the tail of its actions. */
+void GoCodeGen::ACTION_CASES( ActionCaseList &cases, bool inFinish, int level )
+{
+	mergeActionCases( cases, inFinish, true );
+	for ( ActionCaseList::Iter ac = cases; ac.lte(); ac++ ) {
+		out << TABS(level) << L"case ";
+		for ( Vector<int>::Iter label = ac->labels; label.lte(); label++ )
+			out << ( label.first() ? L"" : L", " ) << *label;
+		out << L":" << endl;
+
+		for ( Vector<GenAction*>::Iter act = ac->actions; act.lte(); act++ )
+			ACTION( out, *act, 0, inFinish, false );
+
+		if ( ac->fallThrough )
+			out << TABS(level + 1) << L"fallthrough" << endl;
+	}
+}
+
 void GoCodeGen::CONDITION( wostream &ret, GenAction *condition )
 {
 	INLINE_LIST( ret, condition->inlineList, 0, false, false );
@@ -601,7 +629,9 @@ wstring GoCodeGen::ALPH_TYPE()
 wstring GoCodeGen::WIDE_ALPH_TYPE()
 {
 	wstring ret;
-	if ( redFsm->maxKey <= keyOps->maxKey )
+	if ( redFsm->anyClasses() )
+		ret = ARRAY_TYPE( redFsm->numClasses - 1 );
+	else if ( redFsm->maxKey <= keyOps->maxKey )
 		ret = ALPH_TYPE();
 	else {
 		long long maxKeyVal = redFsm->maxKey.getLongLong();
@@ -639,6 +669,56 @@ void GoCodeGen::STATE_IDS()
 	}
 }
 
+/* Write the map from keys to alphabet classes. */
+void GoCodeGen::CLASS_MAP()
+{
+	if ( redFsm->classPages.length() > 0 ) {
+		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxClassPage), CMP() );
+		out << L"	";
+		for ( int page = 0; page < redFsm->classPages.length(); page++ ) {
+			out << redFsm->classPages[page] << L", ";
+			if ( page < redFsm->classPages.length()-1 && (page+1) % IALL == 0 )
+				out << endl << L"	";
+		}
+		out << endl;
+		CLOSE_ARRAY() <<
+		endl;
+	}
+
+	OPEN_ARRAY( ARRAY_TYPE(redFsm->numClasses-1), CM() );
+	out << L"	";
+	for ( int pos = 0; pos < redFsm->classMap.length(); pos++ ) {
+		out << redFsm->classMap[pos] << L", ";
+		if ( pos < redFsm->classMap.length()-1 && (pos+1) % IALL == 0 )
+			out << endl << L"	";
+	}
+	out << endl;
+	CLOSE_ARRAY() <<
+	endl;
+}
+
+/* Look up the class of the current key. */
+void GoCodeGen::CLASS_TRANSLATE()
+{
+	wostringstream key;
+	if ( redFsm->classLowKey.getVal() == 0 )
+		key << CAST(INT(), GET_KEY());
+	else
+		key << L"(" << CAST(INT(), GET_KEY()) << L" - (" << KEY( redFsm->classLowKey ) << L"))";
+
+	out << L"	_widec = ";
+	if ( redFsm->classPages.length() > 0 ) {
+		wostringstream page;
+		page << CMP() << L"[" << key.str() << L" >> " << CLASS_PAGE_BITS << L"]";
+		out << CM() << L"[" << CAST(INT(), page.str()) << L" + (" << key.str() << 
+				L" & " << ( CLASS_PAGE_SIZE - 1 ) << L")]" << endl;
+	}
+	else {
+		out << CM() << L"[" << key.str() << L"]" << endl;
+	}
+	out << endl;
+}
+
 void GoCodeGen::writeStart()
 {
 	out << START_STATE_ID();
@@ -656,6 +736,9 @@ void GoCodeGen::writeError()
 
 void GoCodeGen::finishRagelDef()
 {
+	/* States the frontend kept apart may be the same once reduced. */
+	mergeStates();
+
 	if ( codeStyle == GenGoto || codeStyle == GenFGoto ||
 			codeStyle == GenIpGoto || codeStyle == GenSplit )
 	{
@@ -670,6 +753,17 @@ void GoCodeGen::finishRagelDef()
 		redFsm->sortByStateId();
 	}
 
+	/* Maybe index by classes of keys instead of the keys. */
+	if ( alphClasses && classesSupported() )
+		redFsm->makeClasses();
+
+	/* Count the traffic of the sample corpus, if there is one. Directly
+	 * executable machines place the busy states together. */
+	profileMachine( redFsm );
+	if ( redFsm->anyProfile() && ( codeStyle == GenGoto || codeStyle == GenFGoto || 
+			codeStyle == GenIpGoto || codeStyle == GenSplit ) )
+		redFsm->profileOrdering();
+
 	/* Choose default transitions and the single transition. */
 	redFsm->chooseDefaultSpan();
 
@@ -74,6 +74,8 @@ protected:
 	wstring LDIR_PATH( wchar_t *path );
 	virtual void ACTION( wostream &ret, GenAction *action, int targState,
 			bool inFinish, bool csForced );
+	void actionText( wostream &ret, GenAction *action, bool inFinish );
+	void ACTION_CASES( ActionCaseList &cases, bool inFinish, int level );
 	void CONDITION( wostream &ret, GenAction *condition );
 	wstring ALPH_TYPE();
 	wstring WIDE_ALPH_TYPE();
@@ -122,6 +124,8 @@ protected:
 	wstring ET() { return L"_" + DATA_PREFIX() + L"eof_trans"; }
 	wstring SP() { return L"_" + DATA_PREFIX() + L"key_spans"; }
 	wstring CSP() { return L"_" + DATA_PREFIX() + L"cond_key_spans"; }
+	wstring CM() { return L"_" + DATA_PREFIX() + L"class_map"; }
+	wstring CMP() { return L"_" + DATA_PREFIX() + L"class_pages"; }
 	wstring START() { return DATA_PREFIX() + L"start"; }
 	wstring ERROR() { return DATA_PREFIX() + L"error"; }
 	wstring FIRST_FINAL() { return DATA_PREFIX() + L"first_final"; }
@@ -152,6 +156,8 @@ protected:
 	virtual void SUB_ACTION( wostream &ret, GenInlineItem *item,
 			int targState, bool inFinish, bool csForced );
 	void STATE_IDS();
+	void CLASS_MAP();
+	void CLASS_TRANSLATE();
 
 	wstring ERROR_STATE();
 	wstring FIRST_FINAL_STATE();
@@ -70,16 +70,12 @@ std::wostream &GoFFlatCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &GoFFlatCodeGen::TO_STATE_ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numToStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-		}
+		if ( redAct->numToStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -90,16 +86,12 @@ std::wostream &GoFFlatCodeGen::TO_STATE_ACTION_SWITCH( int level )
 std::wostream &GoFFlatCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numFromStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-		}
+		if ( redAct->numFromStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -108,16 +100,12 @@ std::wostream &GoFFlatCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 std::wostream &GoFFlatCodeGen::EOF_ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numEofRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, true, false );
-		}
+		if ( redAct->numEofRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, true, level );
 
 	genLineDirective( out );
 	return out;
@@ -128,16 +116,12 @@ std::wostream &GoFFlatCodeGen::EOF_ACTION_SWITCH( int level )
 std::wostream &GoFFlatCodeGen::ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numTransRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-		}
+		if ( redAct->numTransRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -145,6 +129,9 @@ std::wostream &GoFFlatCodeGen::ACTION_SWITCH( int level )
 
 void GoFFlatCodeGen::writeData()
 {
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( WIDE_ALPH_TYPE(), CK() );
 		COND_KEYS();
@@ -256,6 +243,8 @@ void GoFFlatCodeGen::writeExec()
 			L"	var _conds " << INT() << endl <<
 			L"	var _widec " << WIDE_ALPH_TYPE() << endl;
 	}
+	else if ( redFsm->anyClasses() )
+		out << L"	var _widec " << WIDE_ALPH_TYPE() << endl;
 
 	if ( !noEnd ) {
 		testEofUsed = true;
@@ -286,6 +275,8 @@ void GoFFlatCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
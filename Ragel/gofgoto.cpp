@@ -32,17 +32,26 @@ using std::endl;
 std::wostream &GoFGotoCodeGen::EXEC_ACTIONS()
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numTransRefs > 0 ) {
-			/* 	We are at the start of a glob, write the case. */
-			out << L"f" << redAct->actListId << L":" << endl;
+		if ( redAct->numTransRefs > 0 )
+			appendActionCase( cases, redAct->actListId, redAct->key );
+	}
+
+	/* Lists that run the same code share a glob. A glob that runs the tail
+	 * of its actions goes on into the glob of the tail. */
+	mergeActionCases( cases, false, true );
+	for ( ActionCaseList::Iter ac = cases; ac.lte(); ac++ ) {
+		/* 	We are at the start of a glob, write the labels. */
+		for ( Vector<int>::Iter label = ac->labels; label.lte(); label++ )
+			out << L"f" << *label << L":" << endl;
 
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
+		/* Write each action in the list of action items. */
+		for ( Vector<GenAction*>::Iter act = ac->actions; act.lte(); act++ )
+			ACTION( out, *act, 0, false, false );
 
+		if ( !ac->fallThrough )
 			out << TABS(1) << L"goto _again" << endl;
-		}
 	}
 	return out;
 }
@@ -52,16 +61,12 @@ std::wostream &GoFGotoCodeGen::EXEC_ACTIONS()
 std::wostream &GoFGotoCodeGen::TO_STATE_ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numToStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-		}
+		if ( redAct->numToStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -72,16 +77,12 @@ std::wostream &GoFGotoCodeGen::TO_STATE_ACTION_SWITCH( int level )
 std::wostream &GoFGotoCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numFromStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-		}
+		if ( redAct->numFromStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -90,16 +91,12 @@ std::wostream &GoFGotoCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 std::wostream &GoFGotoCodeGen::EOF_ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numEofRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, true, false );
-		}
+		if ( redAct->numEofRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, true, level );
 
 	genLineDirective( out );
 	return out;
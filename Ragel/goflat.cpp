@@ -68,14 +68,13 @@ std::wostream &GoFlatCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &GoFlatCodeGen::TO_STATE_ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, false, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -84,14 +83,13 @@ std::wostream &GoFlatCodeGen::TO_STATE_ACTION_SWITCH( int level )
 std::wostream &GoFlatCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, false, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -100,14 +98,13 @@ std::wostream &GoFlatCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 std::wostream &GoFlatCodeGen::EOF_ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, true, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true, level );
 
 	genLineDirective( out );
 	return out;
@@ -117,14 +114,13 @@ std::wostream &GoFlatCodeGen::EOF_ACTION_SWITCH( int level )
 std::wostream &GoFlatCodeGen::ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, false, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -457,6 +453,9 @@ void GoFlatCodeGen::writeData()
 		endl;
 	}
 
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( WIDE_ALPH_TYPE(), CK() );
 		COND_KEYS();
@@ -618,6 +617,8 @@ void GoFlatCodeGen::writeExec()
 			L"	var _conds " << INT() << endl <<
 			L"	var _widec " << WIDE_ALPH_TYPE() << endl;
 	}
+	else if ( redFsm->anyClasses() )
+		out << L"	var _widec " << WIDE_ALPH_TYPE() << endl;
 
 	out << endl;
 
@@ -655,6 +656,8 @@ void GoFlatCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
@@ -99,18 +99,12 @@ std::wostream &GoFTabCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &GoFTabCodeGen::TO_STATE_ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numToStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << endl;
-		}
+		if ( redAct->numToStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -121,18 +115,12 @@ std::wostream &GoFTabCodeGen::TO_STATE_ACTION_SWITCH( int level )
 std::wostream &GoFTabCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numFromStateRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << endl;
-		}
+		if ( redAct->numFromStateRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -141,18 +129,12 @@ std::wostream &GoFTabCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 std::wostream &GoFTabCodeGen::EOF_ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numEofRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, true, false );
-
-			out << endl;
-		}
+		if ( redAct->numEofRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, true, level );
 
 	genLineDirective( out );
 	return out;
@@ -163,18 +145,12 @@ std::wostream &GoFTabCodeGen::EOF_ACTION_SWITCH( int level )
 std::wostream &GoFTabCodeGen::ACTION_SWITCH( int level )
 {
 	/* Loop the actions. */
+	ActionCaseList cases;
 	for ( GenActionTableMap::Iter redAct = redFsm->actionMap; redAct.lte(); redAct++ ) {
-		if ( redAct->numTransRefs > 0 ) {
-			/* Write the entry label. */
-			out << TABS(level) << L"case " << redAct->actListId+1 << L":" << endl;
-
-			/* Write each action in the list of action items. */
-			for ( GenActionTable::Iter item = redAct->key; item.lte(); item++ )
-				ACTION( out, item->value, 0, false, false );
-
-			out << endl;
-		}
+		if ( redAct->numTransRefs > 0 )
+			appendActionCase( cases, redAct->actListId+1, redAct->key );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -182,6 +158,9 @@ std::wostream &GoFTabCodeGen::ACTION_SWITCH( int level )
 
 void GoFTabCodeGen::writeData()
 {
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondOffset), CO() );
 		COND_OFFSETS();
@@ -308,7 +287,7 @@ void GoFTabCodeGen::writeExec()
 		L"	var _keys " << INT() << endl <<
 		L"	var _trans " << INT() << endl;
 
-	if ( redFsm->anyConditions() )
+	if ( redFsm->anyConditions() || redFsm->anyClasses() )
 		out << L"	var _widec " << WIDE_ALPH_TYPE() << endl;
 
 	out << endl;
@@ -342,6 +321,8 @@ void GoFTabCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
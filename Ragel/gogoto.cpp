@@ -44,14 +44,13 @@ int GoGotoCodeGen::TRANS_NR( RedTransAp *trans )
 std::wostream &GoGotoCodeGen::TO_STATE_ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, false, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -60,14 +59,13 @@ std::wostream &GoGotoCodeGen::TO_STATE_ACTION_SWITCH( int level )
 std::wostream &GoGotoCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, false, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -76,14 +74,13 @@ std::wostream &GoGotoCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 std::wostream &GoGotoCodeGen::EOF_ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, true, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true, level );
 
 	genLineDirective( out );
 	return out;
@@ -92,14 +89,13 @@ std::wostream &GoGotoCodeGen::EOF_ACTION_SWITCH( int level )
 std::wostream &GoGotoCodeGen::ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, false, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -117,6 +113,25 @@ void GoGotoCodeGen::emitSingleSwitch( RedStateAp *state, int level )
 	int numSingles = state->outSingle.length();
 	RedTransEl *data = state->outSingle.data;
 
+	/* With a profile the singles go busiest first and a single that takes
+	 * most of the state's traffic is tested ahead of the switch. */
+	RedTransList profSingles;
+	if ( redFsm->anyProfile() && numSingles > 1 ) {
+		profSingles.append( data, numSingles );
+		MergeSort<RedTransEl, CmpRedTransElProf> mergeSort;
+		mergeSort.sort( profSingles.data, numSingles );
+		data = profSingles.data;
+
+		if ( data[0].profCount * 2 > state->profVisits ) {
+			out << TABS(level) << L"if " << GET_WIDE_KEY(state) << L" == " <<
+					WIDE_KEY(state, data[0].lowKey) << L" {" << endl;
+			TRANS_GOTO(data[0].value, level + 1) << endl;
+			out << TABS(level) << L"}" << endl;
+			data += 1;
+			numSingles -= 1;
+		}
+	}
+
 	if ( numSingles == 1 ) {
 		/* If there is a single single key then write it out as an if. */
 		out << TABS(level) << L"if " << GET_WIDE_KEY(state) << L" == " <<
@@ -143,9 +158,10 @@ void GoGotoCodeGen::emitSingleSwitch( RedStateAp *state, int level )
 
 void GoGotoCodeGen::emitRangeBSearch( RedStateAp *state, int level, int low, int high )
 {
-	/* Get the mid position, staying on the lower end of the range. */
-	int mid = (low + high) >> 1;
+	/* Get the mid position, staying on the lower end of the range unless a
+	 * profile says otherwise. */
 	RedTransEl *data = state->outRange.data;
+	int mid = redFsm->searchMid( data, low, high );
 
 	/* Determine if we need to look higher or lower. */
 	bool anyLower = mid > low;
@@ -98,14 +98,13 @@ std::wostream &GoTabCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &GoTabCodeGen::TO_STATE_ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, false, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -114,14 +113,13 @@ std::wostream &GoTabCodeGen::TO_STATE_ACTION_SWITCH( int level )
 std::wostream &GoTabCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, false, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective( out );
 	return out;
@@ -130,14 +128,13 @@ std::wostream &GoTabCodeGen::FROM_STATE_ACTION_SWITCH( int level )
 std::wostream &GoTabCodeGen::EOF_ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, true, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true, level );
 
 	genLineDirective(out);
 	return out;
@@ -147,14 +144,13 @@ std::wostream &GoTabCodeGen::EOF_ACTION_SWITCH( int level )
 std::wostream &GoTabCodeGen::ACTION_SWITCH( int level )
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << TABS(level) << L"case " << act->actionId << L":" << endl;
-			ACTION( out, act, 0, false, false );
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false, level );
 
 	genLineDirective(out);
 	return out;
@@ -606,6 +602,9 @@ void GoTabCodeGen::writeData()
 		CLOSE_ARRAY() << endl;
 	}
 
+	if ( redFsm->anyClasses() )
+		CLASS_MAP();
+
 	if ( redFsm->anyConditions() ) {
 		OPEN_ARRAY( ARRAY_TYPE(redFsm->maxCondOffset), CO() );
 		COND_OFFSETS();
@@ -819,7 +818,7 @@ void GoTabCodeGen::writeExec()
 	out <<
 		L"	var _trans " << INT() << endl;
 
-	if ( redFsm->anyConditions() )
+	if ( redFsm->anyConditions() || redFsm->anyClasses() )
 		out << L"	var _widec " << WIDE_ALPH_TYPE() << endl;
 
 	if ( redFsm->anyToStateActions() || redFsm->anyRegActions()
@@ -866,6 +865,8 @@ void GoTabCodeGen::writeExec()
 
 	if ( redFsm->anyConditions() )
 		COND_TRANSLATE();
+	else if ( redFsm->anyClasses() )
+		CLASS_TRANSLATE();
 
 	LOCATE_TRANS();
 
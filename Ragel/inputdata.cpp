@@ -256,6 +256,16 @@ void InputData::writeOutput()
 	else if ( generateDot )
 		static_cast<GraphvizDotGen*>(dotGenParser->pd->cgd)->writeDotFile();
 	else {
+		for ( InputItemList::Iter ii = inputItems; ii.lte(); ii++ ) {
+			if ( ii->type == InputItem::Write ) {
+				CodeGenData *cgd = ii->pd->cgd;
+				::keyOps = &cgd->thisKeyOps;
+
+				cgd->prepareWrite( ii->loc, ii->writeArgs.length()-1, 
+						ii->writeArgs.data );
+			}
+		}
+
 		bool hostLineDirective = true;
 		for ( InputItemList::Iter ii = inputItems; ii.lte(); ii++ ) {
 			if ( ii->type == InputItem::Write ) {
@@ -56,6 +56,9 @@ using std::setiosflags;
 
 void javaLineDirective( wostream &out, const wchar_t *fileName, int line )
 {
+	if ( fileName == 0 )
+		return;
+
 	/* Write the preprocessor line info for to the input file. */
 	out << L"// line " << line  << L" \"";
 	for ( const wchar_t *pc = fileName; *pc != 0; pc++ ) {
@@ -451,15 +454,13 @@ int JavaTabCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &JavaTabCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -468,15 +469,13 @@ std::wostream &JavaTabCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &JavaTabCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -485,15 +484,13 @@ std::wostream &JavaTabCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &JavaTabCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, true );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -503,15 +500,13 @@ std::wostream &JavaTabCodeGen::EOF_ACTION_SWITCH()
 std::wostream &JavaTabCodeGen::ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break. */
-			out << L"\tcase " << act->actionId << L":\n";
-			ACTION( out, act, 0, false );
-			out << L"\tbreak;\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -1547,8 +1542,8 @@ void JavaTabCodeGen::SET_TOKEND( wostream &ret, GenInlineItem *item )
 	/* The tokend action sets tokend. */
 	ret << TOKEND() << L" = " << P();
 	if ( item->offset != 0 ) 
-		out << L"+" << item->offset;
-	out << L";";
+		ret << L"+" << item->offset;
+	ret << L";";
 }
 
 void JavaTabCodeGen::GET_TOKEND( wostream &ret, GenInlineItem *item )
@@ -1593,6 +1588,28 @@ void JavaTabCodeGen::ACTION( wostream &ret, GenAction *action, int targState, bo
 	ret << L"}\n";
 }
 
+void JavaTabCodeGen::actionText( wostream &ret, GenAction *action, bool inFinish )
+{
+	INLINE_LIST( ret, action->inlineList, 0, inFinish );
+}
+
+/* Write the cases of an action switch. Cases that run the same code share a
+ * body. */
+void JavaTabCodeGen::ACTION_CASES( ActionCaseList &cases, bool inFinish )
+{
+	mergeActionCases( cases, inFinish, true );
+	for ( ActionCaseList::Iter ac = cases; ac.lte(); ac++ ) {
+		for ( Vector<int>::Iter label = ac->labels; label.lte(); label++ )
+			out << L"\tcase " << *label << L":\n";
+
+		for ( Vector<GenAction*>::Iter act = ac->actions; act.lte(); act++ )
+			ACTION( out, *act, 0, inFinish );
+
+		if ( !ac->fallThrough )
+			out << L"\tbreak;\n";
+	}
+}
+
 void JavaTabCodeGen::CONDITION( wostream &ret, GenAction *condition )
 {
 	ret << L"\n";
@@ -121,6 +121,8 @@ public:
 	wstring KEY( Key key );
 	wstring INT( int i );
 	void ACTION( wostream &ret, GenAction *action, int targState, bool inFinish );
+	void actionText( wostream &ret, GenAction *action, bool inFinish );
+	void ACTION_CASES( ActionCaseList &cases, bool inFinish );
 	void CONDITION( wostream &ret, GenAction *condition );
 	wstring ALPH_TYPE();
 	wstring WIDE_ALPH_TYPE();
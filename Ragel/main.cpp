@@ -53,6 +53,8 @@
 #include "version.h"
 #include "common.h"
 #include "inputdata.h"
+#include "fsmalloc.h"
+#include "profile.h"
 #include <locale>
 #include <codecvt>
 
@@ -78,6 +80,14 @@ bool machineSpecFound = false;
 bool wantDupsRemoved = true;
 
 bool printStatistics = false;
+const wchar_t *scratchFileName = 0;
+const wchar_t *profileFileName = 0;
+bool lazyInLists = false;
+bool alphClasses = false;
+bool vectorSkip = false;
+bool spanTables = false;
+bool unsafeCode = false;
+StyleObjective styleObjective = ObjectiveBalanced;
 bool generateXML = false;
 bool generateDot = false;
 bool useStandardOutput = false;
@@ -115,6 +125,12 @@ L"   -n                   Do not perform minimization\n"
 L"   -m                   Minimize at the end of the compilation\n"
 L"   -l                   Minimize after most operations (default)\n"
 L"   -e                   Minimize after every operation\n"
+L"   --scratch-file=<file>\n"
+L"                        Keep states and transitions in <file> so that\n"
+L"                        they can be paged out to disk. Their lists and\n"
+L"                        tables stay in memory, so this saves about a\n"
+L"                        quarter of the peak on large scanners\n"
+L"   --lazy-in-lists      Build lists of in transitions only when needed\n"
 L"visualization:\n"
 L"   -x                   Run the frontend only: emit XML intermediate format\n"
 L"   -V                   Generate a dot file for Graphviz\n"
@@ -140,9 +156,32 @@ L"   -F1                  Faster flat table-driven FSM\n"
 L"code style: (C/D/C#/OCaml)\n"
 L"   -G0                  Goto-driven FSM\n"
 L"   -G1                  Faster goto-driven FSM\n"
+L"code style: (C/D/C#)\n"
+L"   -T2                  Table driven FSM with each state packed in one record\n"
+L"   -F2                  Flat table-driven FSM with rows packed by displacement\n"
+L"   -F3                  Flat table-driven FSM stepping two keys at a time\n"
 L"code style: (C/D)\n"
 L"   -G2                  Really fast goto-driven FSM\n"
 L"   -P<N>                N-Way Split really fast goto-driven FSM\n"
+L"automatic code style:\n"
+L"   --auto-style[=<obj>] Choose the style of each machine from estimates of\n"
+L"                        its size and speed. <obj> is size, speed or\n"
+L"                        balanced (default)\n"
+L"alphabet classes: (C/D/C#/Go with -T and -F styles)\n"
+L"   --alph-classes       Index tables by classes of equivalent keys\n"
+L"profile guided layout: (C/D/C#/Go)\n"
+L"   --profile=<file>     Lay out machines for the traffic of a sample corpus\n"
+L"self loop skipping: (C/C# with -G styles)\n"
+L"   --vector-skip        Skip runs of keys that a state loops on with SSE2,\n"
+L"                        AVX2 or NEON in C, or SearchValues in C#. Write\n"
+L"                        data must be at file scope in C\n"
+L"table data: (C#)\n"
+L"   --span-tables        Write tables of bytes as ReadOnlySpan properties over\n"
+L"                        constant data. Wider tables stay arrays. Saves the\n"
+L"                        startup copy of those tables but can slow the scan\n"
+L"   --unsafe             Pin the tables and the data and read them through\n"
+L"                        pointers. Needs unsafe code to be allowed and takes\n"
+L"                        the place of --span-tables\n"
 	;	
 
 	exit(0);
@@ -383,6 +422,39 @@ void processArgs( int argc, const wchar_t **argv, InputData &id )
 					else
 						error() << L"invalid value for error-format" << endl;
 				}
+				else if ( wcscmp( arg, L"scratch-file" ) == 0 ) {
+					if ( eq == 0 || *eq == 0 )
+						error() << L"expecting '=file' for scratch-file" << endl;
+					else
+						scratchFileName = _wcsdup( eq );
+				}
+				else if ( wcscmp( arg, L"profile" ) == 0 ) {
+					if ( eq == 0 || *eq == 0 )
+						error() << L"expecting '=file' for profile" << endl;
+					else
+						profileFileName = _wcsdup( eq );
+				}
+				else if ( wcscmp( arg, L"lazy-in-lists" ) == 0 )
+					lazyInLists = true;
+				else if ( wcscmp( arg, L"alph-classes" ) == 0 )
+					alphClasses = true;
+				else if ( wcscmp( arg, L"vector-skip" ) == 0 )
+					vectorSkip = true;
+				else if ( wcscmp( arg, L"span-tables" ) == 0 )
+					spanTables = true;
+				else if ( wcscmp( arg, L"unsafe" ) == 0 )
+					unsafeCode = true;
+				else if ( wcscmp( arg, L"auto-style" ) == 0 ) {
+					codeStyle = GenAuto;
+					if ( eq == 0 || wcscmp( eq, L"balanced" ) == 0 )
+						styleObjective = ObjectiveBalanced;
+					else if ( wcscmp( eq, L"size" ) == 0 )
+						styleObjective = ObjectiveSize;
+					else if ( wcscmp( eq, L"speed" ) == 0 )
+						styleObjective = ObjectiveSpeed;
+					else
+						error() << L"invalid value for auto-style" << endl;
+				}
 				else if ( wcscmp( arg, L"rbx" ) == 0 )
 					rubyImpl = Rubinius;
 				else {
@@ -399,6 +471,8 @@ void processArgs( int argc, const wchar_t **argv, InputData &id )
 					codeStyle = GenTables;
 				else if ( pc.paramArg[0] == L'1' )
 					codeStyle = GenFTables;
+				else if ( pc.paramArg[0] == L'2' )
+					codeStyle = GenPackTables;
 				else {
 					error() << L"-T" << pc.paramArg[0] << 
 							L" is an invalid argument" << endl;
@@ -410,6 +484,10 @@ void processArgs( int argc, const wchar_t **argv, InputData &id )
 					codeStyle = GenFlat;
 				else if ( pc.paramArg[0] == L'1' )
 					codeStyle = GenFFlat;
+				else if ( pc.paramArg[0] == L'2' )
+					codeStyle = GenCombFlat;
+				else if ( pc.paramArg[0] == L'3' )
+					codeStyle = GenPairFlat;
 				else {
 					error() << L"-F" << pc.paramArg[0] << 
 							L" is an invalid argument" << endl;
@@ -566,7 +644,7 @@ wchar_t *makeIntermedTemplate( const wchar_t *baseFileName )
 	else {
 		int baseLen = lastSlash - baseFileName + 1;
 		result = new wchar_t[baseLen + wcslen(templ) + 1];
-		memcpy( result, baseFileName, baseLen );
+		wmemcpy( result, baseFileName, baseLen );
 		wcscpy_s( result+baseLen, wcslen(templ) + 1, templ );
 	}
 	return result;
@@ -600,6 +678,12 @@ int wmain( int argc, const wchar_t **argv )
 				L"\" is the same as the input file" << endp;
 	}
 
+	if ( scratchFileName != 0 && !openScratchFile( scratchFileName ) )
+		error() << L"could not open scratch file " << scratchFileName << endp;
+
+	if ( profileFileName != 0 && !loadProfileCorpus( profileFileName ) )
+		error() << L"could not read profile corpus " << profileFileName << endp;
+
 	process( id );
 
 	return 0;
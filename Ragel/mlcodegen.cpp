@@ -45,7 +45,7 @@ using std::endl;
 
 void ocamlLineDirective( wostream &out, const wchar_t *fileName, int line )
 {
-	if ( noLineDirectives )
+	if ( noLineDirectives || fileName == 0 )
 		return;
 
 	/* Write the line info for to the input file. */
@@ -289,8 +289,8 @@ void OCamlCodeGen::SET_TOKEND( wostream &ret, GenInlineItem *item )
 	/* The tokend action sets tokend. */
 	ret << TOKEND() << L" <- " << P();
 	if ( item->offset != 0 ) 
-		out << L"+" << item->offset;
-	out << L"; ";
+		ret << L"+" << item->offset;
+	ret << L"; ";
 }
 
 void OCamlCodeGen::GET_TOKEND( wostream &ret, GenInlineItem *item )
@@ -431,6 +431,29 @@ void OCamlCodeGen::ACTION( wostream &ret, GenAction *action, int targState, bool
 	ret << L" end;\n";
 }
 
+void OCamlCodeGen::actionText( wostream &ret, GenAction *action, bool inFinish )
+{
+	INLINE_LIST( ret, action->inlineList, 0, inFinish );
+}
+
+/* Write the cases of an action switch. Cases that run the same code share a
+ * body. Matches cannot fall through, so tails are not shared. */
+void OCamlCodeGen::ACTION_CASES( ActionCaseList &cases, bool inFinish )
+{
+	mergeActionCases( cases, inFinish, false );
+	for ( ActionCaseList::Iter ac = cases; ac.lte(); ac++ ) {
+		out << L"\t";
+		for ( Vector<int>::Iter label = ac->labels; label.lte(); label++ )
+			out << L"| " << *label << L" ";
+		out << L"->\n";
+
+		for ( Vector<GenAction*>::Iter act = ac->actions; act.lte(); act++ )
+			ACTION( out, *act, 0, inFinish );
+
+		out << L"\t()\n";
+	}
+}
+
 void OCamlCodeGen::CONDITION( wostream &ret, GenAction *condition )
 {
 	ret << L"\n";
@@ -80,6 +80,8 @@ protected:
 	wstring ALPHA_KEY( Key key );
 	wstring LDIR_PATH( wchar_t *path );
 	void ACTION( wostream &ret, GenAction *action, int targState, bool inFinish );
+	void actionText( wostream &ret, GenAction *action, bool inFinish );
+	void ACTION_CASES( ActionCaseList &cases, bool inFinish );
 	void CONDITION( wostream &ret, GenAction *condition );
 	wstring ALPH_TYPE();
 	wstring WIDE_ALPH_TYPE();
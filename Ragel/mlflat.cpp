@@ -67,15 +67,13 @@ std::wostream &OCamlFlatCodeGen::TRANS_ACTION( RedTransAp *trans )
 std::wostream &OCamlFlatCodeGen::TO_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numToStateRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\t| " << act->actionId << L" ->\n";
-			ACTION( out, act, 0, false );
-			out << L"\t()\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numToStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -84,15 +82,13 @@ std::wostream &OCamlFlatCodeGen::TO_STATE_ACTION_SWITCH()
 std::wostream &OCamlFlatCodeGen::FROM_STATE_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numFromStateRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\t| " << act->actionId << L" ->\n";
-			ACTION( out, act, 0, false );
-			out << L"\t()\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numFromStateRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -101,15 +97,13 @@ std::wostream &OCamlFlatCodeGen::FROM_STATE_ACTION_SWITCH()
 std::wostream &OCamlFlatCodeGen::EOF_ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numEofRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\t| " << act->actionId << L" ->\n";
-			ACTION( out, act, 0, true );
-			out << L"\t()\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numEofRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, true );
 
 	genLineDirective( out );
 	return out;
@@ -119,15 +113,13 @@ std::wostream &OCamlFlatCodeGen::EOF_ACTION_SWITCH()
 std::wostream &OCamlFlatCodeGen::ACTION_SWITCH()
 {
 	/* Walk the list of functions, printing the cases. */
+	ActionCaseList cases;
 	for ( GenActionList::Iter act = actionList; act.lte(); act++ ) {
-		/* Write out referenced actions. */
-		if ( act->numTransRefs > 0 ) {
-			/* Write the case label, the action and the case break */
-			out << L"\t| " << act->actionId << L" ->\n";
-			ACTION( out, act, 0, false );
-			out << L"\t()\n";
-		}
+		/* Take the referenced actions. */
+		if ( act->numTransRefs > 0 )
+			appendActionCase( cases, act->actionId, act );
 	}
+	ACTION_CASES( cases, false );
 
 	genLineDirective( out );
 	return out;
@@ -31,6 +31,7 @@
 #include "parsetree.h"
 #include "mergesort.h"
 #include "xmlcodegen.h"
+#include "gendata.h"
 #include "version.h"
 #include "inputdata.h"
 
@@ -42,7 +43,7 @@ void Token::set( const wchar_t *str, int len )
 {
 	length = len;
 	data = new wchar_t[len+1];
-	memcpy( data, str, len );
+	wmemcpy( data, str, len );
 	data[len] = 0;
 }
 
@@ -50,8 +51,8 @@ void Token::append( const Token &other )
 {
 	int newLength = length + other.length;
 	wchar_t *newString = new wchar_t[newLength+1];
-	memcpy( newString, data, length );
-	memcpy( newString + length, other.data, other.length );
+	wmemcpy( newString, data, length );
+	wmemcpy( newString + length, other.data, other.length );
 	newString[newLength] = 0;
 	data = newString;
 	length = newLength;
@@ -960,9 +961,11 @@ void ParseData::removeActionDups( FsmAp *graph )
 		/* Loop all transitions. */
 		for ( TransList::Iter trans = state->outList; trans.lte(); trans++ )
 			removeDups( trans->actionTable );
-		removeDups( state->toStateActionTable );
-		removeDups( state->fromStateActionTable );
-		removeDups( state->eofActionTable );
+		if ( state->extData != 0 ) {
+			removeDups( state->extData->toStateActionTable );
+			removeDups( state->extData->fromStateActionTable );
+			removeDups( state->extData->eofActionTable );
+		}
 	}
 }
 
@@ -1025,7 +1028,7 @@ void ParseData::setLongestMatchData( FsmAp *graph )
 		for ( EntryMap::Iter en = graph->entryPoints; en.lte(); en++ ) {
 			/* This is run after duplicates are removed, we must guard against
 			 * inserting a duplicate. */
-			ActionTable &actionTable = en->value->toStateActionTable;
+			ActionTable &actionTable = en->value->extMut().toStateActionTable;
 			if ( ! actionTable.hasAction( initTokStart ) )
 				actionTable.setAction( initTokStartOrd, initTokStart );
 		}
@@ -1048,7 +1051,7 @@ void ParseData::setLongestMatchData( FsmAp *graph )
 		for ( StateSet::Iter ps = states; ps.lte(); ps++ ) {
 			/* This is run after duplicates are removed, we must guard against
 			 * inserting a duplicate. */
-			ActionTable &actionTable = (*ps)->toStateActionTable;
+			ActionTable &actionTable = (*ps)->extMut().toStateActionTable;
 			if ( ! actionTable.hasAction( initTokStart ) )
 				actionTable.setAction( initTokStartOrd, initTokStart );
 		}
@@ -1292,16 +1295,16 @@ void ParseData::analyzeGraph( FsmAp *graph )
 				at->value->numTransRefs += 1;
 		}
 
-		for ( ActionTable::Iter at = st->toStateActionTable; at.lte(); at++ )
+		for ( ActionTable::Iter at = st->ext().toStateActionTable; at.lte(); at++ )
 			at->value->numToStateRefs += 1;
 
-		for ( ActionTable::Iter at = st->fromStateActionTable; at.lte(); at++ )
+		for ( ActionTable::Iter at = st->ext().fromStateActionTable; at.lte(); at++ )
 			at->value->numFromStateRefs += 1;
 
-		for ( ActionTable::Iter at = st->eofActionTable; at.lte(); at++ )
+		for ( ActionTable::Iter at = st->ext().eofActionTable; at.lte(); at++ )
 			at->value->numEofRefs += 1;
 
-		for ( StateCondList::Iter sc = st->stateCondList; sc.lte(); sc++ ) {
+		for ( StateCondList::Iter sc = st->ext().stateCondList; sc.lte(); sc++ ) {
 			for ( CondSet::Iter sci = sc->condSpace->condSet; sci.lte(); sci++ )
 				(*sci)->numCondRefs += 1;
 		}
@@ -1428,10 +1431,33 @@ void ParseData::prepareMachineGenTBWrapped( GraphDictEl *graphDictEl )
 	sectionGraph->setStateNumbers( 0 );
 }
 
+/* Reduce the machine with a generator that is thrown away and choose the code
+ * style from estimates taken on the reduced machine. */
+CodeStyle ParseData::probeCodeStyle( InputData &inputData, StyleEstimateList &estimates )
+{
+	codeStyle = GenTables;
+	if ( generateDot )
+		return codeStyle;
+
+	CodeGenData *probe = makeCodeGen( inputData.inputFileName, sectionName, *inputData.outStream );
+	BackendGen probeGen( sectionName, this, sectionGraph, probe );
+	probeGen.makeProbe();
+
+	CodeStyle chosen = chooseCodeStyle( probe->redFsm, estimates );
+	delete probe;
+	return chosen;
+}
+
 void ParseData::generateReduced( InputData &inputData )
 {
 	beginProcessing();
 
+	/* The automatic style is chosen for each machine in turn. */
+	StyleEstimateList estimates;
+	bool autoStyle = codeStyle == GenAuto;
+	if ( autoStyle )
+		codeStyle = probeCodeStyle( inputData, estimates );
+
 	cgd = makeCodeGen( inputData.inputFileName, sectionName, *inputData.outStream );
 
 	/* Make the generator. */
@@ -1443,8 +1469,50 @@ void ParseData::generateReduced( InputData &inputData )
 	if ( printStatistics ) {
 		err() << L"fsm name  : " << sectionName << endl;
 		err() << L"num states: " << sectionGraph->stateList.length() << endl;
+		if ( thisCondData.condSpaceMap.length() > 0 ) {
+			err() << L"cond spaces: " << thisCondData.condSpaceMap.length() << endl;
+			err() << L"cond keys  : " << ( thisCondData.lastCondKey.getLongLong() -
+					thisKeyOps.maxKey.getLongLong() ) << endl;
+			err() << L"cond trans : " << thisCondData.expandedTrans << endl;
+		}
+		if ( cgd->redFsm != 0 && cgd->redFsm->statesMerged > 0 )
+			err() << L"merged    : " << cgd->redFsm->statesMerged << L" reduced states" << endl;
+		if ( cgd->redFsm != 0 && cgd->redFsm->anyClasses() ) {
+			err() << L"classes   : " << cgd->redFsm->numClasses << 
+					L" (class map: " << cgd->redFsm->classMap.length() << L")" << endl;
+		}
+		if ( codeStyle == GenCombFlat && cgd->redFsm != 0 ) {
+			/* The flat style needs the full span of every state's keys plus
+			 * its default. */
+			long long flatLen = 0;
+			for ( RedStateList::Iter st = cgd->redFsm->stateList; st.lte(); st++ ) {
+				if ( st->transList != 0 )
+					flatLen += keyOps->span( st->lowKey, st->highKey );
+				flatLen += 1;
+			}
+			err() << L"comb slots: " << cgd->redFsm->combTrans.length() << 
+					L" (flat indicies: " << flatLen << L")" << endl;
+		}
+		if ( codeStyle == GenSplit && cgd->redFsm != 0 ) {
+			RedFsmAp *redFsm = cgd->redFsm;
+			err() << L"cut       : " << redFsm->partWeight << L" weighted by " <<
+					( redFsm->anyProfile() ? L"traffic" : L"in-degree" ) << L", " <<
+					redFsm->partCut << L" transitions between " << redFsm->nParts <<
+					L" partitions (" << redFsm->partWeightInitial << L" weighted, " <<
+					redFsm->partCutInitial << L" transitions splitting the state "
+					L"ordering)" << endl;
+		}
+		if ( autoStyle && estimates.length() > 0 )
+			printStyleEstimates( err(), codeStyle, estimates );
+		if ( scratchFileOpen() )
+			err() << L"scratch   : " << scratchBytesMapped() << L" bytes mapped" << endl;
 		err() << endl;
 	}
+
+	/* The next machine chooses its own style. The generator keeps the one
+	 * chosen here for its write statements. */
+	if ( autoStyle )
+		codeStyle = GenAuto;
 }
 
 void ParseData::generateXML( wostream &out )
@@ -1460,6 +1528,14 @@ void ParseData::generateXML( wostream &out )
 	if ( printStatistics ) {
 		err() << L"fsm name  : " << sectionName << endl;
 		err() << L"num states: " << sectionGraph->stateList.length() << endl;
+		if ( thisCondData.condSpaceMap.length() > 0 ) {
+			err() << L"cond spaces: " << thisCondData.condSpaceMap.length() << endl;
+			err() << L"cond keys  : " << ( thisCondData.lastCondKey.getLongLong() -
+					thisKeyOps.maxKey.getLongLong() ) << endl;
+			err() << L"cond trans : " << thisCondData.expandedTrans << endl;
+		}
+		if ( scratchFileOpen() )
+			err() << L"scratch   : " << scratchBytesMapped() << L" bytes mapped" << endl;
 		err() << endl;
 	}
 }
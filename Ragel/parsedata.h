@@ -34,6 +34,7 @@
 #include "vector.h"
 #include "common.h"
 #include "parsetree.h"
+#include "autostyle.h"
 
 /* Forwards. */
 using std::wostream;
@@ -231,6 +232,7 @@ struct ParseData
 	void prepareMachineGenTBWrapped( GraphDictEl *graphDictEl );
 	void generateXML( wostream &out );
 	void generateReduced( InputData &inputData );
+	CodeStyle probeCodeStyle( InputData &inputData, StyleEstimateList &estimates );
 	FsmAp *sectionGraph;
 	bool generatingSectionSubset;
 
@@ -296,19 +296,57 @@ void LongestMatch::restart( FsmAp *graph, TransAp *trans )
 	graph->attachTrans( fromState, graph->startState, trans );
 }
 
-void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
+/* Add an item to the item set of a state. If the set grows, the state is put
+ * on the work list so the item gets carried to the states that follow. */
+static void addLmItem( Vector<StateAp*> &workList, StateAp *state, 
+		LongestMatchPart *item )
 {
-	graph->markReachableFromHereStopFinal( graph->startState );
-	for ( StateList::Iter ms = graph->stateList; ms.lte(); ms++ ) {
-		if ( ms->stateBits & STB_ISMARKED ) {
-			ms->lmItemSet.insert( 0 );
-			ms->stateBits &= ~ STB_ISMARKED;
+	if ( state->extMut().lmItemSet.insert( item ) != 0 && 
+			!( state->stateBits & STB_ISMARKED ) )
+	{
+		state->stateBits |= STB_ISMARKED;
+		workList.append( state );
+	}
+}
+
+/* Extend a set of states backwards to every state from which
+ * markReachableFromHereStopFinal would reach a member of the set. States on
+ * the work list are already in the set. Final states are only ever the first
+ * state of such a search, so the search never goes back through them. */
+static void lmReachesBackwards( bool *inSet, Vector<StateAp*> &workList )
+{
+	while ( workList.length() > 0 ) {
+		StateAp *state = workList[workList.length()-1];
+		workList.remove( workList.length()-1 );
+
+		if ( state->isFinState() )
+			continue;
+
+		for ( TransInList::Iter trans = state->inList; trans.lte(); trans++ ) {
+			StateAp *fromState = trans->fromState;
+			if ( !inSet[fromState->alg.stateNum] ) {
+				inSet[fromState->alg.stateNum] = true;
+				workList.append( fromState );
+			}
 		}
 	}
+}
+
+void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
+{
+	/* The item sets are filled in a single pass. An item that is seeded in a
+	 * state reaches every state marked by markReachableFromHereStopFinal from
+	 * there, so instead of marking once per seed we push the item sets along
+	 * the out transitions, not entering final states, until nothing changes.
+	 * States are marked while they are on the work list. */
+	Vector<StateAp*> workList;
+
+	/* The null item starts in the start state. */
+	addLmItem( workList, graph->startState, 0 );
 
 	/* Transfer the first item of non-empty lmAction tables to the item sets
 	 * of the states that follow. Exclude states that have no transitions out.
-	 * This must happen on a separate pass so that on each iteration of the
+	 * All seeds go in before the propagation so that on each iteration of the
 	 * next pass we have the item set entries from all lmAction tables. */
 	for ( StateList::Iter st = graph->stateList; st.lte(); st++ ) {
 		for ( TransList::Iter trans = st->outList; trans.lte(); trans++ ) {
@@ -320,16 +358,23 @@ void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
 				/* Can only optimize this if there are no transitions out.
 				 * Note there can be out transitions going nowhere with
 				 * actions and they too must inhibit this optimization. */
-				if ( toState->outList.length() > 0 ) {
-					/* Fill the item sets. */
-					graph->markReachableFromHereStopFinal( toState );
-					for ( StateList::Iter ms = graph->stateList; ms.lte(); ms++ ) {
-						if ( ms->stateBits & STB_ISMARKED ) {
-							ms->lmItemSet.insert( lmAct->value );
-							ms->stateBits &= ~ STB_ISMARKED;
-						}
-					}
-				}
+				if ( toState->outList.length() > 0 )
+					addLmItem( workList, toState, lmAct->value );
+			}
+		}
+	}
+
+	/* Fill the item sets. */
+	while ( workList.length() > 0 ) {
+		StateAp *state = workList[workList.length()-1];
+		workList.remove( workList.length()-1 );
+		state->stateBits &= ~ STB_ISMARKED;
+
+		for ( TransList::Iter trans = state->outList; trans.lte(); trans++ ) {
+			StateAp *toState = trans->toState;
+			if ( toState != 0 && toState != state && !toState->isFinState() ) {
+				for ( LmItemSet::Iter item = state->ext().lmItemSet; item.lte(); item++ )
+					addLmItem( workList, toState, *item );
 			}
 		}
 	}
@@ -343,16 +388,16 @@ void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
 	graph->markReachableFromHereStopFinal( graph->startState );
 	for ( StateList::Iter ms = graph->stateList; ms.lte(); ms++ ) {
 		if ( ms->stateBits & STB_ISMARKED ) {
-			if ( ms->lmItemSet.length() > maxItemSetLength )
-				maxItemSetLength = ms->lmItemSet.length();
+			if ( ms->ext().lmItemSet.length() > maxItemSetLength )
+				maxItemSetLength = ms->ext().lmItemSet.length();
 			ms->stateBits &= ~ STB_ISMARKED;
 		}
 	}
 
 	/* The actions executed on starting to match a token. */
 	graph->isolateStartState();
-	graph->startState->toStateActionTable.setAction( pd->initTokStartOrd, pd->initTokStart );
-	graph->startState->fromStateActionTable.setAction( pd->setTokStartOrd, pd->setTokStart );
+	graph->startState->extMut().toStateActionTable.setAction( pd->initTokStartOrd, pd->initTokStart );
+	graph->startState->extMut().fromStateActionTable.setAction( pd->setTokStartOrd, pd->setTokStart );
 	if ( maxItemSetLength > 1 ) {
 		/* The longest match action switch may be called when tokens are
 		 * matched, in which case act must be initialized, there must be a
@@ -360,7 +405,7 @@ void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
 		 * error state. */
 		lmSwitchHandlesError = true;
 		pd->lmRequiresErrorState = true;
-		graph->startState->toStateActionTable.setAction( pd->initActIdOrd, pd->initActId );
+		graph->startState->extMut().toStateActionTable.setAction( pd->initActIdOrd, pd->initActId );
 	}
 
 	/* The place to store transitions to restart. It maybe possible for the
@@ -369,6 +414,28 @@ void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
 	 * until after all searching is done. */
 	Vector<TransAp*> restartTrans;
 
+	/* Find, for every state, whether the states reachable from it (excluding
+	 * at transitions to final states) include a non final state with a
+	 * non-empty item set or a state with more than one item. Working
+	 * backwards from those states answers this for all transitions at once. */
+	graph->setStateNumbers( 0 );
+	int numStates = graph->stateList.length();
+	bool *reachesNonFinalItems = new bool[numStates];
+	bool *reachesMultiItems = new bool[numStates];
+	Vector<StateAp*> nonFinalList, multiList;
+	for ( StateList::Iter st = graph->stateList; st.lte(); st++ ) {
+		reachesNonFinalItems[st->alg.stateNum] = 
+				st->ext().lmItemSet.length() > 0 && !st->isFinState();
+		reachesMultiItems[st->alg.stateNum] = st->ext().lmItemSet.length() > 1;
+		if ( reachesNonFinalItems[st->alg.stateNum] )
+			nonFinalList.append( st );
+		if ( reachesMultiItems[st->alg.stateNum] )
+			multiList.append( st );
+	}
+	graph->needInLists();
+	lmReachesBackwards( reachesNonFinalItems, nonFinalList );
+	lmReachesBackwards( reachesMultiItems, multiList );
+
 	/* Set actions that do immediate token recognition, set the longest match part
 	 * id and set the token ending. */
 	for ( StateList::Iter st = graph->stateList; st.lte(); st++ ) {
@@ -399,19 +466,11 @@ void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
 					 * set. If these are present then we need to record the
 					 * end of the token.  Also Find the highest item set
 					 * length reachable from here (excluding at transtions to
-					 * final states). */
-					bool nonFinalNonEmptyItemSet = false;
-					maxItemSetLength = 0;
-					graph->markReachableFromHereStopFinal( toState );
-					for ( StateList::Iter ms = graph->stateList; ms.lte(); ms++ ) {
-						if ( ms->stateBits & STB_ISMARKED ) {
-							if ( ms->lmItemSet.length() > 0 && !ms->isFinState() )
-								nonFinalNonEmptyItemSet = true;
-							if ( ms->lmItemSet.length() > maxItemSetLength )
-								maxItemSetLength = ms->lmItemSet.length();
-							ms->stateBits &= ~ STB_ISMARKED;
-						}
-					}
+					 * final states). Only whether it exceeds one matters. */
+					bool nonFinalNonEmptyItemSet = 
+							reachesNonFinalItems[toState->alg.stateNum];
+					maxItemSetLength = 
+							reachesMultiItems[toState->alg.stateNum] ? 2 : 1;
 
 					/* If there are reachable states that are not final and
 					 * have non empty item sets or that have an item set
@@ -433,6 +492,9 @@ void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
 		}
 	}
 
+	delete[] reachesNonFinalItems;
+	delete[] reachesMultiItems;
+
 	/* Now that all graph searching is done it certainly safe set the
 	 * restarting. It may be safe above, however this must be verified. */
 	for ( Vector<TransAp*>::Iter pt = restartTrans; pt.lte(); pt++ )
@@ -442,36 +504,36 @@ void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
 
 	/* Embed the error for recognizing a char. */
 	for ( StateList::Iter st = graph->stateList; st.lte(); st++ ) {
-		if ( st->lmItemSet.length() == 1 && st->lmItemSet[0] != 0 ) {
+		if ( st->ext().lmItemSet.length() == 1 && st->ext().lmItemSet[0] != 0 ) {
 			if ( st->isFinState() ) {
 				/* On error execute the onActNext action, which knows that
 				 * the last character of the token was one back and restart. */
 				graph->setErrorTarget( st, graph->startState, &lmErrActionOrd, 
-						&st->lmItemSet[0]->actOnNext, 1 );
-				st->eofActionTable.setAction( lmErrActionOrd, 
-						st->lmItemSet[0]->actOnNext );
-				st->eofTarget = graph->startState;
+						&st->ext().lmItemSet[0]->actOnNext, 1 );
+				st->extMut().eofActionTable.setAction( lmErrActionOrd, 
+						st->ext().lmItemSet[0]->actOnNext );
+				st->extMut().eofTarget = graph->startState;
 			}
 			else {
 				graph->setErrorTarget( st, graph->startState, &lmErrActionOrd, 
-						&st->lmItemSet[0]->actLagBehind, 1 );
-				st->eofActionTable.setAction( lmErrActionOrd, 
-						st->lmItemSet[0]->actLagBehind );
-				st->eofTarget = graph->startState;
+						&st->ext().lmItemSet[0]->actLagBehind, 1 );
+				st->extMut().eofActionTable.setAction( lmErrActionOrd, 
+						st->ext().lmItemSet[0]->actLagBehind );
+				st->extMut().eofTarget = graph->startState;
 			}
 		}
-		else if ( st->lmItemSet.length() > 1 ) {
+		else if ( st->ext().lmItemSet.length() > 1 ) {
 			/* Need to use the select. Take note of which items the select
 			 * is needed for so only the necessary actions are included. */
-			for ( LmItemSet::Iter plmi = st->lmItemSet; plmi.lte(); plmi++ ) {
+			for ( LmItemSet::Iter plmi = st->ext().lmItemSet; plmi.lte(); plmi++ ) {
 				if ( *plmi != 0 )
 					(*plmi)->inLmSelect = true;
 			}
 			/* On error, execute the action select and go to the start state. */
 			graph->setErrorTarget( st, graph->startState, &lmErrActionOrd, 
 					&lmActSelect, 1 );
-			st->eofActionTable.setAction( lmErrActionOrd, lmActSelect );
-			st->eofTarget = graph->startState;
+			st->extMut().eofActionTable.setAction( lmErrActionOrd, lmActSelect );
+			st->extMut().eofTarget = graph->startState;
 		}
 	}
 	
@@ -482,8 +544,8 @@ void LongestMatch::runLongestMatch( ParseData *pd, FsmAp *graph )
 void LongestMatch::transferScannerLeavingActions( FsmAp *graph )
 {
 	for ( StateList::Iter st = graph->stateList; st.lte(); st++ ) {
-		if ( st->outActionTable.length() > 0 )
-			graph->setErrorActions( st, st->outActionTable );
+		if ( st->ext().outActionTable.length() > 0 )
+			graph->setErrorActions( st, st->ext().outActionTable );
 	}
 }
 
@@ -908,7 +970,7 @@ FsmAp *Term::walk( ParseData *pd, bool lastInSeq )
 			 * against the left machine persisting by moving through the empty
 			 * wstring. */
 			if ( rhs->startState->isFinState() ) {
-				rhs->startState->outPriorTable.setPrior( 
+				rhs->startState->extMut().outPriorTable.setPrior( 
 						pd->curPriorOrd++, &priorDescs[1] );
 			}
 
@@ -0,0 +1,142 @@
+/*
+ *  Copyright 2001-2007 Adrian Thurston <thurston@complang.org>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#include "profile.h"
+#include "ragel.h"
+#include "redfsm.h"
+#include <stdio.h>
+
+/* The raw bytes of the sample corpus. */
+static Vector<unsigned char> corpus;
+static bool corpusLoaded = false;
+
+bool loadProfileCorpus( const wchar_t *fileName )
+{
+	FILE *file = _wfopen( fileName, L"rb" );
+	if ( file == 0 )
+		return false;
+
+	unsigned char buf[4096];
+	size_t len;
+	while ( ( len = fread( buf, 1, sizeof(buf), file ) ) > 0 )
+		corpus.append( buf, len );
+
+	bool ok = ferror( file ) == 0;
+	fclose( file );
+	corpusLoaded = ok;
+	return ok;
+}
+
+bool profileLoaded()
+{
+	return corpusLoaded;
+}
+
+/* Decode the corpus into keys of the current alphabet. Single byte alphabets
+ * take the bytes as they are. Wider ones take the corpus as UTF-8. */
+static void corpusKeys( Vector<Key> &keys )
+{
+	if ( keyOps->alphType->size == 1 ) {
+		for ( int i = 0; i < corpus.length(); i++ ) {
+			long val = keyOps->isSigned ? (long)(signed char)corpus[i] : (long)corpus[i];
+			keys.append( Key( val ) );
+		}
+		return;
+	}
+
+	int i = 0;
+	while ( i < corpus.length() ) {
+		unsigned char c = corpus[i++];
+		long val = c;
+		int extra = 0;
+		if ( ( c & 0xe0 ) == 0xc0 ) {
+			val = c & 0x1f;
+			extra = 1;
+		}
+		else if ( ( c & 0xf0 ) == 0xe0 ) {
+			val = c & 0x0f;
+			extra = 2;
+		}
+		else if ( ( c & 0xf8 ) == 0xf0 ) {
+			val = c & 0x07;
+			extra = 3;
+		}
+		else if ( c >= 0x80 ) {
+			/* Stray continuation or invalid lead byte. */
+			continue;
+		}
+
+		for ( ; extra > 0 && i < corpus.length(); extra--, i++ )
+			val = ( val << 6 ) | ( corpus[i] & 0x3f );
+
+		if ( val <= keyOps->maxKey.getLongLong() )
+			keys.append( Key( val ) );
+	}
+}
+
+/* Find the range of the list that holds the key. */
+static RedTransEl *findRange( RedTransList &list, Key key )
+{
+	int low = 0, high = list.length() - 1;
+	while ( low <= high ) {
+		int mid = (low + high) >> 1;
+		if ( key < list[mid].lowKey )
+			high = mid - 1;
+		else if ( key > list[mid].highKey )
+			low = mid + 1;
+		else
+			return &list[mid];
+	}
+	return 0;
+}
+
+/* Run the machine over the corpus without executing any actions and count
+ * the keys each state consumes and the ranges taken. When the machine errors
+ * it starts over from the start state. Must be called while all transitions
+ * are still in the out ranges. */
+void profileMachine( RedFsmAp *redFsm )
+{
+	if ( !corpusLoaded || redFsm->startState == 0 )
+		return;
+
+	Vector<Key> keys;
+	corpusKeys( keys );
+
+	RedStateAp *state = redFsm->startState;
+	for ( int i = 0; i < keys.length(); i++ ) {
+		Key key = redFsm->anyClasses() ? Key( redFsm->classOf( keys[i] ) ) : keys[i];
+		state->profVisits += 1;
+
+		RedTransEl *range = findRange( state->outRange, key );
+		if ( range == 0 ) {
+			state = redFsm->startState;
+			continue;
+		}
+
+		range->profCount += 1;
+		state = range->value->targ;
+		if ( state == 0 || state == redFsm->errState )
+			state = redFsm->startState;
+	}
+
+	redFsm->bAnyProfile = true;
+}
@@ -0,0 +1,34 @@
+/*
+ *  Copyright 2001-2007 Adrian Thurston <thurston@complang.org>
+ */
+
+/*  This file is part of Ragel.
+ *
+ *  Ragel is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Ragel is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with Ragel; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef _PROFILE_H
+#define _PROFILE_H
+
+struct RedFsmAp;
+
+/* Profile guided layout. A sample corpus is run through each reduced machine
+ * and the counts of keys taken steer the ordering of states, the choice of
+ * defaults and the order of tests in the goto styles. */
+bool loadProfileCorpus( const wchar_t *fileName );
+bool profileLoaded();
+void profileMachine( RedFsmAp *redFsm );
+
+#endif
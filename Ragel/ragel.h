@@ -37,12 +37,24 @@ enum CodeStyle
 {
 	GenTables,
 	GenFTables,
+	GenPackTables,
 	GenFlat,
 	GenFFlat,
+	GenCombFlat,
+	GenPairFlat,
 	GenGoto,
 	GenFGoto,
 	GenIpGoto,
-	GenSplit
+	GenSplit,
+	GenAuto
+};
+
+/* What the automatic code style optimizes for. */
+enum StyleObjective
+{
+	ObjectiveBalanced,
+	ObjectiveSize,
+	ObjectiveSpeed
 };
 
 /* To what degree are machine minimized. */
@@ -72,6 +84,12 @@ extern MinimizeLevel minimizeLevel;
 extern MinimizeOpt minimizeOpt;
 extern const wchar_t *machineSpec, *machineName;
 extern bool printStatistics;
+extern bool lazyInLists;
+extern bool alphClasses;
+extern bool vectorSkip;
+extern bool spanTables;
+extern bool unsafeCode;
+extern StyleObjective styleObjective;
 extern bool wantDupsRemoved;
 extern bool generateDot;
 extern bool generateXML;
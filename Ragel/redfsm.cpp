@@ -48,6 +48,11 @@ RedFsmAp::RedFsmAp()
 	errTrans(0),
 	firstFinState(0),
 	numFinStates(0),
+	nParts(0),
+	partCutInitial(0),
+	partCut(0),
+	partWeightInitial(0),
+	partWeight(0),
 	bAnyToStateActions(false),
 	bAnyFromStateActions(false),
 	bAnyRegActions(false),
@@ -61,7 +66,18 @@ RedFsmAp::RedFsmAp()
 	bAnyRegNextStmt(false),
 	bAnyRegCurStateRef(false),
 	bAnyRegBreak(false),
-	bAnyConditions(false)
+	bAnyConditions(false),
+	bAnyProfile(false),
+	maxCombBase(0),
+	statesMerged(0),
+	bitmapLen(0),
+	numSkipLoops(0),
+	maxPageDirOffset(0),
+	maxPageStart(0),
+	numClasses(0),
+	maxClassPage(0),
+	numMultiClasses(0),
+	multiStop(0)
 {
 }
 
@@ -116,6 +132,60 @@ void RedFsmAp::depthFirstOrdering()
 	assert( stateListLen == stateList.length() );
 }
 
+struct CmpStateByProf
+{
+	static int compare( RedStateAp *st1, RedStateAp *st2 )
+	{
+		if ( st1->profVisits > st2->profVisits )
+			return -1;
+		else if ( st1->profVisits < st2->profVisits )
+			return 1;
+		else
+			return 0;
+	}
+};
+
+/* Stable sort the states by profiled visits so the busy states are placed
+ * together. Only for styles where the order of the list is not the order of
+ * the ids. */
+void RedFsmAp::profileOrdering()
+{
+	int pos = 0;
+	RedStateAp **ptrList = new RedStateAp*[stateList.length()];
+	for ( RedStateList::Iter st = stateList; st.lte(); st++, pos++ )
+		ptrList[pos] = st;
+
+	MergeSort<RedStateAp*, CmpStateByProf> mergeSort;
+	mergeSort.sort( ptrList, stateList.length() );
+
+	stateList.abandon();
+	for ( int st = 0; st < pos; st++ )
+		stateList.append( ptrList[st] );
+
+	delete[] ptrList;
+}
+
+/* Pick the element to test at the root of a search over the ranges from low
+ * to high. With a profile the split goes at the weighted median, which puts
+ * the busy ranges near the top of the tree. */
+int RedFsmAp::searchMid( RedTransEl *data, int low, int high )
+{
+	long long total = 0;
+	for ( int i = low; i <= high; i++ )
+		total += data[i].profCount;
+
+	if ( total == 0 )
+		return (low + high) >> 1;
+
+	long long below = 0;
+	for ( int i = low; i < high; i++ ) {
+		below += data[i].profCount;
+		if ( below * 2 >= total )
+			return i;
+	}
+	return high;
+}
+
 /* Assign state ids by appearance in the state list. */
 void RedFsmAp::sequentialStateIds()
 {
@@ -204,6 +274,481 @@ void RedFsmAp::findFirstFinState()
 	}
 }
 
+/* Compares states on everything but their transitions. States that differ
+ * here can never be merged. Action tables are shared, so comparing the
+ * pointers compares the contents. */
+struct CmpMergeInit
+{
+	static int compare( RedStateAp *st1, RedStateAp *st2 )
+	{
+		if ( st1->isFinal != st2->isFinal )
+			return st1->isFinal ? 1 : -1;
+
+		int cmp = CmpOrd<RedAction*>::compare( st1->toStateAction, st2->toStateAction );
+		if ( cmp != 0 )
+			return cmp;
+		cmp = CmpOrd<RedAction*>::compare( st1->fromStateAction, st2->fromStateAction );
+		if ( cmp != 0 )
+			return cmp;
+		cmp = CmpOrd<RedAction*>::compare( st1->eofAction, st2->eofAction );
+		if ( cmp != 0 )
+			return cmp;
+
+		if ( st1->eofTrans == 0 || st2->eofTrans == 0 ) {
+			if ( st1->eofTrans != st2->eofTrans )
+				return st1->eofTrans == 0 ? -1 : 1;
+		}
+		else {
+			cmp = CmpOrd<RedAction*>::compare( st1->eofTrans->action, st2->eofTrans->action );
+			if ( cmp != 0 )
+				return cmp;
+		}
+
+		cmp = CmpOrd<long>::compare( st1->stateCondList.length(), st2->stateCondList.length() );
+		if ( cmp != 0 )
+			return cmp;
+		GenStateCond *sc1 = st1->stateCondList.head, *sc2 = st2->stateCondList.head;
+		for ( ; sc1 != 0; sc1 = sc1->next, sc2 = sc2->next ) {
+			if ( sc1->lowKey < sc2->lowKey )
+				return -1;
+			else if ( sc1->lowKey > sc2->lowKey )
+				return 1;
+			else if ( sc1->highKey < sc2->highKey )
+				return -1;
+			else if ( sc1->highKey > sc2->highKey )
+				return 1;
+			cmp = CmpOrd<GenCondSpace*>::compare( sc1->condSpace, sc2->condSpace );
+			if ( cmp != 0 )
+				return cmp;
+		}
+
+		return 0;
+	}
+};
+
+/* Compares states on their class and then on the action and target class
+ * taken on each key, lowest key first. A key with no transition orders before
+ * one with a transition. The ranges are walked together since states that are
+ * the same may still have their keys split into ranges differently. */
+struct CmpMergeRefine
+{
+	static int targClass( RedTransAp *trans )
+		{ return trans->targ != 0 ? trans->targ->mergeClass : -1; }
+
+	static int compare( RedStateAp *st1, RedStateAp *st2 )
+	{
+		int cmp = CmpOrd<int>::compare( st1->mergeClass, st2->mergeClass );
+		if ( cmp != 0 )
+			return cmp;
+
+		RedTransList &list1 = st1->outRange, &list2 = st2->outRange;
+		int r1 = 0, r2 = 0;
+		Key next;
+		bool haveNext = false;
+		while ( r1 < list1.length() && r2 < list2.length() ) {
+			/* Where the current range of each starts, less what has been
+			 * compared already. */
+			Key low1 = haveNext && next > list1[r1].lowKey ? next : list1[r1].lowKey;
+			Key low2 = haveNext && next > list2[r2].lowKey ? next : list2[r2].lowKey;
+			if ( low1 < low2 )
+				return 1;
+			else if ( low1 > low2 )
+				return -1;
+
+			RedTransAp *trans1 = list1[r1].value, *trans2 = list2[r2].value;
+			cmp = CmpOrd<RedAction*>::compare( trans1->action, trans2->action );
+			if ( cmp != 0 )
+				return cmp;
+			cmp = CmpOrd<int>::compare( targClass( trans1 ), targClass( trans2 ) );
+			if ( cmp != 0 )
+				return cmp;
+
+			/* Move past the shorter of the two. */
+			Key high = list1[r1].highKey < list2[r2].highKey ? 
+					list1[r1].highKey : list2[r2].highKey;
+			if ( list1[r1].highKey == high )
+				r1 += 1;
+			if ( list2[r2].highKey == high )
+				r2 += 1;
+			next = high;
+			next.increment();
+			haveNext = true;
+		}
+
+		if ( r1 < list1.length() )
+			return 1;
+		else if ( r2 < list2.length() )
+			return -1;
+
+		if ( st1->eofTrans != 0 )
+			return CmpOrd<int>::compare( targClass( st1->eofTrans ), targClass( st2->eofTrans ) );
+		return 0;
+	}
+};
+
+/* The classes of states while merging. The members of each class are kept
+ * together in one array. Members whose targets have changed class are marked
+ * and moved to the front of their class. Unmarked members of a class all go
+ * the same way on every key. */
+struct MergeClasses
+{
+	MergeClasses( RedStateAp **byPos, int numStates );
+	~MergeClasses();
+
+	void mark( int pos );
+	void split( int cls );
+
+	RedStateAp **byPos;
+	int numStates;
+	int numClasses;
+
+	int *members, *where;
+	int *classStart, *classLen, *numMarked;
+
+	/* States that take a transition into each state. */
+	int *predStart, *preds;
+
+	/* Classes with marked members. */
+	Vector<int> work;
+	bool *inWork;
+};
+
+MergeClasses::MergeClasses( RedStateAp **byPos, int numStates )
+:
+	byPos(byPos),
+	numStates(numStates),
+	numClasses(0)
+{
+	members = new int[numStates];
+	where = new int[numStates];
+	classStart = new int[numStates+1];
+	classLen = new int[numStates+1];
+	numMarked = new int[numStates+1];
+	inWork = new bool[numStates+1];
+	predStart = new int[numStates+1];
+
+	/* Count, then place, the predecessors. Transitions to no state or to the
+	 * error state need no entry since those never change class. */
+	memset( predStart, 0, sizeof(int) * (numStates+1) );
+	for ( int p = 0; p < numStates; p++ ) {
+		for ( RedTransList::Iter rtel = byPos[p]->outRange; rtel.lte(); rtel++ ) {
+			if ( rtel->value->targ != 0 && rtel->value->targ->mergePos >= 0 )
+				predStart[rtel->value->targ->mergePos+1] += 1;
+		}
+		RedTransAp *eofTrans = byPos[p]->eofTrans;
+		if ( eofTrans != 0 && eofTrans->targ != 0 && eofTrans->targ->mergePos >= 0 )
+			predStart[eofTrans->targ->mergePos+1] += 1;
+	}
+	for ( int p = 0; p < numStates; p++ )
+		predStart[p+1] += predStart[p];
+
+	int *fill = new int[numStates];
+	memcpy( fill, predStart, sizeof(int) * numStates );
+	preds = new int[predStart[numStates]];
+	for ( int p = 0; p < numStates; p++ ) {
+		for ( RedTransList::Iter rtel = byPos[p]->outRange; rtel.lte(); rtel++ ) {
+			if ( rtel->value->targ != 0 && rtel->value->targ->mergePos >= 0 )
+				preds[fill[rtel->value->targ->mergePos]++] = p;
+		}
+		RedTransAp *eofTrans = byPos[p]->eofTrans;
+		if ( eofTrans != 0 && eofTrans->targ != 0 && eofTrans->targ->mergePos >= 0 )
+			preds[fill[eofTrans->targ->mergePos]++] = p;
+	}
+	delete[] fill;
+
+	/* The first classes split on everything but the transitions. Every state
+	 * starts out marked. Class zero belongs to the error state. */
+	RedStateAp **sorted = new RedStateAp*[numStates];
+	memcpy( sorted, byPos, sizeof(RedStateAp*) * numStates );
+	MergeSort<RedStateAp*, CmpMergeInit> mergeSort;
+	mergeSort.sort( sorted, numStates );
+
+	numClasses = 1;
+	for ( int s = 0; s < numStates; s++ ) {
+		if ( s == 0 || CmpMergeInit::compare( sorted[s-1], sorted[s] ) != 0 ) {
+			classStart[numClasses] = s;
+			classLen[numClasses] = 0;
+			numClasses += 1;
+		}
+
+		int cls = numClasses - 1;
+		sorted[s]->mergeClass = cls;
+		members[s] = sorted[s]->mergePos;
+		where[sorted[s]->mergePos] = s;
+		classLen[cls] += 1;
+	}
+	delete[] sorted;
+
+	for ( int cls = 1; cls < numClasses; cls++ ) {
+		numMarked[cls] = classLen[cls];
+		inWork[cls] = true;
+		work.append( cls );
+	}
+}
+
+MergeClasses::~MergeClasses()
+{
+	delete[] members;
+	delete[] where;
+	delete[] classStart;
+	delete[] classLen;
+	delete[] numMarked;
+	delete[] inWork;
+	delete[] predStart;
+	delete[] preds;
+}
+
+void MergeClasses::mark( int pos )
+{
+	int cls = byPos[pos]->mergeClass;
+	int index = where[pos];
+	int front = classStart[cls] + numMarked[cls];
+	if ( index < front )
+		return;
+
+	/* Swap into the marked part at the front. */
+	members[index] = members[front];
+	where[members[index]] = index;
+	members[front] = pos;
+	where[pos] = front;
+	numMarked[cls] += 1;
+
+	if ( !inWork[cls] ) {
+		inWork[cls] = true;
+		work.append( cls );
+	}
+}
+
+/* Split the marked members of a class from the rest. Marked members that
+ * still go the same way as the unmarked ones stay. If all are marked the
+ * largest group stays. The rest move to new classes and the states that lead
+ * into them are marked. */
+void MergeClasses::split( int cls )
+{
+	int start = classStart[cls];
+	int marked = numMarked[cls];
+	numMarked[cls] = 0;
+
+	RedStateAp **sorted = new RedStateAp*[marked];
+	for ( int m = 0; m < marked; m++ )
+		sorted[m] = byPos[members[start+m]];
+	MergeSort<RedStateAp*, CmpMergeRefine> mergeSort;
+	mergeSort.sort( sorted, marked );
+
+	/* Find the groups before any class changes, the comparisons depend on
+	 * them. */
+	int *groupStart = new int[marked+1];
+	int numGroups = 0;
+	for ( int m = 0; m < marked; m++ ) {
+		if ( m == 0 || CmpMergeRefine::compare( sorted[m-1], sorted[m] ) != 0 )
+			groupStart[numGroups++] = m;
+	}
+	groupStart[numGroups] = marked;
+
+	int stay = -1;
+	if ( marked < classLen[cls] ) {
+		RedStateAp *unmarked = byPos[members[start+marked]];
+		for ( int g = 0; g < numGroups && stay < 0; g++ ) {
+			if ( CmpMergeRefine::compare( sorted[groupStart[g]], unmarked ) == 0 )
+				stay = g;
+		}
+	}
+	else {
+		stay = 0;
+		for ( int g = 1; g < numGroups; g++ ) {
+			if ( groupStart[g+1] - groupStart[g] > groupStart[stay+1] - groupStart[stay] )
+				stay = g;
+		}
+	}
+
+	/* Lay out the groups that move at the front of the class, then those that
+	 * stay. */
+	int next = start, moved = 0;
+	for ( int g = 0; g < numGroups; g++ ) {
+		if ( g == stay )
+			continue;
+
+		int newCls = numClasses++;
+		classStart[newCls] = next;
+		classLen[newCls] = groupStart[g+1] - groupStart[g];
+		numMarked[newCls] = 0;
+		inWork[newCls] = false;
+		for ( int m = groupStart[g]; m < groupStart[g+1]; m++ ) {
+			sorted[m]->mergeClass = newCls;
+			members[next] = sorted[m]->mergePos;
+			where[sorted[m]->mergePos] = next;
+			next += 1;
+		}
+		moved += classLen[newCls];
+	}
+	if ( stay >= 0 ) {
+		for ( int m = groupStart[stay]; m < groupStart[stay+1]; m++ ) {
+			members[next] = sorted[m]->mergePos;
+			where[sorted[m]->mergePos] = next;
+			next += 1;
+		}
+	}
+	classStart[cls] = start + moved;
+	classLen[cls] -= moved;
+
+	/* Marking reorders the members, so go by the sorted groups. */
+	for ( int g = 0; g < numGroups; g++ ) {
+		if ( g == stay )
+			continue;
+		for ( int m = groupStart[g]; m < groupStart[g+1]; m++ ) {
+			int pos = sorted[m]->mergePos;
+			for ( int p = predStart[pos]; p < predStart[pos+1]; p++ )
+				mark( preds[p] );
+		}
+	}
+
+	delete[] groupStart;
+	delete[] sorted;
+}
+
+/* Merge the states that cannot be told apart in the reduced machine. The
+ * frontend minimizes with priorities and its own action tables, which may
+ * still separate states that are the same once reduced. The classes start
+ * out split on everything but the transitions and are split on the classes
+ * of the targets until they stop changing. Each class keeps its lowest id
+ * state. Must be called before defaults and singles are chosen. */
+void RedFsmAp::mergeStates()
+{
+	int numStates = 0;
+	RedStateAp **byPos = new RedStateAp*[stateList.length()];
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		/* The error state is tested for by id and stays apart. */
+		st->mergedInto = 0;
+		if ( st == errState ) {
+			st->mergeClass = 0;
+			st->mergePos = -1;
+		}
+		else {
+			st->mergePos = numStates;
+			byPos[numStates++] = st;
+		}
+	}
+
+	MergeClasses classes( byPos, numStates );
+	while ( classes.work.length() > 0 ) {
+		int cls = classes.work[classes.work.length()-1];
+		classes.work.remove( classes.work.length()-1 );
+		classes.inWork[cls] = false;
+		if ( classes.numMarked[cls] > 0 )
+			classes.split( cls );
+	}
+
+	/* Detach all but the lowest id state of each class. */
+	statesMerged = 0;
+	for ( int cls = 1; cls < classes.numClasses; cls++ ) {
+		int start = classes.classStart[cls], end = start + classes.classLen[cls];
+		RedStateAp *rep = byPos[classes.members[start]];
+		for ( int m = start + 1; m < end; m++ ) {
+			if ( byPos[classes.members[m]]->id < rep->id )
+				rep = byPos[classes.members[m]];
+		}
+
+		for ( int m = start; m < end; m++ ) {
+			RedStateAp *state = byPos[classes.members[m]];
+			if ( state != rep ) {
+				state->mergedInto = rep;
+				stateList.detach( state );
+				statesMerged += 1;
+			}
+		}
+	}
+
+	if ( statesMerged > 0 ) {
+		if ( startState->mergedInto != 0 )
+			startState = startState->mergedInto;
+
+		RedStateSet newEntryPoints;
+		for ( RedStateSet::Iter en = entryPoints; en.lte(); en++ )
+			newEntryPoints.insert( (*en)->mergedInto != 0 ? (*en)->mergedInto : *en );
+		entryPoints.transfer( newEntryPoints );
+
+		mergeTransitions();
+
+		/* Table based machines need the ids dense. Renumbering in id order
+		 * keeps the final states last. */
+		sortByStateId();
+		sequentialStateIds();
+		for ( int s = 0; s < numStates; s++ ) {
+			if ( byPos[s]->mergedInto != 0 )
+				byPos[s]->id = byPos[s]->mergedInto->id;
+		}
+
+		firstFinState = 0;
+		findFirstFinState();
+	}
+
+	delete[] byPos;
+}
+
+/* Point the transitions into merged states at the states that replaced them.
+ * Transitions that become the same are shared and the ids are kept dense. */
+void RedFsmAp::mergeTransitions()
+{
+	int numTrans = nextTransId;
+	RedTransAp **byId = new RedTransAp*[numTrans];
+	RedTransAp **remap = new RedTransAp*[numTrans];
+	memset( byId, 0, sizeof(RedTransAp*) * numTrans );
+	for ( TransApSet::Iter trans = transSet; trans.lte(); trans++ )
+		byId[trans->id] = trans;
+
+	/* Reinsert everything in id order so the first of any duplicates
+	 * survives. */
+	transSet.abandon();
+	for ( int t = 0; t < numTrans; t++ ) {
+		RedTransAp *trans = byId[t];
+		if ( trans == 0 )
+			continue;
+
+		if ( trans->targ != 0 && trans->targ->mergedInto != 0 )
+			trans->targ = trans->targ->mergedInto;
+
+		RedTransAp *lastFound = 0;
+		remap[t] = transSet.insert( trans, &lastFound ) != 0 ? trans : lastFound;
+	}
+
+	/* Neighbouring ranges that now go the same way are joined. */
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		RedTransList outRange;
+		for ( RedTransList::Iter rtel = st->outRange; rtel.lte(); rtel++ ) {
+			RedTransAp *trans = remap[rtel->value->id];
+			if ( outRange.length() > 0 ) {
+				RedTransEl &last = outRange[outRange.length()-1];
+				Key lowKey = rtel->lowKey;
+				lowKey.decrement();
+				if ( last.value == trans && last.highKey == lowKey ) {
+					last.highKey = rtel->highKey;
+					continue;
+				}
+			}
+			outRange.append( RedTransEl( rtel->lowKey, rtel->highKey, trans ) );
+		}
+		st->outRange.transfer( outRange );
+
+		if ( st->eofTrans != 0 )
+			st->eofTrans = remap[st->eofTrans->id];
+	}
+	if ( errTrans != 0 )
+		errTrans = remap[errTrans->id];
+
+	nextTransId = 0;
+	for ( int t = 0; t < numTrans; t++ ) {
+		if ( byId[t] == 0 )
+			continue;
+		if ( remap[t] != byId[t] )
+			delete byId[t];
+		else
+			byId[t]->id = nextTransId++;
+	}
+
+	delete[] byId;
+	delete[] remap;
+}
+
 void RedFsmAp::assignActionLocs()
 {
 	int nextLocation = 0;
@@ -284,6 +829,245 @@ void RedFsmAp::chooseSingle()
 	}
 }
 
+/* A state links a literal if, apart from its default, it takes a single key
+ * and no actions. */
+bool RedFsmAp::literalLink( RedStateAp *state )
+{
+	return state != errState && state->stateCondVect.length() == 0 &&
+			state->outSingle.length() == 1 && state->outRange.length() == 0 &&
+			state->defTrans != 0 && state->outSingle[0].value->action == 0;
+}
+
+/* Find the runs of linked states that are worth matching as one literal. A
+ * run starts at a link that no other link leads to. Matching skips the states
+ * inside the run, so they cannot have state actions. */
+void RedFsmAp::findLiteralRuns()
+{
+	bool *linkTarg = new bool[nextStateId];
+	memset( linkTarg, 0, sizeof(bool) * nextStateId );
+
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		st->literalLen = 0;
+		st->literalTarg = 0;
+		if ( literalLink( st ) )
+			linkTarg[st->outSingle[0].value->targ->id] = true;
+	}
+
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		if ( !literalLink( st ) || linkTarg[st->id] )
+			continue;
+
+		RedStateAp *run[MAX_LITERAL_RUN];
+		int len = 0;
+		RedStateAp *cur = st;
+		while ( len < MAX_LITERAL_RUN && literalLink( cur ) ) {
+			if ( len > 0 && ( cur->toStateAction != 0 || cur->fromStateAction != 0 ) )
+				break;
+
+			/* Stop where the links loop back into the run. */
+			bool inRun = false;
+			for ( int i = 0; i < len; i++ ) {
+				if ( run[i] == cur )
+					inRun = true;
+			}
+			if ( inRun )
+				break;
+
+			run[len++] = cur;
+			cur = cur->outSingle[0].value->targ;
+		}
+
+		if ( len >= MIN_LITERAL_RUN ) {
+			st->literalLen = len;
+			st->literalTarg = cur;
+		}
+	}
+
+	delete[] linkTarg;
+}
+
+/* Find the states that loop on themselves over a wide set of keys with no
+ * actions. The keys leaving the loop are kept as ranges so generated code
+ * can search for them. Skipping the loop passes over the state's entries,
+ * so states with state actions are left alone. Runs after the default
+ * transitions are chosen and before the singles are taken out, while the
+ * ranges are ordered and apart. */
+void RedFsmAp::findSkipLoops()
+{
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		if ( st == errState || st->stateCondVect.length() > 0 ||
+				st->toStateAction != 0 || st->fromStateAction != 0 )
+			continue;
+
+		/* Walk the alphabet as the ranges and the gaps between them, which
+		 * take the default transition. */
+		Size numLoop = 0;
+		int ranges = 0;
+		Key low[MAX_SKIP_RANGES], high[MAX_SKIP_RANGES];
+		Key next = keyOps->minKey;
+		bool atEnd = false;
+		for ( int r = 0; r <= st->outRange.length() && !atEnd && 
+				ranges <= MAX_SKIP_RANGES; r++ )
+		{
+			/* Each range takes two segments, the gap before it and itself. */
+			for ( int seg = 0; seg < 2 && !atEnd; seg++ ) {
+				Key segLow = next, segHigh;
+				RedTransAp *trans;
+				if ( seg == 0 ) {
+					if ( r == st->outRange.length() )
+						segHigh = keyOps->maxKey;
+					else if ( st->outRange[r].lowKey == next )
+						continue;
+					else {
+						segHigh = st->outRange[r].lowKey;
+						segHigh.decrement();
+					}
+					trans = st->defTrans;
+				}
+				else {
+					if ( r == st->outRange.length() )
+						break;
+					segHigh = st->outRange[r].highKey;
+					trans = st->outRange[r].value;
+				}
+
+				if ( segHigh == keyOps->maxKey )
+					atEnd = true;
+				else {
+					next = segHigh;
+					next.increment();
+				}
+
+				if ( trans != 0 && trans->targ == st && trans->action == 0 )
+					numLoop += keyOps->span( segLow, segHigh );
+				else if ( ranges > 0 && keyOps->span( high[ranges-1], segLow ) == 2 )
+					high[ranges-1] = segHigh;
+				else if ( ranges == MAX_SKIP_RANGES ) {
+					ranges += 1;
+					break;
+				}
+				else {
+					low[ranges] = segLow;
+					high[ranges] = segHigh;
+					ranges += 1;
+				}
+			}
+		}
+
+		if ( numLoop >= MIN_SKIP_KEYS && ranges > 0 && ranges <= MAX_SKIP_RANGES ) {
+			numSkipLoops += 1;
+			st->skipRanges = ranges;
+			st->skipLoopKeys = numLoop;
+			for ( int r = 0; r < ranges; r++ ) {
+				st->skipLow[r] = low[r];
+				st->skipHigh[r] = high[r];
+			}
+		}
+	}
+}
+
+/* Move the keys of trans out of the singles and ranges into the bitmap. */
+void RedFsmAp::makeBitmap( RedStateAp *state, RedTransAp *trans )
+{
+	RedTransList outSingle, outRange;
+	for ( RedTransList::Iter el = state->outSingle; el.lte(); el++ ) {
+		if ( el->value == trans )
+			state->bitmapList.append( *el );
+		else
+			outSingle.append( *el );
+	}
+	for ( RedTransList::Iter el = state->outRange; el.lte(); el++ ) {
+		if ( el->value == trans )
+			state->bitmapList.append( *el );
+		else
+			outRange.append( *el );
+	}
+	state->outSingle.transfer( outSingle );
+	state->outRange.transfer( outRange );
+
+	Key low = state->bitmapList[0].lowKey, high = state->bitmapList[0].highKey;
+	for ( RedTransList::Iter el = state->bitmapList; el.lte(); el++ ) {
+		if ( el->lowKey < low )
+			low = el->lowKey;
+		if ( el->highKey > high )
+			high = el->highKey;
+	}
+
+	state->keyTest = KeyTestBitmap;
+	state->bitmapTrans = trans;
+	state->bitmapLow = low;
+	state->bitmapSpan = keyOps->span( low, high );
+	if ( state->bitmapSpan > BITMAP_WORD_BITS ) {
+		state->bitmapOffset = bitmapLen;
+		bitmapLen += ( state->bitmapSpan + 7 ) / 8;
+	}
+}
+
+/* Scattered keys make deep search trees in the goto styles. Where one
+ * transition takes many keys within a short span, test them with a bitmap.
+ * Where many transitions share a short span, switch on the key so the
+ * compiler can use a jump table. The singles and ranges left over are
+ * searched as before. Ranges may run over singles, which are tested first,
+ * so the bitmap goes after the singles and before the ranges. */
+void RedFsmAp::chooseKeyTests()
+{
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		if ( st == errState || st->stateCondVect.length() > 0 )
+			continue;
+
+		RedTransList els;
+		els.append( st->outSingle.data, st->outSingle.length() );
+		els.append( st->outRange.data, st->outRange.length() );
+		if ( els.length() < MIN_BITMAP_ELEMENTS )
+			continue;
+
+		/* The transition on the most elements and the span of its keys. */
+		RedTransAp *most = 0;
+		int mostEls = 0;
+		Key lowest = els[0].lowKey, highest = els[0].highKey;
+		for ( int i = 0; i < els.length(); i++ ) {
+			if ( els[i].lowKey < lowest )
+				lowest = els[i].lowKey;
+			if ( els[i].highKey > highest )
+				highest = els[i].highKey;
+
+			int n = 0;
+			for ( int j = 0; j < els.length(); j++ ) {
+				if ( els[j].value == els[i].value )
+					n += 1;
+			}
+			if ( n > mostEls ) {
+				most = els[i].value;
+				mostEls = n;
+			}
+		}
+
+		Key low = els[0].lowKey, high = els[0].highKey;
+		bool first = true;
+		for ( int i = 0; i < els.length(); i++ ) {
+			if ( els[i].value == most ) {
+				if ( first || els[i].lowKey < low )
+					low = els[i].lowKey;
+				if ( first || els[i].highKey > high )
+					high = els[i].highKey;
+				first = false;
+			}
+		}
+
+		bool bitmapFits = keyOps->alphType->size <= sizeof(int) &&
+				mostEls >= MIN_BITMAP_ELEMENTS &&
+				keyOps->span( low, high ) <= MAX_BITMAP_SPAN;
+
+		if ( bitmapFits && els.length() - mostEls <= 2 )
+			makeBitmap( st, most );
+		else if ( els.length() >= MIN_JUMP_ELEMENTS && 
+				keyOps->span( lowest, highest ) <= MAX_JUMP_KEYS )
+			st->keyTest = KeyTestJump;
+		else if ( bitmapFits )
+			makeBitmap( st, most );
+	}
+}
+
 void RedFsmAp::makeFlat()
 {
 	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
@@ -337,6 +1121,514 @@ void RedFsmAp::makeFlat()
 }
 
 
+struct CombRow
+{
+	RedStateAp *state;
+	unsigned long long first, span;
+	long numEntries;
+};
+
+/* Rows with more entries go first, ties by state id. */
+struct CmpCombRow
+{
+	static int compare( const CombRow &r1, const CombRow &r2 )
+	{
+		if ( r1.numEntries > r2.numEntries )
+			return -1;
+		else if ( r1.numEntries < r2.numEntries )
+			return 1;
+		else if ( r1.state->id < r2.state->id )
+			return -1;
+		else if ( r1.state->id > r2.state->id )
+			return 1;
+		return 0;
+	}
+};
+
+/* Pack the flat transition lists into one table by row displacement. Keys
+ * outside a state's row take the state's default transition. Inside the row
+ * only the entries that differ from the most common transition of the row
+ * are stored, the rest fall back to that transition. Each row is placed at
+ * the lowest base where all of its entries land on free slots. Must be called
+ * after makeFlat. */
+void RedFsmAp::makeComb()
+{
+	combTrans.empty();
+	combCheck.empty();
+	maxCombBase = 0;
+
+	int *transCount = new int[transSet.length()];
+	memset( transCount, 0, sizeof(int) * transSet.length() );
+
+	CombRow *rows = new CombRow[stateList.length()];
+	int numRows = 0;
+	long tableLen = 0;
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		/* The empty key range sends every key to the default. */
+		st->combLowKey = 1;
+		st->combHighKey = 0;
+		st->combBase = 0;
+		st->combDefTrans = st->defTrans;
+
+		if ( st->transList == 0 )
+			continue;
+
+		/* Trim the entries that go to the default from both ends. */
+		unsigned long long span = keyOps->span( st->lowKey, st->highKey );
+		unsigned long long first = 0, last = span;
+		while ( first < span && st->transList[first] == st->defTrans )
+			first += 1;
+		while ( last > first && st->transList[last-1] == st->defTrans )
+			last -= 1;
+
+		if ( first == last )
+			continue;
+
+		st->combLowKey = st->lowKey + Key( (long)first );
+		st->combHighKey = st->lowKey + Key( (long)last - 1 );
+
+		/* Find the most common transition in the row. */
+		int maxCount = 0;
+		for ( unsigned long long pos = first; pos < last; pos++ ) {
+			RedTransAp *trans = st->transList[pos];
+			int count = ++transCount[trans->id];
+			if ( count > maxCount ) {
+				maxCount = count;
+				st->combDefTrans = trans;
+			}
+		}
+		for ( unsigned long long pos = first; pos < last; pos++ )
+			transCount[st->transList[pos]->id] = 0;
+
+		CombRow &row = rows[numRows++];
+		row.state = st;
+		row.first = first;
+		row.span = last - first;
+		row.numEntries = row.span - maxCount;
+
+		/* Every key in the row is looked up in the table, so it must
+		 * cover rows even where they have no entries. */
+		if ( (long)row.span > tableLen )
+			tableLen = row.span;
+	}
+
+	MergeSort<CombRow, CmpCombRow> mergeSort;
+	mergeSort.sort( rows, numRows );
+
+	/* Slots below this are all taken. */
+	long firstFree = 0;
+	for ( int r = 0; r < numRows && rows[r].numEntries > 0; r++ ) {
+		RedStateAp *st = rows[r].state;
+		RedTransAp **entries = st->transList + rows[r].first;
+		long span = (long)rows[r].span;
+
+		/* The first entry must land on a free slot. */
+		long lead = 0;
+		while ( entries[lead] == st->combDefTrans )
+			lead += 1;
+
+		long base = firstFree > lead ? firstFree - lead : 0;
+		while ( true ) {
+			bool fits = true;
+			for ( long pos = lead; pos < span; pos++ ) {
+				if ( base + pos >= combCheck.length() )
+					break;
+				if ( entries[pos] != st->combDefTrans && combCheck[base + pos] != 0 ) {
+					fits = false;
+					break;
+				}
+			}
+			if ( fits )
+				break;
+			base += 1;
+		}
+
+		/* Grow the table to cover the row. */
+		while ( combCheck.length() < base + span ) {
+			combTrans.append( 0 );
+			combCheck.append( 0 );
+		}
+
+		for ( long pos = lead; pos < span; pos++ ) {
+			if ( entries[pos] != st->combDefTrans ) {
+				combTrans[base + pos] = entries[pos];
+				combCheck[base + pos] = st;
+			}
+		}
+
+		st->combBase = base;
+		if ( base > maxCombBase )
+			maxCombBase = base;
+
+		while ( firstFree < combCheck.length() && combCheck[firstFree] != 0 )
+			firstFree += 1;
+	}
+
+	/* Rows without entries sit at base zero. */
+	while ( combCheck.length() < tableLen ) {
+		combTrans.append( 0 );
+		combCheck.append( 0 );
+	}
+
+	delete[] rows;
+	delete[] transCount;
+}
+
+struct CmpFlatPage
+{
+	static int compare( RedTransAp **p1, RedTransAp **p2 )
+		{ return memcmp( p1, p2, sizeof(RedTransAp*) * FLAT_PAGE_SIZE ); }
+};
+
+/* Split the flat transition lists into pages. Pages with the same
+ * transitions, such as runs of the default, are stored once. The last page of
+ * a list is padded with the default so it can match the others. Must be
+ * called after makeFlat. */
+void RedFsmAp::makePages()
+{
+	pageTrans.empty();
+	pageDir.empty();
+	maxPageDirOffset = 0;
+	maxPageStart = 0;
+
+	BstMap< RedTransAp**, int, CmpFlatPage > pageMap;
+	Vector<RedTransAp**> pages;
+
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		st->pageDirOffset = pageDir.length();
+		if ( st->transList == 0 )
+			continue;
+
+		if ( st->pageDirOffset > maxPageDirOffset )
+			maxPageDirOffset = st->pageDirOffset;
+
+		unsigned long long span = keyOps->span( st->lowKey, st->highKey );
+		RedTransAp *pad = st->defTrans != 0 ? st->defTrans : st->transList[span-1];
+		for ( unsigned long long first = 0; first < span; first += FLAT_PAGE_SIZE ) {
+			RedTransAp **page = new RedTransAp*[FLAT_PAGE_SIZE];
+			for ( unsigned long long pos = 0; pos < FLAT_PAGE_SIZE; pos++ ) {
+				page[pos] = first + pos < span ? 
+						st->transList[first + pos] : pad;
+			}
+
+			BstMapEl<RedTransAp**, int> *stored = pageMap.find( page );
+			if ( stored != 0 )
+				delete[] page;
+			else {
+				stored = pageMap.insert( page, pageTrans.length() );
+				pageTrans.append( page, FLAT_PAGE_SIZE );
+				pages.append( page );
+			}
+
+			pageDir.append( stored->value );
+			if ( stored->value > maxPageStart )
+				maxPageStart = stored->value;
+		}
+	}
+
+	for ( int i = 0; i < pages.length(); i++ )
+		delete[] pages[i];
+}
+
+/* Build the next state table of the lockstep driver. A transition that runs
+ * actions, enters a state with to-state actions, leaves one with from-state
+ * actions or goes to the error state stops the stream, so that the exec can
+ * take it. Keys that every state sends to the same entry share a class. */
+void RedFsmAp::makeMulti()
+{
+	Size alphSize = keyOps->alphSize();
+	int numStates = stateList.length();
+	multiStop = numStates;
+
+	int *rows = new int[numStates * alphSize];
+	RedTransAp **keyTrans = new RedTransAp*[alphSize];
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		/* The transition of each key, in the order the exec tests them:
+		 * singles go over the bitmap, which goes over the ranges. */
+		for ( Size k = 0; k < alphSize; k++ )
+			keyTrans[k] = st->defTrans;
+		Key key = keyOps->minKey;
+		for ( Size k = 0; k < alphSize; k++, key.increment() ) {
+			Key listKey = anyClasses() ? Key( classOf( key ) ) : key;
+
+			for ( RedTransList::Iter el = st->outRange; el.lte(); el++ ) {
+				if ( el->lowKey <= listKey && listKey <= el->highKey )
+					keyTrans[k] = el->value;
+			}
+			for ( RedTransList::Iter el = st->bitmapList; el.lte(); el++ ) {
+				if ( el->lowKey <= listKey && listKey <= el->highKey )
+					keyTrans[k] = el->value;
+			}
+			for ( RedTransList::Iter el = st->outSingle; el.lte(); el++ ) {
+				if ( el->lowKey == listKey )
+					keyTrans[k] = el->value;
+			}
+		}
+
+		int *row = rows + st->id * alphSize;
+		for ( Size k = 0; k < alphSize; k++ ) {
+			RedTransAp *trans = keyTrans[k];
+			if ( st->fromStateAction != 0 || trans == 0 || trans->targ == 0 ||
+					trans->targ == errState || trans->action != 0 ||
+					trans->targ->toStateAction != 0 )
+				row[k] = multiStop;
+			else
+				row[k] = trans->targ->id;
+		}
+	}
+
+	/* Classify the keys by their columns. */
+	Vector<Size> firstKey;
+	multiClassMap.empty();
+	for ( Size k = 0; k < alphSize; k++ ) {
+		int c = 0;
+		while ( c < firstKey.length() ) {
+			int s = 0;
+			while ( s < numStates && rows[s * alphSize + k] == 
+					rows[s * alphSize + firstKey[c]] )
+				s += 1;
+			if ( s == numStates )
+				break;
+			c += 1;
+		}
+		if ( c == firstKey.length() )
+			firstKey.append( k );
+		multiClassMap.append( c );
+	}
+
+	numMultiClasses = firstKey.length();
+	multiNext.empty();
+	for ( int s = 0; s < numStates; s++ ) {
+		for ( int c = 0; c < numMultiClasses; c++ )
+			multiNext.append( rows[s * alphSize + firstKey[c]] );
+	}
+
+	delete[] keyTrans;
+	delete[] rows;
+}
+
+/* Build the pair style's tables for a machine without actions or
+ * conditions. With no actions the only transitions the lockstep table stops
+ * at lead to the error state, so the error state takes their place. The pair
+ * table then holds the state after each pair of key classes. Leaves the
+ * tables empty if the pair table would be too large. */
+void RedFsmAp::makePairs()
+{
+	pairSingle.empty();
+	pairNext.empty();
+
+	makeMulti();
+
+	int numStates = stateList.length();
+	int numClasses = numMultiClasses;
+	if ( (long long)numStates * numClasses * numClasses > MAX_PAIR_ENTRIES )
+		return;
+
+	for ( int pos = 0; pos < multiNext.length(); pos++ ) {
+		int targ = multiNext[pos];
+		if ( targ == multiStop ) {
+			/* Without an error state there is nowhere to go. */
+			if ( errState == 0 ) {
+				pairSingle.empty();
+				return;
+			}
+			targ = errState->id;
+		}
+		pairSingle.append( targ );
+	}
+
+	int numPairs = numClasses * numClasses;
+	for ( int s = 0; s < numStates; s++ ) {
+		for ( int c1 = 0; c1 < numClasses; c1++ ) {
+			int mid = pairSingle[s * numClasses + c1];
+			for ( int c2 = 0; c2 < numClasses; c2++ )
+				pairNext.append( pairSingle[mid * numClasses + c2] * numPairs );
+		}
+	}
+}
+
+/* Find the transition the state takes on the interval starting at the given
+ * key offset. The position in the range list only moves forward, so walking
+ * the intervals in order walks the list once. */
+static RedTransAp *intervalTrans( RedTransList &outRange, int &pos, Size offset )
+{
+	while ( pos < outRange.length() &&
+			keyOps->span( keyOps->minKey, outRange[pos].highKey ) - 1 < offset )
+		pos += 1;
+
+	if ( pos < outRange.length() &&
+			keyOps->span( keyOps->minKey, outRange[pos].lowKey ) - 1 <= offset )
+		return outRange[pos].value;
+	return 0;
+}
+
+/* Partition the alphabet into the coarsest set of classes such that no state
+ * distinguishes between two keys of the same class, then rewrite the out
+ * ranges in terms of class ids. Must be called before the default
+ * transitions are chosen. */
+void RedFsmAp::makeClasses()
+{
+	Size alphSize = keyOps->alphSize();
+
+	/* Cut the alphabet wherever a range starts or stops. Keys between two
+	 * cuts are never distinguished. */
+	Vector<Size> cutList;
+	cutList.append( 0 );
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		for ( RedTransList::Iter rtel = st->outRange; rtel.lte(); rtel++ ) {
+			cutList.append( keyOps->span( keyOps->minKey, rtel->lowKey ) - 1 );
+			Size end = keyOps->span( keyOps->minKey, rtel->highKey );
+			if ( end < alphSize )
+				cutList.append( end );
+		}
+	}
+
+	MergeSort<Size, CmpOrd<Size> > mergeSort;
+	mergeSort.sort( cutList.data, cutList.length() );
+
+	Size *cuts = new Size[cutList.length()];
+	int numCuts = 0;
+	for ( int i = 0; i < cutList.length(); i++ ) {
+		if ( numCuts == 0 || cuts[numCuts-1] != cutList[i] )
+			cuts[numCuts++] = cutList[i];
+	}
+
+	/* Refine the classes of the intervals one state at a time. The first
+	 * transition seen in a class keeps the class, any other splits off a new
+	 * one. A null transition stands for a gap. */
+	int *cls = new int[numCuts];
+	memset( cls, 0, sizeof(int) * numCuts );
+	int nextClass = 1;
+
+	RedStateAp **seenIn = new RedStateAp*[numCuts];
+	RedTransAp **firstTrans = new RedTransAp*[numCuts];
+	memset( seenIn, 0, sizeof(RedStateAp*) * numCuts );
+
+	long long noTrans = nextTransId;
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		BstMap< long long, int, CmpOrd<long long> > splits;
+		int pos = 0;
+		for ( int i = 0; i < numCuts; i++ ) {
+			RedTransAp *trans = intervalTrans( st->outRange, pos, cuts[i] );
+			int c = cls[i];
+			if ( seenIn[c] != st ) {
+				seenIn[c] = st;
+				firstTrans[c] = trans;
+			}
+			else if ( firstTrans[c] != trans ) {
+				long long splitKey = (long long)c * ( noTrans + 1 ) + 
+						( trans != 0 ? trans->id : noTrans );
+				BstMapEl<long long, int> *split = splits.find( splitKey );
+				if ( split == 0 )
+					split = splits.insert( splitKey, nextClass++ );
+				cls[i] = split->value;
+			}
+		}
+	}
+
+	delete[] seenIn;
+	delete[] firstTrans;
+
+	/* Number the classes in order of their lowest key. */
+	int *classId = new int[nextClass];
+	for ( int c = 0; c < nextClass; c++ )
+		classId[c] = -1;
+	numClasses = 0;
+	for ( int i = 0; i < numCuts; i++ ) {
+		if ( classId[cls[i]] < 0 )
+			classId[cls[i]] = numClasses++;
+		cls[i] = classId[cls[i]];
+	}
+	delete[] classId;
+
+	/* Rewrite the out ranges over class ids. */
+	RedTransAp **classTrans = new RedTransAp*[numClasses];
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
+		memset( classTrans, 0, sizeof(RedTransAp*) * numClasses );
+		int pos = 0;
+		for ( int i = 0; i < numCuts; i++ )
+			classTrans[cls[i]] = intervalTrans( st->outRange, pos, cuts[i] );
+
+		RedTransList outRange;
+		for ( int c = 0; c < numClasses; c++ ) {
+			if ( classTrans[c] == 0 )
+				continue;
+			if ( outRange.length() > 0 && outRange[outRange.length()-1].value == classTrans[c] &&
+					outRange[outRange.length()-1].highKey.getVal() == c - 1 )
+				outRange[outRange.length()-1].highKey = c;
+			else
+				outRange.append( RedTransEl( c, c, classTrans[c] ) );
+		}
+		st->outRange.transfer( outRange );
+	}
+	delete[] classTrans;
+
+	classLowKey = keyOps->minKey;
+	makeClassMap( alphSize, cuts, numCuts, cls );
+
+	delete[] cuts;
+	delete[] cls;
+}
+
+/* Find the class of a key. */
+int RedFsmAp::classOf( Key key )
+{
+	Size offset = keyOps->span( classLowKey, key ) - 1;
+	if ( classPages.length() == 0 )
+		return classMap[offset];
+	return classMap[classPages[offset >> CLASS_PAGE_BITS] + 
+			( offset & ( CLASS_PAGE_SIZE - 1 ) )];
+}
+
+/* Expand the classes of the intervals into the map from key offset to class.
+ * Wide alphabets are split into pages and pages with the same contents are
+ * stored once. */
+void RedFsmAp::makeClassMap( Size alphSize, Size *cuts, int numCuts, int *cls )
+{
+	int *full = new int[alphSize];
+	for ( int i = 0; i < numCuts; i++ ) {
+		Size end = i+1 < numCuts ? cuts[i+1] : alphSize;
+		for ( Size off = cuts[i]; off < end; off++ )
+			full[off] = cls[i];
+	}
+
+	classMap.empty();
+	classPages.empty();
+	maxClassPage = 0;
+
+	if ( alphSize <= CLASS_PAGE_SIZE )
+		classMap.append( full, alphSize );
+	else {
+		int numPages = (int)( ( alphSize + CLASS_PAGE_SIZE - 1 ) / CLASS_PAGE_SIZE );
+		for ( int page = 0; page < numPages; page++ ) {
+			int *data = full + page * CLASS_PAGE_SIZE;
+			int len = (int)( alphSize - page * CLASS_PAGE_SIZE );
+			if ( len > CLASS_PAGE_SIZE )
+				len = CLASS_PAGE_SIZE;
+
+			/* Look for an identical page already stored. */
+			int start = -1;
+			for ( int p = 0; p < page && start < 0; p++ ) {
+				int pstart = classPages[p];
+				if ( pstart + len <= classMap.length() && 
+						memcmp( classMap.data + pstart, data, sizeof(int) * len ) == 0 )
+					start = pstart;
+			}
+
+			if ( start < 0 ) {
+				start = classMap.length();
+				classMap.append( data, len );
+			}
+
+			classPages.append( start );
+			if ( start > maxClassPage )
+				maxClassPage = start;
+		}
+	}
+
+	delete[] full;
+}
+
 /* A default transition has been picked, move it from the outRange to the
  * default pointer. */
 void RedFsmAp::moveToDefault( RedTransAp *defTrans, RedStateAp *state )
@@ -365,8 +1657,14 @@ bool RedFsmAp::alphabetCovered( RedTransList &outRange )
 
 	/* If the first range doesn't start at the the lower bound then the
 	 * alphabet is not covered. */
+	Key minKey = keyOps->minKey, maxKey = keyOps->maxKey;
+	if ( anyClasses() ) {
+		minKey = 0;
+		maxKey = numClasses - 1;
+	}
+
 	RedTransList::Iter rtel = outRange;
-	if ( keyOps->minKey < rtel->lowKey )
+	if ( minKey < rtel->lowKey )
 		return false;
 
 	/* Check that every range is next to the previous one. */
@@ -380,7 +1678,7 @@ bool RedFsmAp::alphabetCovered( RedTransList &outRange )
 
 	/* The last must extend to the upper bound. */
 	RedTransEl *last = &outRange[outRange.length()-1];
-	if ( last->highKey < keyOps->maxKey )
+	if ( last->highKey < maxKey )
 		return false;
 
 	return true;
@@ -396,26 +1694,36 @@ RedTransAp *RedFsmAp::chooseDefaultSpan( RedStateAp *state )
 	/* For each transition in the find how many alphabet characters the
 	 * transition spans. */
 	unsigned long long *span = new unsigned long long[stateTransSet.length()];
+	long long *traffic = new long long[stateTransSet.length()];
 	memset( span, 0, sizeof(unsigned long long) * stateTransSet.length() );
+	memset( traffic, 0, sizeof(long long) * stateTransSet.length() );
 	for ( RedTransList::Iter rtel = state->outRange; rtel.lte(); rtel++ ) {
 		/* Lookup the transition in the set. */
 		RedTransAp **inSet = stateTransSet.find( rtel->value );
 		int pos = inSet - stateTransSet.data;
 		span[pos] += keyOps->span( rtel->lowKey, rtel->highKey );
+		traffic[pos] += rtel->profCount;
 	}
 
-	/* Find the max span, choose it for making the default. */
-	RedTransAp *maxTrans = 0;
-	unsigned long long maxSpan = 0;
+	/* Find the max span, choose it for making the default. The default is
+	 * only found after every other test fails, so a transition carrying most
+	 * of the state's profiled traffic is passed over if there is another. */
+	RedTransAp *maxTrans = 0, *maxColdTrans = 0;
+	unsigned long long maxSpan = 0, maxColdSpan = 0;
 	for ( RedTransSet::Iter rtel = stateTransSet; rtel.lte(); rtel++ ) {
 		if ( span[rtel.pos()] > maxSpan ) {
 			maxSpan = span[rtel.pos()];
 			maxTrans = *rtel;
 		}
+		if ( traffic[rtel.pos()] * 2 <= state->profVisits && span[rtel.pos()] > maxColdSpan ) {
+			maxColdSpan = span[rtel.pos()];
+			maxColdTrans = *rtel;
+		}
 	}
 
 	delete[] span;
-	return maxTrans;
+	delete[] traffic;
+	return maxColdTrans != 0 ? maxColdTrans : maxTrans;
 }
 
 /* Pick default transitions from ranges for the states. */
@@ -540,28 +1848,386 @@ RedTransAp *RedFsmAp::allocateTrans( RedStateAp *targ, RedAction *action )
 	return inDict;
 }
 
-void RedFsmAp::partitionFsm( int nparts )
+/* Transition between two states, for partitioning. */
+struct PartEdge
 {
-	/* At this point the states are ordered by a depth-first traversal. We
-	 * will allocate to partitions based on this ordering. */
-	this->nParts = nparts;
-	int partSize = stateList.length() / nparts;
-	int remainder = stateList.length() % nparts;
-	int numInPart = partSize;
-	int partition = 0;
-	if ( remainder-- > 0 )
-		numInPart += 1;
-	for ( RedStateList::Iter st = stateList; st.lte(); st++ ) {
-		st->partition = partition;
+	int from, targ;
+	long long hits;
+	long long weight;
+};
+
+/* Element of the heap of states waiting to join a growing partition. */
+struct PartCand
+{
+	long long conn;
+	int id;
+};
+
+/* Graph of the states for partitioning. The edges are kept in both
+ * directions, as whether an edge is cut does not depend on its direction. */
+struct PartGraph
+{
+	PartGraph( RedFsmAp *redFsm, int nparts );
+	~PartGraph();
+
+	void chunkOrdering( int *part );
+	void growRegions( int *part );
+	void refine( int *part );
+	long long cut( int *part, bool weighted );
+
+	void pushCand( long long conn, int id );
+	PartCand popCand();
+
+	RedFsmAp *redFsm;
+	int nparts, numStates;
+	bool profiled;
+
+	Vector<PartEdge> edges;
+	long long *inDegree;
+
+	/* Code written for a state grows with its transitions. Partitions are
+	 * balanced on this rather than on the number of states. */
+	long long *weight;
+	long long totalWeight, minWeight, maxWeight;
 
-		numInPart -= 1;
-		if ( numInPart == 0 ) {
+	int *adjStart, *adjTarg;
+	long long *adjWeight;
+
+	Vector<PartCand> heap;
+};
+
+PartGraph::PartGraph( RedFsmAp *redFsm, int nparts )
+:
+	redFsm(redFsm),
+	nparts(nparts),
+	numStates(redFsm->nextStateId),
+	profiled(redFsm->anyProfile()),
+	totalWeight(0)
+{
+	inDegree = new long long[numStates];
+	weight = new long long[numStates];
+	memset( inDegree, 0, sizeof(long long) * numStates );
+
+	long long heaviest = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		weight[st->id] = 1 + st->outSingle.length() + st->outRange.length();
+		totalWeight += weight[st->id];
+		if ( weight[st->id] > heaviest )
+			heaviest = weight[st->id];
+
+		/* Every transition the state writes, with the keys that took it in
+		 * the profile. The default takes what the listed ones did not. */
+		long long listed = 0;
+		RedTransList *lists[2] = { &st->outSingle, &st->outRange };
+		for ( int l = 0; l < 2; l++ ) {
+			for ( RedTransList::Iter rtel = *lists[l]; rtel.lte(); rtel++ ) {
+				listed += rtel->profCount;
+				if ( rtel->value->targ != 0 ) {
+					PartEdge edge = { st->id, rtel->value->targ->id, rtel->profCount, 0 };
+					edges.append( edge );
+				}
+			}
+		}
+		if ( st->defTrans != 0 && st->defTrans->targ != 0 ) {
+			long long rest = st->profVisits - listed;
+			PartEdge edge = { st->id, st->defTrans->targ->id, rest > 0 ? rest : 0, 0 };
+			edges.append( edge );
+		}
+	}
+
+	/* Partitions may drift up to a tenth from an even share, plus the state
+	 * that tips them over. */
+	maxWeight = totalWeight * 11 / ( nparts * 10 ) + heaviest;
+	minWeight = totalWeight * 9 / ( nparts * 10 ) - heaviest;
+
+	/* With a profile a transition weighs one plus the keys that took it.
+	 * Without one it weighs the in-degree of the state it goes to, as states
+	 * with many ways in, such as the start state of a scanner, are entered
+	 * most often. */
+	for ( int e = 0; e < edges.length(); e++ )
+		inDegree[edges[e].targ] += 1;
+	for ( int e = 0; e < edges.length(); e++ ) {
+		PartEdge &edge = edges[e];
+		if ( profiled )
+			edge.weight = 1 + edge.hits;
+		else
+			edge.weight = inDegree[edge.targ];
+	}
+
+	adjStart = new int[numStates+1];
+	memset( adjStart, 0, sizeof(int) * (numStates+1) );
+	for ( int e = 0; e < edges.length(); e++ ) {
+		if ( edges[e].from != edges[e].targ ) {
+			adjStart[edges[e].from+1] += 1;
+			adjStart[edges[e].targ+1] += 1;
+		}
+	}
+	for ( int i = 0; i < numStates; i++ )
+		adjStart[i+1] += adjStart[i];
+
+	adjTarg = new int[adjStart[numStates]];
+	adjWeight = new long long[adjStart[numStates]];
+	int *fill = new int[numStates];
+	memcpy( fill, adjStart, sizeof(int) * numStates );
+	for ( int e = 0; e < edges.length(); e++ ) {
+		const PartEdge &edge = edges[e];
+		if ( edge.from != edge.targ ) {
+			adjTarg[fill[edge.from]] = edge.targ;
+			adjWeight[fill[edge.from]++] = edge.weight;
+			adjTarg[fill[edge.targ]] = edge.from;
+			adjWeight[fill[edge.targ]++] = edge.weight;
+		}
+	}
+	delete[] fill;
+}
+
+PartGraph::~PartGraph()
+{
+	delete[] inDegree;
+	delete[] weight;
+	delete[] adjStart;
+	delete[] adjTarg;
+	delete[] adjWeight;
+}
+
+/* Cut the state ordering, which keeps depth-first neighbours together, into
+ * runs of about equal weight. No partition is left empty while states
+ * remain. */
+void PartGraph::chunkOrdering( int *part )
+{
+	int partition = 0, position = 0;
+	long long sofar = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++, position++ ) {
+		part[st->id] = partition;
+		sofar += weight[st->id];
+
+		int statesLeft = redFsm->stateList.length() - position - 1;
+		if ( partition < nparts - 1 && ( sofar * nparts >= (partition + 1) * totalWeight ||
+				statesLeft <= nparts - 1 - partition ) )
 			partition += 1;
-			numInPart = partSize;
-			if ( remainder-- > 0 )
-				numInPart += 1;
+	}
+}
+
+void PartGraph::pushCand( long long conn, int id )
+{
+	PartCand cand = { conn, id };
+	heap.append( cand );
+	int pos = heap.length() - 1;
+	while ( pos > 0 && heap[(pos-1)/2].conn < heap[pos].conn ) {
+		PartCand tmp = heap[pos];
+		heap[pos] = heap[(pos-1)/2];
+		heap[(pos-1)/2] = tmp;
+		pos = (pos-1)/2;
+	}
+}
+
+PartCand PartGraph::popCand()
+{
+	PartCand top = heap[0];
+	heap[0] = heap[heap.length()-1];
+	heap.remove( heap.length()-1 );
+
+	int pos = 0;
+	while ( true ) {
+		int child = pos * 2 + 1;
+		if ( child >= heap.length() )
+			break;
+		if ( child + 1 < heap.length() && heap[child+1].conn > heap[child].conn )
+			child += 1;
+		if ( heap[pos].conn >= heap[child].conn )
+			break;
+		PartCand tmp = heap[pos];
+		heap[pos] = heap[child];
+		heap[child] = tmp;
+		pos = child;
+	}
+	return top;
+}
+
+/* Grow each partition from the busiest state not yet placed, taking in the
+ * state with the heaviest edges into the partition until it has its share.
+ * Hot paths end up inside partitions. */
+void PartGraph::growRegions( int *part )
+{
+	long long *conn = new long long[numStates];
+	memset( conn, 0, sizeof(long long) * numStates );
+	for ( int i = 0; i < numStates; i++ )
+		part[i] = -1;
+
+	/* Seeds are taken busiest first. */
+	RedStateAp **seeds = new RedStateAp*[numStates];
+	int numSeeds = 0, nextSeed = 0;
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ )
+		seeds[numSeeds++] = st;
+	MergeSort<RedStateAp*, CmpStateByProf> mergeSort;
+	if ( profiled )
+		mergeSort.sort( seeds, numSeeds );
+
+	long long remaining = totalWeight;
+	for ( int p = 0; p < nparts; p++ ) {
+		long long share = remaining / ( nparts - p );
+		long long partWeight = 0;
+		heap.empty();
+
+		while ( p == nparts - 1 || partWeight < share ) {
+			int id = -1;
+			while ( heap.length() > 0 && id < 0 ) {
+				PartCand cand = popCand();
+				if ( part[cand.id] < 0 && cand.conn == conn[cand.id] )
+					id = cand.id;
+			}
+
+			if ( id < 0 ) {
+				/* Nothing connected is left. Start again from the next seed.
+				 * Without a profile the one with the most ways in. */
+				if ( !profiled ) {
+					int best = -1;
+					for ( int s = nextSeed; s < numSeeds; s++ ) {
+						if ( part[seeds[s]->id] < 0 && ( best < 0 ||
+								inDegree[seeds[s]->id] > inDegree[seeds[best]->id] ) )
+							best = s;
+					}
+					if ( best >= 0 ) {
+						RedStateAp *tmp = seeds[nextSeed];
+						seeds[nextSeed] = seeds[best];
+						seeds[best] = tmp;
+					}
+				}
+				while ( nextSeed < numSeeds && part[seeds[nextSeed]->id] >= 0 )
+					nextSeed += 1;
+				if ( nextSeed == numSeeds )
+					break;
+				id = seeds[nextSeed]->id;
+			}
+
+			part[id] = p;
+			partWeight += weight[id];
+			for ( int e = adjStart[id]; e < adjStart[id+1]; e++ ) {
+				int targ = adjTarg[e];
+				if ( part[targ] < 0 ) {
+					conn[targ] += adjWeight[e];
+					pushCand( conn[targ], targ );
+				}
+			}
+		}
+
+		/* Connections count toward one partition only. */
+		for ( int i = 0; i < numStates; i++ ) {
+			if ( part[i] < 0 )
+				conn[i] = 0;
+		}
+		remaining -= partWeight;
+	}
+
+	delete[] conn;
+	delete[] seeds;
+}
+
+/* Move single states to the partition they have the most edge weight into,
+ * as long as that lowers the cut and keeps the balance. Each pass is linear
+ * in the edges. Stops when a pass moves nothing. */
+void PartGraph::refine( int *part )
+{
+	long long *partWeight = new long long[nparts];
+	int *partSize = new int[nparts];
+	long long *conn = new long long[nparts];
+	memset( partWeight, 0, sizeof(long long) * nparts );
+	memset( partSize, 0, sizeof(int) * nparts );
+	memset( conn, 0, sizeof(long long) * nparts );
+	for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+		partWeight[part[st->id]] += weight[st->id];
+		partSize[part[st->id]] += 1;
+	}
+
+	Vector<int> touched;
+	for ( int pass = 0; pass < 16; pass++ ) {
+		bool moved = false;
+		for ( RedStateList::Iter st = redFsm->stateList; st.lte(); st++ ) {
+			int id = st->id, from = part[id];
+			touched.empty();
+			for ( int e = adjStart[id]; e < adjStart[id+1]; e++ ) {
+				int p = part[adjTarg[e]];
+				if ( conn[p] == 0 )
+					touched.append( p );
+				conn[p] += adjWeight[e];
+			}
+
+			int best = from;
+			long long bestGain = 0;
+			if ( partSize[from] > 1 && partWeight[from] - weight[id] >= minWeight ) {
+				for ( int t = 0; t < touched.length(); t++ ) {
+					int p = touched[t];
+					long long gain = conn[p] - conn[from];
+					if ( p != from && gain > bestGain &&
+							partWeight[p] + weight[id] <= maxWeight )
+					{
+						best = p;
+						bestGain = gain;
+					}
+				}
+			}
+
+			for ( int t = 0; t < touched.length(); t++ )
+				conn[touched[t]] = 0;
+
+			if ( best != from ) {
+				part[id] = best;
+				partWeight[from] -= weight[id];
+				partWeight[best] += weight[id];
+				partSize[from] -= 1;
+				partSize[best] += 1;
+				moved = true;
+			}
 		}
+
+		if ( !moved )
+			break;
+	}
+
+	delete[] partWeight;
+	delete[] partSize;
+	delete[] conn;
+}
+
+long long PartGraph::cut( int *part, bool weighted )
+{
+	long long total = 0;
+	for ( int e = 0; e < edges.length(); e++ ) {
+		if ( part[edges[e].from] != part[edges[e].targ] )
+			total += weighted ? edges[e].weight : 1;
 	}
+	return total;
+}
+
+/* Split the states into partitions so that the weight of the transitions
+ * between partitions is small. Transitions weigh the in-degree of the state
+ * they go to, or their traffic when there is a profile. Two starting points
+ * are refined: the state ordering cut into runs, and partitions grown around
+ * busy states. The one with the lighter cut is kept. */
+void RedFsmAp::partitionFsm( int nparts )
+{
+	this->nParts = nparts;
+	PartGraph graph( this, nparts );
+
+	int *chunked = new int[nextStateId];
+	int *grown = new int[nextStateId];
+
+	graph.chunkOrdering( chunked );
+	partCutInitial = graph.cut( chunked, false );
+	partWeightInitial = graph.cut( chunked, true );
+	graph.refine( chunked );
+
+	graph.growRegions( grown );
+	graph.refine( grown );
+
+	int *part = graph.cut( grown, true ) < graph.cut( chunked, true ) ? grown : chunked;
+	partCut = graph.cut( part, false );
+	partWeight = graph.cut( part, true );
+	for ( RedStateList::Iter st = stateList; st.lte(); st++ )
+		st->partition = part[st->id];
+
+	delete[] chunked;
+	delete[] grown;
 }
 
 void RedFsmAp::setInTrans()
@@ -39,6 +39,7 @@
 #include "sbstmap.h"
 #include "sbstset.h"
 #include "sbsttable.h"
+#include "fsmalloc.h"
 
 
 #define TRANS_ERR_TRANS   0
@@ -208,7 +209,8 @@ typedef AvlTree<RedAction, GenActionTable, CmpGenActionTable> GenActionTableMap;
 /* Reduced transition. */
 struct RedTransAp
 :
-	public AvlTreeEl<RedTransAp>
+	public AvlTreeEl<RedTransAp>,
+	public ScratchAllocated
 {
 	RedTransAp( RedStateAp *targ, RedAction *action, int id )
 		: targ(targ), action(action), id(id), pos(-1), labelNeeded(true) { }
@@ -248,10 +250,27 @@ struct RedTransEl
 {
 	/* Constructors. */
 	RedTransEl( Key lowKey, Key highKey, RedTransAp *value ) 
-		: lowKey(lowKey), highKey(highKey), value(value) { }
+		: lowKey(lowKey), highKey(highKey), value(value), profCount(0) { }
 
 	Key lowKey, highKey;
 	RedTransAp *value;
+
+	/* Times the range was taken while profiling. */
+	long long profCount;
+};
+
+/* Orders ranges by how often they were taken, busiest first. */
+struct CmpRedTransElProf
+{
+	static int compare( const RedTransEl &el1, const RedTransEl &el2 )
+	{
+		if ( el1.profCount > el2.profCount )
+			return -1;
+		else if ( el1.profCount < el2.profCount )
+			return 1;
+		else
+			return 0;
+	}
 };
 
 typedef Vector<RedTransEl> RedTransList;
@@ -318,14 +337,73 @@ struct GenStateCond
 typedef DList<GenStateCond> GenStateCondList;
 typedef Vector<GenStateCond*> StateCondVect;
 
+/* Alphabets wider than one page get a two level class map. */
+#define CLASS_PAGE_BITS 8
+#define CLASS_PAGE_SIZE (1 << CLASS_PAGE_BITS)
+
+/* Page size of paged flat transition lists. */
+#define FLAT_PAGE_BITS 6
+#define FLAT_PAGE_SIZE (1 << FLAT_PAGE_BITS)
+
+/* Bounds on the runs of states that are matched as one literal. */
+#define MIN_LITERAL_RUN 3
+#define MAX_LITERAL_RUN 32
+
+/* How the goto styles test the keys of a state. */
+enum KeyTest
+{
+	KeyTestSearch,
+	KeyTestBitmap,
+	KeyTestJump
+};
+
+/* Bounds on the bitmap and jump table tests of the goto styles. */
+#define BITMAP_WORD_BITS 32
+#define MAX_BITMAP_SPAN 256
+#define MIN_BITMAP_ELEMENTS 3
+#define MIN_JUMP_ELEMENTS 6
+#define MAX_JUMP_KEYS 256
+
+/* Bounds on the self loops that are skipped with vectors: the fewest keys
+ * looping and the most ranges of keys leaving the loop. */
+#define MIN_SKIP_KEYS 4
+#define MAX_SKIP_RANGES 4
+
+/* The lockstep driver interleaves up to this many streams, over alphabets no
+ * wider than a byte. */
+#define MAX_MULTI_STREAMS 16
+#define MAX_MULTI_ALPH 256
+
+/* The parallel driver steps the paths of a chunk this many keys between
+ * merges. */
+#define PARALLEL_STRETCH 64
+
+/* The pair style steps two keys at a time while the table of key class pairs
+ * stays under this many entries. */
+#define MAX_PAIR_ENTRIES 0x40000
+
 /* Reduced state. */
 struct RedStateAp
+:
+	public ScratchAllocated
 {
 	RedStateAp()
 	: 
 		defTrans(0), 
 		condList(0),
 		transList(0), 
+		combBase(0),
+		combDefTrans(0),
+		pageDirOffset(0),
+		profVisits(0),
+		literalLen(0),
+		literalTarg(0),
+		keyTest(KeyTestSearch),
+		bitmapTrans(0),
+		bitmapSpan(0),
+		bitmapOffset(0),
+		skipRanges(0),
+		skipLoopKeys(0),
 		isFinal(false), 
 		labelNeeded(false), 
 		outNeeded(false), 
@@ -338,7 +416,10 @@ struct RedStateAp
 		bAnyRegCurStateRef(false),
 		partitionBoundary(false),
 		inTrans(0),
-		numInTrans(0)
+		numInTrans(0),
+		mergeClass(0),
+		mergePos(0),
+		mergedInto(0)
 	{ }
 
 	/* Transitions out. */
@@ -354,6 +435,41 @@ struct RedStateAp
 	Key lowKey, highKey;
 	RedTransAp **transList;
 
+	/* For flat keys packed by row displacement. The row starts at combBase.
+	 * Keys in the row that have no entry take combDefTrans. */
+	Key combLowKey, combHighKey;
+	int combBase;
+	RedTransAp *combDefTrans;
+
+	/* For flat keys split into pages. The directory of the state's pages
+	 * starts at pageDirOffset. */
+	int pageDirOffset;
+
+	/* Keys the state consumed while profiling. */
+	long long profVisits;
+
+	/* A run of states that each take a single key to the next starts here.
+	 * Matching the run consumes literalLen keys and ends in literalTarg. */
+	int literalLen;
+	RedStateAp *literalTarg;
+
+	/* How the goto styles test the keys. A bitmap takes the keys of
+	 * bitmapTrans out of the singles and ranges into bitmapList. Bitmaps
+	 * wider than a word are at bitmapOffset in the table of bitmaps. */
+	KeyTest keyTest;
+	RedTransAp *bitmapTrans;
+	RedTransList bitmapList;
+	Key bitmapLow;
+	int bitmapSpan;
+	int bitmapOffset;
+
+	/* The state loops on itself without actions over skipLoopKeys keys,
+	 * all but the skipRanges ranges of keys skipLow to skipHigh. */
+	int skipRanges;
+	Size skipLoopKeys;
+	Key skipLow[MAX_SKIP_RANGES];
+	Key skipHigh[MAX_SKIP_RANGES];
+
 	/* The list of states that transitions from this state go to. */
 	RedStateVect targStates;
 
@@ -380,6 +496,12 @@ struct RedStateAp
 
 	RedTransAp **inTrans;
 	int numInTrans;
+
+	/* Used when merging equivalent states. A state that was merged away
+	 * points to the state that replaced it. */
+	int mergeClass;
+	int mergePos;
+	RedStateAp *mergedInto;
 };
 
 /* List of states. */
@@ -413,6 +535,14 @@ struct RedFsmAp
 	int numFinStates;
 	int nParts;
 
+	/* Transitions that cross partitions, and their weight, when the state
+	 * ordering is split into runs and in the partitioning chosen. The weight
+	 * is what the partitioning minimizes. */
+	long long partCutInitial;
+	long long partCut;
+	long long partWeightInitial;
+	long long partWeight;
+
 	bool bAnyToStateActions;
 	bool bAnyFromStateActions;
 	bool bAnyRegActions;
@@ -427,6 +557,7 @@ struct RedFsmAp
 	bool bAnyRegCurStateRef;
 	bool bAnyRegBreak;
 	bool bAnyConditions;
+	bool bAnyProfile;
 
 	int maxState;
 	int maxSingleLen;
@@ -446,6 +577,51 @@ struct RedFsmAp
 	int maxCondSpaceId;
 	int maxCondIndexOffset;
 	int maxCond;
+	int maxCombBase;
+	int statesMerged;
+
+	/* Bytes in the table of the bitmaps wider than a word. */
+	int bitmapLen;
+
+	/* States whose self loops are skipped with vectors. */
+	int numSkipLoops;
+
+	/* Flat transition lists packed by row displacement. Each slot holds the
+	 * transition and the state that owns it. */
+	Vector<RedTransAp*> combTrans;
+	Vector<RedStateAp*> combCheck;
+
+	/* Flat transition lists split into pages. Each distinct page is stored
+	 * once in pageTrans and the directory gives the start of every page. */
+	Vector<RedTransAp*> pageTrans;
+	Vector<int> pageDir;
+	int maxPageDirOffset;
+	int maxPageStart;
+
+	/* Alphabet equivalence classes. When in use the transition keys are class
+	 * ids. The map takes a key's offset from classLowKey to its class. If
+	 * there are pages the map holds each distinct page once and classPages
+	 * gives the start of every page. */
+	int numClasses;
+	Key classLowKey;
+	Vector<int> classMap;
+	Vector<int> classPages;
+	int maxClassPage;
+
+	/* The lockstep driver's dense table of next states, with a row of key
+	 * classes for each state. The class map takes a key's offset from the
+	 * lowest key. An entry of multiStop stops the stream for the exec. */
+	Vector<int> multiClassMap;
+	Vector<int> multiNext;
+	int numMultiClasses;
+	int multiStop;
+
+	/* The pair style's tables, over the lockstep driver's key classes. The
+	 * single table gives the state after one class and the pair table the
+	 * row after a pair of classes, as the state times the number of class
+	 * pairs. Empty if the machine cannot step two keys at a time. */
+	Vector<int> pairSingle;
+	Vector<int> pairNext;
 
 	bool anyActions();
 	bool anyToStateActions()        { return bAnyToStateActions; }
@@ -462,6 +638,9 @@ struct RedFsmAp
 	bool anyRegCurStateRef()        { return bAnyRegCurStateRef; }
 	bool anyRegBreak()              { return bAnyRegBreak; }
 	bool anyConditions()            { return bAnyConditions; }
+	bool anyClasses()               { return numClasses > 0; }
+	bool anyPairs()                 { return pairNext.length() > 0; }
+	bool anyProfile()               { return bAnyProfile; }
 
 
 	/* Is is it possible to extend a range by bumping ranges that span only
@@ -473,6 +652,30 @@ struct RedFsmAp
 	void chooseSingle();
 
 	void makeFlat();
+	void makeComb();
+
+	/* Find the runs of states that match a literal. */
+	bool literalLink( RedStateAp *state );
+	void findLiteralRuns();
+
+	/* Find the states whose self loops can be skipped a vector at a time. */
+	void findSkipLoops();
+
+	/* Choose between searching, bitmaps and jump tables for the keys. */
+	void chooseKeyTests();
+	void makeBitmap( RedStateAp *state, RedTransAp *trans );
+	void makePages();
+	void makeMulti();
+	void makePairs();
+
+	/* Replace keys with alphabet equivalence classes. */
+	void makeClasses();
+	void makeClassMap( Size alphSize, Size *cuts, int numCuts, int *cls );
+	int classOf( Key key );
+
+	/* Use the transition counts of a profile. */
+	void profileOrdering();
+	int searchMid( RedTransEl *data, int low, int high );
 
 	/* Move a selected transition from ranges to default. */
 	void moveToDefault( RedTransAp *defTrans, RedStateAp *state );
@@ -489,6 +692,10 @@ struct RedFsmAp
 	RedTransAp *chooseDefaultGoto( RedStateAp *state );
 	void chooseDefaultGoto();
 
+	/* Merge states that the reduction has made indistinguishable. */
+	void mergeStates();
+	void mergeTransitions();
+
 	/* Ordering states by transition connections. */
 	void optimizeStateOrdering( RedStateAp *state );
 	void optimizeStateOrdering();
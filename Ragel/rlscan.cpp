@@ -291,7 +291,7 @@ void Scanner::importToken( int token, wchar_t *start, wchar_t *end )
 		int toklen = end-start;
 		token_lens[cur_token] = toklen;
 		token_strings[cur_token] = new wchar_t[toklen+1];
-		memcpy( token_strings[cur_token], start, toklen );
+		wmemcpy( token_strings[cur_token], start, toklen );
 		token_strings[cur_token][toklen] = 0;
 	}
 	cur_token++;
@@ -845,8 +845,8 @@ wchar_t **Scanner::makeIncludePathChecks( const wchar_t *thisFileName,
 			long givenPathLen = (lastSlash - thisFileName) + 1;
 			long checklen = givenPathLen + length;
 			wchar_t *check = new wchar_t[checklen+1];
-			memcpy( check, thisFileName, givenPathLen );
-			memcpy( check+givenPathLen, data, length );
+			wmemcpy( check, thisFileName, givenPathLen );
+			wmemcpy( check+givenPathLen, data, length );
 			check[checklen] = 0;
 			checks[nextCheck++] = check;
 		}
@@ -856,9 +856,9 @@ wchar_t **Scanner::makeIncludePathChecks( const wchar_t *thisFileName,
 			long pathLen = wcslen( *incp );
 			long checkLen = pathLen + 1 + length;
 			wchar_t *check = new wchar_t[checkLen+1];
-			memcpy( check, *incp, pathLen );
+			wmemcpy( check, *incp, pathLen );
 			check[pathLen] = PATH_SEP;
-			memcpy( check+pathLen+1, data, length );
+			wmemcpy( check+pathLen+1, data, length );
 			check[checkLen] = 0;
 			checks[nextCheck++] = check;
 		}
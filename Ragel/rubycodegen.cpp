@@ -65,7 +65,7 @@ extern bool noLineDirectives;
 
 void rubyLineDirective( wostream &out, const wchar_t *fileName, int line )
 {
-	if ( noLineDirectives )
+	if ( noLineDirectives || fileName == 0 )
 		return;
 
 	/* Write a comment containing line info. */
@@ -281,6 +281,27 @@ void RubyCodeGen::ACTION( wostream &ret, GenAction *action, int targState, bool
 	ret << L"		end\n";
 }
 
+void RubyCodeGen::actionText( wostream &ret, GenAction *action, bool inFinish )
+{
+	INLINE_LIST( ret, action->inlineList, 0, inFinish );
+}
+
+/* Write the cases of an action switch. Cases that run the same code share a
+ * body. A when cannot fall through, so tails are not shared. */
+void RubyCodeGen::ACTION_CASES( ActionCaseList &cases, bool inFinish )
+{
+	mergeActionCases( cases, inFinish, false );
+	for ( ActionCaseList::Iter ac = cases; ac.lte(); ac++ ) {
+		out << L"\twhen ";
+		for ( Vector<int>::Iter label = ac->labels; label.lte(); label++ )
+			out << ( label.first() ? L"" : L", " ) << *label;
+		out << L" then\n";
+
+		for ( Vector<GenAction*>::Iter act = ac->actions; act.lte(); act++ )
+			ACTION( out, *act, 0, inFinish );
+	}
+}
+
 
 
 wstring RubyCodeGen::GET_WIDE_KEY()
@@ -642,8 +663,8 @@ void RubyCodeGen::SET_TOKEND( wostream &ret, GenInlineItem *item )
 	/* The tokend action sets tokend. */
 	ret << TOKEND() << L" = " << P();
 	if ( item->offset != 0 ) 
-		out << L"+" << item->offset;
-	out << L"\n";
+		ret << L"+" << item->offset;
+	ret << L"\n";
 }
 
 void RubyCodeGen::GET_TOKEND( wostream &ret, GenInlineItem *item )
@@ -50,6 +50,8 @@ protected:
         wstring ACCESS();
 
         void ACTION( wostream &ret, GenAction *action, int targState, bool inFinish );
+	void actionText( wostream &ret, GenAction *action, bool inFinish );
+	void ACTION_CASES( ActionCaseList &cases, bool inFinish );
 	wstring GET_KEY();
         wstring GET_WIDE_KEY();
 	wstring GET_WIDE_KEY( RedStateAp *state );
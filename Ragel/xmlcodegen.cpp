@@ -26,6 +26,7 @@
 #include "fsmgraph.h"
 #include "gendata.h"
 #include "inputdata.h"
+#include "profile.h"
 #include <string.h>
 #include "rlparse.h"
 #include "version.h"
@@ -55,20 +56,20 @@ void GenBase::reduceActionTables()
 		RedActionTable *actionTable = 0;
 
 		/* Reduce To State Actions. */
-		if ( st->toStateActionTable.length() > 0 ) {
-			if ( actionTableMap.insert( st->toStateActionTable, &actionTable ) )
+		if ( st->ext().toStateActionTable.length() > 0 ) {
+			if ( actionTableMap.insert( st->ext().toStateActionTable, &actionTable ) )
 				actionTable->id = nextActionTableId++;
 		}
 
 		/* Reduce From State Actions. */
-		if ( st->fromStateActionTable.length() > 0 ) {
-			if ( actionTableMap.insert( st->fromStateActionTable, &actionTable ) )
+		if ( st->ext().fromStateActionTable.length() > 0 ) {
+			if ( actionTableMap.insert( st->ext().fromStateActionTable, &actionTable ) )
 				actionTable->id = nextActionTableId++;
 		}
 
 		/* Reduce EOF actions. */
-		if ( st->eofActionTable.length() > 0 ) {
-			if ( actionTableMap.insert( st->eofActionTable, &actionTable ) )
+		if ( st->ext().eofActionTable.length() > 0 ) {
+			if ( actionTableMap.insert( st->ext().eofActionTable, &actionTable ) )
 				actionTable->id = nextActionTableId++;
 		}
 
@@ -187,13 +188,13 @@ void XMLCodeGen::writeTransList( StateAp *state )
 void XMLCodeGen::writeEofTrans( StateAp *state )
 {
 	RedActionTable *eofActions = 0;
-	if ( state->eofActionTable.length() > 0 )
-		eofActions = actionTableMap.find( state->eofActionTable );
+	if ( state->ext().eofActionTable.length() > 0 )
+		eofActions = actionTableMap.find( state->ext().eofActionTable );
 	
 	/* The <eof_t> is used when there is an eof target, otherwise the eof
 	 * action goes into state actions. */
-	if ( state->eofTarget != 0 ) {
-		out << L"      <eof_t>" << state->eofTarget->alg.stateNum;
+	if ( state->ext().eofTarget != 0 ) {
+		out << L"      <eof_t>" << state->ext().eofTarget->alg.stateNum;
 
 		if ( eofActions != 0 )
 			out << L" " << eofActions->id;
@@ -736,18 +737,18 @@ void xmlEscapeHost( std::wostream &out, wchar_t *data, long len )
 void XMLCodeGen::writeStateActions( StateAp *state )
 {
 	RedActionTable *toStateActions = 0;
-	if ( state->toStateActionTable.length() > 0 )
-		toStateActions = actionTableMap.find( state->toStateActionTable );
+	if ( state->ext().toStateActionTable.length() > 0 )
+		toStateActions = actionTableMap.find( state->ext().toStateActionTable );
 
 	RedActionTable *fromStateActions = 0;
-	if ( state->fromStateActionTable.length() > 0 )
-		fromStateActions = actionTableMap.find( state->fromStateActionTable );
+	if ( state->ext().fromStateActionTable.length() > 0 )
+		fromStateActions = actionTableMap.find( state->ext().fromStateActionTable );
 
 	/* EOF actions go out here only if the state has no eof target. If it has
 	 * an eof target then an eof transition will be used instead. */
 	RedActionTable *eofActions = 0;
-	if ( state->eofTarget == 0 && state->eofActionTable.length() > 0 )
-		eofActions = actionTableMap.find( state->eofActionTable );
+	if ( state->ext().eofTarget == 0 && state->ext().eofActionTable.length() > 0 )
+		eofActions = actionTableMap.find( state->ext().eofActionTable );
 	
 	if ( toStateActions != 0 || fromStateActions != 0 || eofActions != 0 ) {
 		out << L"      <state_actions>";
@@ -772,9 +773,9 @@ void XMLCodeGen::writeStateActions( StateAp *state )
 
 void XMLCodeGen::writeStateConditions( StateAp *state )
 {
-	if ( state->stateCondList.length() > 0 ) {
-		out << L"      <cond_list length=\"" << state->stateCondList.length() << "\">\n";
-		for ( StateCondList::Iter scdi = state->stateCondList; scdi.lte(); scdi++ ) {
+	if ( state->ext().stateCondList.length() > 0 ) {
+		out << L"      <cond_list length=\"" << state->ext().stateCondList.length() << "\">\n";
+		for ( StateCondList::Iter scdi = state->ext().stateCondList; scdi.lte(); scdi++ ) {
 			out << L"        <c>";
 			writeKey( scdi->lowKey );
 			out << L" ";
@@ -1142,18 +1143,18 @@ void BackendGen::makeEntryPoints()
 void BackendGen::makeStateActions( StateAp *state )
 {
 	RedActionTable *toStateActions = 0;
-	if ( state->toStateActionTable.length() > 0 )
-		toStateActions = actionTableMap.find( state->toStateActionTable );
+	if ( state->ext().toStateActionTable.length() > 0 )
+		toStateActions = actionTableMap.find( state->ext().toStateActionTable );
 
 	RedActionTable *fromStateActions = 0;
-	if ( state->fromStateActionTable.length() > 0 )
-		fromStateActions = actionTableMap.find( state->fromStateActionTable );
+	if ( state->ext().fromStateActionTable.length() > 0 )
+		fromStateActions = actionTableMap.find( state->ext().fromStateActionTable );
 
 	/* EOF actions go out here only if the state has no eof target. If it has
 	 * an eof target then an eof transition will be used instead. */
 	RedActionTable *eofActions = 0;
-	if ( state->eofTarget == 0 && state->eofActionTable.length() > 0 )
-		eofActions = actionTableMap.find( state->eofActionTable );
+	if ( state->ext().eofTarget == 0 && state->ext().eofActionTable.length() > 0 )
+		eofActions = actionTableMap.find( state->ext().eofActionTable );
 	
 	if ( toStateActions != 0 || fromStateActions != 0 || eofActions != 0 ) {
 		long to = -1;
@@ -1175,13 +1176,13 @@ void BackendGen::makeStateActions( StateAp *state )
 void BackendGen::makeEofTrans( StateAp *state )
 {
 	RedActionTable *eofActions = 0;
-	if ( state->eofActionTable.length() > 0 )
-		eofActions = actionTableMap.find( state->eofActionTable );
+	if ( state->ext().eofActionTable.length() > 0 )
+		eofActions = actionTableMap.find( state->ext().eofActionTable );
 	
 	/* The EOF trans is used when there is an eof target, otherwise the eof
 	 * action goes into state actions. */
-	if ( state->eofTarget != 0 ) {
-		long targ = state->eofTarget->alg.stateNum;
+	if ( state->ext().eofTarget != 0 ) {
+		long targ = state->ext().eofTarget->alg.stateNum;
 		long action = -1;
 		if ( eofActions != 0 )
 			action = eofActions->id;
@@ -1192,12 +1193,12 @@ void BackendGen::makeEofTrans( StateAp *state )
 
 void BackendGen::makeStateConditions( StateAp *state )
 {
-	if ( state->stateCondList.length() > 0 ) {
-		long length = state->stateCondList.length();
+	if ( state->ext().stateCondList.length() > 0 ) {
+		long length = state->ext().stateCondList.length();
 		cgd->initStateCondList( curState, length );
 		curStateCond = 0;
 
-		for ( StateCondList::Iter scdi = state->stateCondList; scdi.lte(); scdi++ ) {
+		for ( StateCondList::Iter scdi = state->ext().stateCondList; scdi.lte(); scdi++ ) {
 			cgd->addStateCond( curState, scdi->lowKey, scdi->highKey, 
 					scdi->condSpace->condSpaceId );
 		}
@@ -1397,6 +1398,19 @@ void BackendGen::makeBackend()
 	close_ragel_def();
 }
 
+/* Reduce the machine without finishing it for output. The machine is only
+ * measured, to choose the code style it will be written with. */
+void BackendGen::makeProbe()
+{
+	cgd->setAlphType( keyOps->alphType->internalName );
+	makeMachine();
+
+	cgd->redFsm->maxKey = cgd->findMaxKey();
+	cgd->redFsm->findFirstFinState();
+	cgd->mergeStates();
+	profileMachine( cgd->redFsm );
+}
+
 void InputData::writeLanguage( std::wostream &out )
 {
 	out << L" lang=\"";
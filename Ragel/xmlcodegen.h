@@ -143,6 +143,7 @@ class BackendGen : protected GenBase
 public:
 	BackendGen( wchar_t *fsmName, ParseData *pd, FsmAp *fsm, CodeGenData *cgd );
 	void makeBackend( );
+	void makeProbe( );
 
 private:
 	void makeGenInlineList( GenInlineList *outList, InlineList *inList );
@@ -48,13 +48,19 @@ protected override byte[] GenerateCode(string inputFileName, string inputFileCon
 
         // This method is used by tests
         public byte[] Generate(string inputFileName, string inputFileContent, DateTime dateTime)
+        {
+            return Generate(inputFileName, inputFileContent, dateTime, "-A -c");
+        }
+
+        // Used by tests to run Ragel with options other than the C# ones
+        public byte[] Generate(string inputFileName, string inputFileContent, DateTime dateTime, string options)
         {
             try
             {
                 var startInfo = new ProcessStartInfo
                 {
                     CreateNoWindow = true,
-                    Arguments = "-A -c -i " + inputFileName,
+                    Arguments = options + " -i " + inputFileName,
                     RedirectStandardInput = true,
                     RedirectStandardOutput = true,
                     RedirectStandardError = true,
@@ -13,6 +13,7 @@ public class GeneratorTests
     {
         [Test]
         [TestCase("sample")]
+        [TestCase("or_literals")]
         public void GivenValidInput_Generate_ShouldReturnCSCode(string filename)
         {
             // Arrange
@@ -83,6 +84,37 @@ public void GivenValidInput_Generate2Times_ShouldReturnCSCodeBothTimes(string fi
             Assert.AreEqual(FixWhitespaces(expected), FixWhitespaces(Encoding.UTF8.GetString(another)));
         }
 
+        [Test]
+        [TestCase("sample", "auto.cs", "-A -c --auto-style")]
+        [TestCase("ocaml_actions", "ml", "-O -L -c")]
+        [TestCase("pair_c", "c", "-C -F3 -c")]
+        [TestCase("pair_cs", "cs", "-A -F3 -c")]
+        [TestCase("paged_cs", "cs", "-A -F1 -c")]
+        [TestCase("row_disp", "cs", "-A -F2 -c")]
+        [TestCase("alph_classes", "cs", "-A -F1 --alph-classes -c")]
+        [TestCase("state_records", "cs", "-A -T2 -c")]
+        [TestCase("scattered_keys", "cs", "-A -G1 -c")]
+        [TestCase("span_tables", "cs", "-A -T0 --span-tables -c")]
+        [TestCase("unsafe_tables", "cs", "-A -F1 --unsafe -c")]
+        [TestCase("feed_chunks", "cs", "-A -T0 -c")]
+        [TestCase("stream_tokens", "c", "-C -T0 -c")]
+        [TestCase("multi_fields", "c", "-C -T0 -c")]
+        [TestCase("parallel_lines", "c", "-C -G2 -c")]
+        public void GivenValidInputAndOptions_Generate_ShouldReturnCodeForThoseOptions(
+            string filename, string extension, string options)
+        {
+            // Arrange
+            var generator = new CodeGenerator();
+            var content = ReadAllTextFromEmbeddedResource(filename + ".rl");
+            var expected = ReadAllTextFromEmbeddedResource(filename + "." + extension);
+
+            // Act
+            var actual = generator.Generate(filename, content, new DateTime(2016, 1, 1, 8, 0, 0), options);
+
+            // Assert
+            Assert.AreEqual(FixWhitespaces(expected), FixWhitespaces(Encoding.UTF8.GetString(actual)));
+        }
+
         private static string FixWhitespaces(string str)
         {
             str = str.Replace("\r\n", "\n")
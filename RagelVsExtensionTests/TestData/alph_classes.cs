@@ -0,0 +1,167 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "alph_classes"
+// With --alph-classes the tables are indexed by alphabet equivalence class
+// rather than by key. The generator test compares the generated text only.
+// Built and run on its own, Main checks that keys mapped to one class still
+// take the transitions their own key would.
+
+using System;
+using System.Text;
+
+public static class AlphClasses
+{
+	
+#line 18 "alph_classes"
+
+
+	
+static readonly sbyte[] _alph_classes_class_map =  new sbyte [] {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 1, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	2, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 2, 0, 0, 0, 
+	3, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 0, 0, 0, 0, 0, 0, 
+	0, 5, 5, 5, 5, 5, 5, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 5, 5, 5, 5, 5, 5, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	6, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static readonly sbyte[] _alph_classes_trans_keys =  new sbyte [] {
+	0, 0, 1, 4, 0, 6, 1, 4, 3, 5, 1, 5, 0, 6, 0, 0, 
+	0
+};
+
+static readonly sbyte[] _alph_classes_key_spans =  new sbyte [] {
+	0, 4, 7, 4, 3, 5, 7, 0
+};
+
+static readonly sbyte[] _alph_classes_index_offsets =  new sbyte [] {
+	0, 0, 5, 13, 18, 22, 28, 36
+};
+
+static readonly sbyte[] _alph_classes_indicies =  new sbyte [] {
+	0, 1, 2, 3, 1, 1, 0, 
+	3, 2, 3, 1, 4, 3, 0, 3, 
+	2, 3, 1, 5, 5, 5, 1, 0, 
+	3, 6, 5, 5, 1, 1, 0, 3, 
+	6, 5, 5, 4, 5, 1, 0
+};
+
+static readonly sbyte[] _alph_classes_trans_targs =  new sbyte [] {
+	7, 0, 2, 3, 4, 5, 6
+};
+
+const int alph_classes_start = 1;
+const int alph_classes_first_final = 7;
+const int alph_classes_error = 0;
+
+const int alph_classes_en_main = 1;
+
+
+#line 21 "alph_classes"
+
+	static bool Accepts( string input )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length;
+
+		
+	{
+	cs = alph_classes_start;
+	}
+
+#line 28 "alph_classes"
+		
+	{
+	sbyte _slen;
+	sbyte _trans;
+	int _keys;
+	sbyte _inds;
+	sbyte _widec;
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	_widec = _alph_classes_class_map[data[p]];
+
+	_keys = cs<<1;
+	_inds = _alph_classes_index_offsets[cs];
+
+	_slen = _alph_classes_key_spans[cs];
+	_trans = _alph_classes_indicies[_inds + (
+		_slen > 0 && _alph_classes_trans_keys[_keys] <=_widec &&
+		_widec <= _alph_classes_trans_keys[_keys+1] ?
+		_widec - _alph_classes_trans_keys[_keys] : _slen ) ];
+
+	cs = _alph_classes_trans_targs[_trans];
+
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	_out: {}
+	}
+
+#line 29 "alph_classes"
+
+		return cs >= alph_classes_first_final;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "0x1F, 42 0 0xab\n", true ),
+			Tuple.Create( "\n", true ),
+			Tuple.Create( "0x\n", false ),
+			Tuple.Create( "0xg1\n", false ),
+			Tuple.Create( "1 x\n", false ),
+			Tuple.Create( "42;\n", false ),
+			Tuple.Create( "0xAB", false ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			if ( Accepts( c.Item1 ) != c.Item2 ) {
+				Console.WriteLine( "FAIL {0}", c.Item1 );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
@@ -0,0 +1,54 @@
+﻿// With --alph-classes the tables are indexed by alphabet equivalence class
+// rather than by key. The generator test compares the generated text only.
+// Built and run on its own, Main checks that keys mapped to one class still
+// take the transitions their own key would.
+
+using System;
+using System.Text;
+
+public static class AlphClasses
+{
+	%%{
+		machine alph_classes;
+		alphtype byte;
+
+		hex = '0x' [0-9a-fA-F]+;
+		dec = [1-9] [0-9]* | '0';
+		main := ( ( hex | dec ) ( ',' | ' ' )* )* '\n';
+	}%%
+
+	%% write data;
+
+	static bool Accepts( string input )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length;
+
+		%% write init;
+		%% write exec;
+
+		return cs >= alph_classes_first_final;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "0x1F, 42 0 0xab\n", true ),
+			Tuple.Create( "\n", true ),
+			Tuple.Create( "0x\n", false ),
+			Tuple.Create( "0xg1\n", false ),
+			Tuple.Create( "1 x\n", false ),
+			Tuple.Create( "42;\n", false ),
+			Tuple.Create( "0xAB", false ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			if ( Accepts( c.Item1 ) != c.Item2 ) {
+				Console.WriteLine( "FAIL {0}", c.Item1 );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
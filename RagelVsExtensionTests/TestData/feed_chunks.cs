@@ -0,0 +1,311 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "feed_chunks"
+// 'write feed' writes FeedInit and Feed, which run the machine over one
+// chunk at a time and keep a token that runs past the end of a chunk. The
+// generator test compares the generated text only. Built and run on its own,
+// Main checks that every chunk size finds the tokens a single chunk finds.
+
+using System;
+using System.Text;
+
+public class FeedChunks
+{
+	int words, numbers;
+
+	
+#line 23 "feed_chunks"
+
+
+	
+static readonly sbyte[] _feed_chunks_actions =  new sbyte [] {
+	0, 1, 0, 1, 1, 1, 2, 1, 
+	3, 1, 4, 1, 5
+};
+
+static readonly sbyte[] _feed_chunks_key_offsets =  new sbyte [] {
+	0, 0, 6, 8, 12
+};
+
+static readonly byte[] _feed_chunks_trans_keys =  new byte [] {
+	10, 32, 48, 57, 97, 122, 48, 57, 
+	48, 57, 97, 122, 48, 57, 0
+};
+
+static readonly sbyte[] _feed_chunks_single_lengths =  new sbyte [] {
+	0, 2, 0, 0, 0
+};
+
+static readonly sbyte[] _feed_chunks_range_lengths =  new sbyte [] {
+	0, 2, 1, 2, 1
+};
+
+static readonly sbyte[] _feed_chunks_index_offsets =  new sbyte [] {
+	0, 0, 5, 7, 10
+};
+
+static readonly sbyte[] _feed_chunks_trans_targs =  new sbyte [] {
+	1, 1, 2, 3, 0, 2, 1, 4, 
+	3, 1, 4, 1, 1, 1, 1, 0
+};
+
+static readonly sbyte[] _feed_chunks_trans_actions =  new sbyte [] {
+	5, 5, 0, 0, 0, 0, 9, 0, 
+	0, 7, 0, 11, 9, 7, 11, 0
+};
+
+static readonly sbyte[] _feed_chunks_to_state_actions =  new sbyte [] {
+	0, 1, 0, 0, 0
+};
+
+static readonly sbyte[] _feed_chunks_from_state_actions =  new sbyte [] {
+	0, 3, 0, 0, 0
+};
+
+static readonly sbyte[] _feed_chunks_eof_trans =  new sbyte [] {
+	0, 0, 13, 14, 15
+};
+
+const int feed_chunks_start = 1;
+const int feed_chunks_first_final = 1;
+const int feed_chunks_error = 0;
+
+const int feed_chunks_en_main = 1;
+
+
+#line 26 "feed_chunks"
+	
+public struct _feed_chunks_feed_state
+{
+	public int cs;
+	public int act, ts, te;
+	public byte[] buf;
+	public int pending;
+}
+
+_feed_chunks_feed_state _feed_chunks_feed;
+
+public void FeedInit()
+{
+	_feed_chunks_feed = new _feed_chunks_feed_state();
+	_feed_chunks_feed.cs = feed_chunks_start;
+	_feed_chunks_feed.ts = -1;
+	_feed_chunks_feed.te = -1;
+}
+
+public void Feed( System.Buffers.ReadOnlySequence<byte> chunk, bool isFinal )
+{
+	foreach ( System.ReadOnlyMemory<byte> segment in chunk )
+		Feed( segment.Span, false );
+	if ( isFinal )
+		Feed( System.ReadOnlySpan<byte>.Empty, true );
+}
+
+public void Feed( System.ReadOnlySpan<byte> chunk, bool isFinal )
+{
+	int cs = _feed_chunks_feed.cs;
+	int act = _feed_chunks_feed.act, ts = _feed_chunks_feed.ts, te = _feed_chunks_feed.te;
+	System.ReadOnlySpan<byte> data = chunk;
+	int p = 0;
+	if ( _feed_chunks_feed.pending > 0 ) {
+		int len = _feed_chunks_feed.pending + chunk.Length;
+		if ( _feed_chunks_feed.buf.Length < len )
+			System.Array.Resize( ref _feed_chunks_feed.buf, System.Math.Max( len, 2 * _feed_chunks_feed.buf.Length ) );
+		chunk.CopyTo( System.MemoryExtensions.AsSpan( _feed_chunks_feed.buf, _feed_chunks_feed.pending ) );
+		data = new System.ReadOnlySpan<byte>( _feed_chunks_feed.buf, 0, len );
+		p = _feed_chunks_feed.pending;
+	}
+	int pe = data.Length;
+	int eof = isFinal ? pe : -1;
+
+	{
+	sbyte _klen;
+	sbyte _trans;
+	int _acts;
+	int _nacts;
+	sbyte _keys;
+
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	_acts = _feed_chunks_from_state_actions[cs];
+	_nacts = _feed_chunks_actions[_acts++];
+	while ( _nacts-- > 0 ) {
+		switch ( _feed_chunks_actions[_acts++] ) {
+	case 1:
+#line 1 "NONE"
+	{ts = p;}
+	break;
+		default: break;
+		}
+	}
+
+	_keys = _feed_chunks_key_offsets[cs];
+	_trans = (sbyte)_feed_chunks_index_offsets[cs];
+
+	_klen = _feed_chunks_single_lengths[cs];
+	if ( _klen > 0 ) {
+		sbyte _lower = _keys;
+		sbyte _mid;
+		sbyte _upper = (sbyte) (_keys + _klen - 1);
+		while (true) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = (sbyte) (_lower + ((_upper-_lower) >> 1));
+			if ( data[p] < _feed_chunks_trans_keys[_mid] )
+				_upper = (sbyte) (_mid - 1);
+			else if ( data[p] > _feed_chunks_trans_keys[_mid] )
+				_lower = (sbyte) (_mid + 1);
+			else {
+				_trans += (sbyte) (_mid - _keys);
+				goto _match;
+			}
+		}
+		_keys += (sbyte) _klen;
+		_trans += (sbyte) _klen;
+	}
+
+	_klen = _feed_chunks_range_lengths[cs];
+	if ( _klen > 0 ) {
+		sbyte _lower = _keys;
+		sbyte _mid;
+		sbyte _upper = (sbyte) (_keys + (_klen<<1) - 2);
+		while (true) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = (sbyte) (_lower + (((_upper-_lower) >> 1) & ~1));
+			if ( data[p] < _feed_chunks_trans_keys[_mid] )
+				_upper = (sbyte) (_mid - 2);
+			else if ( data[p] > _feed_chunks_trans_keys[_mid+1] )
+				_lower = (sbyte) (_mid + 2);
+			else {
+				_trans += (sbyte)((_mid - _keys)>>1);
+				goto _match;
+			}
+		}
+		_trans += (sbyte) _klen;
+	}
+
+_match:
+_eof_trans:
+	cs = _feed_chunks_trans_targs[_trans];
+
+	if ( _feed_chunks_trans_actions[_trans] == 0 )
+		goto _again;
+
+	_acts = _feed_chunks_trans_actions[_trans];
+	_nacts = _feed_chunks_actions[_acts++];
+	while ( _nacts-- > 0 )
+	{
+		switch ( _feed_chunks_actions[_acts++] )
+		{
+	case 2:
+#line 21 "feed_chunks"
+	{te = p+1;}
+	break;
+	case 3:
+#line 18 "feed_chunks"
+	{te = p;p--;{ words++; }}
+	break;
+	case 4:
+#line 19 "feed_chunks"
+	{te = p;p--;{ numbers++; }}
+	break;
+	case 5:
+#line 20 "feed_chunks"
+	{te = p;p--;{ words++; numbers++; }}
+	break;
+		default: break;
+		}
+	}
+
+_again:
+	_acts = _feed_chunks_to_state_actions[cs];
+	_nacts = _feed_chunks_actions[_acts++];
+	while ( _nacts-- > 0 ) {
+		switch ( _feed_chunks_actions[_acts++] ) {
+	case 0:
+#line 1 "NONE"
+	{ts = -1;}
+	break;
+		default: break;
+		}
+	}
+
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	if ( p == eof )
+	{
+	if ( _feed_chunks_eof_trans[cs] > 0 ) {
+		_trans = (sbyte) (_feed_chunks_eof_trans[cs] - 1);
+		goto _eof_trans;
+	}
+	}
+
+	_out: {}
+	}
+
+	_feed_chunks_feed.pending = 0;
+	if ( !isFinal && ts != -1 ) {
+		_feed_chunks_feed.pending = pe - ts;
+		if ( _feed_chunks_feed.buf == null || _feed_chunks_feed.buf.Length < _feed_chunks_feed.pending )
+			_feed_chunks_feed.buf = new byte[2 * _feed_chunks_feed.pending];
+		data.Slice( ts, _feed_chunks_feed.pending ).CopyTo( _feed_chunks_feed.buf );
+		te -= ts;
+		ts = 0;
+	}
+	_feed_chunks_feed.act = act;
+	_feed_chunks_feed.ts = ts;
+	_feed_chunks_feed.te = te;
+	_feed_chunks_feed.cs = cs;
+}
+
+#line 27 "feed_chunks"
+
+	static string Run( string input, int chunkSize )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		var f = new FeedChunks();
+		f.FeedInit();
+		for ( int i = 0; i < data.Length; i += chunkSize ) {
+			int len = Math.Min( chunkSize, data.Length - i );
+			f.Feed( new ReadOnlySpan<byte>( data, i, len ), false );
+		}
+		f.Feed( ReadOnlySpan<byte>.Empty, true );
+		return f.words + " " + f.numbers + " " + f._feed_chunks_feed.cs;
+	}
+
+	public static int Main()
+	{
+		string input = "alpha 12 beta7 gamma\n345 delta epsilon99 z 0\nomega";
+		string whole = Run( input, input.Length );
+
+		int failed = whole == "7 5 " + feed_chunks_start ? 0 : 1;
+		for ( int size = 1; size < 12; size++ ) {
+			string part = Run( input, size );
+			if ( part != whole ) {
+				Console.WriteLine( "FAIL {0}: {1} against {2}", size, part, whole );
+				failed = 1;
+			}
+		}
+		if ( failed != 0 )
+			Console.WriteLine( "whole: {0}", whole );
+		return failed;
+	}
+}
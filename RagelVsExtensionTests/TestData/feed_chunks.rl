@@ -0,0 +1,58 @@
+﻿// 'write feed' writes FeedInit and Feed, which run the machine over one
+// chunk at a time and keep a token that runs past the end of a chunk. The
+// generator test compares the generated text only. Built and run on its own,
+// Main checks that every chunk size finds the tokens a single chunk finds.
+
+using System;
+using System.Text;
+
+public class FeedChunks
+{
+	int words, numbers;
+
+	%%{
+		machine feed_chunks;
+		alphtype byte;
+
+		main := |*
+			[a-z]+ => { words++; };
+			[0-9]+ => { numbers++; };
+			[a-z]+ [0-9]+ => { words++; numbers++; };
+			' ' | '\n';
+		*|;
+	}%%
+
+	%% write data;
+	%% write feed;
+
+	static string Run( string input, int chunkSize )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		var f = new FeedChunks();
+		f.FeedInit();
+		for ( int i = 0; i < data.Length; i += chunkSize ) {
+			int len = Math.Min( chunkSize, data.Length - i );
+			f.Feed( new ReadOnlySpan<byte>( data, i, len ), false );
+		}
+		f.Feed( ReadOnlySpan<byte>.Empty, true );
+		return f.words + " " + f.numbers + " " + f._feed_chunks_feed.cs;
+	}
+
+	public static int Main()
+	{
+		string input = "alpha 12 beta7 gamma\n345 delta epsilon99 z 0\nomega";
+		string whole = Run( input, input.Length );
+
+		int failed = whole == "7 5 " + feed_chunks_start ? 0 : 1;
+		for ( int size = 1; size < 12; size++ ) {
+			string part = Run( input, size );
+			if ( part != whole ) {
+				Console.WriteLine( "FAIL {0}: {1} against {2}", size, part, whole );
+				failed = 1;
+			}
+		}
+		if ( failed != 0 )
+			Console.WriteLine( "whole: {0}", whole );
+		return failed;
+	}
+}
@@ -0,0 +1,303 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "multi_fields"
+/*
+ * 'write multi' writes a driver that walks many streams through the machine
+ * together, stopping each before any transition with actions. The generator
+ * test compares the generated text only. Built and run on its own, main
+ * checks that finishing each stream with the exec gives the state and the
+ * actions of running the exec alone.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+
+#line 18 "multi_fields"
+
+
+
+static const char _multi_fields_actions[] = {
+	0, 1, 0
+};
+
+static const char _multi_fields_key_offsets[] = {
+	0, 0, 5, 11, 15
+};
+
+static const char _multi_fields_trans_keys[] = {
+	95, 48, 57, 97, 122, 64, 95, 48, 
+	57, 97, 122, 48, 57, 97, 122, 46, 
+	48, 57, 97, 122, 0
+};
+
+static const char _multi_fields_single_lengths[] = {
+	0, 1, 2, 0, 1
+};
+
+static const char _multi_fields_range_lengths[] = {
+	0, 2, 2, 2, 2
+};
+
+static const char _multi_fields_index_offsets[] = {
+	0, 0, 4, 9, 12
+};
+
+static const char _multi_fields_indicies[] = {
+	0, 0, 0, 1, 2, 0, 0, 0, 
+	1, 3, 3, 1, 4, 3, 3, 1, 
+	0
+};
+
+static const char _multi_fields_trans_targs[] = {
+	2, 0, 3, 4, 3
+};
+
+static const char _multi_fields_trans_actions[] = {
+	0, 0, 0, 0, 1
+};
+
+static const int multi_fields_start = 1;
+static const int multi_fields_first_final = 4;
+static const int multi_fields_error = 0;
+
+static const int multi_fields_en_main = 1;
+
+
+#line 21 "multi_fields"
+
+static const char _multi_fields_multi_classes[] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 0, 0, 0, 0, 0, 0, 
+	2, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 3, 
+	0, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 0, 0, 0, 0, 0
+};
+
+static const char _multi_fields_multi_next[] = {
+	20, 20, 20, 20, 20, 8, 20, 8, 
+	20, 8, 12, 8, 20, 16, 20, 20, 
+	20, 16, 20, 20
+};
+
+static void multi_fields_multi_exec( int n, int *cs, char **p, char **pe )
+{
+	int ln[16], row[16];
+	char *q[16], *e[16];
+	int lanes = 0, i = 0, l;
+	long m;
+	for ( ;; ) {
+		while ( lanes < 16 && i < n ) {
+			if ( p[i] != pe[i] ) {
+				ln[lanes] = i;
+				row[lanes] = cs[i] * 4;
+				q[lanes] = p[i];
+				e[lanes] = pe[i];
+				lanes += 1;
+			}
+			i += 1;
+		}
+		if ( lanes == 0 )
+			break;
+
+		m = e[0] - q[0];
+		for ( l = 1; l < lanes; l++ ) {
+			if ( e[l] - q[l] < m )
+				m = e[l] - q[l];
+		}
+		while ( m-- > 0 ) {
+			for ( l = 0; l < lanes; l++ ) {
+				int s = _multi_fields_multi_next[row[l] + _multi_fields_multi_classes[*q[l] - (-128)]];
+				if ( s != 20 ) {
+					row[l] = s;
+					q[l] += 1;
+				}
+			}
+		}
+
+		for ( l = 0; l < lanes; ) {
+			if ( q[l] == e[l] || _multi_fields_multi_next[row[l] + _multi_fields_multi_classes[*q[l] - (-128)]] == 20 ) {
+				cs[ln[l]] = row[l] / 4;
+				p[ln[l]] = q[l];
+				lanes -= 1;
+				ln[l] = ln[lanes];
+				row[l] = row[lanes];
+				q[l] = q[lanes];
+				e[l] = e[lanes];
+			}
+			else
+				l += 1;
+		}
+	}
+}
+
+
+#line 22 "multi_fields"
+
+static int exec( int cs, const char *p, const char *pe, int *count )
+{
+	int dots = 0;
+	
+	{
+	int _klen;
+	unsigned int _trans;
+	const char *_acts;
+	unsigned int _nacts;
+	const char *_keys;
+
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	_keys = _multi_fields_trans_keys + _multi_fields_key_offsets[cs];
+	_trans = _multi_fields_index_offsets[cs];
+
+	_klen = _multi_fields_single_lengths[cs];
+	if ( _klen > 0 ) {
+		const char *_lower = _keys;
+		const char *_mid;
+		const char *_upper = _keys + _klen - 1;
+		while (1) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = _lower + ((_upper-_lower) >> 1);
+			if ( (*p) < *_mid )
+				_upper = _mid - 1;
+			else if ( (*p) > *_mid )
+				_lower = _mid + 1;
+			else {
+				_trans += (unsigned int)(_mid - _keys);
+				goto _match;
+			}
+		}
+		_keys += _klen;
+		_trans += _klen;
+	}
+
+	_klen = _multi_fields_range_lengths[cs];
+	if ( _klen > 0 ) {
+		const char *_lower = _keys;
+		const char *_mid;
+		const char *_upper = _keys + (_klen<<1) - 2;
+		while (1) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = _lower + (((_upper-_lower) >> 1) & ~1);
+			if ( (*p) < _mid[0] )
+				_upper = _mid - 2;
+			else if ( (*p) > _mid[1] )
+				_lower = _mid + 2;
+			else {
+				_trans += (unsigned int)((_mid - _keys)>>1);
+				goto _match;
+			}
+		}
+		_trans += _klen;
+	}
+
+_match:
+	_trans = _multi_fields_indicies[_trans];
+	cs = _multi_fields_trans_targs[_trans];
+
+	if ( _multi_fields_trans_actions[_trans] == 0 )
+		goto _again;
+
+	_acts = _multi_fields_actions + _multi_fields_trans_actions[_trans];
+	_nacts = (unsigned int) *_acts++;
+	while ( _nacts-- > 0 )
+	{
+		switch ( *_acts++ )
+		{
+	case 0:
+#line 15 "multi_fields"
+	{ dots++; }
+	break;
+		}
+	}
+
+_again:
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	_out: {}
+	}
+
+#line 27 "multi_fields"
+	*count = dots;
+	return cs;
+}
+
+int main()
+{
+	const char *fields[] = {
+		"joe@example.com", "a_b@x.y.z", "no_at_sign", "@start.com",
+		"end@", "two@@at", "x@y", "long_user_name_0123@host9.sub.domain.org",
+		"", "up@Case.com", "tail@dot.", "m@n.o.p.q.r.s.t.u.v.w",
+		"a@b.c", "d@e.f", "g@h.i", "j@k.l", "q@r.s", "t@u.v", "w@x.y",
+	};
+	int n = sizeof(fields) / sizeof(fields[0]);
+	int cs[32];
+	const char *p[32], *pe[32];
+	int i, failed = 0;
+
+	for ( i = 0; i < n; i++ ) {
+		cs[i] = multi_fields_start;
+		p[i] = fields[i];
+		pe[i] = fields[i] + strlen( fields[i] );
+	}
+
+	multi_fields_multi_exec( n, cs, (char**) p, (char**) pe );
+
+	for ( i = 0; i < n; i++ ) {
+		int dots = 0, alone, expect;
+		int end = p[i] == pe[i] ? cs[i] : exec( cs[i], p[i], pe[i], &dots );
+		alone = exec( multi_fields_start, fields[i], pe[i], &expect );
+		if ( end != alone || dots != expect ) {
+			printf( "FAIL %s: cs=%d dots=%d against cs=%d dots=%d\n",
+					fields[i], end, dots, alone, expect );
+			failed = 1;
+		}
+	}
+	return failed;
+}
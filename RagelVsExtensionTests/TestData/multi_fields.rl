@@ -0,0 +1,63 @@
+﻿/*
+ * 'write multi' writes a driver that walks many streams through the machine
+ * together, stopping each before any transition with actions. The generator
+ * test compares the generated text only. Built and run on its own, main
+ * checks that finishing each stream with the exec gives the state and the
+ * actions of running the exec alone.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+%%{
+	machine multi_fields;
+
+	action dot { dots++; }
+
+	main := [a-z0-9_]+ '@' [a-z0-9]+ ( '.' @dot [a-z0-9]+ )*;
+}%%
+
+%% write data;
+%% write multi;
+
+static int exec( int cs, const char *p, const char *pe, int *count )
+{
+	int dots = 0;
+	%% write exec;
+	*count = dots;
+	return cs;
+}
+
+int main()
+{
+	const char *fields[] = {
+		"joe@example.com", "a_b@x.y.z", "no_at_sign", "@start.com",
+		"end@", "two@@at", "x@y", "long_user_name_0123@host9.sub.domain.org",
+		"", "up@Case.com", "tail@dot.", "m@n.o.p.q.r.s.t.u.v.w",
+		"a@b.c", "d@e.f", "g@h.i", "j@k.l", "q@r.s", "t@u.v", "w@x.y",
+	};
+	int n = sizeof(fields) / sizeof(fields[0]);
+	int cs[32];
+	const char *p[32], *pe[32];
+	int i, failed = 0;
+
+	for ( i = 0; i < n; i++ ) {
+		cs[i] = multi_fields_start;
+		p[i] = fields[i];
+		pe[i] = fields[i] + strlen( fields[i] );
+	}
+
+	multi_fields_multi_exec( n, cs, (char**) p, (char**) pe );
+
+	for ( i = 0; i < n; i++ ) {
+		int dots = 0, alone, expect;
+		int end = p[i] == pe[i] ? cs[i] : exec( cs[i], p[i], pe[i], &dots );
+		alone = exec( multi_fields_start, fields[i], pe[i], &expect );
+		if ( end != alone || dots != expect ) {
+			printf( "FAIL %s: cs=%d dots=%d against cs=%d dots=%d\n",
+					fields[i], end, dots, alone, expect );
+			failed = 1;
+		}
+	}
+	return failed;
+}
@@ -0,0 +1,164 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+(* Two one-line actions that differ only in their code must keep cases of
+ * their own when no line directives are written. *)
+
+
+
+
+
+let _ocaml_actions_actions : int array = [|
+	0; 1; 0; 1; 1
+|]
+
+let _ocaml_actions_key_offsets : int array = [|
+	0; 0
+|]
+
+let _ocaml_actions_trans_keys : int array = [|
+	97; 98; 0
+|]
+
+let _ocaml_actions_single_lengths : int array = [|
+	0; 2
+|]
+
+let _ocaml_actions_range_lengths : int array = [|
+	0; 0
+|]
+
+let _ocaml_actions_index_offsets : int array = [|
+	0; 0
+|]
+
+let _ocaml_actions_trans_targs : int array = [|
+	1; 1; 0; 0
+|]
+
+let _ocaml_actions_trans_actions : int array = [|
+	1; 3; 0; 0
+|]
+
+let ocaml_actions_start : int = 1
+let ocaml_actions_first_final : int = 1
+let ocaml_actions_error : int = 0
+
+let ocaml_actions_en_main : int = 1
+
+type _ocaml_actions_state = { mutable keys : int; mutable trans : int; mutable acts : int; mutable nacts : int; }
+exception Goto_match
+exception Goto_again
+exception Goto_eof_trans
+
+
+let count data =
+	let a = ref 0 and b = ref 0 in
+	let cs = ref 0 and p = ref 0 and pe = ref (String.length data) in
+	
+	begin
+	cs.contents <- ocaml_actions_start;
+	end;
+
+	
+	begin
+	let state = { keys = 0; trans = 0; acts = 0; nacts = 0; } in
+	let rec do_start () =
+	if p.contents = pe.contents then
+		do_test_eof ()
+	else
+	if cs.contents = 0 then
+		do_out ()
+	else
+	do_resume ()
+and do_resume () =
+	begin try
+	state.keys <- _ocaml_actions_key_offsets.(cs.contents);
+	state.trans <- _ocaml_actions_index_offsets.(cs.contents);
+
+	let klen = _ocaml_actions_single_lengths.(cs.contents) in
+	if klen > 0 then begin
+		let lower : int ref = ref state.keys in
+		let upper : int ref = ref (state.keys + klen - 1) in
+		while !upper >= !lower do
+			let mid =  (!lower + ((!upper - !lower) / 2)) in
+			if Char.code data.[p.contents] < _ocaml_actions_trans_keys.(mid) then
+				upper :=  (mid - 1)
+			else if Char.code data.[p.contents] > _ocaml_actions_trans_keys.(mid) then
+				lower :=  (mid + 1)
+			else begin
+				state.trans <- state.trans +  (mid - state.keys);
+				raise Goto_match;
+			end
+		done;
+		state.keys <- state.keys +  klen;
+		state.trans <- state.trans +  klen;
+	end;
+
+	let klen = _ocaml_actions_range_lengths.(cs.contents) in
+	if klen > 0 then begin
+		let lower : int ref = ref state.keys in
+		let upper : int ref = ref (state.keys + (klen * 2) - 2) in
+		while !upper >= !lower do
+			let mid =  (!lower + (((!upper - !lower) / 2) land (lnot 1))) in
+			if Char.code data.[p.contents] < _ocaml_actions_trans_keys.(mid) then
+				upper :=  (mid - 2)
+			else if Char.code data.[p.contents] > _ocaml_actions_trans_keys.(mid+1) then
+				lower :=  (mid + 2)
+			else begin
+				state.trans <- state.trans + ((mid - state.keys) / 2);
+				raise Goto_match;
+		  end
+		done;
+		state.trans <- state.trans +  klen;
+	end;
+
+	with Goto_match -> () end;
+	do_match ()
+and do_match () =
+	do_eof_trans ()
+and do_eof_trans () =
+	cs.contents <- _ocaml_actions_trans_targs.(state.trans);
+
+	begin try
+	match _ocaml_actions_trans_actions.(state.trans) with
+	| 0 -> raise Goto_again
+	| _ ->
+	state.acts <- _ocaml_actions_trans_actions.(state.trans);
+	state.nacts <- _ocaml_actions_actions.((let temp = state.acts in state.acts <- state.acts + 1; temp));
+	while (let temp = state.nacts in state.nacts <- state.nacts - 1; temp) > 0 do
+		begin match _ocaml_actions_actions.((let temp = state.acts in state.acts <- state.acts + 1; temp)) with
+	| 0 ->
+		begin  incr a  end;
+	()
+	| 1 ->
+		begin  incr b  end;
+	()
+		| _ -> ()
+		end;
+	done
+	with Goto_again -> () end;
+	do_again ()
+	and do_again () =
+	match cs.contents with
+	| 0 -> do_out ()
+	| _ ->
+	p.contents <- p.contents + 1;
+	if p.contents <> pe.contents then
+		do_resume ()
+	else do_test_eof ()
+and do_test_eof () =
+	()
+	and do_out () = ()
+	in do_start ()
+	end;
+
+	(!a, !b)
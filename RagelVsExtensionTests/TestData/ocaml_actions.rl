@@ -0,0 +1,17 @@
+﻿(* Two one-line actions that differ only in their code must keep cases of
+ * their own when no line directives are written. *)
+
+%%{
+	machine ocaml_actions;
+
+	main := ( 'a' @{ incr a } | 'b' @{ incr b } )*;
+}%%
+
+%% write data;
+
+let count data =
+	let a = ref 0 and b = ref 0 in
+	let cs = ref 0 and p = ref 0 and pe = ref (String.length data) in
+	%% write init;
+	%% write exec;
+	(!a, !b)
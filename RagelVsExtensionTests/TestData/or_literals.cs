@@ -0,0 +1,141 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "or_literals"
+// Or-literals with escapes and ranges must take every character they list.
+
+public class OrLiterals
+{
+	
+#line 9 "or_literals"
+
+
+	
+static readonly sbyte[] _or_literals_key_offsets =  new sbyte [] {
+	0, 0
+};
+
+static readonly char[] _or_literals_trans_keys =  new char [] {
+	'\u0020', '\u002d', '\u005f', '\u0009', '\u000a', '\u002a', '\u002b', '\u002f', 
+	'\u0039', '\u0041', '\u005a', '\u0061', '\u007a', (char) 0
+};
+
+static readonly sbyte[] _or_literals_single_lengths =  new sbyte [] {
+	0, 3
+};
+
+static readonly sbyte[] _or_literals_range_lengths =  new sbyte [] {
+	0, 5
+};
+
+static readonly sbyte[] _or_literals_index_offsets =  new sbyte [] {
+	0, 0
+};
+
+static readonly sbyte[] _or_literals_trans_targs =  new sbyte [] {
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	0, 0
+};
+
+const int or_literals_start = 1;
+const int or_literals_first_final = 1;
+const int or_literals_error = 0;
+
+const int or_literals_en_main = 1;
+
+
+#line 12 "or_literals"
+
+	public static int Scan( char[] data )
+	{
+		int cs, p = 0, pe = data.Length;
+
+		
+	{
+	cs = or_literals_start;
+	}
+
+#line 18 "or_literals"
+		
+	{
+	sbyte _klen;
+	sbyte _trans;
+	sbyte _keys;
+
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	_keys = _or_literals_key_offsets[cs];
+	_trans = (sbyte)_or_literals_index_offsets[cs];
+
+	_klen = _or_literals_single_lengths[cs];
+	if ( _klen > 0 ) {
+		sbyte _lower = _keys;
+		sbyte _mid;
+		sbyte _upper = (sbyte) (_keys + _klen - 1);
+		while (true) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = (sbyte) (_lower + ((_upper-_lower) >> 1));
+			if ( data[p] < _or_literals_trans_keys[_mid] )
+				_upper = (sbyte) (_mid - 1);
+			else if ( data[p] > _or_literals_trans_keys[_mid] )
+				_lower = (sbyte) (_mid + 1);
+			else {
+				_trans += (sbyte) (_mid - _keys);
+				goto _match;
+			}
+		}
+		_keys += (sbyte) _klen;
+		_trans += (sbyte) _klen;
+	}
+
+	_klen = _or_literals_range_lengths[cs];
+	if ( _klen > 0 ) {
+		sbyte _lower = _keys;
+		sbyte _mid;
+		sbyte _upper = (sbyte) (_keys + (_klen<<1) - 2);
+		while (true) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = (sbyte) (_lower + (((_upper-_lower) >> 1) & ~1));
+			if ( data[p] < _or_literals_trans_keys[_mid] )
+				_upper = (sbyte) (_mid - 2);
+			else if ( data[p] > _or_literals_trans_keys[_mid+1] )
+				_lower = (sbyte) (_mid + 2);
+			else {
+				_trans += (sbyte)((_mid - _keys)>>1);
+				goto _match;
+			}
+		}
+		_trans += (sbyte) _klen;
+	}
+
+_match:
+	cs = _or_literals_trans_targs[_trans];
+
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	_out: {}
+	}
+
+#line 19 "or_literals"
+
+		return cs;
+	}
+}
@@ -0,0 +1,22 @@
+﻿// Or-literals with escapes and ranges must take every character they list.
+
+public class OrLiterals
+{
+	%%{
+		machine or_literals;
+
+		main := ( [ \t\n]+ | [+\-*/] | [a-zA-Z_]+ | [0-9]+ )*;
+	}%%
+
+	%% write data;
+
+	public static int Scan( char[] data )
+	{
+		int cs, p = 0, pe = data.Length;
+
+		%% write init;
+		%% write exec;
+
+		return cs;
+	}
+}
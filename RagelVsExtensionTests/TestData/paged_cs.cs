@@ -0,0 +1,138 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "paged_cs"
+// The exec is written before 'write data paged', so it must already look up
+// transitions through the page directory.
+
+public class PagedCs
+{
+	
+#line 12 "paged_cs"
+
+
+	public static int Scan( byte[] data )
+	{
+		int cs, p = 0, pe = data.Length;
+
+		
+	{
+	cs = paged_cs_start;
+	}
+
+#line 19 "paged_cs"
+		
+	{
+	sbyte _slen;
+	sbyte _trans;
+	int _keys;
+	byte _inds;
+	int _pos;
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	_keys = cs<<1;
+	_slen = _paged_cs_key_spans[cs];
+	if ( _slen > 0 && _paged_cs_trans_keys[_keys] <= data[p] && data[p] <= _paged_cs_trans_keys[_keys+1] ) {
+		_pos = data[p] - _paged_cs_trans_keys[_keys];
+		_inds = _paged_cs_page_dir[_paged_cs_index_offsets[cs] + (_pos >> 6)];
+		_trans = _paged_cs_indicies[_inds + (_pos & 63)];
+	}
+	else
+		_trans = _paged_cs_default_trans[cs];
+
+	cs = _paged_cs_trans_targs[_trans];
+
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	_out: {}
+	}
+
+#line 20 "paged_cs"
+
+		return cs;
+	}
+
+	
+static readonly byte[] _paged_cs_trans_keys =  new byte [] {
+	0, 0, 10, 122, 48, 122, 48, 122, 0
+};
+
+static readonly sbyte[] _paged_cs_key_spans =  new sbyte [] {
+	0, 113, 75, 75
+};
+
+static readonly sbyte[] _paged_cs_index_offsets =  new sbyte [] {
+	0, 0, 2, 4
+};
+
+static readonly byte[] _paged_cs_page_dir =  new byte [] {
+	0, 64, 128, 192, 128, 192, 0
+};
+
+static readonly sbyte[] _paged_cs_indicies =  new sbyte [] {
+	0, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 2, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	1, 1, 1, 1, 1, 1, 1, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 1, 1, 1, 1, 3, 1, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 1, 1, 1, 1, 1, 1, 
+	1, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 1, 1, 1, 1, 3, 
+	1, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	0
+};
+
+static readonly sbyte[] _paged_cs_default_trans =  new sbyte [] {
+	0, 1, 1, 1
+};
+
+static readonly sbyte[] _paged_cs_trans_targs =  new sbyte [] {
+	3, 0, 2, 1
+};
+
+const int paged_cs_start = 3;
+const int paged_cs_first_final = 3;
+const int paged_cs_error = 0;
+
+const int paged_cs_en_main = 3;
+
+
+#line 25 "paged_cs"
+}
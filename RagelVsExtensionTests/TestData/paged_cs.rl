@@ -0,0 +1,25 @@
+﻿// The exec is written before 'write data paged', so it must already look up
+// transitions through the page directory.
+
+public class PagedCs
+{
+	%%{
+		machine paged_cs;
+		alphtype byte;
+
+		word = [a-zA-Z0-9_]+;
+		main := ( word ( ' ' word )* '\n' )*;
+	}%%
+
+	public static int Scan( byte[] data )
+	{
+		int cs, p = 0, pe = data.Length;
+
+		%% write init;
+		%% write exec;
+
+		return cs;
+	}
+
+	%% write data paged;
+}
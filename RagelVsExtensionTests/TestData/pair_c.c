@@ -0,0 +1,188 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "pair_c"
+/*
+ * The -F3 style steps two keys at a time. The generator test compares the
+ * generated text only. Built and run on its own, main checks that an error
+ * on either key of a pair and an odd key at the end stop where single steps
+ * would.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+
+#line 15 "pair_c"
+
+
+
+static const char _pair_c_pair_classes[] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 2, 2, 2, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static const char _pair_c_pair_high_classes[] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 6, 6, 6, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static const char _pair_c_pair_single[] = {
+	0, 0, 0, 0, 2, 0, 0, 0, 
+	1
+};
+
+static const char _pair_c_pair_next[] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 9, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 18, 0
+};
+
+static const int pair_c_start = 2;
+static const int pair_c_first_final = 2;
+static const int pair_c_error = 0;
+
+static const int pair_c_en_main = 2;
+
+
+#line 18 "pair_c"
+
+static int scan( const char *data, int *pos )
+{
+	const char *p = data, *pe = data + strlen( data );
+	int cs;
+
+	
+	{
+	cs = pair_c_start;
+	}
+
+#line 25 "pair_c"
+	
+	{
+	int _ps, _next;
+	if ( cs == 0 )
+		goto _out;
+	_ps = cs * 9;
+	while ( pe - p >= 2 ) {
+		_next = _pair_c_pair_next[_ps + _pair_c_pair_high_classes[(*p) - (-128)] + _pair_c_pair_classes[p[1] - (-128)]];
+		if ( _next == 0 ) {
+			if ( _pair_c_pair_single[_ps / 3 + _pair_c_pair_classes[(*p) - (-128)]] != 0 )
+				p += 1;
+			cs = 0;
+			goto _out;
+		}
+		_ps = _next;
+		p += 2;
+	}
+	cs = _ps / 9;
+	if ( p != pe ) {
+		cs = _pair_c_pair_single[_ps / 3 + _pair_c_pair_classes[(*p) - (-128)]];
+		if ( cs != 0 )
+			p += 1;
+	}
+	_out: {}
+	}
+
+#line 26 "pair_c"
+
+	*pos = (int)( p - data );
+	return cs;
+}
+
+static const struct {
+	const char *input;
+	int pos;
+	int final;
+	int error;
+} cases[] = {
+	{ "a1b2", 4, 1, 0 },
+	{ "a1x2", 2, 0, 1 },
+	{ "a1bx", 3, 0, 1 },
+	{ "a1b", 3, 0, 0 },
+	{ "a1b2c", 5, 0, 0 },
+};
+
+int main()
+{
+	int i, failed = 0;
+	for ( i = 0; i < (int)( sizeof(cases) / sizeof(cases[0]) ); i++ ) {
+		int pos, cs = scan( cases[i].input, &pos );
+		if ( pos != cases[i].pos ||
+				( cs >= pair_c_first_final ) != cases[i].final ||
+				( cs == pair_c_error ) != cases[i].error ) {
+			printf( "FAIL %s: cs=%d pos=%d\n", cases[i].input, cs, pos );
+			failed = 1;
+		}
+	}
+	return failed;
+}
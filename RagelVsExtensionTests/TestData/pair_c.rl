@@ -0,0 +1,57 @@
+﻿/*
+ * The -F3 style steps two keys at a time. The generator test compares the
+ * generated text only. Built and run on its own, main checks that an error
+ * on either key of a pair and an odd key at the end stop where single steps
+ * would.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+%%{
+	machine pair_c;
+
+	main := ( [a-c] [0-9] )*;
+}%%
+
+%% write data;
+
+static int scan( const char *data, int *pos )
+{
+	const char *p = data, *pe = data + strlen( data );
+	int cs;
+
+	%% write init;
+	%% write exec;
+
+	*pos = (int)( p - data );
+	return cs;
+}
+
+static const struct {
+	const char *input;
+	int pos;
+	int final;
+	int error;
+} cases[] = {
+	{ "a1b2", 4, 1, 0 },
+	{ "a1x2", 2, 0, 1 },
+	{ "a1bx", 3, 0, 1 },
+	{ "a1b", 3, 0, 0 },
+	{ "a1b2c", 5, 0, 0 },
+};
+
+int main()
+{
+	int i, failed = 0;
+	for ( i = 0; i < (int)( sizeof(cases) / sizeof(cases[0]) ); i++ ) {
+		int pos, cs = scan( cases[i].input, &pos );
+		if ( pos != cases[i].pos ||
+				( cs >= pair_c_first_final ) != cases[i].final ||
+				( cs == pair_c_error ) != cases[i].error ) {
+			printf( "FAIL %s: cs=%d pos=%d\n", cases[i].input, cs, pos );
+			failed = 1;
+		}
+	}
+	return failed;
+}
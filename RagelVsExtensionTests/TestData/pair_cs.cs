@@ -0,0 +1,182 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "pair_cs"
+// The -F3 style steps two keys at a time. The generator test compares the
+// generated text only. Built and run on its own, Main checks that an error
+// on either key of a pair and an odd key at the end stop where single steps
+// would.
+
+using System;
+using System.Text;
+
+public static class PairCs
+{
+	
+#line 16 "pair_cs"
+
+
+	
+static readonly sbyte[] _pair_cs_pair_classes =  new sbyte [] {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 2, 2, 2, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static readonly sbyte[] _pair_cs_pair_high_classes =  new sbyte [] {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 6, 6, 6, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static readonly sbyte[] _pair_cs_pair_single =  new sbyte [] {
+	0, 0, 0, 0, 2, 0, 0, 0, 
+	1
+};
+
+static readonly sbyte[] _pair_cs_pair_next =  new sbyte [] {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 9, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 18, 0
+};
+
+const int pair_cs_start = 2;
+const int pair_cs_first_final = 2;
+const int pair_cs_error = 0;
+
+const int pair_cs_en_main = 2;
+
+
+#line 19 "pair_cs"
+
+	static int Scan( byte[] data, out int pos )
+	{
+		int cs, p = 0, pe = data.Length;
+
+		
+	{
+	cs = pair_cs_start;
+	}
+
+#line 25 "pair_cs"
+		
+	{
+	int _ps, _next;
+	if ( cs == 0 )
+		goto _out;
+	_ps = cs * 9;
+	while ( pe - p >= 2 ) {
+		_next = _pair_cs_pair_next[_ps + _pair_cs_pair_high_classes[data[p]] + _pair_cs_pair_classes[data[p + 1]]];
+		if ( _next == 0 ) {
+			if ( _pair_cs_pair_single[_ps / 3 + _pair_cs_pair_classes[data[p]]] != 0 )
+				p += 1;
+			cs = 0;
+			goto _out;
+		}
+		_ps = _next;
+		p += 2;
+	}
+	cs = _ps / 9;
+	if ( p != pe ) {
+		cs = _pair_cs_pair_single[_ps / 3 + _pair_cs_pair_classes[data[p]]];
+		if ( cs != 0 )
+			p += 1;
+	}
+	_out: {}
+	}
+
+#line 26 "pair_cs"
+
+		pos = p;
+		return cs;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "a1b2", 4, true, false ),
+			Tuple.Create( "a1x2", 2, false, true ),
+			Tuple.Create( "a1bx", 3, false, true ),
+			Tuple.Create( "a1b", 3, false, false ),
+			Tuple.Create( "a1b2c", 5, false, false ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			int pos, cs = Scan( Encoding.ASCII.GetBytes( c.Item1 ), out pos );
+			if ( pos != c.Item2 || ( cs >= pair_cs_first_final ) != c.Item3 ||
+					( cs == pair_cs_error ) != c.Item4 ) {
+				Console.WriteLine( "FAIL {0}: cs={1} pos={2}", c.Item1, cs, pos );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
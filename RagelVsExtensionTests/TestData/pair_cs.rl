@@ -0,0 +1,52 @@
+﻿// The -F3 style steps two keys at a time. The generator test compares the
+// generated text only. Built and run on its own, Main checks that an error
+// on either key of a pair and an odd key at the end stop where single steps
+// would.
+
+using System;
+using System.Text;
+
+public static class PairCs
+{
+	%%{
+		machine pair_cs;
+		alphtype byte;
+
+		main := ( [a-c] [0-9] )*;
+	}%%
+
+	%% write data;
+
+	static int Scan( byte[] data, out int pos )
+	{
+		int cs, p = 0, pe = data.Length;
+
+		%% write init;
+		%% write exec;
+
+		pos = p;
+		return cs;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "a1b2", 4, true, false ),
+			Tuple.Create( "a1x2", 2, false, true ),
+			Tuple.Create( "a1bx", 3, false, true ),
+			Tuple.Create( "a1b", 3, false, false ),
+			Tuple.Create( "a1b2c", 5, false, false ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			int pos, cs = Scan( Encoding.ASCII.GetBytes( c.Item1 ), out pos );
+			if ( pos != c.Item2 || ( cs >= pair_cs_first_final ) != c.Item3 ||
+					( cs == pair_cs_error ) != c.Item4 ) {
+				Console.WriteLine( "FAIL {0}: cs={1} pos={2}", c.Item1, cs, pos );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
@@ -0,0 +1,486 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "parallel_lines"
+/*
+ * 'write parallel' writes a driver that scans one input in chunks, starting
+ * every chunk but the first from all states at once. The generator test
+ * compares the generated text only. Built and run on its own, with or
+ * without OpenMP, main checks that any number of chunks ends in the state
+ * the exec ends in, with errors in the input and without.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+
+#line 19 "parallel_lines"
+
+
+
+static const int parallel_lines_start = 22;
+static const int parallel_lines_first_final = 22;
+static const int parallel_lines_error = 0;
+
+static const int parallel_lines_en_main = 22;
+
+
+#line 22 "parallel_lines"
+
+static const char _parallel_lines_multi_classes[] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 1, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	2, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 4, 0, 0, 0, 0, 0, 
+	0, 5, 0, 0, 0, 6, 7, 0, 
+	0, 8, 0, 0, 0, 0, 9, 10, 
+	0, 0, 11, 0, 0, 0, 0, 12, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0
+};
+
+static const short _parallel_lines_multi_next[] = {
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	26, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 299, 299, 39, 299, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 52, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 299, 299, 299, 65, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 299, 78, 299, 299, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 91, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 299, 299, 104, 299, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 117, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 130, 299, 208, 299, 299, 
+	299, 247, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 299, 143, 299, 299, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 156, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 299, 299, 169, 299, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 182, 299, 299, 299, 
+	195, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 195, 286, 195, 195, 195, 
+	195, 195, 195, 195, 195, 195, 195, 195, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 221, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 234, 299, 299, 299, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 182, 299, 299, 299, 
+	299, 299, 299, 299, 260, 299, 299, 299, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299, 299, 299, 299, 299, 273, 
+	299, 299, 299, 299, 299, 299, 299, 299, 
+	299, 299, 182, 299, 299, 299, 299, 299, 
+	299, 13, 299, 299, 299, 299, 299, 299, 
+	299, 299, 299
+};
+
+#include <stdlib.h>
+
+static int parallel_lines_parallel_exec( int cs, char *p, char *pe, int chunks )
+{
+	long long len = pe - p;
+	int *ends = chunks > 1 ? (int*) malloc( sizeof(int) * chunks * 115 ) : 0;
+	int c;
+	if ( ends == 0 ) {
+		int r = cs * 13;
+		for ( ; p < pe && r != 299; p++ )
+			r = _parallel_lines_multi_next[r + _parallel_lines_multi_classes[*p - (-128)]];
+		return r == 299 ? 0 : r / 13;
+	}
+#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic)
+#endif
+	for ( c = 0; c < chunks; c++ ) {
+		char *q = p + len * c / chunks;
+		char *e = p + len * ( c + 1 ) / chunks;
+		int *cur = ends + chunks * 23 + c * 92;
+		int *own = cur + 23, *merged = own + 23, *slot = merged + 23;
+		int n, m, k, s;
+		if ( c == 0 ) {
+			cur[0] = cs * 13;
+			for ( s = 0; s < 23; s++ )
+				own[s] = 0;
+			n = 1;
+		}
+		else {
+			for ( s = 0; s < 23; s++ ) {
+				cur[s] = s * 13;
+				own[s] = s;
+			}
+			n = 23;
+		}
+		for ( s = 0; s < 23; s++ )
+			slot[s] = -1;
+
+		while ( q < e && n > 1 ) {
+			char *stretch = e - q > 64 ? q + 64 : e;
+			for ( ; q < stretch; q++ ) {
+				int cl = _parallel_lines_multi_classes[*q - (-128)];
+				for ( k = 0; k < n; k++ ) {
+					if ( cur[k] != 299 )
+						cur[k] = _parallel_lines_multi_next[cur[k] + cl];
+				}
+			}
+
+			m = 0;
+			for ( k = 0; k < n; k++ ) {
+				if ( cur[k] == 299 )
+					merged[k] = -1;
+				else {
+					s = cur[k] / 13;
+					if ( slot[s] < 0 ) {
+						slot[s] = m;
+						cur[m++] = cur[k];
+					}
+					merged[k] = slot[s];
+				}
+			}
+			for ( s = 0; s < 23; s++ ) {
+				if ( own[s] >= 0 )
+					own[s] = merged[own[s]];
+			}
+			for ( k = 0; k < m; k++ )
+				slot[cur[k] / 13] = -1;
+			n = m;
+		}
+
+		if ( n == 1 ) {
+			int r = cur[0];
+			for ( ; q < e && r != 299; q++ )
+				r = _parallel_lines_multi_next[r + _parallel_lines_multi_classes[*q - (-128)]];
+			cur[0] = r;
+		}
+
+		for ( s = 0; s < 23; s++ ) {
+			ends[c * 23 + s] = own[s] < 0 || cur[own[s]] == 299 ? 0 : cur[own[s]] / 13;
+		}
+	}
+
+	for ( c = 0; c < chunks && cs >= 0; c++ )
+		cs = ends[c * 23 + cs];
+	free( ends );
+	return cs;
+}
+
+
+#line 23 "parallel_lines"
+
+static int exec( const char *p, const char *pe )
+{
+	int cs;
+	
+	{
+	cs = parallel_lines_start;
+	}
+
+#line 28 "parallel_lines"
+	
+	{
+	if ( p == pe )
+		goto _test_eof;
+	switch ( cs )
+	{
+st22:
+	if ( ++p == pe )
+		goto _test_eof22;
+case 22:
+	if ( 48 <= (*p) && (*p) <= 57 )
+		goto st1;
+	goto st0;
+st0:
+cs = 0;
+	goto _out;
+st1:
+	if ( ++p == pe )
+		goto _test_eof1;
+case 1:
+	if ( 48 <= (*p) && (*p) <= 57 )
+		goto st2;
+	goto st0;
+st2:
+	if ( ++p == pe )
+		goto _test_eof2;
+case 2:
+	if ( (*p) == 58 )
+		goto st3;
+	goto st0;
+st3:
+	if ( ++p == pe )
+		goto _test_eof3;
+case 3:
+	if ( 48 <= (*p) && (*p) <= 57 )
+		goto st4;
+	goto st0;
+st4:
+	if ( ++p == pe )
+		goto _test_eof4;
+case 4:
+	if ( 48 <= (*p) && (*p) <= 57 )
+		goto st5;
+	goto st0;
+st5:
+	if ( ++p == pe )
+		goto _test_eof5;
+case 5:
+	if ( (*p) == 58 )
+		goto st6;
+	goto st0;
+st6:
+	if ( ++p == pe )
+		goto _test_eof6;
+case 6:
+	if ( 48 <= (*p) && (*p) <= 57 )
+		goto st7;
+	goto st0;
+st7:
+	if ( ++p == pe )
+		goto _test_eof7;
+case 7:
+	if ( 48 <= (*p) && (*p) <= 57 )
+		goto st8;
+	goto st0;
+st8:
+	if ( ++p == pe )
+		goto _test_eof8;
+case 8:
+	if ( (*p) == 32 )
+		goto st9;
+	goto st0;
+st9:
+	if ( ++p == pe )
+		goto _test_eof9;
+case 9:
+	switch( (*p) ) {
+		case 69: goto st10;
+		case 73: goto st16;
+		case 87: goto st19;
+	}
+	goto st0;
+st10:
+	if ( ++p == pe )
+		goto _test_eof10;
+case 10:
+	if ( pe - p >= 6 &&
+			(*p) == 82 &&
+			p[1] == 82 &&
+			p[2] == 79 &&
+			p[3] == 82 &&
+			p[4] == 32 &&
+			p[5] == 10 )
+	{
+		p += 5;
+		{goto st22;}
+	}
+	if ( (*p) == 82 )
+		goto st11;
+	goto st0;
+st11:
+	if ( ++p == pe )
+		goto _test_eof11;
+case 11:
+	if ( (*p) == 82 )
+		goto st12;
+	goto st0;
+st12:
+	if ( ++p == pe )
+		goto _test_eof12;
+case 12:
+	if ( (*p) == 79 )
+		goto st13;
+	goto st0;
+st13:
+	if ( ++p == pe )
+		goto _test_eof13;
+case 13:
+	if ( (*p) == 82 )
+		goto st14;
+	goto st0;
+st14:
+	if ( ++p == pe )
+		goto _test_eof14;
+case 14:
+	if ( (*p) == 32 )
+		goto st15;
+	goto st0;
+st15:
+	if ( ++p == pe )
+		goto _test_eof15;
+case 15:
+	if ( (*p) == 10 )
+		goto st22;
+	goto st15;
+st16:
+	if ( ++p == pe )
+		goto _test_eof16;
+case 16:
+	if ( pe - p >= 5 &&
+			(*p) == 78 &&
+			p[1] == 70 &&
+			p[2] == 79 &&
+			p[3] == 32 &&
+			p[4] == 10 )
+	{
+		p += 4;
+		{goto st22;}
+	}
+	if ( (*p) == 78 )
+		goto st17;
+	goto st0;
+st17:
+	if ( ++p == pe )
+		goto _test_eof17;
+case 17:
+	if ( (*p) == 70 )
+		goto st18;
+	goto st0;
+st18:
+	if ( ++p == pe )
+		goto _test_eof18;
+case 18:
+	if ( (*p) == 79 )
+		goto st14;
+	goto st0;
+st19:
+	if ( ++p == pe )
+		goto _test_eof19;
+case 19:
+	if ( pe - p >= 5 &&
+			(*p) == 65 &&
+			p[1] == 82 &&
+			p[2] == 78 &&
+			p[3] == 32 &&
+			p[4] == 10 )
+	{
+		p += 4;
+		{goto st22;}
+	}
+	if ( (*p) == 65 )
+		goto st20;
+	goto st0;
+st20:
+	if ( ++p == pe )
+		goto _test_eof20;
+case 20:
+	if ( (*p) == 82 )
+		goto st21;
+	goto st0;
+st21:
+	if ( ++p == pe )
+		goto _test_eof21;
+case 21:
+	if ( (*p) == 78 )
+		goto st14;
+	goto st0;
+	}
+	_test_eof22: cs = 22; goto _test_eof; 
+	_test_eof1: cs = 1; goto _test_eof; 
+	_test_eof2: cs = 2; goto _test_eof; 
+	_test_eof3: cs = 3; goto _test_eof; 
+	_test_eof4: cs = 4; goto _test_eof; 
+	_test_eof5: cs = 5; goto _test_eof; 
+	_test_eof6: cs = 6; goto _test_eof; 
+	_test_eof7: cs = 7; goto _test_eof; 
+	_test_eof8: cs = 8; goto _test_eof; 
+	_test_eof9: cs = 9; goto _test_eof; 
+	_test_eof10: cs = 10; goto _test_eof; 
+	_test_eof11: cs = 11; goto _test_eof; 
+	_test_eof12: cs = 12; goto _test_eof; 
+	_test_eof13: cs = 13; goto _test_eof; 
+	_test_eof14: cs = 14; goto _test_eof; 
+	_test_eof15: cs = 15; goto _test_eof; 
+	_test_eof16: cs = 16; goto _test_eof; 
+	_test_eof17: cs = 17; goto _test_eof; 
+	_test_eof18: cs = 18; goto _test_eof; 
+	_test_eof19: cs = 19; goto _test_eof; 
+	_test_eof20: cs = 20; goto _test_eof; 
+	_test_eof21: cs = 21; goto _test_eof; 
+
+	_test_eof: {}
+	_out: {}
+	}
+
+#line 29 "parallel_lines"
+	return cs;
+}
+
+int main()
+{
+	static char text[4096];
+	const char *lines[] = {
+		"12:00:01 INFO started\n", "12:00:02 WARN slow disk\n",
+		"12:00:03 ERROR lost 3 of 4 replies: WARN INFO\n",
+		"12:01:00 INFO 12:00:00 INFO\n",
+	};
+	int bad, chunks, failed = 0;
+	size_t len = 0;
+
+	while ( len + 64 < sizeof(text) ) {
+		const char *l = lines[len % 4];
+		memcpy( text + len, l, strlen( l ) );
+		len += strlen( l );
+	}
+
+	for ( bad = -1; bad < 3; bad++ ) {
+		const char *pe = text + len;
+		int alone;
+		if ( bad == 0 )
+			pe -= 3;
+		else if ( bad == 1 ) {
+			size_t at = len / 2;
+			while ( text[at - 1] != '\n' )
+				at += 1;
+			text[at] = 'x';
+		}
+		else if ( bad == 2 )
+			text[7] = '-';
+
+		alone = exec( text, pe );
+		for ( chunks = 1; chunks <= 40; chunks++ ) {
+			int cs = parallel_lines_parallel_exec( parallel_lines_start,
+					text, (char*) pe, chunks );
+			if ( cs != alone ) {
+				printf( "FAIL error %d, %d chunks: cs=%d against %d\n",
+						bad, chunks, cs, alone );
+				failed = 1;
+			}
+		}
+	}
+	return failed;
+}
@@ -0,0 +1,75 @@
+﻿/*
+ * 'write parallel' writes a driver that scans one input in chunks, starting
+ * every chunk but the first from all states at once. The generator test
+ * compares the generated text only. Built and run on its own, with or
+ * without OpenMP, main checks that any number of chunks ends in the state
+ * the exec ends in, with errors in the input and without.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+%%{
+	machine parallel_lines;
+
+	level = 'INFO' | 'WARN' | 'ERROR';
+	time = [0-9]{2} ':' [0-9]{2} ':' [0-9]{2};
+	line = time ' ' level ' ' [^\n]* '\n';
+	main := line*;
+}%%
+
+%% write data;
+%% write parallel;
+
+static int exec( const char *p, const char *pe )
+{
+	int cs;
+	%% write init;
+	%% write exec;
+	return cs;
+}
+
+int main()
+{
+	static char text[4096];
+	const char *lines[] = {
+		"12:00:01 INFO started\n", "12:00:02 WARN slow disk\n",
+		"12:00:03 ERROR lost 3 of 4 replies: WARN INFO\n",
+		"12:01:00 INFO 12:00:00 INFO\n",
+	};
+	int bad, chunks, failed = 0;
+	size_t len = 0;
+
+	while ( len + 64 < sizeof(text) ) {
+		const char *l = lines[len % 4];
+		memcpy( text + len, l, strlen( l ) );
+		len += strlen( l );
+	}
+
+	for ( bad = -1; bad < 3; bad++ ) {
+		const char *pe = text + len;
+		int alone;
+		if ( bad == 0 )
+			pe -= 3;
+		else if ( bad == 1 ) {
+			size_t at = len / 2;
+			while ( text[at - 1] != '\n' )
+				at += 1;
+			text[at] = 'x';
+		}
+		else if ( bad == 2 )
+			text[7] = '-';
+
+		alone = exec( text, pe );
+		for ( chunks = 1; chunks <= 40; chunks++ ) {
+			int cs = parallel_lines_parallel_exec( parallel_lines_start,
+					text, (char*) pe, chunks );
+			if ( cs != alone ) {
+				printf( "FAIL error %d, %d chunks: cs=%d against %d\n",
+						bad, chunks, cs, alone );
+				failed = 1;
+			}
+		}
+	}
+	return failed;
+}
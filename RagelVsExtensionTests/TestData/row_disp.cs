@@ -0,0 +1,185 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "row_disp"
+// The -F2 style packs the rows of the flat table into one array by row
+// displacement. The generator test compares the generated text only. Built
+// and run on its own, Main checks that rows sharing the packed array still
+// accept and reject the same input as the plain flat style.
+
+using System;
+using System.Text;
+
+public static class RowDisp
+{
+	
+#line 19 "row_disp"
+
+
+	
+static readonly byte[] _row_disp_trans_keys =  new byte [] {
+	1, 0, 34, 122, 34, 92, 32, 122, 32, 122, 48, 57, 1, 0, 1, 0, 
+	0
+};
+
+static readonly sbyte[] _row_disp_comb_base =  new sbyte [] {
+	0, 119, 1, 28, 0, 0, 0, 0
+};
+
+static readonly sbyte[] _row_disp_indicies =  new sbyte [] {
+	6, 4, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 7, 0, 
+	2, 2, 2, 2, 2, 2, 2, 2, 
+	2, 2, 0, 3, 6, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 2, 2, 2, 2, 
+	2, 2, 2, 2, 2, 2, 0, 3, 
+	0, 0, 0, 5, 0, 0, 0, 4, 
+	0, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 4, 0, 4, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 2, 2, 2, 
+	2, 2, 2, 2, 2, 2, 2, 0, 
+	3, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 4, 0, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	0
+};
+
+static readonly sbyte[] _row_disp_comb_check =  new sbyte [] {
+	4, 2, 4, 8, 8, 8, 8, 8, 
+	8, 8, 8, 8, 8, 8, 4, 8, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 8, 4, 3, 8, 3, 8, 
+	8, 8, 8, 8, 8, 8, 8, 8, 
+	8, 8, 8, 8, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 8, 3, 
+	8, 8, 8, 2, 8, 8, 8, 4, 
+	8, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 4, 4, 4, 4, 4, 
+	4, 4, 4, 3, 8, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 1, 
+	8, 8, 8, 8, 8, 8, 8, 8, 
+	8, 8, 8, 8, 8, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 8, 
+	1, 8, 8, 8, 8, 8, 8, 8, 
+	8, 8, 8, 8, 8, 8, 8, 8, 
+	8, 8, 8, 8, 8, 8, 8, 8, 
+	8, 8, 8, 8, 8, 8, 8, 8, 
+	8, 8, 8, 8, 1, 8, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	8
+};
+
+static readonly sbyte[] _row_disp_default_trans =  new sbyte [] {
+	0, 0, 1, 1, 0, 0, 1, 1, 1, 1, 1, 4, 0, 0, 1, 1, 
+	0
+};
+
+static readonly sbyte[] _row_disp_trans_targs =  new sbyte [] {
+	2, 0, 4, 7, 3, 6, 1, 5
+};
+
+const int row_disp_start = 1;
+const int row_disp_first_final = 7;
+const int row_disp_error = 0;
+
+const int row_disp_en_main = 1;
+
+
+#line 22 "row_disp"
+
+	static bool Accepts( string input )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length;
+
+		
+	{
+	cs = row_disp_start;
+	}
+
+#line 29 "row_disp"
+		
+	{
+	sbyte _slen;
+	sbyte _trans;
+	int _keys;
+	sbyte _inds;
+
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	_keys = cs<<1;
+	_inds = _row_disp_comb_base[cs];
+
+	if ( _row_disp_trans_keys[_keys] <= data[p] && data[p] <= _row_disp_trans_keys[_keys+1] ) {
+		_slen = (sbyte) (data[p] - _row_disp_trans_keys[_keys]);
+		_trans = _row_disp_comb_check[_inds + _slen] == cs ?
+			_row_disp_indicies[_inds + _slen] : _row_disp_default_trans[_keys+1];
+	}
+	else
+		_trans = _row_disp_default_trans[_keys];
+
+	cs = _row_disp_trans_targs[_trans];
+
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	_out: {}
+	}
+
+#line 30 "row_disp"
+
+		return cs >= row_disp_first_final;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "12.5 abc \"x\\\"y\";", true ),
+			Tuple.Create( "a_1 7;", true ),
+			Tuple.Create( ";", true ),
+			Tuple.Create( "12.;", false ),
+			Tuple.Create( "1..2;", false ),
+			Tuple.Create( "\"open;", false ),
+			Tuple.Create( "Abc;", false ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			if ( Accepts( c.Item1 ) != c.Item2 ) {
+				Console.WriteLine( "FAIL {0}", c.Item1 );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
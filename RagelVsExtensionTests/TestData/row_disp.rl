@@ -0,0 +1,55 @@
+﻿// The -F2 style packs the rows of the flat table into one array by row
+// displacement. The generator test compares the generated text only. Built
+// and run on its own, Main checks that rows sharing the packed array still
+// accept and reject the same input as the plain flat style.
+
+using System;
+using System.Text;
+
+public static class RowDisp
+{
+	%%{
+		machine row_disp;
+		alphtype byte;
+
+		number = [0-9]+ ( '.' [0-9]+ )?;
+		ident = [a-z_] [a-z_0-9]*;
+		str = '"' ( [^"\\] | '\\' any )* '"';
+		main := ( ( number | ident | str ) ' '? )* ';';
+	}%%
+
+	%% write data;
+
+	static bool Accepts( string input )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length;
+
+		%% write init;
+		%% write exec;
+
+		return cs >= row_disp_first_final;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "12.5 abc \"x\\\"y\";", true ),
+			Tuple.Create( "a_1 7;", true ),
+			Tuple.Create( ";", true ),
+			Tuple.Create( "12.;", false ),
+			Tuple.Create( "1..2;", false ),
+			Tuple.Create( "\"open;", false ),
+			Tuple.Create( "Abc;", false ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			if ( Accepts( c.Item1 ) != c.Item2 ) {
+				Console.WriteLine( "FAIL {0}", c.Item1 );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
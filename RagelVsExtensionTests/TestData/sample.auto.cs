@@ -0,0 +1,130 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "sample"
+
+#line 9 "sample"
+
+
+// ReSharper disable All
+
+using System.Collections.Generic;
+
+namespace Sample
+{
+	public partial class SampleLexer
+	{
+
+		
+static readonly sbyte[] _sample_to_state_actions =  new sbyte [] {
+	0, 1
+};
+
+static readonly sbyte[] _sample_from_state_actions =  new sbyte [] {
+	0, 2
+};
+
+const int sample_start = 1;
+const int sample_first_final = 1;
+const int sample_error = 0;
+
+const int sample_en_main = 1;
+
+
+#line 21 "sample"
+
+		partial void Init()
+		{
+			
+	{
+	cs = sample_start;
+	ts = -1;
+	te = -1;
+	act = 0;
+	}
+
+#line 25 "sample"
+		}
+
+		private IEnumerable<Token> GetTokens()
+		{
+			
+	{
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	switch ( _sample_from_state_actions[cs] ) {
+	case 2:
+#line 1 "NONE"
+	{ts = p;}
+	break;
+		default: break;
+	}
+
+	switch ( cs ) {
+case 1:
+	switch( data[p] ) {
+		case '\u0020': goto tr0;
+		case '\u007b': goto tr2;
+		case '\u007d': goto tr3;
+		default: break;
+	}
+	if ( 9u <= data[p] && data[p] <= 13u )
+		goto tr0;
+	goto tr1;
+case 0:
+	goto _out;
+		default: break;
+	}
+
+	tr1: cs = 0; goto _again;
+	tr0: cs = 1; goto f2;
+	tr2: cs = 1; goto f3;
+	tr3: cs = 1; goto f4;
+
+f3:
+#line 5 "sample"
+	{te = p+1;{ yield return Emit(TokenType.LCurly); }}
+	goto _again;
+f4:
+#line 6 "sample"
+	{te = p+1;{ yield return Emit(TokenType.RCurly); }}
+	goto _again;
+f2:
+#line 7 "sample"
+	{te = p+1;}
+	goto _again;
+
+_again:
+	switch ( _sample_to_state_actions[cs] ) {
+	case 1:
+#line 1 "NONE"
+	{ts = -1;}
+	break;
+		default: break;
+	}
+
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	_out: {}
+	}
+
+#line 30 "sample"
+		}
+	}
+}
+
+// ReSharper restore All
\ No newline at end of file
@@ -0,0 +1,170 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "scattered_keys"
+// Goto-style states test scattered keys with a bitmap when one transition
+// takes most of them, and with a jump switch when many short-span keys go to
+// different places. The generator test compares the generated text only.
+// Built and run on its own, Main checks that both tests send every key
+// where the range tests would.
+
+using System;
+using System.Text;
+
+public static class ScatteredKeys
+{
+	
+#line 20 "scattered_keys"
+
+
+	
+const int scattered_keys_start = 1;
+const int scattered_keys_first_final = 9;
+const int scattered_keys_error = 0;
+
+const int scattered_keys_en_main = 1;
+
+
+#line 23 "scattered_keys"
+
+	static bool Accepts( string input )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length;
+
+		
+	{
+	cs = scattered_keys_start;
+	}
+
+#line 30 "scattered_keys"
+		
+	{
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	switch ( cs ) {
+case 1:
+	switch( data[p] ) {
+		case 10:
+			goto tr0;
+		case 33:
+		case 44:
+		case 46:
+		case 58:
+		case 59:
+		case 63:
+			goto tr2;
+		case 97:
+			goto tr3;
+		case 98:
+			goto tr4;
+		case 99:
+			goto tr5;
+		case 100:
+			goto tr6;
+		case 101:
+			goto tr7;
+		case 102:
+			goto tr8;
+		case 113:
+			goto tr9;
+		default: break;
+	}
+	goto tr1;
+case 0:
+	goto _out;
+case 9:
+	goto tr1;
+case 2:
+	if ( data[p] == 120u )
+		goto tr2;
+	goto tr1;
+case 3:
+	if ( data[p] == 121u )
+		goto tr2;
+	goto tr1;
+case 4:
+	if ( data[p] == 122u )
+		goto tr2;
+	goto tr1;
+case 5:
+	if ( data[p] == 49u )
+		goto tr2;
+	goto tr1;
+case 6:
+	if ( data[p] == 50u )
+		goto tr2;
+	goto tr1;
+case 7:
+	if ( data[p] == 51u )
+		goto tr2;
+	goto tr1;
+case 8:
+	if ( data[p] == 101u )
+		goto tr2;
+	if ( (uint)(data[p] - 33u) < 31 && ( ( 0x46002801u >> (int)(data[p] - 33u) ) & 1 ) != 0 )
+		goto tr9;
+	goto tr1;
+		default: break;
+	}
+
+	tr1: cs = 0; goto _again;
+	tr2: cs = 1; goto _again;
+	tr3: cs = 2; goto _again;
+	tr4: cs = 3; goto _again;
+	tr5: cs = 4; goto _again;
+	tr6: cs = 5; goto _again;
+	tr7: cs = 6; goto _again;
+	tr8: cs = 7; goto _again;
+	tr9: cs = 8; goto _again;
+	tr0: cs = 9; goto _again;
+
+_again:
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	_out: {}
+	}
+
+#line 31 "scattered_keys"
+
+		return cs >= scattered_keys_first_final;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "ax,by;cz:d1!e2?f3.\n", true ),
+			Tuple.Create( "q!,.:;?e\n", true ),
+			Tuple.Create( "qe;q.e\n", true ),
+			Tuple.Create( "\n", true ),
+			Tuple.Create( "ay\n", false ),
+			Tuple.Create( "q!-e\n", false ),
+			Tuple.Create( "q!\n", false ),
+			Tuple.Create( "g\n", false ),
+			Tuple.Create( "-\n", false ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			if ( Accepts( c.Item1 ) != c.Item2 ) {
+				Console.WriteLine( "FAIL {0}", c.Item1 );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
@@ -0,0 +1,58 @@
+﻿// Goto-style states test scattered keys with a bitmap when one transition
+// takes most of them, and with a jump switch when many short-span keys go to
+// different places. The generator test compares the generated text only.
+// Built and run on its own, Main checks that both tests send every key
+// where the range tests would.
+
+using System;
+using System.Text;
+
+public static class ScatteredKeys
+{
+	%%{
+		machine scattered_keys;
+		alphtype byte;
+
+		marks = [!,.:;?];
+		pair = 'a' 'x' | 'b' 'y' | 'c' 'z' | 'd' '1' | 'e' '2' | 'f' '3';
+		quote = 'q' marks* 'e';
+		main := ( pair | quote | marks )* '\n';
+	}%%
+
+	%% write data;
+
+	static bool Accepts( string input )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length;
+
+		%% write init;
+		%% write exec;
+
+		return cs >= scattered_keys_first_final;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "ax,by;cz:d1!e2?f3.\n", true ),
+			Tuple.Create( "q!,.:;?e\n", true ),
+			Tuple.Create( "qe;q.e\n", true ),
+			Tuple.Create( "\n", true ),
+			Tuple.Create( "ay\n", false ),
+			Tuple.Create( "q!-e\n", false ),
+			Tuple.Create( "q!\n", false ),
+			Tuple.Create( "g\n", false ),
+			Tuple.Create( "-\n", false ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			if ( Accepts( c.Item1 ) != c.Item2 ) {
+				Console.WriteLine( "FAIL {0}", c.Item1 );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
@@ -0,0 +1,189 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "span_tables"
+// With --span-tables, tables of bytes are written as ReadOnlySpan properties
+// over constant data. The generator test compares the generated text only.
+// Built and run on its own, Main checks that the machine reads its tables
+// through the spans the same way it reads arrays.
+
+using System;
+using System.Text;
+
+public static class SpanTables
+{
+	
+#line 19 "span_tables"
+
+
+	
+static System.ReadOnlySpan<sbyte> _span_tables_actions => new sbyte [] {
+	0, 1, 0
+};
+
+static System.ReadOnlySpan<sbyte> _span_tables_key_offsets => new sbyte [] {
+	0, 2
+};
+
+static System.ReadOnlySpan<byte> _span_tables_trans_keys => new byte [] {
+	10, 44, 10, 44, 0
+};
+
+static System.ReadOnlySpan<sbyte> _span_tables_single_lengths => new sbyte [] {
+	2, 2
+};
+
+static System.ReadOnlySpan<sbyte> _span_tables_range_lengths => new sbyte [] {
+	0, 0
+};
+
+static System.ReadOnlySpan<sbyte> _span_tables_index_offsets => new sbyte [] {
+	0, 3
+};
+
+static System.ReadOnlySpan<sbyte> _span_tables_trans_targs => new sbyte [] {
+	1, 0, 0, 1, 0, 0, 0
+};
+
+static System.ReadOnlySpan<sbyte> _span_tables_trans_actions => new sbyte [] {
+	1, 1, 0, 1, 1, 0, 0
+};
+
+const int span_tables_start = 1;
+const int span_tables_first_final = 1;
+const int span_tables_error = -1;
+
+const int span_tables_en_main = 1;
+
+
+#line 22 "span_tables"
+
+	static int Fields( string input )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length, fields = 0;
+
+		
+	{
+	cs = span_tables_start;
+	}
+
+#line 29 "span_tables"
+		
+	{
+	sbyte _klen;
+	sbyte _trans;
+	int _acts;
+	int _nacts;
+	sbyte _keys;
+
+	if ( p == pe )
+		goto _test_eof;
+_resume:
+	_keys = _span_tables_key_offsets[cs];
+	_trans = (sbyte)_span_tables_index_offsets[cs];
+
+	_klen = _span_tables_single_lengths[cs];
+	if ( _klen > 0 ) {
+		sbyte _lower = _keys;
+		sbyte _mid;
+		sbyte _upper = (sbyte) (_keys + _klen - 1);
+		while (true) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = (sbyte) (_lower + ((_upper-_lower) >> 1));
+			if ( data[p] < _span_tables_trans_keys[_mid] )
+				_upper = (sbyte) (_mid - 1);
+			else if ( data[p] > _span_tables_trans_keys[_mid] )
+				_lower = (sbyte) (_mid + 1);
+			else {
+				_trans += (sbyte) (_mid - _keys);
+				goto _match;
+			}
+		}
+		_keys += (sbyte) _klen;
+		_trans += (sbyte) _klen;
+	}
+
+	_klen = _span_tables_range_lengths[cs];
+	if ( _klen > 0 ) {
+		sbyte _lower = _keys;
+		sbyte _mid;
+		sbyte _upper = (sbyte) (_keys + (_klen<<1) - 2);
+		while (true) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = (sbyte) (_lower + (((_upper-_lower) >> 1) & ~1));
+			if ( data[p] < _span_tables_trans_keys[_mid] )
+				_upper = (sbyte) (_mid - 2);
+			else if ( data[p] > _span_tables_trans_keys[_mid+1] )
+				_lower = (sbyte) (_mid + 2);
+			else {
+				_trans += (sbyte)((_mid - _keys)>>1);
+				goto _match;
+			}
+		}
+		_trans += (sbyte) _klen;
+	}
+
+_match:
+	cs = _span_tables_trans_targs[_trans];
+
+	if ( _span_tables_trans_actions[_trans] == 0 )
+		goto _again;
+
+	_acts = _span_tables_trans_actions[_trans];
+	_nacts = _span_tables_actions[_acts++];
+	while ( _nacts-- > 0 )
+	{
+		switch ( _span_tables_actions[_acts++] )
+		{
+	case 0:
+#line 15 "span_tables"
+	{ fields++; }
+	break;
+		default: break;
+		}
+	}
+
+_again:
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	}
+
+#line 30 "span_tables"
+
+		return cs == span_tables_error ? -1 : fields;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "a,b,c\n", 3 ),
+			Tuple.Create( "a,,\nxyz\n", 4 ),
+			Tuple.Create( "\n\n", 2 ),
+			Tuple.Create( "", 0 ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			int n = Fields( c.Item1 );
+			if ( n != c.Item2 ) {
+				Console.WriteLine( "FAIL {0}: {1}", c.Item1.Replace( "\n", "|" ), n );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
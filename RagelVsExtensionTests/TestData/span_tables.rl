@@ -0,0 +1,53 @@
+﻿// With --span-tables, tables of bytes are written as ReadOnlySpan properties
+// over constant data. The generator test compares the generated text only.
+// Built and run on its own, Main checks that the machine reads its tables
+// through the spans the same way it reads arrays.
+
+using System;
+using System.Text;
+
+public static class SpanTables
+{
+	%%{
+		machine span_tables;
+		alphtype byte;
+
+		action field { fields++; }
+
+		field = [^,\n]* %field;
+		main := ( field ( ',' field )* '\n' )*;
+	}%%
+
+	%% write data;
+
+	static int Fields( string input )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length, fields = 0;
+
+		%% write init;
+		%% write exec;
+
+		return cs == span_tables_error ? -1 : fields;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "a,b,c\n", 3 ),
+			Tuple.Create( "a,,\nxyz\n", 4 ),
+			Tuple.Create( "\n\n", 2 ),
+			Tuple.Create( "", 0 ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			int n = Fields( c.Item1 );
+			if ( n != c.Item2 ) {
+				Console.WriteLine( "FAIL {0}: {1}", c.Item1.Replace( "\n", "|" ), n );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
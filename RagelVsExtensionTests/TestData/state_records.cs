@@ -0,0 +1,249 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "state_records"
+// The -T2 style packs each state's key offset, lengths and index offset
+// into one record. The generator test compares the generated text only.
+// Built and run on its own, Main checks that keywords, identifiers and
+// numbers are counted the same way the -T0 tables would count them.
+
+using System;
+using System.Text;
+
+public static class StateRecords
+{
+	
+#line 25 "state_records"
+
+
+	
+static readonly sbyte[] _state_records_records =  new sbyte [] {
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 6, 2, 0, 0, 2, 1, 0, 
+	0, 0, 10, 1, 3, 32, 1, 3, 
+	101, 4, 0, 105, 7, 0, 114, 8, 
+	0, 119, 13, 0, 48, 57, 2, 0, 
+	97, 122, 3, 4, 0, 1, 1, 5, 
+	0, 0, 1, 1, 5, 48, 57, 2, 
+	0, 0, 1, 1, 6, 0, 0, 1, 
+	1, 6, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 108, 
+	5, 0, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 115, 
+	6, 0, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 101, 
+	3, 8, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 102, 
+	3, 8, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 101, 
+	9, 0, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 116, 
+	10, 0, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 117, 
+	11, 0, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 114, 
+	12, 0, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 110, 
+	3, 8, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 104, 
+	14, 0, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 105, 
+	15, 0, 97, 122, 3, 4, 1, 1, 
+	1, 7, 0, 0, 1, 1, 7, 108, 
+	6, 0, 97, 122, 3, 4
+};
+
+static readonly short[] _state_records_record_offsets =  new short [] {
+	0, 9, 44, 57, 70, 86, 102, 118, 
+	134, 150, 166, 182, 198, 214, 230, 246
+};
+
+const int state_records_start = 1;
+const int state_records_first_final = 1;
+const int state_records_error = 0;
+
+const int state_records_en_main = 1;
+
+
+#line 28 "state_records"
+
+	static bool Count( string input, out int keywords, out int idents, out int numbers )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, act, ts, te, p = 0, pe = data.Length, eof = pe;
+		keywords = idents = numbers = 0;
+
+		
+	{
+	cs = state_records_start;
+	ts = -1;
+	te = -1;
+	act = 0;
+	}
+
+#line 36 "state_records"
+		
+	{
+	int _klen, _rec, _ent;
+
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	switch ( _state_records_records[_state_records_record_offsets[cs] + 4] ) {
+	case 2:
+#line 1 "NONE"
+	{ts = p;}
+	break;
+		default: break;
+	}
+
+	_rec = _state_records_record_offsets[cs];
+	_ent = _rec + 9;
+
+	_klen = _state_records_records[_rec];
+	if ( _klen > 0 ) {
+		int _lower = 0;
+		int _upper = _klen - 1;
+		int _mid;
+		while ( _lower <= _upper ) {
+			_mid = (_lower + _upper) >> 1;
+			if ( data[p] < _state_records_records[_ent + _mid*3] )
+				_upper = _mid - 1;
+			else if ( data[p] > _state_records_records[_ent + _mid*3] )
+				_lower = _mid + 1;
+			else {
+				_ent += _mid*3;
+				goto _match;
+			}
+		}
+		_ent += _klen*3;
+	}
+
+	_klen = _state_records_records[_rec + 1];
+	if ( _klen > 0 ) {
+		int _lower = 0;
+		int _upper = _klen - 1;
+		int _mid;
+		while ( _lower <= _upper ) {
+			_mid = (_lower + _upper) >> 1;
+			if ( data[p] < _state_records_records[_ent + _mid*4] )
+				_upper = _mid - 1;
+			else if ( data[p] > _state_records_records[_ent + _mid*4 + 1] )
+				_lower = _mid + 1;
+			else {
+				_ent += _mid*4 + 1;
+				goto _match;
+			}
+		}
+	}
+
+	_ent = _rec + 1;
+
+_match:
+_eof_trans:
+	cs = _state_records_records[_ent + 1];
+
+	if ( _state_records_records[_ent + 2] == 0 )
+		goto _again;
+
+	switch ( _state_records_records[_ent + 2] ) {
+	case 3:
+#line 23 "state_records"
+	{te = p+1;}
+	break;
+	case 7:
+#line 16 "state_records"
+	{te = p;p--;{ idents++; }}
+	break;
+	case 5:
+#line 17 "state_records"
+	{te = p;p--;{ numbers++; }}
+	break;
+	case 6:
+#line 1 "NONE"
+	{	switch( act ) {
+	case 1:
+	{{p = ((te))-1;} keywords++; }
+	break;
+	case 2:
+	{{p = ((te))-1;} idents++; }
+	break;
+	}
+	}
+	break;
+	case 8:
+#line 1 "NONE"
+	{te = p+1;}
+#line 15 "state_records"
+	{act = 1;}
+	break;
+	case 4:
+#line 1 "NONE"
+	{te = p+1;}
+#line 16 "state_records"
+	{act = 2;}
+	break;
+		default: break;
+	}
+
+_again:
+	switch ( _state_records_records[_state_records_record_offsets[cs] + 5] ) {
+	case 1:
+#line 1 "NONE"
+	{ts = -1;}
+	break;
+		default: break;
+	}
+
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	if ( p == eof )
+	{
+	_rec = _state_records_record_offsets[cs];
+	if ( _state_records_records[_rec + 6] > 0 ) {
+		_ent = _rec + 6;
+		goto _eof_trans;
+	}
+	}
+
+	_out: {}
+	}
+
+#line 37 "state_records"
+
+		return cs != state_records_error;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "if x return 42\nelse whilex 7", true, 3, 2, 2 ),
+			Tuple.Create( "iff el retur", true, 0, 3, 0 ),
+			Tuple.Create( "while 1 X", false, 1, 0, 1 ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			int k, i, n;
+			bool ok = Count( c.Item1, out k, out i, out n );
+			if ( ok != c.Item2 || k != c.Item3 || i != c.Item4 || n != c.Item5 ) {
+				Console.WriteLine( "FAIL {0}: {1} {2} {3} {4}", c.Item1, ok, k, i, n );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
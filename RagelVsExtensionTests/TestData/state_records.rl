@@ -0,0 +1,60 @@
+﻿// The -T2 style packs each state's key offset, lengths and index offset
+// into one record. The generator test compares the generated text only.
+// Built and run on its own, Main checks that keywords, identifiers and
+// numbers are counted the same way the -T0 tables would count them.
+
+using System;
+using System.Text;
+
+public static class StateRecords
+{
+	%%{
+		machine state_records;
+		alphtype byte;
+
+		action kw { keywords++; }
+		action id { idents++; }
+		action num { numbers++; }
+
+		main := |*
+			'if' | 'else' | 'while' | 'return' => kw;
+			[a-z]+ => id;
+			[0-9]+ => num;
+			' ' | '\n';
+		*|;
+	}%%
+
+	%% write data;
+
+	static bool Count( string input, out int keywords, out int idents, out int numbers )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, act, ts, te, p = 0, pe = data.Length, eof = pe;
+		keywords = idents = numbers = 0;
+
+		%% write init;
+		%% write exec;
+
+		return cs != state_records_error;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "if x return 42\nelse whilex 7", true, 3, 2, 2 ),
+			Tuple.Create( "iff el retur", true, 0, 3, 0 ),
+			Tuple.Create( "while 1 X", false, 1, 0, 1 ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			int k, i, n;
+			bool ok = Count( c.Item1, out k, out i, out n );
+			if ( ok != c.Item2 || k != c.Item3 || i != c.Item4 || n != c.Item5 ) {
+				Console.WriteLine( "FAIL {0}: {1} {2} {3} {4}", c.Item1, ok, k, i, n );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
@@ -0,0 +1,329 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "stream_tokens"
+/*
+ * 'write stream' writes a fixed size buffer refilled through a read callback
+ * and a fill function to call before each exec. The generator test compares
+ * the generated text only. Built and run on its own, main checks that small
+ * buffers and short reads find the tokens one read of the whole input finds.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+struct source
+{
+	const char *data;
+	long len, step;
+};
+
+static long read_source( void *ctx, char *data, long len )
+{
+	struct source *src = ctx;
+	if ( len > src->step )
+		len = src->step;
+	if ( len > src->len )
+		len = src->len;
+	memcpy( data, src->data, len );
+	src->data += len;
+	src->len -= len;
+	return len;
+}
+
+
+#line 39 "stream_tokens"
+
+
+
+static const char _stream_tokens_actions[] = {
+	0, 1, 0, 1, 1, 1, 2, 1, 
+	3, 1, 4, 1, 5
+};
+
+static const char _stream_tokens_key_offsets[] = {
+	0, 0, 6, 8, 12
+};
+
+static const char _stream_tokens_trans_keys[] = {
+	10, 32, 48, 57, 97, 122, 48, 57, 
+	48, 57, 97, 122, 48, 57, 0
+};
+
+static const char _stream_tokens_single_lengths[] = {
+	0, 2, 0, 0, 0
+};
+
+static const char _stream_tokens_range_lengths[] = {
+	0, 2, 1, 2, 1
+};
+
+static const char _stream_tokens_index_offsets[] = {
+	0, 0, 5, 7, 10
+};
+
+static const char _stream_tokens_trans_targs[] = {
+	1, 1, 2, 3, 0, 2, 1, 4, 
+	3, 1, 4, 1, 1, 1, 1, 0
+};
+
+static const char _stream_tokens_trans_actions[] = {
+	5, 5, 0, 0, 0, 0, 9, 0, 
+	0, 7, 0, 11, 9, 7, 11, 0
+};
+
+static const char _stream_tokens_to_state_actions[] = {
+	0, 1, 0, 0, 0
+};
+
+static const char _stream_tokens_from_state_actions[] = {
+	0, 3, 0, 0, 0
+};
+
+static const char _stream_tokens_eof_trans[] = {
+	0, 0, 13, 14, 15
+};
+
+static const int stream_tokens_start = 1;
+static const int stream_tokens_first_final = 1;
+static const int stream_tokens_error = 0;
+
+static const int stream_tokens_en_main = 1;
+
+
+#line 42 "stream_tokens"
+
+#include <string.h>
+
+struct stream_tokens_stream
+{
+	char *buf;
+	long size;
+	long (*read)( void *ctx, char *data, long len );
+	void *ctx;
+};
+
+static long stream_tokens_stream_fill( struct stream_tokens_stream *s, char **p, char **pe, char **eof, char **ts, char **te )
+{
+	long keep = 0, len;
+	if ( *pe == 0 )
+		*p = s->buf;
+	else {
+		char *from = *ts != 0 ? *ts : *p;
+		keep = *pe - from;
+		if ( keep == s->size )
+			return -1;
+		if ( from != s->buf ) {
+			long shift = from - s->buf;
+			memmove( s->buf, from, keep * sizeof(char) );
+			*p -= shift;
+			if ( *ts != 0 ) {
+				*te = *te >= from ? *te - shift : 0;
+				*ts = s->buf;
+			}
+		}
+	}
+	len = s->read( s->ctx, s->buf + keep, s->size - keep );
+	if ( len < 0 )
+		return len;
+	*pe = s->buf + keep + len;
+	*eof = len == 0 ? *pe : 0;
+	return len;
+}
+
+
+#line 43 "stream_tokens"
+
+static int scan( const char *input, long size, long step, int *words, int *numbers )
+{
+	char buf[64];
+	struct source src = { input, (long) strlen( input ), step };
+	struct stream_tokens_stream s = { buf, size, read_source, &src };
+	char *p = 0, *pe = 0, *eof = 0, *ts, *te;
+	int cs, act, nw = 0, nn = 0;
+	long len;
+
+	
+	{
+	cs = stream_tokens_start;
+	ts = 0;
+	te = 0;
+	act = 0;
+	}
+
+#line 54 "stream_tokens"
+	do {
+		len = stream_tokens_stream_fill( &s, &p, &pe, &eof, &ts, &te );
+		if ( len < 0 )
+			return -1;
+		
+	{
+	int _klen;
+	unsigned int _trans;
+	const char *_acts;
+	unsigned int _nacts;
+	const char *_keys;
+
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	_acts = _stream_tokens_actions + _stream_tokens_from_state_actions[cs];
+	_nacts = (unsigned int) *_acts++;
+	while ( _nacts-- > 0 ) {
+		switch ( *_acts++ ) {
+	case 1:
+#line 1 "NONE"
+	{ts = p;}
+	break;
+		}
+	}
+
+	_keys = _stream_tokens_trans_keys + _stream_tokens_key_offsets[cs];
+	_trans = _stream_tokens_index_offsets[cs];
+
+	_klen = _stream_tokens_single_lengths[cs];
+	if ( _klen > 0 ) {
+		const char *_lower = _keys;
+		const char *_mid;
+		const char *_upper = _keys + _klen - 1;
+		while (1) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = _lower + ((_upper-_lower) >> 1);
+			if ( (*p) < *_mid )
+				_upper = _mid - 1;
+			else if ( (*p) > *_mid )
+				_lower = _mid + 1;
+			else {
+				_trans += (unsigned int)(_mid - _keys);
+				goto _match;
+			}
+		}
+		_keys += _klen;
+		_trans += _klen;
+	}
+
+	_klen = _stream_tokens_range_lengths[cs];
+	if ( _klen > 0 ) {
+		const char *_lower = _keys;
+		const char *_mid;
+		const char *_upper = _keys + (_klen<<1) - 2;
+		while (1) {
+			if ( _upper < _lower )
+				break;
+
+			_mid = _lower + (((_upper-_lower) >> 1) & ~1);
+			if ( (*p) < _mid[0] )
+				_upper = _mid - 2;
+			else if ( (*p) > _mid[1] )
+				_lower = _mid + 2;
+			else {
+				_trans += (unsigned int)((_mid - _keys)>>1);
+				goto _match;
+			}
+		}
+		_trans += _klen;
+	}
+
+_match:
+_eof_trans:
+	cs = _stream_tokens_trans_targs[_trans];
+
+	if ( _stream_tokens_trans_actions[_trans] == 0 )
+		goto _again;
+
+	_acts = _stream_tokens_actions + _stream_tokens_trans_actions[_trans];
+	_nacts = (unsigned int) *_acts++;
+	while ( _nacts-- > 0 )
+	{
+		switch ( *_acts++ )
+		{
+	case 2:
+#line 37 "stream_tokens"
+	{te = p+1;}
+	break;
+	case 3:
+#line 34 "stream_tokens"
+	{te = p;p--;{ nw++; }}
+	break;
+	case 4:
+#line 35 "stream_tokens"
+	{te = p;p--;{ nn++; }}
+	break;
+	case 5:
+#line 36 "stream_tokens"
+	{te = p;p--;{ nw++; nn++; }}
+	break;
+		}
+	}
+
+_again:
+	_acts = _stream_tokens_actions + _stream_tokens_to_state_actions[cs];
+	_nacts = (unsigned int) *_acts++;
+	while ( _nacts-- > 0 ) {
+		switch ( *_acts++ ) {
+	case 0:
+#line 1 "NONE"
+	{ts = 0;}
+	break;
+		}
+	}
+
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	if ( p == eof )
+	{
+	if ( _stream_tokens_eof_trans[cs] > 0 ) {
+		_trans = _stream_tokens_eof_trans[cs] - 1;
+		goto _eof_trans;
+	}
+	}
+
+	_out: {}
+	}
+
+#line 59 "stream_tokens"
+	} while ( len > 0 && cs != stream_tokens_error );
+
+	*words = nw;
+	*numbers = nn;
+	return cs;
+}
+
+int main()
+{
+	const char *input = "alpha 12 beta7 gamma\n345 delta epsilon99 z 0\nomega";
+	int words, numbers, failed = 0;
+	long size, step;
+
+	for ( size = 10; size <= 64; size += 9 ) {
+		for ( step = 1; step <= size; step += 3 ) {
+			int cs = scan( input, size, step, &words, &numbers );
+			if ( cs != stream_tokens_start || words != 7 || numbers != 5 ) {
+				printf( "FAIL size %ld step %ld: cs=%d %d %d\n",
+						size, step, cs, words, numbers );
+				failed = 1;
+			}
+		}
+	}
+
+	if ( scan( "abcdefghijklmnop", 8, 8, &words, &numbers ) != -1 ) {
+		printf( "FAIL a token longer than the buffer was not reported\n" );
+		failed = 1;
+	}
+	return failed;
+}
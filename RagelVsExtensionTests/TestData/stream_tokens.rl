@@ -0,0 +1,88 @@
+﻿/*
+ * 'write stream' writes a fixed size buffer refilled through a read callback
+ * and a fill function to call before each exec. The generator test compares
+ * the generated text only. Built and run on its own, main checks that small
+ * buffers and short reads find the tokens one read of the whole input finds.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+struct source
+{
+	const char *data;
+	long len, step;
+};
+
+static long read_source( void *ctx, char *data, long len )
+{
+	struct source *src = ctx;
+	if ( len > src->step )
+		len = src->step;
+	if ( len > src->len )
+		len = src->len;
+	memcpy( data, src->data, len );
+	src->data += len;
+	src->len -= len;
+	return len;
+}
+
+%%{
+	machine stream_tokens;
+
+	main := |*
+		[a-z]+ => { nw++; };
+		[0-9]+ => { nn++; };
+		[a-z]+ [0-9]+ => { nw++; nn++; };
+		' ' | '\n';
+	*|;
+}%%
+
+%% write data;
+%% write stream;
+
+static int scan( const char *input, long size, long step, int *words, int *numbers )
+{
+	char buf[64];
+	struct source src = { input, (long) strlen( input ), step };
+	struct stream_tokens_stream s = { buf, size, read_source, &src };
+	char *p = 0, *pe = 0, *eof = 0, *ts, *te;
+	int cs, act, nw = 0, nn = 0;
+	long len;
+
+	%% write init;
+	do {
+		len = stream_tokens_stream_fill( &s, &p, &pe, &eof, &ts, &te );
+		if ( len < 0 )
+			return -1;
+		%% write exec;
+	} while ( len > 0 && cs != stream_tokens_error );
+
+	*words = nw;
+	*numbers = nn;
+	return cs;
+}
+
+int main()
+{
+	const char *input = "alpha 12 beta7 gamma\n345 delta epsilon99 z 0\nomega";
+	int words, numbers, failed = 0;
+	long size, step;
+
+	for ( size = 10; size <= 64; size += 9 ) {
+		for ( step = 1; step <= size; step += 3 ) {
+			int cs = scan( input, size, step, &words, &numbers );
+			if ( cs != stream_tokens_start || words != 7 || numbers != 5 ) {
+				printf( "FAIL size %ld step %ld: cs=%d %d %d\n",
+						size, step, cs, words, numbers );
+				failed = 1;
+			}
+		}
+	}
+
+	if ( scan( "abcdefghijklmnop", 8, 8, &words, &numbers ) != -1 ) {
+		printf( "FAIL a token longer than the buffer was not reported\n" );
+		failed = 1;
+	}
+	return failed;
+}
@@ -0,0 +1,203 @@
+﻿// <auto-generated>
+//
+//      This code was auto-generated on Friday, 1 January 2016 8:00 AM.
+//
+//      DO NOT EDIT THIS FILE.
+//
+//      Changes to this file may cause incorrect behaviour and will be lost if
+//      the code is regenerated.
+//
+// </auto-generated>
+
+#line 1 "unsafe_tables"
+// With --unsafe the tables are pinned once and read through pointers, and
+// the exec pins the data. The generator test compares the generated text
+// only. Built with unsafe code allowed and run on its own, Main checks that
+// the pointer reads give the same tokens as the array reads.
+
+using System;
+using System.Text;
+
+public static class UnsafeTables
+{
+	
+#line 22 "unsafe_tables"
+
+
+	
+static readonly unsafe byte* _unsafe_tables_trans_keys = (byte*)(void*) System.Runtime.InteropServices.GCHandle.Alloc( new byte [] {
+	0, 0, 10, 122, 9, 57, 9, 122, 9, 122, 0, 0, 0
+}, System.Runtime.InteropServices.GCHandleType.Pinned ).AddrOfPinnedObject();
+
+static readonly unsafe sbyte* _unsafe_tables_key_spans = (sbyte*)(void*) System.Runtime.InteropServices.GCHandle.Alloc( new sbyte [] {
+	0, 113, 49, 114, 114, 0
+}, System.Runtime.InteropServices.GCHandleType.Pinned ).AddrOfPinnedObject();
+
+static readonly unsafe short* _unsafe_tables_index_offsets = (short*)(void*) System.Runtime.InteropServices.GCHandle.Alloc( new short [] {
+	0, 0, 114, 164, 279, 394
+}, System.Runtime.InteropServices.GCHandleType.Pinned ).AddrOfPinnedObject();
+
+static readonly unsafe sbyte* _unsafe_tables_indicies = (sbyte*)(void*) System.Runtime.InteropServices.GCHandle.Alloc( new sbyte [] {
+	0, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 2, 
+	2, 2, 2, 2, 2, 2, 2, 2, 
+	2, 1, 1, 1, 1, 1, 1, 1, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 1, 1, 1, 1, 1, 1, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 1, 4, 5, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 4, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 2, 2, 2, 2, 2, 2, 
+	2, 2, 2, 2, 1, 6, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 6, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 2, 2, 2, 2, 
+	2, 2, 2, 2, 2, 2, 1, 1, 
+	1, 1, 1, 1, 1, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 1, 
+	1, 1, 1, 1, 1, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 1, 
+	7, 8, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 7, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	1, 1, 1, 1, 1, 1, 1, 1, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 1, 1, 1, 1, 1, 1, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 3, 3, 3, 3, 3, 3, 
+	3, 3, 1, 1, 0
+}, System.Runtime.InteropServices.GCHandleType.Pinned ).AddrOfPinnedObject();
+
+static readonly unsafe sbyte* _unsafe_tables_trans_targs = (sbyte*)(void*) System.Runtime.InteropServices.GCHandle.Alloc( new sbyte [] {
+	5, 0, 2, 4, 3, 5, 3, 3, 
+	5
+}, System.Runtime.InteropServices.GCHandleType.Pinned ).AddrOfPinnedObject();
+
+static readonly unsafe sbyte* _unsafe_tables_trans_actions = (sbyte*)(void*) System.Runtime.InteropServices.GCHandle.Alloc( new sbyte [] {
+	0, 0, 1, 0, 2, 2, 0, 3, 
+	3
+}, System.Runtime.InteropServices.GCHandleType.Pinned ).AddrOfPinnedObject();
+
+const int unsafe_tables_start = 1;
+const int unsafe_tables_first_final = 5;
+const int unsafe_tables_error = 0;
+
+const int unsafe_tables_en_main = 1;
+
+
+#line 25 "unsafe_tables"
+
+	static bool Scan( string input, out int words, out int sum )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length, n = 0;
+		words = sum = 0;
+
+		
+	{
+	cs = unsafe_tables_start;
+	}
+
+#line 33 "unsafe_tables"
+		
+	unsafe {
+	fixed ( byte* _data = data ) {
+	{
+	sbyte _slen;
+	sbyte _trans;
+	int _keys;
+	short _inds;
+	if ( p == pe )
+		goto _test_eof;
+	if ( cs == 0 )
+		goto _out;
+_resume:
+	_keys = cs<<1;
+	_inds = _unsafe_tables_index_offsets[cs];
+
+	_slen = _unsafe_tables_key_spans[cs];
+	_trans = _unsafe_tables_indicies[_inds + (
+		_slen > 0 && _unsafe_tables_trans_keys[_keys] <=_data[p] &&
+		_data[p] <= _unsafe_tables_trans_keys[_keys+1] ?
+		_data[p] - _unsafe_tables_trans_keys[_keys] : _slen ) ];
+
+	cs = _unsafe_tables_trans_targs[_trans];
+
+	if ( _unsafe_tables_trans_actions[_trans] == 0 )
+		goto _again;
+
+	switch ( _unsafe_tables_trans_actions[_trans] ) {
+	case 3:
+#line 15 "unsafe_tables"
+	{ words++; }
+	break;
+	case 2:
+#line 16 "unsafe_tables"
+	{ sum += n; n = 0; }
+	break;
+	case 1:
+#line 17 "unsafe_tables"
+	{ n = n * 10 + ( _data[p] - '0' ); }
+	break;
+		default: break;
+	}
+
+_again:
+	if ( cs == 0 )
+		goto _out;
+	if ( ++p != pe )
+		goto _resume;
+	_test_eof: {}
+	_out: {}
+	}
+	}
+	}
+
+#line 34 "unsafe_tables"
+
+		return cs >= unsafe_tables_first_final;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "abc 12 de\t30\n", true, 2, 42 ),
+			Tuple.Create( "7 8 9\n", true, 0, 24 ),
+			Tuple.Create( "abc-\n", false, 0, 0 ),
+			Tuple.Create( "\n", true, 0, 0 ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			int words, sum;
+			bool ok = Scan( c.Item1, out words, out sum );
+			if ( ok != c.Item2 || words != c.Item3 || sum != c.Item4 ) {
+				Console.WriteLine( "FAIL {0}: {1} {2} {3}", c.Item1, ok, words, sum );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}
@@ -0,0 +1,58 @@
+﻿// With --unsafe the tables are pinned once and read through pointers, and
+// the exec pins the data. The generator test compares the generated text
+// only. Built with unsafe code allowed and run on its own, Main checks that
+// the pointer reads give the same tokens as the array reads.
+
+using System;
+using System.Text;
+
+public static class UnsafeTables
+{
+	%%{
+		machine unsafe_tables;
+		alphtype byte;
+
+		action word { words++; }
+		action num { sum += n; n = 0; }
+		action digit { n = n * 10 + ( fc - '0' ); }
+
+		word = [a-zA-Z]+ %word;
+		num = ( [0-9] @digit )+ %num;
+		main := ( ( word | num ) ( [ \t]+ ( word | num ) )* )? '\n';
+	}%%
+
+	%% write data;
+
+	static bool Scan( string input, out int words, out int sum )
+	{
+		byte[] data = Encoding.ASCII.GetBytes( input );
+		int cs, p = 0, pe = data.Length, n = 0;
+		words = sum = 0;
+
+		%% write init;
+		%% write exec;
+
+		return cs >= unsafe_tables_first_final;
+	}
+
+	public static int Main()
+	{
+		var cases = new[] {
+			Tuple.Create( "abc 12 de\t30\n", true, 2, 42 ),
+			Tuple.Create( "7 8 9\n", true, 0, 24 ),
+			Tuple.Create( "abc-\n", false, 0, 0 ),
+			Tuple.Create( "\n", true, 0, 0 ),
+		};
+
+		int failed = 0;
+		foreach ( var c in cases ) {
+			int words, sum;
+			bool ok = Scan( c.Item1, out words, out sum );
+			if ( ok != c.Item2 || words != c.Item3 || sum != c.Item4 ) {
+				Console.WriteLine( "FAIL {0}: {1} {2} {3}", c.Item1, ok, words, sum );
+				failed = 1;
+			}
+		}
+		return failed;
+	}
+}